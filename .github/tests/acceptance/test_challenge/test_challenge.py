@@ -2,40 +2,31 @@ import pytest
 import time
 import RPi.GPIO as GPIO
 import sys
+import edgestats
 
 
-def test_led_initially_off(setup_gpio):
+def test_led_initially_off(led):
     """Test that LED is initially off when the program starts."""
     
     # Monitor LED state for 5 seconds to ensure it stays consistently off
     try:
-        initial_led_state = GPIO.input(17)
+        initial_led_state = led.level()
         print(f"Initial LED state (GPIO 17): {initial_led_state}")
     except Exception as e:
         pytest.fail(f"Failed to read GPIO 17: {e}. Make sure RPi.GPIO is properly set up.")
     
     # Monitor LED for 5 seconds to detect any unexpected blinking
     transitions = 0
-    led_states = []
-    last_state = initial_led_state
-    start_time = time.time()
+    start_time = led.now()
     monitoring_duration = 5.0
     
     print(f"Monitoring LED for {monitoring_duration} seconds to ensure it stays off...")
     
-    while time.time() - start_time < monitoring_duration:
-        current_state = GPIO.input(17)
-        led_states.append(current_state)
-        
-        if current_state != last_state:
-            transitions += 1
-            transition_time = time.time() - start_time
-            print(f"Unexpected transition at {transition_time:.3f}s: {last_state} -> {current_state}")
-            last_state = current_state
-        
-        time.sleep(0.01)  # Check every 10ms
-    
-    final_state = GPIO.input(17)
+    for transition_time, current_state in led.watch(monitoring_duration):
+        transitions += 1
+        print(f"Unexpected transition at {transition_time - start_time:.3f}s: {1 - current_state} -> {current_state}")
+    
+    final_state = led.level()
     print(f"Final LED state after {monitoring_duration}s: {final_state}")
     print(f"Total transitions detected: {transitions}")
     
@@ -48,11 +39,11 @@ def test_led_initially_off(setup_gpio):
     print("✓ LED is correctly and consistently off initially")
 
 
-def test_led_starts_blinking_on_first_button_press(setup_gpio):
+def test_led_starts_blinking_on_first_button_press(led):
     """Test that LED starts blinking every 500ms after first button press."""
     
     # Verify LED is initially off
-    initial_state = GPIO.input(17)
+    initial_state = led.level()
     print(f"Initial LED state: {initial_state}")
     
     # Simulate first button press
@@ -66,53 +57,39 @@ def test_led_starts_blinking_on_first_button_press(setup_gpio):
     
     # Monitor LED for blinking pattern over 3 seconds
     led_transitions = []
-    last_led_state = GPIO.input(17)
-    start_time = time.time()
+    start_time = led.now()
     monitoring_duration = 3.0  # Monitor for 3 seconds
     
     print(f"Monitoring LED for {monitoring_duration} seconds after button press...")
     
-    while time.time() - start_time < monitoring_duration:
-        current_led_state = GPIO.input(17)
-        
-        if current_led_state != last_led_state:
-            transition_time = time.time() - start_time
-            led_transitions.append({
-                'time': transition_time,
-                'from': last_led_state,
-                'to': current_led_state
-            })
-            print(f"LED transition at {transition_time:.3f}s: {last_led_state} -> {current_led_state}")
-            last_led_state = current_led_state
-        
-        time.sleep(0.01)  # Small delay to avoid excessive CPU usage
+    for transition_time, current_led_state in led.watch(monitoring_duration):
+        led_transitions.append({
+            'time': transition_time - start_time,
+            'from': 1 - current_led_state,
+            'to': current_led_state
+        })
+        print(f"LED transition at {transition_time - start_time:.3f}s: {1 - current_led_state} -> {current_led_state}")
     
     print(f"Detected {len(led_transitions)} LED transitions")
     
     # Check if LED is blinking (should have multiple transitions)
     assert len(led_transitions) >= 4, f"Expected at least 4 transitions (2 blinks) in 3 seconds, but got {len(led_transitions)}"
     
-    # Calculate intervals between transitions to verify ~500ms timing
-    intervals = []
-    for i in range(1, len(led_transitions)):
-        interval = led_transitions[i]['time'] - led_transitions[i-1]['time']
-        intervals.append(interval)
-    
-    # Check that intervals are approximately 500ms (0.5s) with some tolerance
-    expected_interval = 0.5
-    tolerance = 0.15  # Allow 150ms tolerance
-    
-    valid_intervals = [interval for interval in intervals if abs(interval - expected_interval) <= tolerance]
-    print(f"Intervals: {[round(i, 3) for i in intervals]}")
-    print(f"Valid intervals (~500ms ± {tolerance*1000}ms): {len(valid_intervals)}/{len(intervals)}")
-    
-    # At least 50% of intervals should be close to 500ms
-    assert len(valid_intervals) >= len(intervals) * 0.5, f"Less than 50% of intervals are close to 500ms"
+    # Verify ~500ms timing: a period spans two toggles, so 1 s
+    stats = edgestats.EdgeStats(nominal_period_us=1_000_000, tolerance_us=150_000)  # Allow 150ms tolerance
+    stats.feed_watch((t['time'], t['to']) for t in led_transitions)
+    summary = stats.summary()
+    print(f"Edge statistics: {summary}")
+    print(f"Valid periods (~1s ± 150ms): {summary['inTolerance']}/{summary['periods']}")
+
+    # At least 50% of periods should be close to 1s
+    assert summary["periods"] > 0, "No full period between the transitions"
+    assert summary["inTolerance"] >= summary["periods"] * 0.5, f"Less than 50% of periods are close to 1s"
     
     print("✓ LED is blinking at approximately 500ms intervals after first button press")
 
 
-def test_led_stops_blinking_on_second_button_press(setup_gpio):
+def test_led_stops_blinking_on_second_button_press(led):
     """Test that LED stops blinking and turns off after second button press."""
     
     # First button press to start blinking
@@ -123,16 +100,7 @@ def test_led_stops_blinking_on_second_button_press(setup_gpio):
     time.sleep(1)  # Wait for blinking to start
     
     # Verify blinking is active by checking for transitions
-    transitions_before = 0
-    last_state = GPIO.input(17)
-    check_start = time.time()
-    
-    while time.time() - check_start < 1.5:  # Check for 1.5 seconds
-        current_state = GPIO.input(17)
-        if current_state != last_state:
-            transitions_before += 1
-            last_state = current_state
-        time.sleep(0.01)
+    transitions_before = len(led.watch(1.5))  # Check for 1.5 seconds
     
     print(f"Transitions detected while blinking: {transitions_before}")
     assert transitions_before >= 2, "LED should be blinking after first button press"
@@ -146,18 +114,11 @@ def test_led_stops_blinking_on_second_button_press(setup_gpio):
     
     # Monitor LED for 2 seconds to verify it stops blinking and stays off
     transitions_after = 0
-    led_states = []
-    last_state = GPIO.input(17)
-    check_start = time.time()
-    
-    while time.time() - check_start < 2.0:  # Check for 2 seconds
-        current_state = GPIO.input(17)
-        led_states.append(current_state)
-        if current_state != last_state:
-            transitions_after += 1
-            print(f"Transition at {time.time() - check_start:.3f}s: {last_state} -> {current_state}")
-            last_state = current_state
-        time.sleep(0.01)
+    check_start = led.now()
+    
+    for transition_time, current_state in led.watch(2.0):  # Check for 2 seconds
+        transitions_after += 1
+        print(f"Transition at {transition_time - check_start:.3f}s: {1 - current_state} -> {current_state}")
     
     print(f"Transitions after second button press: {transitions_after}")
     
@@ -165,33 +126,22 @@ def test_led_stops_blinking_on_second_button_press(setup_gpio):
     assert transitions_after <= 1, f"LED should stop blinking after second button press, but detected {transitions_after} transitions"
     
     # LED should be off (final state should be LOW)
-    final_state = GPIO.input(17)
+    final_state = led.level()
     print(f"Final LED state: {final_state}")
     assert final_state == GPIO.LOW, f"LED should be off (LOW) after stopping, but found {final_state}"
     
     print("✓ LED correctly stops blinking and turns off after second button press")
 
 
-def test_led_toggle_between_blinking_and_off(setup_gpio):
+def test_led_toggle_between_blinking_and_off(led):
     """Test the complete cycle: off -> blinking -> off -> blinking."""
     
     # Helper function to count transitions
     def count_transitions(duration):
-        transitions = 0
-        last_state = GPIO.input(17)
-        start = time.time()
-        
-        while time.time() - start < duration:
-            current_state = GPIO.input(17)
-            if current_state != last_state:
-                transitions += 1
-                last_state = current_state
-            time.sleep(0.01)
-        
-        return transitions
+        return len(led.watch(duration))
     
     # Initial state should be off
-    initial_state = GPIO.input(17)
+    initial_state = led.level()
     print(f"Initial LED state: {initial_state}")
     assert initial_state == GPIO.LOW, "LED should initially be off"
     
@@ -214,7 +164,7 @@ def test_led_toggle_between_blinking_and_off(setup_gpio):
     time.sleep(0.5)
     
     transitions_2 = count_transitions(1.5)
-    final_state_1 = GPIO.input(17)
+    final_state_1 = led.level()
     print(f"Transitions after second press: {transitions_2}")
     print(f"LED state after stopping: {final_state_1}")
     assert transitions_2 <= 1, "LED should stop blinking after second press"
@@ -1,3 +1,25 @@
+import os
+import sys
+
+# With SIM_FIRMWARE set, run against the host build of the firmware
+# (.github/tests/sim) instead of the Nucleo wired to the Raspberry Pi.
+SIM_FIRMWARE = os.environ.get("SIM_FIRMWARE")
+if SIM_FIRMWARE:
+    sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", "..", "sim", "python"))
+    import simboard
+    firmware = simboard.setup()
+
+# GPIO 17 is watched through kernel-timestamped edge events when the
+# gpiocapture library is built (.github/tests/tools/gpiocapture), and polled
+# through RPi.GPIO otherwise.
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", "..", "tools", "gpiocapture"))
+import gpiocapture
+
+# LED timing is measured by the edgestats library, built with make in
+# .github/tests/tools/edgestats.
+sys.path.insert(0, os.path.join(os.path.dirname(__file__), "..", "..", "tools", "edgestats"))
+import edgestats
+
 import pytest
 import time
 import RPi.GPIO as GPIO
@@ -15,16 +37,33 @@ def setup_gpio():
         pass
     
     # GPIO 17 will be set as an input (no pull-up/down as it uses push-pull driver)
-    GPIO.setup(17, GPIO.IN)
+    led = None if SIM_FIRMWARE else gpiocapture.try_line_watch(17)
+    if led is None:
+        GPIO.setup(17, GPIO.IN)
+        led = gpiocapture.PollingWatch(lambda: GPIO.input(17))
     
     # Reset the system before each test using OpenOCD
-    subprocess.run([
-        "pio", "pkg", "exec", "-p", "tool-openocd", "-c",
-        "openocd -f interface/stlink.cfg -f target/stm32f4x.cfg -c 'init; reset run; shutdown'"
-    ], check=True)
+    if SIM_FIRMWARE:
+        firmware.reset()
+    else:
+        subprocess.run([
+            "pio", "pkg", "exec", "-p", "tool-openocd", "-c",
+            "openocd -f interface/stlink.cfg -f target/stm32f4x.cfg -c 'init; reset run; shutdown'"
+        ], check=True)
     time.sleep(0.5)  # Wait for system to initialize
     
-    yield
+    yield led
 
     # Clean up GPIO settings after tests
-    GPIO.cleanup()
\ No newline at end of file
+    led.close()
+    GPIO.cleanup()
+    if SIM_FIRMWARE:
+        firmware.stop()
+
+
+@pytest.fixture(scope="function")
+def led(setup_gpio):
+    """GPIO 17: level() reads it and watch(seconds) returns the (time, level)
+    of each transition in that time, on the clock of now(). Pass since=now()
+    taken before a stimulus to count the transitions from then on."""
+    return setup_gpio
\ No newline at end of file
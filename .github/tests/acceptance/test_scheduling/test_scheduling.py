@@ -2,61 +2,47 @@ import pytest
 import time
 import RPi.GPIO as GPIO
 import sys
+import edgestats
 
-def test_gpio_17_toggles_every_second(setup_gpio):
+def test_gpio_17_toggles_every_second(led):
     """Test that GPIO pin 17 toggles every second."""
     
     # Print GPIO information for debugging
     print(f"Testing with RPi.GPIO version: {GPIO.VERSION}")
     print(f"Running on Python: {sys.version}")
     
-    # List to store the timestamps of transitions
-    transitions = []
-    
     # Initial state - handle potential errors
     try:
-        last_state = GPIO.input(17)
+        last_state = led.level()
         print(f"Initial GPIO 17 state: {last_state}")
     except Exception as e:
         pytest.fail(f"Failed to read GPIO 17: {e}. Make sure RPi.GPIO is properly set up.")
     
     # Monitor for 5 seconds (should see about 5 transitions)
-    start_time = time.time()
-    timeout = start_time + 5
+    start_time = led.now()
     
-    while time.time() < timeout:
-        try:
-            current_state = GPIO.input(17)
-            
-            # If state changed, record the timestamp
-            if current_state != last_state:
-                transition_time = time.time()
-                transitions.append(transition_time)
-                print(f"Transition detected at {transition_time-start_time:.2f}s: {last_state} -> {current_state}")
-                last_state = current_state
-        except Exception as e:
-            print(f"Error reading GPIO: {e}")
-            time.sleep(0.1)  # Longer delay on error
-        
-        # Small delay to avoid hogging CPU
-        time.sleep(0.01)
-    
-    # Calculate time between transitions
-    intervals = []
-    for i in range(1, len(transitions)):
-        interval = transitions[i] - transitions[i-1]
-        intervals.append(interval)
+    # List to store the timestamps of transitions
+    transitions = []
+    transitions_with_levels = led.watch(5)
+    for transition_time, current_state in transitions_with_levels:
+        transitions.append(transition_time)
+        print(f"Transition detected at {transition_time-start_time:.2f}s: {1 - current_state} -> {current_state}")
     
     # Check if we have enough transitions
     assert len(transitions) >= 4, f"Not enough transitions detected: {len(transitions)}"
-    
-    # Calculate average interval
-    avg_interval = sum(intervals) / len(intervals)
-    
+
+    # A period spans two toggles, so a toggle every second is a 2 s period,
+    # allowing 0.2 seconds on each toggle
+    stats = edgestats.EdgeStats(nominal_period_us=2_000_000, tolerance_us=400_000)
+    stats.feed_watch(transitions_with_levels)
+    summary = stats.summary()
+    avg_interval = summary["periodMeanUs"] / 2 / 1_000_000
+
     # Print for debugging
     print(f"Detected {len(transitions)} transitions")
     print(f"Average interval: {avg_interval:.3f} seconds")
-    print(f"Intervals: {[round(i, 3) for i in intervals]}")
-    
-    # Check if the average interval is close to 1 second (allowing 0.2 seconds tolerance)
-    assert 0.8 <= avg_interval <= 1.2, f"Average toggle interval {avg_interval:.3f} is not close to 1 second"
\ No newline at end of file
+    print(f"Edge statistics: {summary}")
+
+    # Check that every period is close to 2 seconds
+    assert summary["periods"] > 0, "No full period between the transitions"
+    assert summary["inTolerance"] == summary["periods"], f"Average toggle interval {avg_interval:.3f} is not close to 1 second"
\ No newline at end of file
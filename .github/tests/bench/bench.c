@@ -0,0 +1,105 @@
+#define _POSIX_C_SOURCE 200809L
+#include "bench.h"
+#include "fake.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+uint64_t BENCH_allocations = 0;
+
+// glibc's own entry points; defining malloc() here interposes the one the
+// C++ runtime calls too.
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *pointer, size_t size);
+extern void __libc_free(void *pointer);
+
+void *malloc(size_t size) {
+  BENCH_allocations++;
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+  BENCH_allocations++;
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) {
+  BENCH_allocations++;
+  return __libc_realloc(pointer, size);
+}
+
+void free(void *pointer) { __libc_free(pointer); }
+
+// BENCH_ITERATIONS overrides the calls per batch, e.g. for a quick run. The
+// count is kept even, so a step that toggles state ends where it started.
+uint64_t BENCH_iterations(void) {
+  const char *value = getenv("BENCH_ITERATIONS");
+  uint64_t iterations = value ? strtoull(value, NULL, 10) : 0;
+
+  return iterations ? (iterations + 1) / 2 * 2 : 1000000;
+}
+
+static double nowNs(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec * 1e9 + (double)now.tv_nsec;
+}
+
+static int compareDoubles(const void *a, const void *b) {
+  double x = *(const double *)a;
+  double y = *(const double *)b;
+
+  return (x > y) - (x < y);
+}
+
+void BENCH_run(const char *name, BENCH_Step step, BENCH_Result *result) {
+  uint64_t iterations = BENCH_iterations();
+  double batches[BENCH_BATCHES];
+  uint64_t calls = FAKE_callTotal;
+  uint64_t allocations = BENCH_allocations;
+
+  // Warm up caches and branch predictors, and let lazy state settle.
+  for (uint64_t i = 0; i < iterations / 20 * 2; i++) {
+    step();
+  }
+  calls = FAKE_callTotal;
+  allocations = BENCH_allocations;
+
+  for (int batch = 0; batch < BENCH_BATCHES; batch++) {
+    double start = nowNs();
+
+    for (uint64_t i = 0; i < iterations; i++) {
+      step();
+    }
+    batches[batch] = (nowNs() - start) / (double)iterations;
+  }
+  qsort(batches, BENCH_BATCHES, sizeof(double), compareDoubles);
+
+  uint64_t total = iterations * BENCH_BATCHES;
+
+  result->name = name;
+  result->iterations = total;
+  result->nsPerCall = batches[BENCH_BATCHES / 2];
+  result->mockCallsPerCall = (double)(FAKE_callTotal - calls) / (double)total;
+  result->allocationsPerCall =
+      (double)(BENCH_allocations - allocations) / (double)total;
+}
+
+// One JSON object on stdout, read back by compare.py.
+void BENCH_report(const char *platform, const char *lab,
+                  const BENCH_Result *results, int count) {
+  printf("{\n  \"name\": \"%s_%s\",\n  \"platform\": \"%s\",\n"
+         "  \"lab\": \"%s\",\n  \"benchmarks\": {",
+         platform, lab, platform, lab);
+  for (int i = 0; i < count; i++) {
+    printf("%s\n    \"%s\": {\"iterations\": %llu, \"ns_per_call\": %.3f, "
+           "\"mock_calls_per_call\": %.4f, \"allocations_per_call\": %.4f}",
+           i ? "," : "", results[i].name,
+           (unsigned long long)results[i].iterations, results[i].nsPerCall,
+           results[i].mockCallsPerCall, results[i].allocationsPerCall);
+  }
+  printf("\n  }\n}\n");
+}
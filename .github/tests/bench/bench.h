@@ -0,0 +1,44 @@
+#ifndef Bench_H__
+#define Bench_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Host microbenchmarks of the lab firmware against the fast mocks.
+//
+// BENCH_run() calls step() in batches and keeps the median batch, so a
+// scheduler hiccup does not show up as a regression. Besides the time per
+// call it counts mock calls (HAL or Arduino API calls logged by fake.h) and
+// heap allocations per call: both are exact, so an extra HAL_GetTick() in
+// the hot path shows up as a number even when the timing noise hides it.
+// Allocations are counted by interposing malloc() and friends, which
+// catches operator new as well.
+
+#define BENCH_BATCHES 7
+#define BENCH_MAX 8
+
+typedef void (*BENCH_Step)(void);
+
+typedef struct {
+  const char *name;
+  uint64_t iterations;
+  double nsPerCall;
+  double mockCallsPerCall;
+  double allocationsPerCall;
+} BENCH_Result;
+
+extern uint64_t BENCH_allocations;
+
+uint64_t BENCH_iterations(void);
+void BENCH_run(const char *name, BENCH_Step step, BENCH_Result *result);
+void BENCH_report(const char *platform, const char *lab,
+                  const BENCH_Result *results, int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Bench_H__ */
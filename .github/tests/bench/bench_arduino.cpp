@@ -0,0 +1,40 @@
+#include "Arduino.h"
+#include "bench.h"
+#include "fake.h"
+#include "vclock.h"
+
+extern void setup(void);
+extern void loop(void);
+
+// Every loop() sees the next tick, as if it ran once per millisecond.
+static void loopStep(void)
+{
+    VCLOCK_advance(1);
+    loop();
+}
+
+static void interruptStep(void)
+{
+    SPY_triggerInterrupt();
+}
+
+int main(void)
+{
+    BENCH_Result results[BENCH_MAX];
+    int count = 0;
+
+    FAKE_setEnabled(1);
+    setup();
+    BENCH_run("loop", loopStep, &results[count++]);
+#ifdef BENCH_ISR
+    BENCH_run("interrupt", interruptStep, &results[count++]);
+    // The presses above come in pairs; one more switches the sketch to its
+    // other state, LED on or blinking.
+    SPY_triggerInterrupt();
+    BENCH_run("loop_after_interrupt", loopStep, &results[count++]);
+#else
+    (void)interruptStep;
+#endif
+    BENCH_report("arduino", BENCH_LAB, results, count);
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include "bench.h"
+#include "blinker.hpp"
+#include "fake.h"
+#include "main.h"
+#include "vclock.h"
+
+// The Blinker template against the scheduling lab's hand-written toggle.
+// Both run out of line so that `make size` can compare their symbols; the
+// benchmarks compare time and mock calls per call.
+
+extern "C" {
+void BENCH_blinkHandwritten(uint32_t now) __attribute__((noinline));
+void BENCH_blinkTemplated(uint32_t now) __attribute__((noinline));
+}
+
+static uint32_t previousMillis = 0;
+static BLINKER::Blinker<BLINKER::GpioA, LED_Pin, 500> led;
+
+void BENCH_blinkHandwritten(uint32_t now) {
+  if (now - previousMillis >= 500) {
+    previousMillis = now;
+    HAL_GPIO_TogglePin(LED_GPIO_Port, LED_Pin);
+  }
+}
+
+void BENCH_blinkTemplated(uint32_t now) { led.run(now); }
+
+static uint32_t now = 0;
+
+static void handwrittenStep(void) { BENCH_blinkHandwritten(now++); }
+
+static void templatedStep(void) { BENCH_blinkTemplated(now++); }
+
+int main(void) {
+  BENCH_Result results[BENCH_MAX];
+  int count = 0;
+
+  FAKE_setEnabled(1);
+  BENCH_run("handwritten", handwrittenStep, &results[count++]);
+  now = 0;
+  BENCH_run("templated", templatedStep, &results[count++]);
+  BENCH_report("stm32cube", "blinker", results, count);
+  return 0;
+}
@@ -0,0 +1,35 @@
+#include "bench.h"
+#include "fake.h"
+#include "main.h"
+#include "vclock.h"
+
+extern void setup(void);
+extern void loop(void);
+
+// Every loop() sees the next tick, as if it ran once per millisecond.
+static void loopStep(void) {
+  VCLOCK_advance(1);
+  loop();
+}
+
+static void interruptStep(void) { SPY_HAL_GPIO_EXTI_Trigger(PUSH_BUTTON_Pin); }
+
+int main(void) {
+  BENCH_Result results[BENCH_MAX];
+  int count = 0;
+
+  FAKE_setEnabled(1);
+  setup();
+  BENCH_run("loop", loopStep, &results[count++]);
+#ifdef BENCH_ISR
+  BENCH_run("interrupt", interruptStep, &results[count++]);
+  // The presses above come in pairs; one more switches the firmware to its
+  // other state, LED on or blinking.
+  SPY_HAL_GPIO_EXTI_Trigger(PUSH_BUTTON_Pin);
+  BENCH_run("loop_after_interrupt", loopStep, &results[count++]);
+#else
+  (void)interruptStep;
+#endif
+  BENCH_report("stm32cube", BENCH_LAB, results, count);
+  return 0;
+}
@@ -0,0 +1,94 @@
+"""Stores and checks the results of the host microbenchmarks.
+
+Each bench executable prints one JSON object; `save` merges them into a
+baseline keyed by name and `check` compares a fresh run against it. Mock
+calls and heap allocations per call are deterministic, so any change is a
+regression unless the baseline is updated with the firmware. Timings vary
+between hosts and only fail when slower than the baseline by more than
+--tolerance percent; --counts-only skips them, e.g. on shared CI runners.
+"""
+import argparse
+import json
+import sys
+
+COUNTS = ("mock_calls_per_call", "allocations_per_call")
+
+
+def load_runs(paths):
+    runs = {}
+    for path in paths:
+        with open(path) as file:
+            run = json.load(file)
+        runs[run["name"]] = run
+    return runs
+
+
+def save(baseline_path, paths):
+    with open(baseline_path, "w") as file:
+        json.dump(load_runs(paths), file, indent=2, sort_keys=True)
+        file.write("\n")
+    print(f"Saved {len(paths)} results to {baseline_path}")
+    return 0
+
+
+def compare_bench(name, expected, actual, tolerance, counts_only):
+    failures = []
+    if expected["iterations"] == actual["iterations"]:
+        for count in COUNTS:
+            if expected[count] != actual[count]:
+                failures.append(
+                    f"{name}: {count} {expected[count]} -> {actual[count]}")
+    else:
+        print(f"{name}: iterations differ from the baseline, counts skipped")
+
+    change = (actual["ns_per_call"] / expected["ns_per_call"] - 1) * 100
+    line = (f"{name}: {expected['ns_per_call']:.3f} -> "
+            f"{actual['ns_per_call']:.3f} ns ({change:+.1f}%)")
+    if not counts_only and change > tolerance:
+        failures.append(line)
+    else:
+        print(line)
+    return failures
+
+
+def check(baseline_path, paths, tolerance, counts_only):
+    with open(baseline_path) as file:
+        baseline = json.load(file)
+
+    failures = []
+    for run_name, run in load_runs(paths).items():
+        if run_name not in baseline:
+            failures.append(f"{run_name}: missing from {baseline_path}")
+            continue
+        expected = baseline[run_name]["benchmarks"]
+        for bench, actual in run["benchmarks"].items():
+            name = f"{run_name}.{bench}"
+            if bench not in expected:
+                failures.append(f"{name}: missing from {baseline_path}")
+                continue
+            failures += compare_bench(name, expected[bench], actual,
+                                      tolerance, counts_only)
+
+    for failure in failures:
+        print(f"REGRESSION {failure}")
+    return 1 if failures else 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("mode", choices=("save", "check"))
+    parser.add_argument("baseline")
+    parser.add_argument("results", nargs="+")
+    parser.add_argument("--tolerance", type=float, default=25,
+                        help="allowed slowdown in percent (default 25)")
+    parser.add_argument("--counts-only", action="store_true",
+                        help="ignore timings and compare counts only")
+    args = parser.parse_args()
+
+    if args.mode == "save":
+        return save(args.baseline, args.results)
+    return check(args.baseline, args.results, args.tolerance, args.counts_only)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
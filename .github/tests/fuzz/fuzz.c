@@ -0,0 +1,353 @@
+#define _POSIX_C_SOURCE 200809L
+#include "fuzz.h"
+#include "fake.h"
+#include "vclock.h"
+#include <dirent.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SCHEDULING_PERIOD 1000
+#define CHALLENGE_PERIOD 500
+
+// The firmware's .data and .bss, renamed by the makefile.
+extern char __start_fuzz_state[];
+extern char __stop_fuzz_state[];
+
+static const FUZZ_Lab *lab = NULL;
+static char *bootState = NULL;
+static const uint8_t *input;
+static size_t inputSize;
+static FUZZ_Model *current;
+static uint32_t preemptAt;
+static uint32_t preemptCalls;
+
+// The LED toggles every second, and on time as far as loop() can tell.
+static void checkScheduling(FUZZ_Model *model, const FUZZ_Step *step,
+                            int led) {
+  uint32_t since = model->now - model->lastToggle;
+
+  if (led != model->led) {
+    if (since < SCHEDULING_PERIOD) {
+      FUZZ_fail(model, "LED toggled %" PRIu32 " ms after the last toggle",
+                since);
+    }
+    model->led = led;
+    model->lastToggle = model->now;
+  } else if (step->op == FUZZ_LOOP && since >= SCHEDULING_PERIOD) {
+    FUZZ_fail(model, "LED not toggled %" PRIu32 " ms after the last toggle",
+              since);
+  }
+}
+
+// The LED follows the number of presses once loop() has run undisturbed.
+static void checkInterrupts(FUZZ_Model *model, const FUZZ_Step *step,
+                            int led) {
+  if (step->op == FUZZ_LOOP && model->taken == 0 &&
+      led != (int)(model->interrupts & 1)) {
+    FUZZ_fail(model, "LED is %s after %" PRIu32 " presses",
+              led ? "HIGH" : "LOW", model->interrupts);
+  }
+  model->led = led;
+}
+
+// Odd presses blink the LED, even ones turn it off. Only changes made while
+// blinking throughout the step count as toggles: a press may light the LED
+// or restart the period, depending on the platform, so lastToggle is never
+// later than the firmware's own and the period check holds for both.
+static void checkChallenge(FUZZ_Model *model, const FUZZ_Step *step,
+                           int led) {
+  int blinking = model->interrupts & 1;
+
+  if (led != model->led && blinking && model->taken == 0) {
+    uint32_t since = model->now - model->lastToggle;
+
+    if (since < CHALLENGE_PERIOD) {
+      FUZZ_fail(model, "LED toggled %" PRIu32 " ms after the last toggle",
+                since);
+    }
+    model->lastToggle = model->now;
+  }
+  model->led = led;
+  if (step->op == FUZZ_LOOP && model->taken == 0 && !blinking && led) {
+    FUZZ_fail(model, "LED is HIGH with blinking off");
+  }
+}
+
+static const FUZZ_Lab fuzzLabs[] = {
+    {"scheduling", checkScheduling},
+    {"interrupts", checkInterrupts},
+    {"challenge", checkChallenge},
+};
+
+const FUZZ_Lab *FUZZ_lab(const char *name) {
+  for (size_t i = 0; i < sizeof(fuzzLabs) / sizeof(fuzzLabs[0]); i++) {
+    if (strcmp(fuzzLabs[i].name, name) == 0) {
+      return &fuzzLabs[i];
+    }
+  }
+  return NULL;
+}
+
+// Returns the offset of the next step, or 0 when the input is used up.
+size_t FUZZ_decode(const uint8_t *data, size_t size, size_t offset,
+                   FUZZ_Step *step) {
+  if (offset + 2 > size) {
+    return 0;
+  }
+
+  uint8_t op = data[offset];
+
+  step->op = (FUZZ_Op)(op & 3);
+  step->arg = data[offset + 1];
+  step->ms = step->arg << ((op >> 2) & 7);
+  return offset + 2;
+}
+
+static void preempt(FAKE_Api api) {
+  (void)api;
+  if (++preemptCalls == preemptAt) {
+    FAKE_callHook = NULL;
+    current->taken += (uint32_t)FUZZ_boardInterrupt();
+  }
+}
+
+void FUZZ_run(const uint8_t *data, size_t size) {
+  size_t stateSize = (size_t)(__stop_fuzz_state - __start_fuzz_state);
+
+  if (lab == NULL) {
+    lab = FUZZ_lab(FUZZ_LAB);
+    bootState = malloc(stateSize);
+    if (lab == NULL || bootState == NULL) {
+      fprintf(stderr, "fuzz: no lab %s\n", FUZZ_LAB);
+      abort();
+    }
+    memcpy(bootState, __start_fuzz_state, stateSize);
+  } else {
+    memcpy(__start_fuzz_state, bootState, stateSize);
+  }
+
+  FUZZ_Model state = {0};
+  FUZZ_Step step;
+  size_t offset = 0;
+
+  input = data;
+  inputSize = size;
+  current = &state;
+  FUZZ_boardReset();
+  state.led = FUZZ_boardLed();
+
+  while ((offset = FUZZ_decode(data, size, offset, &step)) != 0) {
+    state.taken = 0;
+    switch (step.op) {
+    case FUZZ_ADVANCE:
+      VCLOCK_advance(step.ms);
+      break;
+    case FUZZ_LOOP:
+      preemptAt = step.arg;
+      preemptCalls = 0;
+      FAKE_callHook = (step.arg != 0) ? preempt : NULL;
+      FUZZ_boardLoop();
+      FAKE_callHook = NULL;
+      break;
+    case FUZZ_INTERRUPT:
+      state.taken = (uint32_t)FUZZ_boardInterrupt();
+      break;
+    case FUZZ_LEVEL:
+      state.taken = (uint32_t)FUZZ_boardLevel(step.arg & 1);
+      break;
+    }
+    state.interrupts += state.taken;
+    state.now = VCLOCK_now();
+    lab->check(&state, &step, FUZZ_boardLed());
+    state.step++;
+  }
+}
+
+void FUZZ_fail(const FUZZ_Model *model, const char *format, ...) {
+  va_list args;
+
+  fprintf(stderr, "fuzz: %s, step %" PRIu32 " at %" PRIu32 " ms: ",
+          lab->name, model->step, model->now);
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+
+#ifndef FUZZ_LIBFUZZER
+  // libFuzzer saves the input itself when the target aborts.
+  uint64_t hash = 14695981039346656037ULL;
+  char name[32];
+
+  for (size_t i = 0; i < inputSize; i++) {
+    hash = (hash ^ input[i]) * 1099511628211ULL;
+  }
+  snprintf(name, sizeof(name), "crash-%016" PRIx64, hash);
+
+  FILE *file = fopen(name, "wb");
+
+  if (file != NULL) {
+    fwrite(input, 1, inputSize, file);
+    fclose(file);
+    fprintf(stderr, "fuzz: input written to %s\n", name);
+  }
+#endif
+  abort();
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  FUZZ_run(data, size);
+  return 0;
+}
+
+#ifndef FUZZ_LIBFUZZER
+
+// The standalone driver takes libFuzzer's -runs, -seed, -max_len and
+// -max_total_time, so the makefile runs either engine the same way, and
+// replays files and directories of inputs instead of fuzzing when given
+// any. Its inputs are random rather than coverage-guided.
+
+static uint64_t rngState;
+
+static uint64_t nextRandom(void) {
+  rngState ^= rngState >> 12;
+  rngState ^= rngState << 25;
+  rngState ^= rngState >> 27;
+  return rngState * 2685821657736338717ULL;
+}
+
+static double nowSeconds(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static int replayFile(const char *path) {
+  FILE *file = fopen(path, "rb");
+
+  if (file == NULL) {
+    perror(path);
+    return -1;
+  }
+
+  uint8_t *data = NULL;
+  size_t size = 0;
+  size_t capacity = 0;
+  size_t count;
+
+  do {
+    if (size == capacity) {
+      capacity = capacity ? capacity * 2 : 4096;
+      uint8_t *grown = realloc(data, capacity);
+
+      if (grown == NULL) {
+        free(data);
+        fclose(file);
+        return -1;
+      }
+      data = grown;
+    }
+    count = fread(data + size, 1, capacity - size, file);
+    size += count;
+  } while (count > 0);
+  fclose(file);
+
+  printf("Running: %s\n", path);
+  FUZZ_run(data, size);
+  free(data);
+  return 0;
+}
+
+static int replay(const char *path) {
+  DIR *dir = opendir(path);
+
+  if (dir == NULL) {
+    return replayFile(path);
+  }
+
+  struct dirent *entry;
+  char name[4096];
+  int status = 0;
+
+  while ((entry = readdir(dir)) != NULL) {
+    if (entry->d_name[0] != '.') {
+      snprintf(name, sizeof(name), "%s/%s", path, entry->d_name);
+      status |= replayFile(name);
+    }
+  }
+  closedir(dir);
+  return status;
+}
+
+int main(int argc, char **argv) {
+  long long runs = -1;
+  unsigned long long seed = 0;
+  size_t maxLen = 512;
+  double maxTime = 0;
+  int replayed = 0;
+  int status = 0;
+
+  for (int i = 1; i < argc; i++) {
+    const char *arg = argv[i];
+
+    if (strncmp(arg, "-runs=", 6) == 0) {
+      runs = strtoll(arg + 6, NULL, 10);
+    } else if (strncmp(arg, "-seed=", 6) == 0) {
+      seed = strtoull(arg + 6, NULL, 10);
+    } else if (strncmp(arg, "-max_len=", 9) == 0) {
+      maxLen = strtoul(arg + 9, NULL, 10);
+    } else if (strncmp(arg, "-max_total_time=", 16) == 0) {
+      maxTime = strtod(arg + 16, NULL);
+    } else if (arg[0] == '-') {
+      fprintf(stderr, "fuzz: ignoring %s\n", arg);
+    } else {
+      status |= replay(arg);
+      replayed = 1;
+    }
+  }
+  if (replayed) {
+    return status ? 1 : 0;
+  }
+
+  uint8_t *data = malloc(maxLen + 1);
+
+  if (data == NULL) {
+    return 1;
+  }
+  if (seed == 0) {
+    seed = (unsigned long long)time(NULL);
+  }
+  rngState = seed | 1;
+  printf("fuzz: %s, seed %llu\n", FUZZ_LAB, seed);
+
+  double start = nowSeconds();
+  long long done = 0;
+
+  while (runs < 0 || done < runs) {
+    size_t size = (size_t)(nextRandom() % (maxLen + 1));
+
+    for (size_t i = 0; i < size; i++) {
+      data[i] = (uint8_t)(nextRandom() >> 56);
+    }
+    FUZZ_run(data, size);
+    done++;
+    if (maxTime > 0 && (done & 1023) == 0 && nowSeconds() - start > maxTime) {
+      break;
+    }
+  }
+
+  double elapsed = nowSeconds() - start;
+
+  printf("Done %lld runs in %.1f second(s), %.0f exec/s\n", done, elapsed,
+         elapsed > 0 ? (double)done / elapsed : 0.0);
+  free(data);
+  return 0;
+}
+
+#endif
@@ -0,0 +1,92 @@
+#ifndef Fuzz_H__
+#define Fuzz_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Fuzz targets for the lab firmware on the host, built like ../bench
+// against the unit test mocks with MOCKS_FAST_ONLY.
+//
+// Each input is a sequence of two-byte steps, an opcode and an argument:
+//
+//   op & 3 == 0  advance the clock by arg << (op >> 2 & 7) ms
+//   op & 3 == 1  run loop(); a non-zero arg takes the button interrupt
+//                right after loop()'s arg-th mock call, if it makes that
+//                many
+//   op & 3 == 2  take the button interrupt
+//   op & 3 == 3  drive the button to arg & 1; a falling edge interrupts
+//
+// A trailing odd byte is ignored. The lab's invariants are checked after
+// every step; a failure is reported with the step and tick and aborts, so
+// libFuzzer keeps the input. The firmware's globals and statics are put
+// back before every input: the makefile renames the sketch's .data and
+// .bss to fuzz_state, which FUZZ_run() copies at the first input and
+// restores before each later one, so the firmware boots afresh without
+// the sources having to change.
+//
+// Built with FUZZ_LIBFUZZER the target only defines
+// LLVMFuzzerTestOneInput(); otherwise fuzz.c adds a standalone driver,
+// for hosts without clang, that runs random inputs or replays the files
+// it is given.
+
+typedef enum {
+  FUZZ_ADVANCE = 0,
+  FUZZ_LOOP,
+  FUZZ_INTERRUPT,
+  FUZZ_LEVEL
+} FUZZ_Op;
+
+typedef struct {
+  FUZZ_Op op;
+  uint32_t arg;
+  uint32_t ms;
+} FUZZ_Step;
+
+// What the lab's checks see. interrupts counts the times the firmware's
+// button handler ran, taken how many of those came in the current step; a
+// loop() step with one taken was preempted. led and lastToggle are the
+// checks' own.
+typedef struct {
+  uint32_t step;
+  uint32_t now;
+  uint32_t interrupts;
+  uint32_t taken;
+  int led;
+  uint32_t lastToggle;
+} FUZZ_Model;
+
+typedef void (*FUZZ_Check)(FUZZ_Model *model, const FUZZ_Step *step,
+                           int led);
+
+typedef struct {
+  const char *name;
+  FUZZ_Check check;
+} FUZZ_Lab;
+
+// Provided by the platform's fuzz_<platform> file. FUZZ_boardReset()
+// brings the mocks back to power-on with the button released and runs
+// setup();
+// FUZZ_boardInterrupt() and FUZZ_boardLevel() return whether the
+// firmware's handler ran.
+void FUZZ_boardReset(void);
+void FUZZ_boardLoop(void);
+int FUZZ_boardInterrupt(void);
+int FUZZ_boardLevel(int level);
+int FUZZ_boardLed(void);
+
+const FUZZ_Lab *FUZZ_lab(const char *name);
+size_t FUZZ_decode(const uint8_t *data, size_t size, size_t offset,
+                   FUZZ_Step *step);
+void FUZZ_run(const uint8_t *data, size_t size);
+void FUZZ_fail(const FUZZ_Model *model, const char *format, ...)
+    __attribute__((format(printf, 2, 3), noreturn));
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Fuzz_H__ */
@@ -0,0 +1,45 @@
+#include "Arduino.h"
+#include "fake.h"
+#include "fuzz.h"
+#include "vclock.h"
+
+#define LED 13
+#define PUSH_BUTTON 23
+
+extern void setup(void);
+extern void loop(void);
+
+// The button idles high and the sketches attach to its falling edge.
+void FUZZ_boardReset(void)
+{
+    VCLOCK_reset();
+    FAKE_clear();
+    SPY_resetInterrupts();
+    SPY_setPinLevel(LED, LOW);
+    SPY_setPinLevel(PUSH_BUTTON, HIGH);
+    setup();
+}
+
+void FUZZ_boardLoop(void)
+{
+    loop();
+}
+
+int FUZZ_boardInterrupt(void)
+{
+    SPY_triggerInterrupt();
+    return SPY_getStoredInterruptCallback() != nullptr;
+}
+
+int FUZZ_boardLevel(int level)
+{
+    uint64_t before = SPY_getInterruptCount();
+
+    SPY_setPinLevel(PUSH_BUTTON, level ? HIGH : LOW);
+    return SPY_getInterruptCount() != before;
+}
+
+int FUZZ_boardLed(void)
+{
+    return SPY_getPinLevel(LED) == HIGH;
+}
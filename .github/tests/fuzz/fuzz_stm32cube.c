@@ -0,0 +1,40 @@
+#include "fake.h"
+#include "fuzz.h"
+#include "main.h"
+#include "vclock.h"
+
+extern void setup(void);
+extern void loop(void);
+
+// The Nucleo's B1 pulls the line up and the EXTI fires on the falling edge.
+void FUZZ_boardReset(void) {
+  VCLOCK_reset();
+  FAKE_clear();
+  SPY_HAL_GPIO_Reset();
+  SPY_HAL_GPIO_SetInputPin(PUSH_BUTTON_GPIO_Port, PUSH_BUTTON_Pin,
+                           GPIO_PIN_SET);
+  setup();
+}
+
+void FUZZ_boardLoop(void) { loop(); }
+
+int FUZZ_boardInterrupt(void) {
+  SPY_HAL_GPIO_EXTI_Trigger(PUSH_BUTTON_Pin);
+  return 1;
+}
+
+int FUZZ_boardLevel(int level) {
+  int falling = level == 0 &&
+                (PUSH_BUTTON_GPIO_Port->IDR & PUSH_BUTTON_Pin) != 0;
+
+  SPY_HAL_GPIO_SetInputPin(PUSH_BUTTON_GPIO_Port, PUSH_BUTTON_Pin,
+                           level ? GPIO_PIN_SET : GPIO_PIN_RESET);
+  if (falling) {
+    SPY_HAL_GPIO_EXTI_Fire(PUSH_BUTTON_Pin);
+  }
+  return falling;
+}
+
+int FUZZ_boardLed(void) {
+  return SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin) == GPIO_PIN_SET;
+}
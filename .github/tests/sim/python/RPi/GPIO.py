@@ -0,0 +1,89 @@
+"""Stand-in for RPi.GPIO that drives the simulated board of the host build.
+
+Only the two channels wired on the test rig are available: GPIO 17 reads
+the LED and GPIO 27 drives the push button. Both map to words of the board
+file shared with the firmware (see sim_board.h).
+"""
+import mmap
+import os
+import struct
+
+VERSION = "sim"
+
+BCM = 11
+BOARD = 10
+OUT = 0
+IN = 1
+LOW = 0
+HIGH = 1
+PUD_OFF = 20
+PUD_DOWN = 21
+PUD_UP = 22
+
+_MAGIC = 0x424D4953
+_BOARD_SIZE = 16
+_CHANNEL_OFFSETS = {17: 4, 27: 8}
+
+_board = None
+_directions = {}
+
+
+def _map():
+    global _board
+    if _board is None:
+        path = os.environ["SIM_BOARD"]
+        fd = os.open(path, os.O_RDWR | os.O_CREAT, 0o644)
+        try:
+            os.ftruncate(fd, _BOARD_SIZE)
+            _board = mmap.mmap(fd, _BOARD_SIZE)
+        finally:
+            os.close(fd)
+        if struct.unpack_from("<I", _board, 0)[0] != _MAGIC:
+            struct.pack_into("<III", _board, 0, _MAGIC, LOW, HIGH)
+    return _board
+
+
+def _offset(channel):
+    if channel not in _CHANNEL_OFFSETS:
+        raise ValueError(f"Channel {channel} is not wired on the simulated board")
+    return _CHANNEL_OFFSETS[channel]
+
+
+def setwarnings(flag):
+    pass
+
+
+def setmode(mode):
+    pass
+
+
+def getmode():
+    return BCM
+
+
+def setup(channel, direction, pull_up_down=PUD_OFF, initial=None):
+    offset = _offset(channel)
+    _directions[channel] = direction
+    if direction == OUT and initial is not None:
+        struct.pack_into("<I", _map(), offset, 1 if initial else 0)
+
+
+def input(channel):
+    return struct.unpack_from("<I", _map(), _offset(channel))[0]
+
+
+def output(channel, value):
+    if _directions.get(channel) != OUT:
+        raise RuntimeError("The GPIO channel has not been set up as an OUTPUT")
+    struct.pack_into("<I", _map(), _offset(channel), 1 if value else 0)
+
+
+def cleanup(channel=None):
+    # Released pins float back to the rig's pull-up: button not pressed.
+    if channel is None or channel == 27:
+        if _directions.get(27) == OUT:
+            struct.pack_into("<I", _map(), _offset(27), HIGH)
+    if channel is None:
+        _directions.clear()
+    else:
+        _directions.pop(channel, None)
@@ -0,0 +1,60 @@
+"""Helpers for running the acceptance suites against the host firmware build.
+
+The conftests call these when SIM_FIRMWARE points at an executable built by
+.github/tests/sim/makefile. SIM_TIME_SCALE (default 1) compresses time on
+both sides: the firmware clock runs that many times faster and time.time()
+and time.sleep() are patched here to match, so the suites keep their
+real-time expectations.
+"""
+import atexit
+import os
+import subprocess
+import tempfile
+import time
+
+
+def time_scale():
+    return max(1, int(os.environ.get("SIM_TIME_SCALE", "1")))
+
+
+def board_path():
+    if "SIM_BOARD" not in os.environ:
+        path = os.path.join(tempfile.gettempdir(), f"simboard-{os.getpid()}")
+        os.environ["SIM_BOARD"] = path
+        atexit.register(lambda: os.path.exists(path) and os.remove(path))
+    return os.environ["SIM_BOARD"]
+
+
+def compress_time(scale):
+    if scale == 1:
+        return
+    real_time = time.time
+    real_sleep = time.sleep
+    origin = real_time()
+    time.time = lambda: origin + (real_time() - origin) * scale
+    time.sleep = lambda seconds: real_sleep(seconds / scale)
+
+
+class Firmware:
+    """Host firmware process; a fresh process stands in for a board reset."""
+
+    def __init__(self, executable):
+        self.executable = os.path.abspath(executable)
+        self.process = None
+
+    def reset(self):
+        self.stop()
+        self.process = subprocess.Popen([self.executable], env=os.environ.copy())
+
+    def stop(self):
+        if self.process is not None:
+            self.process.terminate()
+            self.process.wait()
+            self.process = None
+
+
+def setup():
+    """Prepares the board and clock and returns the firmware to reset per test."""
+    board_path()
+    compress_time(time_scale())
+    return Firmware(os.environ["SIM_FIRMWARE"])
@@ -0,0 +1,41 @@
+#include "Arduino.h"
+#include "sim_board.h"
+
+#define LED 13
+#define PUSH_BUTTON 23
+
+extern void setup(void);
+extern void loop(void);
+
+int main(void)
+{
+    SIM_Board *board = SIM_openBoard();
+
+    if (board == nullptr)
+    {
+        return 1;
+    }
+
+    uint32_t button = board->button;
+
+    SPY_setPinLevel(PUSH_BUTTON, button ? HIGH : LOW);
+
+    setup();
+    for (;;)
+    {
+        SIM_syncClock();
+
+        uint32_t level = board->button;
+        if (level != button)
+        {
+            button = level;
+            // Fires whatever the sketch attached to the button, by mode.
+            SPY_setPinLevel(PUSH_BUTTON, level ? HIGH : LOW);
+        }
+
+        loop();
+
+        board->led = SPY_getPinLevel(LED);
+        SIM_idle();
+    }
+}
@@ -0,0 +1,83 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "sim_board.h"
+#include "vclock.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+static uint32_t timeScale = 1;
+static struct timespec origin;
+
+static uint64_t elapsedMs(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  uint64_t ns = (uint64_t)(now.tv_sec - origin.tv_sec) * 1000000000ULL +
+                (uint64_t)now.tv_nsec - (uint64_t)origin.tv_nsec;
+
+  return ns * timeScale / 1000000ULL;
+}
+
+SIM_Board *SIM_openBoard(void) {
+  const char *path = getenv("SIM_BOARD");
+  const char *scale = getenv("SIM_TIME_SCALE");
+
+  if (path == NULL) {
+    fprintf(stderr, "SIM_BOARD is not set\n");
+    return NULL;
+  }
+  if (scale != NULL && atoi(scale) > 0) {
+    timeScale = (uint32_t)atoi(scale);
+  }
+
+  int fd = open(path, O_RDWR | O_CREAT, 0644);
+  if (fd < 0 || ftruncate(fd, sizeof(SIM_Board)) != 0) {
+    perror(path);
+    return NULL;
+  }
+
+  SIM_Board *board = (SIM_Board *)mmap(NULL, sizeof(SIM_Board),
+                                       PROT_READ | PROT_WRITE, MAP_SHARED,
+                                       fd, 0);
+  close(fd);
+  if (board == MAP_FAILED) {
+    perror(path);
+    return NULL;
+  }
+
+  if (board->magic != SIM_BOARD_MAGIC) {
+    board->button = 1;
+    board->magic = SIM_BOARD_MAGIC;
+  }
+  board->led = 0;
+
+  clock_gettime(CLOCK_MONOTONIC, &origin);
+  VCLOCK_setNow64(0);
+  return board;
+}
+
+// Moves the virtual clock up to real (scaled) time. If the firmware got
+// ahead of it through HAL_Delay()/delay(), waits for real time to catch up.
+void SIM_syncClock(void) {
+  uint64_t real = elapsedMs();
+  uint64_t virtualNow = VCLOCK_now64();
+
+  if (real > virtualNow) {
+    VCLOCK_advanceTo(real);
+    return;
+  }
+
+  while (elapsedMs() < virtualNow) {
+    SIM_idle();
+  }
+}
+
+void SIM_idle(void) {
+  struct timespec pause = {0, 50000L / (long)timeScale};
+
+  nanosleep(&pause, NULL);
+}
@@ -0,0 +1,36 @@
+#ifndef SimBoard_H__
+#define SimBoard_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Simulated Nucleo board shared with the acceptance tests.
+//
+// The board is a small file mapped by both the host firmware build and the
+// RPi.GPIO stand-in in python/RPi/GPIO.py: the firmware publishes the LED
+// line (read by the tests on GPIO 17) and reads the button line (driven by
+// the tests on GPIO 27, high when released). The file path comes from the
+// SIM_BOARD environment variable and the clock runs SIM_TIME_SCALE times
+// faster than real time.
+
+#define SIM_BOARD_MAGIC 0x424D4953UL // "SIMB"
+
+typedef struct {
+  uint32_t magic;
+  volatile uint32_t led;
+  volatile uint32_t button;
+  uint32_t reserved;
+} SIM_Board;
+
+SIM_Board *SIM_openBoard(void);
+void SIM_syncClock(void);
+void SIM_idle(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SimBoard_H__ */
@@ -0,0 +1,40 @@
+#include "main.h"
+#include "sim_board.h"
+
+extern void setup(void);
+extern void loop(void);
+
+int main(void) {
+  SIM_Board *board = SIM_openBoard();
+
+  if (board == NULL) {
+    return 1;
+  }
+
+  uint32_t button = board->button;
+
+  SPY_HAL_GPIO_SetInputPin(PUSH_BUTTON_GPIO_Port, PUSH_BUTTON_Pin,
+                           button ? GPIO_PIN_SET : GPIO_PIN_RESET);
+
+  setup();
+  for (;;) {
+    SIM_syncClock();
+
+    uint32_t level = board->button;
+    if (level != button) {
+      button = level;
+      SPY_HAL_GPIO_SetInputPin(PUSH_BUTTON_GPIO_Port, PUSH_BUTTON_Pin,
+                               level ? GPIO_PIN_SET : GPIO_PIN_RESET);
+      // B1 is active low and its EXTI line triggers on the falling edge.
+      if (!level) {
+        SPY_HAL_GPIO_EXTI_Trigger(PUSH_BUTTON_Pin);
+      }
+    }
+
+    loop();
+
+    board->led =
+        SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin) == GPIO_PIN_SET;
+    SIM_idle();
+  }
+}
@@ -0,0 +1,48 @@
+#include "Arduino.h"
+#include "fake.h"
+#include "soak.h"
+#include "vclock.h"
+#include <stdio.h>
+
+#define LED 13
+#define PUSH_BUTTON 23
+
+extern void setup(void);
+extern void loop(void);
+
+static int ledLevel(void)
+{
+    return SPY_getPinLevel(LED) == HIGH;
+}
+
+// The button idles high and the sketch toggles on its falling edge.
+static void startBlinking(void)
+{
+#ifdef SOAK_BUTTON
+    SPY_setPinLevel(PUSH_BUTTON, LOW);
+    SPY_setPinLevel(PUSH_BUTTON, HIGH);
+#endif
+}
+
+// The sketch's own period, which it keeps in unsigned long.
+#ifdef SOAK_BUTTON
+#define SOAK_PERIOD_MS 500
+#else
+#define SOAK_PERIOD_MS 1000
+#endif
+
+int main(void)
+{
+    SOAK_Config config = {loop, ledLevel, NULL, SOAK_PERIOD_MS, 0, SOAK_WRAPS,
+                          startBlinking, NULL};
+    SOAK_Result result;
+
+    printf("arduino %s, unsigned long is %u bits\n", SOAK_LAB,
+           (unsigned)(sizeof(unsigned long) * 8));
+    FAKE_setEnabled(1);
+    SPY_setPinLevel(PUSH_BUTTON, HIGH);
+    setup();
+    SOAK_run(&config, &result);
+    printf("%s\n", SOAK_describe(&result));
+    return result.violation != SOAK_OK;
+}
@@ -0,0 +1,251 @@
+#include "binlogdecode.hpp"
+#include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// A conversion spec from its '%': flags, width and precision are kept for
+// snprintf(), length modifiers are dropped since every argument is 32
+// bits, and conversion is the character that ends it, or '\0' if the
+// format ends first.
+struct Spec {
+  size_t keep;
+  size_t length;
+  char conversion;
+};
+
+static Spec parseSpec(const char *spec) {
+  Spec parsed;
+  size_t i = 1;
+
+  while (spec[i] != '\0' && strchr("-+ #0", spec[i]) != NULL) {
+    i++;
+  }
+  while (isdigit((unsigned char)spec[i])) {
+    i++;
+  }
+  if (spec[i] == '.') {
+    i++;
+    while (isdigit((unsigned char)spec[i])) {
+      i++;
+    }
+  }
+  parsed.keep = i;
+  while (spec[i] != '\0' && strchr("hljztLq", spec[i]) != NULL) {
+    i++;
+  }
+  parsed.conversion = spec[i];
+  parsed.length = spec[i] != '\0' ? i + 1 : i;
+  return parsed;
+}
+
+int BINLOGDECODE_conversions(const char *format) {
+  int count = 0;
+
+  while ((format = strchr(format, '%')) != NULL) {
+    Spec spec = parseSpec(format);
+
+    if (spec.conversion == '\0') {
+      break;
+    }
+    if (spec.conversion != '%' || spec.length != 2) {
+      count++;
+    }
+    format += spec.length;
+  }
+  return count;
+}
+
+static void convert(std::string &out, const char *at, const Spec &spec,
+                    uint32_t arg) {
+  std::string conversion(at, spec.keep);
+  char piece[BINLOGDECODE_TEXT_MAX];
+
+  switch (spec.conversion) {
+  case 'd':
+  case 'i':
+    conversion += 'd';
+    snprintf(piece, sizeof(piece), conversion.c_str(), (int)(int32_t)arg);
+    break;
+  case 'u':
+  case 'x':
+  case 'X':
+  case 'o':
+    conversion += spec.conversion;
+    snprintf(piece, sizeof(piece), conversion.c_str(), (unsigned int)arg);
+    break;
+  case 'c':
+    conversion += 'c';
+    snprintf(piece, sizeof(piece), conversion.c_str(), (int)(arg & 0xFFU));
+    break;
+  case 'p':
+    snprintf(piece, sizeof(piece), "0x%08" PRIx32, arg);
+    break;
+  default:
+    snprintf(piece, sizeof(piece), "?");
+    break;
+  }
+  out += piece;
+}
+
+int BINLOGDECODE_format(const char *format, const uint32_t *args,
+                        uint32_t count, char *text, size_t size) {
+  int conversions = BINLOGDECODE_conversions(format);
+  std::string out;
+  uint32_t next = 0;
+
+  if (conversions < 0 || (uint32_t)conversions > count) {
+    return -1;
+  }
+
+  for (const char *at = format; *at != '\0';) {
+    const char *percent = strchr(at, '%');
+
+    if (percent == NULL) {
+      out += at;
+      break;
+    }
+    out.append(at, (size_t)(percent - at));
+
+    Spec spec = parseSpec(percent);
+
+    if (spec.conversion == '\0') {
+      out += percent;
+      break;
+    }
+    if (spec.conversion == '%' && spec.length == 2) {
+      out += '%';
+    } else {
+      convert(out, percent, spec, args[next++]);
+    }
+    at = percent + spec.length;
+  }
+
+  if (size > 0) {
+    size_t length = out.size() < size - 1 ? out.size() : size - 1;
+
+    memcpy(text, out.data(), length);
+    text[length] = '\0';
+  }
+  return conversions;
+}
+
+BinlogDecoder::BinlogDecoder(const char *dictionary, size_t size)
+  : formats(dictionary, size), conversions(size, -1), decoded(0),
+    noise(0) {
+  for (size_t start = 0; start < size;) {
+    size_t end = formats.find('\0', start);
+
+    if (end == std::string::npos) {
+      end = size;
+    }
+    conversions[start] =
+        BINLOGDECODE_conversions(formats.substr(start, end - start).c_str());
+    start = end + 1;
+  }
+}
+
+static uint32_t le32(const uint8_t *bytes) {
+  return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 |
+         (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+const char *BinlogDecoder::formatOf(uint32_t header) const {
+  uint32_t id = header >> 16;
+  int count = (int)((header >> 8) & 0xFFU);
+
+  if ((header & 0xFFU) != BINLOGDECODE_SYNC ||
+      count > BINLOGDECODE_ARGS_MAX || id >= conversions.size() ||
+      conversions[id] != count) {
+    return NULL;
+  }
+  return formats.c_str() + id;
+}
+
+// Every frame has at least its header and tick, so fewer than 8 bytes
+// wait for more.
+size_t BinlogDecoder::feed(const uint8_t *bytes, size_t size,
+                           BINLOGDECODE_Sink sink, void *context) {
+  size_t at = 0;
+  size_t count = 0;
+
+  pending.insert(pending.end(), bytes, bytes + size);
+  while (pending.size() - at >= 8) {
+    uint32_t header = le32(&pending[at]);
+    const char *format = formatOf(header);
+
+    if (format == NULL) {
+      at++;
+      noise++;
+      continue;
+    }
+
+    uint32_t args[BINLOGDECODE_ARGS_MAX];
+    uint32_t argCount = (header >> 8) & 0xFFU;
+    size_t length = 8 + 4 * (size_t)argCount;
+
+    if (pending.size() - at < length) {
+      break;
+    }
+    for (uint32_t i = 0; i < argCount; i++) {
+      args[i] = le32(&pending[at + 8 + 4 * i]);
+    }
+
+    char text[BINLOGDECODE_TEXT_MAX];
+    BINLOGDECODE_format(format, args, argCount, text, sizeof(text));
+    sink(context, le32(&pending[at + 4]), text);
+    decoded++;
+    count++;
+    at += length;
+  }
+  pending.erase(pending.begin(), pending.begin() + (long)at);
+  return count;
+}
+
+BINLOGDECODE_Decoder *BINLOGDECODE_create(const char *dictionary,
+                                          size_t size) {
+  if (size > BINLOGDECODE_DICTIONARY_MAX) {
+    errno = EFBIG;
+    return NULL;
+  }
+  return new BinlogDecoder(dictionary, size);
+}
+
+BINLOGDECODE_Decoder *BINLOGDECODE_fromElf(const char *path) {
+  char *data;
+  size_t size;
+
+  if (BINLOGDECODE_readSection(path, "binlog", &data, &size) != 0) {
+    return NULL;
+  }
+
+  BINLOGDECODE_Decoder *decoder = BINLOGDECODE_create(data, size);
+  int error = errno;
+
+  free(data);
+  errno = error;
+  return decoder;
+}
+
+void BINLOGDECODE_destroy(BINLOGDECODE_Decoder *decoder) { delete decoder; }
+
+size_t BINLOGDECODE_feed(BINLOGDECODE_Decoder *decoder, const uint8_t *bytes,
+                         size_t size, BINLOGDECODE_Sink sink, void *context) {
+  return decoder->feed(bytes, size, sink, context);
+}
+
+uint64_t BINLOGDECODE_frames(const BINLOGDECODE_Decoder *decoder) {
+  return decoder->frames();
+}
+
+uint64_t BINLOGDECODE_skipped(const BINLOGDECODE_Decoder *decoder) {
+  return decoder->skipped();
+}
+
+const char *BINLOGDECODE_dictionary(const BINLOGDECODE_Decoder *decoder,
+                                    size_t *size) {
+  *size = decoder->dictionary().size();
+  return decoder->dictionary().data();
+}
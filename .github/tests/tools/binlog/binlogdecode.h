@@ -0,0 +1,77 @@
+#ifndef BinlogDecode_H__
+#define BinlogDecode_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Host side of lib/binlog: turns the firmware's frames back into text.
+//
+// The dictionary is the contents of the firmware's binlog section, the
+// format strings back to back with their terminators, and a frame's id is
+// the offset of its format in it. It is read from the ELF the firmware was
+// built as, or from a file holding just that section.
+//
+// Bytes can be fed in pieces of any size; a frame split across two feeds
+// is decoded when the rest arrives. A frame is only accepted if its sync
+// byte is right, its id is the start of a format in the dictionary and its
+// argument count matches the format's conversions. Anything else is taken
+// for noise, such as a capture that starts part way through a frame, and
+// skipped a byte at a time until the stream lines up again.
+//
+// Ids are 16 bits, so no frame can name a format past the first
+// BINLOGDECODE_DICTIONARY_MAX bytes. A larger dictionary means the
+// firmware's ids have wrapped and alias other formats, so it is refused
+// rather than decoded into the wrong text.
+
+#define BINLOGDECODE_SYNC 0xB1U
+#define BINLOGDECODE_ARGS_MAX 4
+#define BINLOGDECODE_TEXT_MAX 256
+#define BINLOGDECODE_DICTIONARY_MAX 0x10000U
+
+typedef struct BinlogDecoder BINLOGDECODE_Decoder;
+
+typedef void (*BINLOGDECODE_Sink)(void *context, uint32_t tick,
+                                  const char *text);
+
+// Both return NULL with errno set to EFBIG when the dictionary is larger
+// than BINLOGDECODE_DICTIONARY_MAX. BINLOGDECODE_fromElf() also returns
+// NULL with errno set when the file cannot be read or is not an ELF, and
+// with errno set to ENOENT when it has no binlog section.
+BINLOGDECODE_Decoder *BINLOGDECODE_create(const char *dictionary,
+                                          size_t size);
+BINLOGDECODE_Decoder *BINLOGDECODE_fromElf(const char *path);
+void BINLOGDECODE_destroy(BINLOGDECODE_Decoder *decoder);
+
+// Calls sink once per frame completed by these bytes and returns how many
+// that was.
+size_t BINLOGDECODE_feed(BINLOGDECODE_Decoder *decoder, const uint8_t *bytes,
+                         size_t size, BINLOGDECODE_Sink sink, void *context);
+uint64_t BINLOGDECODE_frames(const BINLOGDECODE_Decoder *decoder);
+uint64_t BINLOGDECODE_skipped(const BINLOGDECODE_Decoder *decoder);
+
+// The dictionary as loaded, e.g. to save one taken from an ELF.
+const char *BINLOGDECODE_dictionary(const BINLOGDECODE_Decoder *decoder,
+                                    size_t *size);
+
+// printf() for the integer conversions the firmware can log, each taking
+// one 32-bit argument. Conversions it cannot carry print as "?". Returns
+// the number of conversions in format, or -1 when there are more than
+// count of them.
+int BINLOGDECODE_format(const char *format, const uint32_t *args,
+                        uint32_t count, char *text, size_t size);
+int BINLOGDECODE_conversions(const char *format);
+
+// Reads the named section of an ELF file into a malloc()ed buffer. Returns
+// 0, or -1 with errno set.
+int BINLOGDECODE_readSection(const char *path, const char *name,
+                             char **data, size_t *size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BinlogDecode_H__ */
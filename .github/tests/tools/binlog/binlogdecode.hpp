@@ -0,0 +1,31 @@
+#ifndef BinlogDecode_HPP__
+#define BinlogDecode_HPP__
+
+#include "binlogdecode.h"
+#include <string>
+#include <vector>
+
+class BinlogDecoder {
+public:
+  BinlogDecoder(const char *dictionary, size_t size);
+
+  size_t feed(const uint8_t *bytes, size_t size, BINLOGDECODE_Sink sink,
+              void *context);
+  uint64_t frames() const { return decoded; }
+  uint64_t skipped() const { return noise; }
+  const std::string &dictionary() const { return formats; }
+
+private:
+  // The format a frame header names, or NULL if it names none with that
+  // many arguments.
+  const char *formatOf(uint32_t header) const;
+
+  std::string formats;
+  // Conversions per format, by id; -1 where no format starts.
+  std::vector<int> conversions;
+  std::vector<uint8_t> pending;
+  uint64_t decoded;
+  uint64_t noise;
+};
+
+#endif /* BinlogDecode_HPP__ */
@@ -0,0 +1,104 @@
+#include "binlogdecode.h"
+#include <elf.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+static bool readFile(const char *path, std::vector<char> &data) {
+  FILE *file = fopen(path, "rb");
+  char buffer[65536];
+  size_t got;
+
+  if (file == NULL) {
+    return false;
+  }
+  while ((got = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    data.insert(data.end(), buffer, buffer + got);
+  }
+  bool ok = ferror(file) == 0;
+  fclose(file);
+  return ok;
+}
+
+static bool within(const std::vector<char> &data, uint64_t offset,
+                   uint64_t size) {
+  return offset <= data.size() && size <= data.size() - offset;
+}
+
+// Both the firmware (32-bit ARM) and the host's own binaries (64-bit) are
+// read; either way they are little-endian.
+template <typename Ehdr, typename Shdr>
+static int findSection(const std::vector<char> &data, const char *name,
+                       char **out, size_t *size) {
+  Ehdr header;
+
+  if (!within(data, 0, sizeof(header))) {
+    errno = ENOEXEC;
+    return -1;
+  }
+  memcpy(&header, data.data(), sizeof(header));
+  if (header.e_shentsize != sizeof(Shdr) || header.e_shstrndx == SHN_UNDEF ||
+      header.e_shstrndx >= header.e_shnum ||
+      !within(data, header.e_shoff,
+              (uint64_t)header.e_shnum * sizeof(Shdr))) {
+    errno = ENOEXEC;
+    return -1;
+  }
+
+  std::vector<Shdr> sections(header.e_shnum);
+  memcpy(sections.data(), data.data() + header.e_shoff,
+         sections.size() * sizeof(Shdr));
+
+  const Shdr &names = sections[header.e_shstrndx];
+  if (!within(data, names.sh_offset, names.sh_size)) {
+    errno = ENOEXEC;
+    return -1;
+  }
+
+  for (const Shdr &section : sections) {
+    if (section.sh_name >= names.sh_size ||
+        strncmp(data.data() + names.sh_offset + section.sh_name, name,
+                names.sh_size - section.sh_name) != 0) {
+      continue;
+    }
+    if (section.sh_type == SHT_NOBITS ||
+        !within(data, section.sh_offset, section.sh_size)) {
+      errno = ENOEXEC;
+      return -1;
+    }
+    *out = (char *)malloc(section.sh_size > 0 ? section.sh_size : 1);
+    if (*out == NULL) {
+      return -1;
+    }
+    memcpy(*out, data.data() + section.sh_offset, section.sh_size);
+    *size = section.sh_size;
+    return 0;
+  }
+
+  errno = ENOENT;
+  return -1;
+}
+
+int BINLOGDECODE_readSection(const char *path, const char *name,
+                             char **data, size_t *size) {
+  std::vector<char> file;
+
+  if (!readFile(path, file)) {
+    return -1;
+  }
+  if (!within(file, 0, EI_NIDENT) || memcmp(file.data(), ELFMAG, SELFMAG) ||
+      file[EI_DATA] != ELFDATA2LSB) {
+    errno = ENOEXEC;
+    return -1;
+  }
+  if (file[EI_CLASS] == ELFCLASS32) {
+    return findSection<Elf32_Ehdr, Elf32_Shdr>(file, name, data, size);
+  }
+  if (file[EI_CLASS] == ELFCLASS64) {
+    return findSection<Elf64_Ehdr, Elf64_Shdr>(file, name, data, size);
+  }
+  errno = ENOEXEC;
+  return -1;
+}
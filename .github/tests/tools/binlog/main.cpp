@@ -0,0 +1,134 @@
+// binlogdecode (-e firmware.elf | -d dictionary) [-w dictionary] [capture]
+//
+// Decodes a capture of lib/binlog frames, from the file or from standard
+// input as it arrives, into one "<tick> <text>" line per frame. The
+// dictionary comes from the firmware's ELF or from a file holding its
+// binlog section; -w saves it, so later captures can be decoded without
+// the ELF.
+
+#include "binlogdecode.h"
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static int usage(const char *name) {
+  fprintf(stderr,
+          "usage: %s (-e firmware.elf | -d dictionary) [-w dictionary] "
+          "[capture]\n",
+          name);
+  return 2;
+}
+
+static void print(void *context, uint32_t tick, const char *text) {
+  printf("%" PRIu32 " %s\n", tick, text);
+}
+
+static BINLOGDECODE_Decoder *loadDictionary(const char *path) {
+  FILE *file = fopen(path, "rb");
+  char *data = NULL;
+  size_t size = 0;
+  char buffer[4096];
+  size_t got;
+
+  if (file == NULL) {
+    return NULL;
+  }
+  while ((got = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    char *grown = (char *)realloc(data, size + got);
+
+    if (grown == NULL) {
+      free(data);
+      fclose(file);
+      return NULL;
+    }
+    data = grown;
+    memcpy(data + size, buffer, got);
+    size += got;
+  }
+  fclose(file);
+
+  BINLOGDECODE_Decoder *decoder = BINLOGDECODE_create(data, size);
+  free(data);
+  return decoder;
+}
+
+static int saveDictionary(const BINLOGDECODE_Decoder *decoder,
+                          const char *path) {
+  size_t size;
+  const char *data = BINLOGDECODE_dictionary(decoder, &size);
+  FILE *file = fopen(path, "wb");
+
+  if (file == NULL) {
+    return -1;
+  }
+  size_t written = fwrite(data, 1, size, file);
+  return (fclose(file) == 0 && written == size) ? 0 : -1;
+}
+
+int main(int argc, char **argv) {
+  const char *elf = NULL;
+  const char *dictionary = NULL;
+  const char *save = NULL;
+  int option;
+
+  while ((option = getopt(argc, argv, "e:d:w:")) != -1) {
+    switch (option) {
+    case 'e':
+      elf = optarg;
+      break;
+    case 'd':
+      dictionary = optarg;
+      break;
+    case 'w':
+      save = optarg;
+      break;
+    default:
+      return usage(argv[0]);
+    }
+  }
+  if ((elf == NULL) == (dictionary == NULL) || argc - optind > 1) {
+    return usage(argv[0]);
+  }
+
+  const char *source = elf != NULL ? elf : dictionary;
+  BINLOGDECODE_Decoder *decoder = elf != NULL ? BINLOGDECODE_fromElf(elf)
+                                              : loadDictionary(dictionary);
+
+  if (decoder == NULL) {
+    fprintf(stderr, "%s: %s\n", source, strerror(errno));
+    return 1;
+  }
+  if (save != NULL && saveDictionary(decoder, save) != 0) {
+    fprintf(stderr, "%s: %s\n", save, strerror(errno));
+    BINLOGDECODE_destroy(decoder);
+    return 1;
+  }
+
+  FILE *capture = stdin;
+  if (optind < argc && (capture = fopen(argv[optind], "rb")) == NULL) {
+    fprintf(stderr, "%s: %s\n", argv[optind], strerror(errno));
+    BINLOGDECODE_destroy(decoder);
+    return 1;
+  }
+
+  // Unbuffered reads, so a live capture is decoded as it comes in.
+  uint8_t bytes[4096];
+  ssize_t got;
+  while ((got = read(fileno(capture), bytes, sizeof(bytes))) > 0) {
+    BINLOGDECODE_feed(decoder, bytes, (size_t)got, print, NULL);
+    fflush(stdout);
+  }
+
+  uint64_t skipped = BINLOGDECODE_skipped(decoder);
+  if (skipped > 0) {
+    fprintf(stderr, "%" PRIu64 " bytes skipped\n", skipped);
+  }
+  if (capture != stdin) {
+    fclose(capture);
+  }
+  BINLOGDECODE_destroy(decoder);
+  return got < 0 ? 1 : 0;
+}
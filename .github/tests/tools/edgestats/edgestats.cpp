@@ -0,0 +1,232 @@
+#include "edgestats.hpp"
+#include <math.h>
+#include <string.h>
+
+void Histogram::reset() {
+  memset(counts, 0, sizeof(counts));
+  total = 0;
+  maximum = 0;
+}
+
+int Histogram::bucketOf(uint64_t value) {
+  if (value < (uint64_t)SUB_BUCKETS) {
+    return (int)value;
+  }
+  int shift = 63 - __builtin_clzll(value) - SUB_BUCKET_BITS;
+  return SUB_BUCKETS * shift + (int)(value >> shift);
+}
+
+uint64_t Histogram::bucketUpper(int bucket) {
+  if (bucket < 2 * SUB_BUCKETS) {
+    return (uint64_t)bucket;
+  }
+  int shift = bucket / SUB_BUCKETS - 1;
+  uint64_t mantissa = (uint64_t)(bucket - SUB_BUCKETS * shift);
+  return ((mantissa + 1) << shift) - 1;
+}
+
+void Histogram::add(uint64_t value) {
+  counts[bucketOf(value)]++;
+  total++;
+  if (value > maximum) {
+    maximum = value;
+  }
+}
+
+uint64_t Histogram::percentile(double percent) const {
+  if (total == 0) {
+    return 0;
+  }
+  uint64_t rank = (uint64_t)ceil(percent / 100.0 * (double)total);
+  if (rank < 1) {
+    rank = 1;
+  }
+  uint64_t seen = 0;
+  for (int bucket = 0; bucket < BUCKETS; bucket++) {
+    seen += counts[bucket];
+    if (seen >= rank) {
+      uint64_t upper = bucketUpper(bucket);
+      return upper < maximum ? upper : maximum;
+    }
+  }
+  return maximum;
+}
+
+EdgeStats::EdgeStats(uint64_t nominalPeriodUs, uint64_t toleranceUs)
+  : nominal(nominalPeriodUs), tolerance(toleranceUs) {
+  reset();
+}
+
+void EdgeStats::reset() {
+  edges = 0;
+  missed = 0;
+  lastLevel = -1;
+  lastEdge[0] = lastEdge[1] = 0;
+  seen[0] = seen[1] = false;
+  previousPeriod = 0;
+  periods = 0;
+  inTolerance = 0;
+  periodMin = UINT64_MAX;
+  periodMax = 0;
+  periodMean = 0.0;
+  periodM2 = 0.0;
+  duties = 0;
+  dutyMean = 0.0;
+  fitOrigin = 0;
+  cycle = 0;
+  fitCount = 0;
+  fitMeanX = fitMeanY = fitCxy = fitM2x = 0.0;
+  jitter.reset();
+}
+
+void EdgeStats::edge(uint64_t timeUs, int level) {
+  level = level ? 1 : 0;
+  edges++;
+  // Without a nominal period gaps cannot be sized, so only two edges of the
+  // same polarity in a row tell that the one in between was lost.
+  if (nominal == 0 && level == lastLevel) {
+    missed++;
+  }
+
+  if (seen[level] && timeUs > lastEdge[level]) {
+    period(timeUs, level, timeUs - lastEdge[level]);
+  }
+  else if (level == 1 && !seen[1]) {
+    fitOrigin = timeUs;
+    fit(timeUs);
+  }
+
+  lastEdge[level] = timeUs;
+  seen[level] = true;
+  lastLevel = level;
+}
+
+void EdgeStats::period(uint64_t timeUs, int level, uint64_t periodUs) {
+  uint64_t cycles = 1;
+
+  if (nominal != 0) {
+    cycles = (periodUs + nominal / 2) / nominal;
+    if (cycles < 1) {
+      cycles = 1;
+    }
+  }
+
+  if (level == 1) {
+    cycle += cycles;
+    fit(timeUs);
+  }
+
+  // A gap of whole periods is missed edges, not a long period.
+  if (cycles > 1) {
+    missed += cycles - 1;
+    return;
+  }
+
+  if (level == 1 && seen[0] && lastEdge[0] > lastEdge[1]) {
+    double duty = (double)(lastEdge[0] - lastEdge[1]) / (double)periodUs;
+    duties++;
+    dutyMean += (duty - dutyMean) / (double)duties;
+  }
+
+  periods++;
+  double delta = (double)periodUs - periodMean;
+  periodMean += delta / (double)periods;
+  periodM2 += delta * ((double)periodUs - periodMean);
+  if (periodUs < periodMin) {
+    periodMin = periodUs;
+  }
+  if (periodUs > periodMax) {
+    periodMax = periodUs;
+  }
+
+  uint64_t reference = nominal != 0 ? nominal : previousPeriod;
+  previousPeriod = periodUs;
+  if (reference == 0) {
+    return;
+  }
+  uint64_t deviation =
+      periodUs > reference ? periodUs - reference : reference - periodUs;
+  jitter.add(deviation);
+  if (deviation <= tolerance) {
+    inTolerance++;
+  }
+}
+
+void EdgeStats::fit(uint64_t timeUs) {
+  double x = (double)cycle;
+  double y = (double)(timeUs - fitOrigin);
+
+  fitCount++;
+  double dx = x - fitMeanX;
+  fitMeanX += dx / (double)fitCount;
+  fitMeanY += (y - fitMeanY) / (double)fitCount;
+  fitCxy += dx * (y - fitMeanY);
+  fitM2x += dx * (x - fitMeanX);
+}
+
+void EdgeStats::summary(EDGESTATS_Summary *out) const {
+  out->edges = edges;
+  out->periods = periods;
+  out->missedEdges = missed;
+  out->inTolerance = inTolerance;
+  out->periodMinUs = periods != 0 ? periodMin : 0;
+  out->periodMaxUs = periodMax;
+  out->periodMeanUs = periodMean;
+  out->periodStdDevUs =
+      periods > 1 ? sqrt(periodM2 / (double)(periods - 1)) : 0.0;
+  out->dutyMean = dutyMean;
+  out->fittedPeriodUs = fitM2x > 0.0 ? fitCxy / fitM2x : 0.0;
+  out->driftPpm = nominal != 0 && fitM2x > 0.0
+                      ? (out->fittedPeriodUs - (double)nominal) /
+                            (double)nominal * 1e6
+                      : 0.0;
+}
+
+extern "C" {
+
+EDGESTATS_Stats *EDGESTATS_create(uint64_t nominalPeriodUs,
+                                  uint64_t toleranceUs) {
+  return new EdgeStats(nominalPeriodUs, toleranceUs);
+}
+
+void EDGESTATS_destroy(EDGESTATS_Stats *stats) {
+  delete stats;
+}
+
+void EDGESTATS_reset(EDGESTATS_Stats *stats) {
+  stats->reset();
+}
+
+void EDGESTATS_edge(EDGESTATS_Stats *stats, uint64_t timeUs, int level) {
+  stats->edge(timeUs, level);
+}
+
+// Trace ticks are milliseconds; port and pin select the line as in
+// TRACE_Record (GPIO port index and mask on STM32, pin number and 1 on
+// Arduino).
+size_t EDGESTATS_feedTrace(EDGESTATS_Stats *stats,
+                           const TRACE_Record *records, size_t count,
+                           uint16_t port, uint16_t pin) {
+  size_t fed = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    const TRACE_Record *record = &records[i];
+    if (record->kind == TRACE_OUTPUT && record->port == port &&
+        (record->pins & pin) != 0) {
+      stats->edge(record->tick * 1000, (record->levels & pin) != 0);
+      fed++;
+    }
+  }
+  return fed;
+}
+
+void EDGESTATS_summary(const EDGESTATS_Stats *stats,
+                       EDGESTATS_Summary *summary) {
+  stats->summary(summary);
+}
+
+uint64_t EDGESTATS_jitterPercentile(const EDGESTATS_Stats *stats,
+                                    double percent) {
+  return stats->jitterPercentile(percent);
+}
+}
@@ -0,0 +1,56 @@
+#ifndef EdgeStats_H__
+#define EdgeStats_H__
+
+#include "trace.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Streaming timing statistics for a single digital line.
+//
+// Edges are fed one at a time with their timestamp in microseconds and the
+// new level. A period is measured between consecutive edges of the same
+// polarity, so a square wave yields a sample on every edge after the first
+// two. Nothing is kept per edge: summaries come from running moments and a
+// fixed log-linear histogram, so arbitrarily long captures fit in ~16 KiB.
+
+typedef struct EdgeStats EDGESTATS_Stats;
+
+typedef struct {
+  uint64_t edges;
+  uint64_t periods;
+  uint64_t missedEdges;
+  uint64_t inTolerance;
+  uint64_t periodMinUs;
+  uint64_t periodMaxUs;
+  double periodMeanUs;
+  double periodStdDevUs;
+  double dutyMean;
+  double fittedPeriodUs;
+  double driftPpm;
+} EDGESTATS_Summary;
+
+// Periods spanning several nominal periods count as missed edges. When
+// nominalPeriodUs is 0 jitter is taken period-to-period instead and missed
+// edges are only seen as two edges of the same polarity in a row.
+EDGESTATS_Stats *EDGESTATS_create(uint64_t nominalPeriodUs,
+                                  uint64_t toleranceUs);
+void EDGESTATS_destroy(EDGESTATS_Stats *stats);
+void EDGESTATS_reset(EDGESTATS_Stats *stats);
+void EDGESTATS_edge(EDGESTATS_Stats *stats, uint64_t timeUs, int level);
+size_t EDGESTATS_feedTrace(EDGESTATS_Stats *stats,
+                           const TRACE_Record *records, size_t count,
+                           uint16_t port, uint16_t pin);
+void EDGESTATS_summary(const EDGESTATS_Stats *stats,
+                       EDGESTATS_Summary *summary);
+uint64_t EDGESTATS_jitterPercentile(const EDGESTATS_Stats *stats,
+                                    double percent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EdgeStats_H__ */
@@ -0,0 +1,76 @@
+#ifndef EdgeStats_HPP__
+#define EdgeStats_HPP__
+
+#include "edgestats.h"
+
+class Histogram {
+public:
+  // 32 linear sub-buckets per power of two: values below 64 us are exact
+  // and larger ones are within 1/32 of their bucket.
+  static const int SUB_BUCKET_BITS = 5;
+  static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+  static const int BUCKETS = SUB_BUCKETS * (64 - SUB_BUCKET_BITS + 1);
+
+  void reset();
+  void add(uint64_t value);
+  uint64_t percentile(double percent) const;
+  uint64_t count() const { return total; }
+
+  static int bucketOf(uint64_t value);
+  static uint64_t bucketUpper(int bucket);
+
+private:
+  uint64_t counts[BUCKETS];
+  uint64_t total;
+  uint64_t maximum;
+};
+
+class EdgeStats {
+public:
+  EdgeStats(uint64_t nominalPeriodUs, uint64_t toleranceUs);
+
+  void reset();
+  void edge(uint64_t timeUs, int level);
+  void summary(EDGESTATS_Summary *out) const;
+  uint64_t jitterPercentile(double percent) const {
+    return jitter.percentile(percent);
+  }
+
+private:
+  void period(uint64_t timeUs, int level, uint64_t periodUs);
+  void fit(uint64_t timeUs);
+
+  uint64_t nominal;
+  uint64_t tolerance;
+
+  uint64_t edges;
+  uint64_t missed;
+  int lastLevel;
+  uint64_t lastEdge[2];
+  bool seen[2];
+  uint64_t previousPeriod;
+
+  // Welford running moments of the period and of the duty cycle.
+  uint64_t periods;
+  uint64_t inTolerance;
+  uint64_t periodMin;
+  uint64_t periodMax;
+  double periodMean;
+  double periodM2;
+  uint64_t duties;
+  double dutyMean;
+
+  // Least-squares fit of rising edge time against cycle number; the slope
+  // is the long-run period, so it sees drift that jitter hides.
+  uint64_t fitOrigin;
+  uint64_t cycle;
+  uint64_t fitCount;
+  double fitMeanX;
+  double fitMeanY;
+  double fitCxy;
+  double fitM2x;
+
+  Histogram jitter;
+};
+
+#endif /* EdgeStats_HPP__ */
@@ -0,0 +1,123 @@
+"""Python binding for the edgestats streaming timing library.
+
+Build the shared library with `make` in this directory (or point
+EDGESTATS_LIB at it), then feed edges as they are captured:
+
+    stats = EdgeStats(nominal_period_us=1_000_000, tolerance_us=150_000)
+    stats.edge(time.monotonic_ns() // 1000, GPIO.input(17))
+    ...
+    print(stats.summary(), stats.jitter_percentile(99))
+
+Traces written by the unit test mocks (trace.h) can be fed directly with
+feed_trace(), and the transitions the acceptance tests watch on GPIO 17
+with feed_watch().
+"""
+import ctypes
+import os
+import struct
+
+_LIB_PATH = os.environ.get(
+    "EDGESTATS_LIB",
+    os.path.join(os.path.dirname(os.path.abspath(__file__)), "build", "libedgestats.so"),
+)
+
+_TRACE_MAGIC = 0x4352544D
+_TRACE_HEADER = struct.Struct("<IHHQ")
+_TRACE_RECORD_SIZE = 16
+_TRACE_CHUNK = 4096
+
+
+class _Summary(ctypes.Structure):
+    _fields_ = [
+        ("edges", ctypes.c_uint64),
+        ("periods", ctypes.c_uint64),
+        ("missedEdges", ctypes.c_uint64),
+        ("inTolerance", ctypes.c_uint64),
+        ("periodMinUs", ctypes.c_uint64),
+        ("periodMaxUs", ctypes.c_uint64),
+        ("periodMeanUs", ctypes.c_double),
+        ("periodStdDevUs", ctypes.c_double),
+        ("dutyMean", ctypes.c_double),
+        ("fittedPeriodUs", ctypes.c_double),
+        ("driftPpm", ctypes.c_double),
+    ]
+
+
+def _load():
+    lib = ctypes.CDLL(_LIB_PATH)
+    lib.EDGESTATS_create.restype = ctypes.c_void_p
+    lib.EDGESTATS_create.argtypes = [ctypes.c_uint64, ctypes.c_uint64]
+    lib.EDGESTATS_destroy.argtypes = [ctypes.c_void_p]
+    lib.EDGESTATS_reset.argtypes = [ctypes.c_void_p]
+    lib.EDGESTATS_edge.argtypes = [ctypes.c_void_p, ctypes.c_uint64, ctypes.c_int]
+    lib.EDGESTATS_feedTrace.restype = ctypes.c_size_t
+    lib.EDGESTATS_feedTrace.argtypes = [
+        ctypes.c_void_p, ctypes.c_char_p, ctypes.c_size_t, ctypes.c_uint16, ctypes.c_uint16,
+    ]
+    lib.EDGESTATS_summary.argtypes = [ctypes.c_void_p, ctypes.POINTER(_Summary)]
+    lib.EDGESTATS_jitterPercentile.restype = ctypes.c_uint64
+    lib.EDGESTATS_jitterPercentile.argtypes = [ctypes.c_void_p, ctypes.c_double]
+    return lib
+
+
+_lib = _load()
+
+
+class EdgeStats:
+    """Period, duty cycle, jitter, drift and missed edges of one line."""
+
+    def __init__(self, nominal_period_us=0, tolerance_us=0):
+        self._handle = _lib.EDGESTATS_create(nominal_period_us, tolerance_us)
+
+    def close(self):
+        if self._handle:
+            _lib.EDGESTATS_destroy(self._handle)
+            self._handle = None
+
+    def __del__(self):
+        self.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def reset(self):
+        _lib.EDGESTATS_reset(self._handle)
+
+    def edge(self, time_us, level):
+        _lib.EDGESTATS_edge(self._handle, int(time_us), 1 if level else 0)
+
+    def feed(self, edges):
+        """Feeds an iterable of (time_us, level) pairs."""
+        for time_us, level in edges:
+            self.edge(time_us, level)
+
+    def feed_watch(self, transitions):
+        """Feeds the (time, level) transitions of a gpiocapture watch(),
+        whose times are in seconds."""
+        for time_s, level in transitions:
+            self.edge(round(time_s * 1_000_000), level)
+
+    def feed_trace(self, path, port, pin):
+        """Feeds the output transitions of one line of a mock trace file."""
+        fed = 0
+        with open(path, "rb") as trace:
+            magic, _, record_size, _ = _TRACE_HEADER.unpack(trace.read(_TRACE_HEADER.size))
+            if magic != _TRACE_MAGIC or record_size != _TRACE_RECORD_SIZE:
+                raise ValueError(f"{path} is not a GPIO trace")
+            while True:
+                chunk = trace.read(_TRACE_RECORD_SIZE * _TRACE_CHUNK)
+                count = len(chunk) // _TRACE_RECORD_SIZE
+                if count == 0:
+                    return fed
+                fed += _lib.EDGESTATS_feedTrace(self._handle, chunk, count, port, pin)
+
+    def summary(self):
+        summary = _Summary()
+        _lib.EDGESTATS_summary(self._handle, ctypes.byref(summary))
+        return {name: getattr(summary, name) for name, _ in _Summary._fields_}
+
+    def jitter_percentile(self, percent):
+        return _lib.EDGESTATS_jitterPercentile(self._handle, percent)
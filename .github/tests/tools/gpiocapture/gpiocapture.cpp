@@ -0,0 +1,210 @@
+#include "gpiocapture.hpp"
+#include <errno.h>
+#include <fcntl.h>
+#include <gpiod.h>
+#include <poll.h>
+#include <time.h>
+#include <unistd.h>
+
+// Events taken from the kernel per read(), and the kernel's own queue for
+// the whole request, which is the most the kernel accepts.
+static const size_t EVENT_BATCH = 64;
+static const size_t KERNEL_QUEUE_EDGES = 1024;
+
+static uint64_t monotonicNs(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+GpioCapture::GpioCapture() : request(NULL), buffer(NULL), running(false) {
+  stopPipe[0] = -1;
+  stopPipe[1] = -1;
+}
+
+GpioCapture::~GpioCapture() {
+  if (running) {
+    char stop = 0;
+
+    while (write(stopPipe[1], &stop, 1) < 0 && errno == EINTR) {
+    }
+    pthread_join(thread, NULL);
+  }
+  for (int i = 0; i < 2; i++) {
+    if (stopPipe[i] >= 0) {
+      close(stopPipe[i]);
+    }
+  }
+  if (buffer != NULL) {
+    gpiod_edge_event_buffer_free(buffer);
+  }
+  if (request != NULL) {
+    gpiod_line_request_release(request);
+  }
+}
+
+GpioCapture *GpioCapture::open(const char *chip, const unsigned int *lines,
+                               size_t count, const char *path) {
+  GpioCapture *capture = NULL;
+
+  if (count == 0 || count > GPIOCAPTURE_LINES_MAX) {
+    errno = EINVAL;
+    return NULL;
+  }
+  capture = new GpioCapture();
+  if (capture->requestLines(chip, lines, count) < 0 ||
+      capture->recorder.open(path, monotonicNs(), (uint32_t)count) < 0 ||
+      capture->start() < 0) {
+    int saved = errno;
+
+    delete capture;
+    errno = saved;
+    return NULL;
+  }
+  return capture;
+}
+
+// The request outlives the chip handle, so the chip is closed right away.
+int GpioCapture::requestLines(const char *chip, const unsigned int *lines,
+                              size_t count) {
+  struct gpiod_chip *handle = gpiod_chip_open(chip);
+  struct gpiod_line_settings *settings = gpiod_line_settings_new();
+  struct gpiod_line_config *config = gpiod_line_config_new();
+  struct gpiod_request_config *requestConfig = gpiod_request_config_new();
+  int saved = 0;
+
+  if (handle != NULL && settings != NULL && config != NULL &&
+      requestConfig != NULL) {
+    gpiod_line_settings_set_direction(settings, GPIOD_LINE_DIRECTION_INPUT);
+    gpiod_line_settings_set_edge_detection(settings, GPIOD_LINE_EDGE_BOTH);
+    gpiod_line_settings_set_event_clock(settings,
+                                        GPIOD_LINE_CLOCK_MONOTONIC);
+    gpiod_request_config_set_consumer(requestConfig, "gpiocapture");
+    gpiod_request_config_set_event_buffer_size(requestConfig,
+                                               KERNEL_QUEUE_EDGES);
+    if (gpiod_line_config_add_line_settings(config, lines, count,
+                                            settings) == 0) {
+      request = gpiod_chip_request_lines(handle, requestConfig, config);
+    }
+  }
+  saved = errno;
+
+  if (requestConfig != NULL) {
+    gpiod_request_config_free(requestConfig);
+  }
+  if (config != NULL) {
+    gpiod_line_config_free(config);
+  }
+  if (settings != NULL) {
+    gpiod_line_settings_free(settings);
+  }
+  if (handle != NULL) {
+    gpiod_chip_close(handle);
+  }
+  if (request == NULL) {
+    errno = saved;
+    return -1;
+  }
+
+  buffer = gpiod_edge_event_buffer_new(EVENT_BATCH);
+  return (buffer != NULL) ? 0 : -1;
+}
+
+int GpioCapture::start() {
+  int error = 0;
+
+  if (pipe2(stopPipe, O_CLOEXEC) < 0) {
+    return -1;
+  }
+  error = pthread_create(&thread, NULL, run, this);
+  if (error != 0) {
+    errno = error;
+    return -1;
+  }
+  running = true;
+  return 0;
+}
+
+void *GpioCapture::run(void *self) {
+  static_cast<GpioCapture *>(self)->loop();
+  return NULL;
+}
+
+// Sleeps in poll() until the kernel has edges or the capture is closed.
+void GpioCapture::loop() {
+  struct pollfd fds[2] = {{gpiod_line_request_get_fd(request), POLLIN, 0},
+                          {stopPipe[0], POLLIN, 0}};
+
+  for (;;) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    if (fds[1].revents != 0) {
+      return;
+    }
+    if ((fds[0].revents & POLLIN) == 0) {
+      return;
+    }
+    drain();
+  }
+}
+
+void GpioCapture::drain() {
+  GPIOCAPTURE_Edge edges[EVENT_BATCH];
+  int count = gpiod_line_request_read_edge_events(request, buffer, EVENT_BATCH);
+
+  for (int i = 0; i < count; i++) {
+    struct gpiod_edge_event *event =
+        gpiod_edge_event_buffer_get_event(buffer, (unsigned long)i);
+
+    edges[i].timeNs = gpiod_edge_event_get_timestamp_ns(event);
+    edges[i].seqno = (uint32_t)gpiod_edge_event_get_global_seqno(event);
+    edges[i].line = (uint16_t)gpiod_edge_event_get_line_offset(event);
+    edges[i].level = gpiod_edge_event_get_event_type(event) ==
+                     GPIOD_EDGE_EVENT_RISING_EDGE;
+    edges[i].reserved = 0;
+  }
+  if (count > 0) {
+    recorder.record(edges, (size_t)count);
+  }
+}
+
+int GpioCapture::level(unsigned int line) {
+  enum gpiod_line_value value = gpiod_line_request_get_value(request, line);
+
+  return (value == GPIOD_LINE_VALUE_ERROR) ? -1 : (int)value;
+}
+
+extern "C" {
+
+GPIOCAPTURE_Capture *GPIOCAPTURE_open(const char *chip,
+                                      const unsigned int *lines, size_t count,
+                                      const char *path) {
+  return GpioCapture::open(chip, lines, count, path);
+}
+
+void GPIOCAPTURE_close(GPIOCAPTURE_Capture *capture) {
+  delete capture;
+}
+
+size_t GPIOCAPTURE_read(GPIOCAPTURE_Capture *capture, GPIOCAPTURE_Edge *edges,
+                        size_t max) {
+  return capture->read(edges, max);
+}
+
+int GPIOCAPTURE_level(GPIOCAPTURE_Capture *capture, unsigned int line) {
+  return capture->level(line);
+}
+
+uint64_t GPIOCAPTURE_kernelDropped(const GPIOCAPTURE_Capture *capture) {
+  return capture->edges().kernelDropped();
+}
+
+uint64_t GPIOCAPTURE_ringDropped(const GPIOCAPTURE_Capture *capture) {
+  return capture->edges().ringDropped();
+}
+}
@@ -0,0 +1,74 @@
+#ifndef GpioCapture_H__
+#define GpioCapture_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Edge capture from GPIO lines through the libgpiod v2 character device.
+//
+// The kernel timestamps every edge in its interrupt handler, so an edge's
+// time does not depend on when user space gets round to reading it. A
+// reader thread drains the kernel's event queue into a lock-free ring that
+// GPIOCAPTURE_read() empties, and optionally streams every edge to a file.
+// Timestamps are CLOCK_MONOTONIC nanoseconds, the clock behind Python's
+// time.monotonic_ns().
+//
+// A capture file is a 24-byte header followed by fixed 16-byte edge records
+// in host byte order, written in batches as the kernel hands them over.
+
+#define GPIOCAPTURE_MAGIC 0x50414347UL // "GCAP"
+#define GPIOCAPTURE_VERSION 1
+#define GPIOCAPTURE_LINES_MAX 64
+#define GPIOCAPTURE_RING_EDGES 4096
+
+typedef struct GpioCapture GPIOCAPTURE_Capture;
+
+typedef struct {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t recordSize;
+  uint64_t startNs;
+  uint32_t lineCount;
+  uint32_t reserved;
+} GPIOCAPTURE_Header;
+
+// seqno counts the edges of every line in the request, as the kernel
+// numbered them, so a gap means the kernel's queue overflowed.
+typedef struct {
+  uint64_t timeNs;
+  uint32_t seqno;
+  uint16_t line;
+  uint8_t level;
+  uint8_t reserved;
+} GPIOCAPTURE_Edge;
+
+// Requests the lines as inputs with both edges detected and starts the
+// reader thread. chip is a path such as "/dev/gpiochip0"; path names the
+// file to stream to, or is NULL. Returns NULL with errno set on failure.
+GPIOCAPTURE_Capture *GPIOCAPTURE_open(const char *chip,
+                                      const unsigned int *lines, size_t count,
+                                      const char *path);
+void GPIOCAPTURE_close(GPIOCAPTURE_Capture *capture);
+
+// Takes up to max edges out of the ring, oldest first. When nobody reads
+// the ring, the newest edges are dropped once it is full; the file still
+// gets them.
+size_t GPIOCAPTURE_read(GPIOCAPTURE_Capture *capture, GPIOCAPTURE_Edge *edges,
+                        size_t max);
+
+// The line's current level, or -1 with errno set.
+int GPIOCAPTURE_level(GPIOCAPTURE_Capture *capture, unsigned int line);
+
+// Edges lost in the kernel's queue and in the ring.
+uint64_t GPIOCAPTURE_kernelDropped(const GPIOCAPTURE_Capture *capture);
+uint64_t GPIOCAPTURE_ringDropped(const GPIOCAPTURE_Capture *capture);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* GpioCapture_H__ */
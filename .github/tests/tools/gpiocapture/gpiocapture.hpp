@@ -0,0 +1,122 @@
+#ifndef GpioCapture_HPP__
+#define GpioCapture_HPP__
+
+#include "gpiocapture.h"
+#include <atomic>
+#include <pthread.h>
+#include <stdio.h>
+
+// Single-producer, single-consumer ring: the reader thread pushes and the
+// caller pops. The indices run freely and are masked on access, so the
+// capacity must be a power of two.
+template <size_t CAPACITY> class EdgeRing {
+  static_assert((CAPACITY & (CAPACITY - 1)) == 0,
+                "ring capacity must be a power of two");
+
+public:
+  EdgeRing() : head(0), tail(0) {}
+
+  bool push(const GPIOCAPTURE_Edge &edge) {
+    size_t at = head.load(std::memory_order_relaxed);
+
+    if (at - tail.load(std::memory_order_acquire) == CAPACITY) {
+      return false;
+    }
+    slots[at & (CAPACITY - 1)] = edge;
+    head.store(at + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t pop(GPIOCAPTURE_Edge *edges, size_t max) {
+    size_t from = tail.load(std::memory_order_relaxed);
+    size_t count = head.load(std::memory_order_acquire) - from;
+
+    if (count > max) {
+      count = max;
+    }
+    for (size_t i = 0; i < count; i++) {
+      edges[i] = slots[(from + i) & (CAPACITY - 1)];
+    }
+    tail.store(from + count, std::memory_order_release);
+    return count;
+  }
+
+  size_t size() const {
+    return head.load(std::memory_order_acquire) -
+           tail.load(std::memory_order_acquire);
+  }
+
+private:
+  GPIOCAPTURE_Edge slots[CAPACITY];
+  // Padded apart so the two threads do not bounce one cache line; padding
+  // rather than alignas, since C++11 new ignores extended alignment.
+  std::atomic<size_t> head;
+  char padding[64 - sizeof(std::atomic<size_t>)];
+  std::atomic<size_t> tail;
+};
+
+// What the reader thread does with a batch of edges once libgpiod has
+// handed it over: count kernel overflows from the sequence numbers, fill
+// the ring and append to the capture file.
+class EdgeRecorder {
+public:
+  EdgeRecorder();
+  ~EdgeRecorder();
+
+  // Opens and truncates the capture file and writes its header; a NULL
+  // path records to the ring only. Returns -1 with errno set on failure.
+  int open(const char *path, uint64_t startNs, uint32_t lineCount);
+  void record(const GPIOCAPTURE_Edge *edges, size_t count);
+
+  size_t read(GPIOCAPTURE_Edge *edges, size_t max) {
+    return ring.pop(edges, max);
+  }
+  uint64_t kernelDropped() const {
+    return kernelLost.load(std::memory_order_relaxed);
+  }
+  uint64_t ringDropped() const {
+    return ringLost.load(std::memory_order_relaxed);
+  }
+
+private:
+  EdgeRing<GPIOCAPTURE_RING_EDGES> ring;
+  FILE *file;
+  bool sequenced;
+  uint32_t lastSeqno;
+  std::atomic<uint64_t> kernelLost;
+  std::atomic<uint64_t> ringLost;
+};
+
+struct gpiod_line_request;
+struct gpiod_edge_event_buffer;
+
+class GpioCapture {
+public:
+  static GpioCapture *open(const char *chip, const unsigned int *lines,
+                           size_t count, const char *path);
+  ~GpioCapture();
+
+  size_t read(GPIOCAPTURE_Edge *edges, size_t max) {
+    return recorder.read(edges, max);
+  }
+  int level(unsigned int line);
+  const EdgeRecorder &edges() const { return recorder; }
+
+private:
+  GpioCapture();
+  int requestLines(const char *chip, const unsigned int *lines, size_t count);
+  int start();
+  static void *run(void *self);
+  void loop();
+  void drain();
+
+  gpiod_line_request *request;
+  gpiod_edge_event_buffer *buffer;
+  // Written to once to wake the reader thread up and stop it.
+  int stopPipe[2];
+  pthread_t thread;
+  bool running;
+  EdgeRecorder recorder;
+};
+
+#endif /* GpioCapture_HPP__ */
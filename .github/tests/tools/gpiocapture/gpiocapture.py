@@ -0,0 +1,239 @@
+"""Python binding for the gpiocapture edge-capture library.
+
+Build the shared library with `make` in this directory (it needs libgpiod
+v2; point GPIOCAPTURE_LIB elsewhere to override), then read edges as the
+kernel timestamped them:
+
+    with Capture("/dev/gpiochip0", [17]) as capture:
+        ...
+        for edge in capture.read():
+            print(edge.time_ns, edge.line, edge.level)
+
+Timestamps are CLOCK_MONOTONIC nanoseconds, the clock behind
+time.monotonic_ns(). Files streamed by Capture(path=...) or by the
+gpiocapture tool are read back with read_file().
+
+LineWatch gives the acceptance suites the transitions of one line over a
+stretch of time; PollingWatch offers the same interface by sampling a read
+function, for where no capture is possible.
+"""
+import collections
+import ctypes
+import os
+import struct
+import time
+
+_LIB_PATH = os.environ.get(
+    "GPIOCAPTURE_LIB",
+    os.path.join(os.path.dirname(os.path.abspath(__file__)), "build", "libgpiocapture.so"),
+)
+DEFAULT_CHIP = os.environ.get("GPIOCAPTURE_CHIP", "/dev/gpiochip0")
+
+_MAGIC = 0x50414347
+_HEADER = struct.Struct("<IHHQII")
+_EDGE = struct.Struct("<QIHBx")
+_READ_CHUNK = 256
+_FILE_CHUNK = 4096
+# Time for the reader thread to hand over edges from the end of a window.
+_SETTLE_S = 0.005
+
+Edge = collections.namedtuple("Edge", ["time_ns", "seqno", "line", "level"])
+
+
+class _Edge(ctypes.Structure):
+    _fields_ = [
+        ("timeNs", ctypes.c_uint64),
+        ("seqno", ctypes.c_uint32),
+        ("line", ctypes.c_uint16),
+        ("level", ctypes.c_uint8),
+        ("reserved", ctypes.c_uint8),
+    ]
+
+
+_lib = None
+
+
+def _load():
+    global _lib
+    if _lib is None:
+        lib = ctypes.CDLL(_LIB_PATH, use_errno=True)
+        lib.GPIOCAPTURE_open.restype = ctypes.c_void_p
+        lib.GPIOCAPTURE_open.argtypes = [
+            ctypes.c_char_p, ctypes.POINTER(ctypes.c_uint), ctypes.c_size_t, ctypes.c_char_p,
+        ]
+        lib.GPIOCAPTURE_close.argtypes = [ctypes.c_void_p]
+        lib.GPIOCAPTURE_read.restype = ctypes.c_size_t
+        lib.GPIOCAPTURE_read.argtypes = [ctypes.c_void_p, ctypes.POINTER(_Edge), ctypes.c_size_t]
+        lib.GPIOCAPTURE_level.restype = ctypes.c_int
+        lib.GPIOCAPTURE_level.argtypes = [ctypes.c_void_p, ctypes.c_uint]
+        lib.GPIOCAPTURE_kernelDropped.restype = ctypes.c_uint64
+        lib.GPIOCAPTURE_kernelDropped.argtypes = [ctypes.c_void_p]
+        lib.GPIOCAPTURE_ringDropped.restype = ctypes.c_uint64
+        lib.GPIOCAPTURE_ringDropped.argtypes = [ctypes.c_void_p]
+        _lib = lib
+    return _lib
+
+
+def available():
+    """Whether the library has been built and loads."""
+    try:
+        _load()
+    except OSError:
+        return False
+    return True
+
+
+class Capture:
+    """Edges on a set of lines of one GPIO chip, captured in the background."""
+
+    def __init__(self, chip, lines, path=None):
+        lib = _load()
+        offsets = (ctypes.c_uint * len(lines))(*lines)
+        self._handle = lib.GPIOCAPTURE_open(
+            chip.encode(), offsets, len(lines), path.encode() if path else None
+        )
+        if not self._handle:
+            error = ctypes.get_errno()
+            raise OSError(error, os.strerror(error), chip)
+        self._buffer = (_Edge * _READ_CHUNK)()
+
+    def close(self):
+        if getattr(self, "_handle", None):
+            _lib.GPIOCAPTURE_close(self._handle)
+            self._handle = None
+
+    def __del__(self):
+        self.close()
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def read(self):
+        """Takes every edge captured since the last read, oldest first."""
+        edges = []
+        while True:
+            count = _lib.GPIOCAPTURE_read(self._handle, self._buffer, _READ_CHUNK)
+            edges.extend(
+                Edge(edge.timeNs, edge.seqno, edge.line, edge.level) for edge in self._buffer[:count]
+            )
+            if count < _READ_CHUNK:
+                return edges
+
+    def level(self, line):
+        value = _lib.GPIOCAPTURE_level(self._handle, line)
+        if value < 0:
+            error = ctypes.get_errno()
+            raise OSError(error, os.strerror(error))
+        return value
+
+    @property
+    def kernel_dropped(self):
+        return _lib.GPIOCAPTURE_kernelDropped(self._handle)
+
+    @property
+    def ring_dropped(self):
+        return _lib.GPIOCAPTURE_ringDropped(self._handle)
+
+
+def read_file(path):
+    """Yields the edges of a capture file, including one still being written."""
+    with open(path, "rb") as capture:
+        magic, _, record_size, _, _, _ = _HEADER.unpack(capture.read(_HEADER.size))
+        if magic != _MAGIC or record_size != _EDGE.size:
+            raise ValueError(f"{path} is not a GPIO capture")
+        while True:
+            chunk = capture.read(_EDGE.size * _FILE_CHUNK)
+            whole = len(chunk) - len(chunk) % _EDGE.size
+            for fields in _EDGE.iter_unpack(chunk[:whole]):
+                yield Edge(*fields)
+            if len(chunk) < _EDGE.size * _FILE_CHUNK:
+                return
+
+
+class LineWatch:
+    """Transitions of one line, timestamped by the kernel."""
+
+    def __init__(self, line, chip=DEFAULT_CHIP):
+        self.line = line
+        self._capture = Capture(chip, [line])
+        self._pending = []
+
+    def close(self):
+        self._capture.close()
+
+    def now(self):
+        return time.monotonic_ns() / 1e9
+
+    def level(self):
+        return self._capture.level(self.line)
+
+    def watch(self, seconds, since=None):
+        """Waits for seconds and returns (time, level) for each edge in between.
+
+        With since, a now() reading, the edges from then on that no earlier
+        watch() returned come first, so a stimulus applied before the call
+        is seen whole.
+        """
+        edges = self._pending + self._capture.read()
+        start = time.monotonic_ns() if since is None else int(since * 1e9)
+        time.sleep(seconds)
+        end = time.monotonic_ns()
+        time.sleep(_SETTLE_S)
+        edges += self._capture.read()
+        self._pending = [edge for edge in edges if edge.time_ns >= end]
+        return [
+            (edge.time_ns / 1e9, edge.level)
+            for edge in edges
+            if start <= edge.time_ns < end
+        ]
+
+
+class PollingWatch:
+    """The LineWatch interface over a read function sampled every interval."""
+
+    def __init__(self, read, interval=0.01):
+        self._read = read
+        self._interval = interval
+        self._last = None
+
+    def close(self):
+        pass
+
+    def now(self):
+        self._last = self._read()
+        return time.time()
+
+    def level(self):
+        return self._read()
+
+    def watch(self, seconds, since=None):
+        """Samples for seconds and returns (time, level) for each change seen.
+
+        With since, changes are counted from the level read by that now()
+        call, or by the end of a later watch(), rather than from the level
+        at the call.
+        """
+        transitions = []
+        last = self._read() if since is None or self._last is None else self._last
+        end = time.time() + seconds
+        while time.time() < end:
+            current = self._read()
+            if current != last:
+                transitions.append((time.time(), current))
+                last = current
+            time.sleep(self._interval)
+        self._last = last
+        return transitions
+
+
+def try_line_watch(line, chip=DEFAULT_CHIP):
+    """A LineWatch on the line, or None if the library or line is unavailable."""
+    if not available():
+        return None
+    try:
+        return LineWatch(line, chip)
+    except OSError:
+        return None
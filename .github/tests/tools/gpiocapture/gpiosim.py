@@ -0,0 +1,69 @@
+"""Simulated GPIO chips from the gpio-sim kernel module, for testing
+gpiocapture on any Linux machine.
+
+Needs the module loaded (`sudo modprobe gpio-sim`), configfs mounted on
+/sys/kernel/config and root. The simulator pulls each line of its chip up
+or down; requested as an input, the line follows the pull and the kernel
+reports an edge on every change, just as it would for a real pin.
+"""
+import os
+
+CONFIGFS = "/sys/kernel/config/gpio-sim"
+
+
+def supported():
+    return os.path.isdir(CONFIGFS) and os.access(CONFIGFS, os.W_OK)
+
+
+def _write(path, value):
+    with open(path, "w") as attribute:
+        attribute.write(value)
+
+
+def _read(path):
+    with open(path) as attribute:
+        return attribute.read().strip()
+
+
+class SimChip:
+    """A live gpio-sim chip with one bank of lines, all pulled down."""
+
+    def __init__(self, lines=8, name=None):
+        self._dir = os.path.join(CONFIGFS, name or f"gpiocapture-{os.getpid()}")
+        self._bank = os.path.join(self._dir, "bank0")
+        os.mkdir(self._dir)
+        try:
+            os.mkdir(self._bank)
+            _write(os.path.join(self._bank, "num_lines"), str(lines))
+            _write(os.path.join(self._dir, "live"), "1")
+            self.chip_name = _read(os.path.join(self._bank, "chip_name"))
+            self.dev_name = _read(os.path.join(self._dir, "dev_name"))
+        except OSError:
+            self.close()
+            raise
+        self.path = os.path.join("/dev", self.chip_name)
+
+    def _line(self, line):
+        return os.path.join(
+            "/sys/devices/platform", self.dev_name, self.chip_name, f"sim_gpio{line}"
+        )
+
+    def set_pull(self, line, level):
+        _write(os.path.join(self._line(line), "pull"), "pull-up" if level else "pull-down")
+
+    def value(self, line):
+        return int(_read(os.path.join(self._line(line), "value")))
+
+    def close(self):
+        if os.path.exists(os.path.join(self._dir, "live")):
+            _write(os.path.join(self._dir, "live"), "0")
+        if os.path.isdir(self._bank):
+            os.rmdir(self._bank)
+        if os.path.isdir(self._dir):
+            os.rmdir(self._dir)
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
@@ -0,0 +1,100 @@
+// gpiocapture [-c chip] [-o file] [-t seconds] line...
+//
+// Captures edges on the given lines until interrupted or for the given
+// time. With -o the edges are streamed to a capture file for
+// gpiocapture.read_file(); otherwise each one is printed as
+// "<time_ns> <line> <level>".
+
+#include "gpiocapture.h"
+#include <errno.h>
+#include <inttypes.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+static volatile sig_atomic_t stopping = 0;
+
+static void stop(int number) { stopping = 1; }
+
+static int usage(const char *name) {
+  fprintf(stderr, "usage: %s [-c chip] [-o file] [-t seconds] line...\n",
+          name);
+  return 2;
+}
+
+int main(int argc, char **argv) {
+  const char *chip = "/dev/gpiochip0";
+  const char *path = NULL;
+  double seconds = 0;
+  unsigned int lines[GPIOCAPTURE_LINES_MAX];
+  size_t count = 0;
+  int option;
+
+  while ((option = getopt(argc, argv, "c:o:t:")) != -1) {
+    switch (option) {
+    case 'c':
+      chip = optarg;
+      break;
+    case 'o':
+      path = optarg;
+      break;
+    case 't':
+      seconds = atof(optarg);
+      break;
+    default:
+      return usage(argv[0]);
+    }
+  }
+  for (int i = optind; i < argc; i++) {
+    if (count == GPIOCAPTURE_LINES_MAX) {
+      return usage(argv[0]);
+    }
+    lines[count++] = (unsigned int)strtoul(argv[i], NULL, 0);
+  }
+  if (count == 0) {
+    return usage(argv[0]);
+  }
+
+  GPIOCAPTURE_Capture *capture = GPIOCAPTURE_open(chip, lines, count, path);
+
+  if (capture == NULL) {
+    fprintf(stderr, "%s: %s\n", chip, strerror(errno));
+    return 1;
+  }
+  signal(SIGINT, stop);
+  signal(SIGTERM, stop);
+
+  // The file gets every edge, so the ring is only drained to print.
+  GPIOCAPTURE_Edge edges[256];
+  struct timespec interval = {0, 10000000};
+  long polls = (long)(seconds * 100);
+
+  for (long i = 0; !stopping && (seconds <= 0 || i < polls); i++) {
+    nanosleep(&interval, NULL);
+    if (path != NULL) {
+      continue;
+    }
+    size_t taken;
+    while ((taken = GPIOCAPTURE_read(capture, edges, 256)) > 0) {
+      for (size_t e = 0; e < taken; e++) {
+        printf("%" PRIu64 " %u %u\n", edges[e].timeNs, edges[e].line,
+               edges[e].level);
+      }
+    }
+    fflush(stdout);
+  }
+
+  uint64_t dropped = GPIOCAPTURE_kernelDropped(capture);
+  if (path == NULL) {
+    dropped += GPIOCAPTURE_ringDropped(capture);
+  }
+  GPIOCAPTURE_close(capture);
+  if (dropped > 0) {
+    fprintf(stderr, "%" PRIu64 " edges dropped\n", dropped);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,63 @@
+#include "gpiocapture.hpp"
+#include <errno.h>
+
+EdgeRecorder::EdgeRecorder()
+    : file(NULL), sequenced(false), lastSeqno(0), kernelLost(0), ringLost(0) {
+}
+
+EdgeRecorder::~EdgeRecorder() {
+  if (file != NULL) {
+    fclose(file);
+  }
+}
+
+int EdgeRecorder::open(const char *path, uint64_t startNs,
+                       uint32_t lineCount) {
+  GPIOCAPTURE_Header header = {GPIOCAPTURE_MAGIC,
+                               GPIOCAPTURE_VERSION,
+                               sizeof(GPIOCAPTURE_Edge),
+                               startNs,
+                               lineCount,
+                               0};
+
+  if (path == NULL) {
+    return 0;
+  }
+  file = fopen(path, "wb");
+  if (file == NULL) {
+    return -1;
+  }
+  if (fwrite(&header, sizeof(header), 1, file) != 1 || fflush(file) != 0) {
+    int saved = errno;
+
+    fclose(file);
+    file = NULL;
+    errno = saved;
+    return -1;
+  }
+  return 0;
+}
+
+// Flushed per batch, so the file can be read while the capture runs.
+void EdgeRecorder::record(const GPIOCAPTURE_Edge *edges, size_t count) {
+  uint64_t lost = 0;
+  uint64_t full = 0;
+
+  for (size_t i = 0; i < count; i++) {
+    if (sequenced) {
+      lost += (uint32_t)(edges[i].seqno - lastSeqno - 1);
+    }
+    sequenced = true;
+    lastSeqno = edges[i].seqno;
+    if (!ring.push(edges[i])) {
+      full++;
+    }
+  }
+  kernelLost.fetch_add(lost, std::memory_order_relaxed);
+  ringLost.fetch_add(full, std::memory_order_relaxed);
+
+  if (file != NULL && count > 0) {
+    fwrite(edges, sizeof(*edges), count, file);
+    fflush(file);
+  }
+}
@@ -0,0 +1,144 @@
+"""Tests for gpiocapture against a gpio-sim chip; no Raspberry Pi needed.
+
+    sudo modprobe gpio-sim
+    make
+    sudo python3 -m pytest -v test_gpiocapture.py
+"""
+import os
+import signal
+import subprocess
+import threading
+import time
+
+import pytest
+
+import gpiocapture
+import gpiosim
+
+pytestmark = [
+    pytest.mark.skipif(not gpiocapture.available(), reason="libgpiocapture.so is not built"),
+    pytest.mark.skipif(not gpiosim.supported(), reason="gpio-sim is not loaded or needs root"),
+]
+
+TOOL = os.path.join(os.path.dirname(os.path.abspath(__file__)), "build", "gpiocapture")
+
+
+@pytest.fixture
+def sim():
+    with gpiosim.SimChip(lines=4) as chip:
+        yield chip
+
+
+def toggle(sim, line, count, spacing=0.002):
+    """Flips the line count times; returns the window around each flip."""
+    windows = []
+    for i in range(count):
+        before = time.monotonic_ns()
+        sim.set_pull(line, i % 2 == 0)
+        windows.append((before, time.monotonic_ns()))
+        time.sleep(spacing)
+    time.sleep(0.05)
+    return windows
+
+
+def test_edges_carry_the_kernel_timestamp(sim):
+    with gpiocapture.Capture(sim.path, [0, 1]) as capture:
+        windows = toggle(sim, 1, 20)
+        edges = capture.read()
+
+        assert len(edges) == 20
+        assert [edge.line for edge in edges] == [1] * 20
+        assert [edge.level for edge in edges] == [1, 0] * 10
+        assert [edge.seqno for edge in edges] == list(range(edges[0].seqno, edges[0].seqno + 20))
+        for edge, (before, after) in zip(edges, windows):
+            assert before <= edge.time_ns <= after
+        assert capture.kernel_dropped == 0
+        assert capture.ring_dropped == 0
+
+
+def test_level_follows_the_line(sim):
+    with gpiocapture.Capture(sim.path, [2]) as capture:
+        assert capture.level(2) == 0
+        sim.set_pull(2, 1)
+        assert capture.level(2) == 1
+
+
+def test_streams_every_edge_to_a_file(sim, tmp_path):
+    path = str(tmp_path / "edges.gcap")
+
+    with gpiocapture.Capture(sim.path, [0], path=path) as capture:
+        toggle(sim, 0, 10)
+        edges = capture.read()
+
+    assert list(gpiocapture.read_file(path)) == edges
+
+
+def test_line_watch_sees_edges_polling_misses(sim):
+    def flip():
+        time.sleep(0.05)
+        toggle(sim, 3, 100, 0.001)
+
+    watch = gpiocapture.LineWatch(3, sim.path)
+    flipper = threading.Thread(target=flip)
+
+    try:
+        flipper.start()
+        transitions = watch.watch(1.0)
+    finally:
+        flipper.join()
+        watch.close()
+
+    assert len(transitions) == 100
+    assert [level for _, level in transitions] == [1, 0] * 50
+    intervals = [b[0] - a[0] for a, b in zip(transitions, transitions[1:])]
+    assert all(interval > 0 for interval in intervals)
+    assert sum(intervals) / len(intervals) < 0.005
+
+
+def test_line_watch_counts_edges_since_a_mark(sim):
+    watch = gpiocapture.LineWatch(2, sim.path)
+
+    try:
+        since = watch.now()
+        toggle(sim, 2, 3)
+        first = watch.watch(0.05, since=since)
+        toggle(sim, 2, 1)
+        second = watch.watch(0.05, since=since)
+        late = watch.watch(0.05)
+    finally:
+        watch.close()
+
+    assert [level for _, level in first] == [1, 0, 1]
+    assert all(time >= since for time, _ in first)
+    assert [level for _, level in second] == [0]
+    assert late == []
+
+
+def test_polling_watch_compares_with_the_level_at_the_mark():
+    levels = [0]
+    watch = gpiocapture.PollingWatch(lambda: levels[0], interval=0.001)
+
+    since = watch.now()
+    levels[0] = 1
+    first = watch.watch(0.02, since=since)
+    levels[0] = 0
+    second = watch.watch(0.02, since=since)
+
+    assert [level for _, level in first] == [1]
+    assert [level for _, level in second] == [0]
+    assert watch.watch(0.02) == []
+
+
+@pytest.mark.skipif(not os.path.exists(TOOL), reason="gpiocapture is not built")
+def test_tool_streams_until_interrupted(sim, tmp_path):
+    path = str(tmp_path / "edges.gcap")
+    tool = subprocess.Popen([TOOL, "-c", sim.path, "-o", path, "0"])
+
+    try:
+        time.sleep(0.2)
+        toggle(sim, 0, 6)
+    finally:
+        tool.send_signal(signal.SIGINT)
+        assert tool.wait(timeout=5) == 0
+
+    assert [edge.level for edge in gpiocapture.read_file(path)] == [1, 0] * 3
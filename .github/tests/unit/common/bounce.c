@@ -0,0 +1,104 @@
+#include "bounce.h"
+
+void BOUNCE_init(BOUNCE_Generator *generator, uint32_t seed) {
+  generator->state = seed ? seed : 0x9E3779B9UL;
+  generator->minBurstUs = 1000;
+  generator->maxBurstUs = 10000;
+  generator->maxEdges = BOUNCE_EDGES_MAX;
+  generator->minHoldUs = 50000;
+  generator->maxHoldUs = 500000;
+}
+
+uint32_t BOUNCE_random(BOUNCE_Generator *generator) {
+  uint32_t x = generator->state;
+
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  generator->state = x;
+  return x;
+}
+
+// Uniform in [low, high]; the modulo bias is irrelevant at these ranges.
+uint32_t BOUNCE_between(BOUNCE_Generator *generator, uint32_t low,
+                        uint32_t high) {
+  return low + BOUNCE_random(generator) % (high - low + 1);
+}
+
+// Fills edgesUs with one burst in increasing order, the first edge at 0 and
+// none later than the drawn burst length. Gaps are drawn up to twice the
+// average left for the remaining edges, so some bounces cluster and others
+// spread out. Returns the number of edges.
+uint32_t BOUNCE_burst(BOUNCE_Generator *generator, uint32_t *edgesUs,
+                      uint32_t max) {
+  uint32_t limit = generator->maxEdges < max ? generator->maxEdges : max;
+  uint32_t count = BOUNCE_between(generator, 1, limit);
+  uint32_t length =
+      BOUNCE_between(generator, generator->minBurstUs, generator->maxBurstUs);
+  uint32_t at = 0;
+
+  edgesUs[0] = 0;
+  for (uint32_t i = 1; i < count; i++) {
+    uint32_t left = length - at;
+    uint32_t gap = BOUNCE_between(generator, 1, 2 * left / (count - i) + 1);
+
+    at += gap < left ? gap : left;
+    edgesUs[i] = at;
+  }
+  return count;
+}
+
+// Fills edgesUs with the edges of one press and its release, in
+// increasing order from 0 and alternating from a closing edge. Returns the
+// number of edges, which is even unless max cuts the press short.
+uint32_t BOUNCE_press(BOUNCE_Generator *generator, uint32_t *edgesUs,
+                      uint32_t max) {
+  uint32_t burst[BOUNCE_EDGES_MAX];
+  uint32_t closing = BOUNCE_burst(generator, burst, BOUNCE_EDGES_MAX);
+  uint32_t hold =
+      BOUNCE_between(generator, generator->minHoldUs, generator->maxHoldUs);
+  uint32_t count = 0;
+
+  for (uint32_t i = 0; i < closing && count < max; i++) {
+    if (i > 0) {
+      edgesUs[count++] = (burst[i - 1] + burst[i]) / 2;
+    }
+    if (count < max) {
+      edgesUs[count++] = burst[i];
+    }
+  }
+
+  uint32_t release = burst[closing - 1] + hold;
+  uint32_t opening = BOUNCE_burst(generator, burst, BOUNCE_EDGES_MAX);
+
+  for (uint32_t i = 0; i < opening && count < max; i++) {
+    if (i > 0) {
+      edgesUs[count++] = release + (burst[i - 1] + burst[i]) / 2;
+    }
+    if (count < max) {
+      edgesUs[count++] = release + burst[i];
+    }
+  }
+  return count;
+}
+
+// Schedules one press, release included, on the virtual clock, starting at
+// the given millisecond; each edge calls closes or opens at the tick it
+// falls on. Returns the number of edges scheduled, which is less than the
+// press if the event table fills up.
+uint32_t BOUNCE_schedule(BOUNCE_Generator *generator, uint64_t at,
+                         VCLOCK_Callback closes, VCLOCK_Callback opens,
+                         void *context) {
+  uint32_t edgesUs[BOUNCE_PRESS_EDGES_MAX];
+  uint32_t count = BOUNCE_press(generator, edgesUs, BOUNCE_PRESS_EDGES_MAX);
+  uint32_t scheduled = 0;
+
+  for (uint32_t i = 0; i < count; i++) {
+    VCLOCK_Callback callback = BOUNCE_CLOSES(i) ? closes : opens;
+
+    if (VCLOCK_schedule(at + edgesUs[i] / 1000, callback, context) >= 0) {
+      scheduled++;
+    }
+  }
+  return scheduled;
+}
@@ -0,0 +1,58 @@
+#ifndef Bounce_H__
+#define Bounce_H__
+
+#include "vclock.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bouncing-button stimulus for the interrupt mocks.
+//
+// A press is modelled as a burst of falling edges: the first when the
+// contact closes, then a random number of bounces at random spacing until
+// the contact settles, 1 ms to 10 ms later by default. Edge times are in
+// microseconds from the start of the burst so that several bounces can land
+// on the same millisecond tick, as they do on the board. The generator is a
+// seeded xorshift32, so a failing run can be replayed from its seed.
+//
+// BOUNCE_press() gives every edge of a press, in both directions: the
+// contact opens again halfway between two closing edges of a burst. After
+// a hold of 50 ms to 500 ms by default, counted from the last closing
+// edge, the contact opens with a burst of its own, closing again halfway
+// between its opening edges. The edges alternate, so the even ones close
+// the contact and the odd ones open it; a clean press has two.
+
+#define BOUNCE_EDGES_MAX 16
+#define BOUNCE_PRESS_EDGES_MAX (4 * BOUNCE_EDGES_MAX)
+
+#define BOUNCE_CLOSES(index) (((index) & 1U) == 0)
+
+typedef struct {
+  uint32_t state;
+  uint32_t minBurstUs;
+  uint32_t maxBurstUs;
+  uint32_t maxEdges;
+  uint32_t minHoldUs;
+  uint32_t maxHoldUs;
+} BOUNCE_Generator;
+
+void BOUNCE_init(BOUNCE_Generator *generator, uint32_t seed);
+uint32_t BOUNCE_random(BOUNCE_Generator *generator);
+uint32_t BOUNCE_between(BOUNCE_Generator *generator, uint32_t low,
+                        uint32_t high);
+
+uint32_t BOUNCE_burst(BOUNCE_Generator *generator, uint32_t *edgesUs,
+                      uint32_t max);
+uint32_t BOUNCE_press(BOUNCE_Generator *generator, uint32_t *edgesUs,
+                      uint32_t max);
+uint32_t BOUNCE_schedule(BOUNCE_Generator *generator, uint64_t at,
+                         VCLOCK_Callback closes, VCLOCK_Callback opens,
+                         void *context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Bounce_H__ */
@@ -0,0 +1,147 @@
+#include "energy.h"
+#include "vclock.h"
+#include <string.h>
+
+// Run current is the datasheet's 146 uA/MHz with the peripherals off;
+// STOP is with the flash in stop mode and the regulator in low-power mode.
+// Call costs are ballpark cycle counts for the HAL on -Os, and for the
+// STM32 Arduino core on top of it.
+const ENERGY_Model ENERGY_defaultModel = {
+    84e6,
+    {12.3, 4.6, 0.042},
+    {
+        [FAKE_HAL_GetTick] = 12,
+        [FAKE_HAL_Delay] = 30,
+        [FAKE_HAL_GPIO_TogglePin] = 20,
+        [FAKE_HAL_GPIO_ReadPin] = 16,
+        [FAKE_HAL_GPIO_WritePin] = 16,
+        [FAKE_HAL_SuspendTick] = 12,
+        [FAKE_HAL_ResumeTick] = 12,
+        [FAKE_HAL_PWR_EnterSTOPMode] = 40,
+        [FAKE_HAL_TIM_Base_Start_IT] = 60,
+        [FAKE_HAL_TIM_Base_Stop_IT] = 60,
+        [FAKE_HAL_TIM_Base_Start] = 40,
+        [FAKE_HAL_TIM_Base_Stop] = 40,
+        [FAKE_HAL_DMA_Start] = 150,
+        [FAKE_HAL_DMA_Abort] = 100,
+        [FAKE_HAL_UART_Transmit] = 200,
+        [FAKE_HAL_UART_Transmit_DMA] = 250,
+        [FAKE_millis] = 20,
+        [FAKE_delay] = 40,
+        [FAKE_pinMode] = 400,
+        [FAKE_digitalWrite] = 60,
+        [FAKE_digitalRead] = 60,
+        [FAKE_attachInterrupt] = 500,
+        [FAKE_detachInterrupt] = 300,
+        [FAKE_digitalPinToInterrupt] = 10,
+    },
+};
+
+static ENERGY_State restState = ENERGY_SLEEP;
+static uint64_t restMs[ENERGY_STATE_COUNT];
+
+static uint64_t startElapsed;
+static uint64_t startRest[ENERGY_STATE_COUNT];
+static uint64_t startCalls[FAKE_API_COUNT];
+
+void ENERGY_rest(uint64_t ms) { restMs[restState] += ms; }
+
+void ENERGY_setRestState(ENERGY_State state) { restState = state; }
+
+void ENERGY_start(void) {
+  startElapsed = VCLOCK_elapsed();
+  memcpy(startRest, restMs, sizeof(startRest));
+  for (int api = 0; api < FAKE_API_COUNT; api++) {
+    startCalls[api] = FAKE_lifetimeCount((FAKE_Api)api);
+  }
+}
+
+void ENERGY_measure(const ENERGY_Model *model, ENERGY_Report *report) {
+  uint64_t resting = 0;
+  double charge = 0;
+
+  memset(report, 0, sizeof(*report));
+  report->elapsedMs = VCLOCK_elapsed() - startElapsed;
+  for (int state = ENERGY_SLEEP; state < ENERGY_STATE_COUNT; state++) {
+    report->stateMs[state] = restMs[state] - startRest[state];
+    resting += report->stateMs[state];
+  }
+  report->stateMs[ENERGY_RUN] =
+      (report->elapsedMs > resting) ? report->elapsedMs - resting : 0;
+
+  for (int api = 0; api < FAKE_API_COUNT; api++) {
+    report->calls[api] = FAKE_lifetimeCount((FAKE_Api)api) - startCalls[api];
+    report->callMs += (double)report->calls[api] * model->cycles[api] *
+                      1000.0 / model->coreHz;
+  }
+
+  if (report->elapsedMs == 0) {
+    return;
+  }
+  for (int state = 0; state < ENERGY_STATE_COUNT; state++) {
+    charge += (double)report->stateMs[state] * model->milliamps[state];
+  }
+  report->dutyCycle =
+      (double)report->stateMs[ENERGY_RUN] / (double)report->elapsedMs;
+  report->milliamps = charge / (double)report->elapsedMs;
+}
+
+double ENERGY_callsPerSecond(const ENERGY_Report *report, FAKE_Api api) {
+  if (report->elapsedMs == 0) {
+    return 0;
+  }
+  return (double)report->calls[api] * 1000.0 / (double)report->elapsedMs;
+}
+
+// Assumes the running time the calls do not account for is spent repeating
+// the same mix of calls.
+double ENERGY_estimatedCallsPerSecond(const ENERGY_Report *report,
+                                      FAKE_Api api) {
+  if (report->callMs <= 0) {
+    return 0;
+  }
+  return ENERGY_callsPerSecond(report, api) *
+         (double)report->stateMs[ENERGY_RUN] / report->callMs;
+}
+
+// One line per test. Rates and ratios are null when no simulated time
+// passed.
+void ENERGY_writeJson(FILE *out, const char *group, const char *name,
+                      const ENERGY_Report *report) {
+  int timed = report->elapsedMs > 0;
+  int first = 1;
+
+  fprintf(out,
+          "{\"group\": \"%s\", \"test\": \"%s\", \"elapsed_ms\": %llu, "
+          "\"run_ms\": %llu, \"sleep_ms\": %llu, \"stop_ms\": %llu, "
+          "\"call_ms\": %.6g",
+          group, name, (unsigned long long)report->elapsedMs,
+          (unsigned long long)report->stateMs[ENERGY_RUN],
+          (unsigned long long)report->stateMs[ENERGY_SLEEP],
+          (unsigned long long)report->stateMs[ENERGY_STOP], report->callMs);
+  if (timed) {
+    fprintf(out, ", \"duty_cycle\": %.6g, \"mah_per_hour\": %.6g",
+            report->dutyCycle, report->milliamps);
+  } else {
+    fprintf(out, ", \"duty_cycle\": null, \"mah_per_hour\": null");
+  }
+
+  fprintf(out, ", \"calls\": {");
+  for (int api = 0; api < FAKE_API_COUNT; api++) {
+    if (report->calls[api] == 0) {
+      continue;
+    }
+    fprintf(out, "%s\"%s\": {\"count\": %llu", first ? "" : ", ",
+            FAKE_apiName((FAKE_Api)api),
+            (unsigned long long)report->calls[api]);
+    if (timed) {
+      fprintf(out, ", \"per_second\": %.6g, \"estimated_per_second\": %.6g}",
+              ENERGY_callsPerSecond(report, (FAKE_Api)api),
+              ENERGY_estimatedCallsPerSecond(report, (FAKE_Api)api));
+    } else {
+      fprintf(out, ", \"per_second\": null, \"estimated_per_second\": null}");
+    }
+    first = 0;
+  }
+  fprintf(out, "}}\n");
+}
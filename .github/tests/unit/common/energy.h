@@ -0,0 +1,75 @@
+#ifndef Energy_H__
+#define Energy_H__
+
+#include "fake.h"
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Duty-cycle and charge estimates for a stretch of simulated time.
+//
+// The core is taken to be running whenever it is not asleep: __WFI()
+// reports the time it sleeps through, charged as STOP mode while
+// HAL_PWR_EnterSTOPMode() is waiting and as sleep otherwise. The model
+// turns that into an average current, which in mA is also the charge drawn
+// per simulated hour in mAh. The Arduino mocks have no way to sleep, so
+// sketches always run.
+//
+// Each mock call is also given a cost in core cycles. callMs is the time
+// the calls alone would take on the board; the rest of the running time
+// goes to the firmware's own code or to spinning, as a polling loop does.
+// Scaling the simulated call counts up to fill the running time estimates
+// how often a loop that never sleeps would make each call on the board,
+// which the simulation cannot show directly since it runs loop() once per
+// step of the virtual clock.
+//
+// ENERGY_start() opens a window and ENERGY_measure() reports on it; the
+// counters behind it survive VCLOCK_reset(), FAKE_clear() and the spies'
+// resets, so tests can reset those in setup() as usual. EnergyPlugin does
+// this around every test and writes one JSON line per test.
+
+typedef enum {
+  ENERGY_RUN = 0,
+  ENERGY_SLEEP,
+  ENERGY_STOP,
+  ENERGY_STATE_COUNT
+} ENERGY_State;
+
+typedef struct {
+  double coreHz;
+  double milliamps[ENERGY_STATE_COUNT];
+  uint32_t cycles[FAKE_API_COUNT];
+} ENERGY_Model;
+
+typedef struct {
+  uint64_t elapsedMs;
+  uint64_t stateMs[ENERGY_STATE_COUNT];
+  uint64_t calls[FAKE_API_COUNT];
+  double callMs;
+  double dutyCycle;
+  double milliamps;
+} ENERGY_Report;
+
+// Rough figures for a Nucleo-F401RE at 84 MHz.
+extern const ENERGY_Model ENERGY_defaultModel;
+
+void ENERGY_start(void);
+void ENERGY_measure(const ENERGY_Model *model, ENERGY_Report *report);
+double ENERGY_callsPerSecond(const ENERGY_Report *report, FAKE_Api api);
+double ENERGY_estimatedCallsPerSecond(const ENERGY_Report *report,
+                                      FAKE_Api api);
+void ENERGY_writeJson(FILE *out, const char *group, const char *name,
+                      const ENERGY_Report *report);
+
+// Called by the mocks.
+void ENERGY_rest(uint64_t ms);
+void ENERGY_setRestState(ENERGY_State state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Energy_H__ */
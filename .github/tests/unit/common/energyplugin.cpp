@@ -0,0 +1,37 @@
+#include "energyplugin.h"
+#include <stdlib.h>
+
+extern "C" {
+#include "energy.h"
+}
+
+EnergyPlugin::EnergyPlugin() : TestPlugin("EnergyPlugin"), out(NULL) {
+  const char *path = getenv("ENERGY_JSON");
+
+  if (path != NULL && path[0] != '\0') {
+    out = fopen(path, "w");
+  }
+}
+
+EnergyPlugin::~EnergyPlugin() {
+  if (out != NULL) {
+    fclose(out);
+  }
+}
+
+void EnergyPlugin::preTestAction(UtestShell &test, TestResult &result) {
+  if (out != NULL) {
+    ENERGY_start();
+  }
+}
+
+void EnergyPlugin::postTestAction(UtestShell &test, TestResult &result) {
+  ENERGY_Report report;
+
+  if (out == NULL) {
+    return;
+  }
+  ENERGY_measure(&ENERGY_defaultModel, &report);
+  ENERGY_writeJson(out, test.getGroup().asCharString(),
+                   test.getName().asCharString(), &report);
+}
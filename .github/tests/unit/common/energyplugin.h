@@ -0,0 +1,26 @@
+#ifndef EnergyPlugin_H__
+#define EnergyPlugin_H__
+
+#include "CppUTest/TestPlugin.h"
+#include <stdio.h>
+
+// Measures every test with ENERGY_start() and ENERGY_measure() against the
+// default model and appends one ENERGY_writeJson() line per test to the
+// file named by the ENERGY_JSON environment variable. The file is
+// truncated when the runner starts; without the variable the plugin does
+// nothing. A test that calls ENERGY_start() itself narrows its line to
+// what follows. Install it in all_tests.cpp.
+
+class EnergyPlugin : public TestPlugin {
+public:
+  EnergyPlugin();
+  virtual ~EnergyPlugin();
+
+  virtual void preTestAction(UtestShell &test, TestResult &result);
+  virtual void postTestAction(UtestShell &test, TestResult &result);
+
+private:
+  FILE *out;
+};
+
+#endif /* EnergyPlugin_H__ */
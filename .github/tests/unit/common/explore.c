@@ -0,0 +1,159 @@
+#define _DEFAULT_SOURCE
+
+#include "explore.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Shared with every process of an exploration. The processes never run
+// concurrently: each one waits for its child before it goes on.
+static EXPLORE_Result *shared;
+
+static const EXPLORE_Config *exploreConfig;
+static uint64_t point;
+static uint32_t remaining;
+static uint32_t injected;
+static uint64_t path[EXPLORE_DEPTH_MAX];
+static FAKE_Api pathApi[EXPLORE_DEPTH_MAX];
+
+static void fail(void) {
+  if (shared->failures++ == 0) {
+    shared->failedDepth = injected;
+    memcpy(shared->failedAt, path, sizeof(path));
+    memcpy(shared->failedApi, pathApi, sizeof(pathApi));
+  }
+}
+
+static void take(uint64_t at, FAKE_Api api) {
+  path[injected] = at;
+  pathApi[injected] = api;
+  injected++;
+}
+
+static void preempt(FAKE_Api api) {
+  uint64_t at = point++;
+  pid_t child;
+  int status;
+
+  if (remaining == 0) {
+    return;
+  }
+
+  fflush(NULL);
+  child = fork();
+  if (child == 0) {
+    take(at, api);
+    remaining--;
+    FAKE_callHook = NULL;
+    exploreConfig->isr();
+    FAKE_callHook = preempt;
+    return;
+  }
+
+  // A run that could not start or did not finish counts as a crash.
+  if (child < 0 || waitpid(child, &status, 0) != child || !WIFEXITED(status) ||
+      WEXITSTATUS(status) != 0) {
+    take(at, api);
+    shared->runs++;
+    shared->crashes++;
+    fail();
+    injected--;
+  }
+}
+
+static void explore(void) {
+  exploreConfig->setup();
+
+  FAKE_callHook = preempt;
+  for (uint32_t i = 0; i < exploreConfig->loops; i++) {
+    exploreConfig->loop();
+  }
+  FAKE_callHook = NULL;
+
+  for (uint32_t i = 0; i < exploreConfig->settleLoops; i++) {
+    exploreConfig->loop();
+  }
+
+  shared->runs++;
+  if (injected == 0) {
+    shared->points = point;
+  }
+  if (!exploreConfig->check()) {
+    fail();
+  }
+  fflush(NULL);
+  _exit(0);
+}
+
+// Returns the number of failing runs, crashes included.
+uint64_t EXPLORE_run(const EXPLORE_Config *config, EXPLORE_Result *result) {
+  pid_t child;
+  int status;
+
+  memset(result, 0, sizeof(*result));
+  shared = mmap(NULL, sizeof(*shared), PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared == MAP_FAILED) {
+    result->crashes = 1;
+    result->failures = 1;
+    return result->failures;
+  }
+  memset(shared, 0, sizeof(*shared));
+
+  exploreConfig = config;
+  point = 0;
+  injected = 0;
+  remaining = (config->depth < EXPLORE_DEPTH_MAX) ? config->depth
+                                                  : EXPLORE_DEPTH_MAX;
+
+  fflush(NULL);
+  child = fork();
+  if (child == 0) {
+    explore();
+  }
+  if (child < 0 || waitpid(child, &status, 0) != child || !WIFEXITED(status) ||
+      WEXITSTATUS(status) != 0) {
+    shared->runs++;
+    shared->crashes++;
+    fail();
+  }
+
+  *result = *shared;
+  munmap(shared, sizeof(*shared));
+  shared = NULL;
+  return result->failures;
+}
+
+uint32_t EXPLORE_injected(void) { return injected; }
+
+const char *EXPLORE_describe(const EXPLORE_Result *result) {
+  static char text[256];
+  int length;
+
+  if (result->failures == 0) {
+    snprintf(text, sizeof(text), "%llu runs over %llu points passed",
+             (unsigned long long)result->runs,
+             (unsigned long long)result->points);
+    return text;
+  }
+
+  length = snprintf(text, sizeof(text), "%llu of %llu runs failed",
+                    (unsigned long long)result->failures,
+                    (unsigned long long)result->runs);
+  if (result->crashes > 0) {
+    length += snprintf(text + length, sizeof(text) - length, " (%llu crashed)",
+                       (unsigned long long)result->crashes);
+  }
+  length += snprintf(text + length, sizeof(text) - length, ", first:%s",
+                     result->failedDepth ? "" : " no interrupt");
+  for (uint32_t i = 0; i < result->failedDepth && length < (int)sizeof(text);
+       i++) {
+    length += snprintf(text + length, sizeof(text) - length,
+                       "%s interrupt after call %llu (%s)", i ? "," : "",
+                       (unsigned long long)result->failedAt[i],
+                       FAKE_apiName(result->failedApi[i]));
+  }
+  return text;
+}
@@ -0,0 +1,67 @@
+#ifndef Explore_H__
+#define Explore_H__
+
+#include "fake.h"
+#include "vclock.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Systematic interrupt interleavings over the mock calls.
+//
+// Every call into the HAL or Arduino mocks made by loop() is a preemption
+// point. EXPLORE_run() runs setup() and then loop() for the given number of
+// passes, forks at each point, and lets the child take the interrupt there
+// while the parent carries on without it. Each child keeps forking at the
+// points after its own until it has taken depth interrupts, so every
+// placement of up to depth interrupts is tried exactly once. After the last
+// pass, loop() runs settleLoops more times without preemption, and check()
+// judges the final state; EXPLORE_injected() tells it how many interrupts
+// that run took.
+//
+// Forking is the snapshot: nothing is reset between runs, and a run that
+// crashes is counted as a failure. The whole exploration runs in a child
+// process, so it leaves the caller's state untouched. The interrupt is
+// taken right after the call's effect on the spies, its own mock calls are
+// not preemption points, and setup() is not preempted. The scenario must be
+// deterministic, so use the mocks' fast path and the virtual clock, and
+// check() must answer through its return value: a CppUTest assertion
+// failing in a forked run would carry on with the rest of the suite there.
+
+#define EXPLORE_DEPTH_MAX 4
+
+typedef int (*EXPLORE_Check)(void);
+
+typedef struct {
+  void (*setup)(void);
+  VCLOCK_Loop loop;
+  void (*isr)(void);
+  EXPLORE_Check check;
+  uint32_t loops;
+  uint32_t settleLoops;
+  uint32_t depth;
+} EXPLORE_Config;
+
+typedef struct {
+  uint64_t points;
+  uint64_t runs;
+  uint64_t failures;
+  uint64_t crashes;
+  // The first failing run: the point each interrupt was taken at, counted
+  // from the start of loop(), and the call it interrupted.
+  uint32_t failedDepth;
+  uint64_t failedAt[EXPLORE_DEPTH_MAX];
+  FAKE_Api failedApi[EXPLORE_DEPTH_MAX];
+} EXPLORE_Result;
+
+uint64_t EXPLORE_run(const EXPLORE_Config *config, EXPLORE_Result *result);
+uint32_t EXPLORE_injected(void);
+const char *EXPLORE_describe(const EXPLORE_Result *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Explore_H__ */
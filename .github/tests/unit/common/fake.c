@@ -0,0 +1,83 @@
+#include "fake.h"
+#include <stddef.h>
+#include <string.h>
+
+#ifdef MOCKS_FAST_ONLY
+int FAKE_enabled = 1;
+#else
+int FAKE_enabled = 0;
+#endif
+
+int FAKE_concurrent = 0;
+FAKE_Hook FAKE_callHook = NULL;
+FAKE_Call FAKE_callLog[FAKE_LOG_CAPACITY];
+uint64_t FAKE_callTotal = 0;
+uint64_t FAKE_callCounts[FAKE_API_COUNT];
+static uint64_t clearedCounts[FAKE_API_COUNT];
+
+static const char *const apiNames[FAKE_API_COUNT] = {
+    [FAKE_HAL_GetTick] = "HAL_GetTick",
+    [FAKE_HAL_Delay] = "HAL_Delay",
+    [FAKE_HAL_GPIO_TogglePin] = "HAL_GPIO_TogglePin",
+    [FAKE_HAL_GPIO_ReadPin] = "HAL_GPIO_ReadPin",
+    [FAKE_HAL_GPIO_WritePin] = "HAL_GPIO_WritePin",
+    [FAKE_HAL_SuspendTick] = "HAL_SuspendTick",
+    [FAKE_HAL_ResumeTick] = "HAL_ResumeTick",
+    [FAKE_HAL_PWR_EnterSTOPMode] = "HAL_PWR_EnterSTOPMode",
+    [FAKE_HAL_TIM_Base_Start_IT] = "HAL_TIM_Base_Start_IT",
+    [FAKE_HAL_TIM_Base_Stop_IT] = "HAL_TIM_Base_Stop_IT",
+    [FAKE_HAL_TIM_Base_Start] = "HAL_TIM_Base_Start",
+    [FAKE_HAL_TIM_Base_Stop] = "HAL_TIM_Base_Stop",
+    [FAKE_HAL_DMA_Start] = "HAL_DMA_Start",
+    [FAKE_HAL_DMA_Abort] = "HAL_DMA_Abort",
+    [FAKE_HAL_UART_Transmit] = "HAL_UART_Transmit",
+    [FAKE_HAL_UART_Transmit_DMA] = "HAL_UART_Transmit_DMA",
+    [FAKE_millis] = "millis",
+    [FAKE_delay] = "delay",
+    [FAKE_pinMode] = "pinMode",
+    [FAKE_digitalWrite] = "digitalWrite",
+    [FAKE_digitalRead] = "digitalRead",
+    [FAKE_attachInterrupt] = "attachInterrupt",
+    [FAKE_detachInterrupt] = "detachInterrupt",
+    [FAKE_digitalPinToInterrupt] = "digitalPinToInterrupt",
+};
+
+void FAKE_setEnabled(int enabled) {
+#ifndef MOCKS_FAST_ONLY
+  FAKE_enabled = enabled;
+#endif
+}
+
+void FAKE_clear(void) {
+  for (int api = 0; api < FAKE_API_COUNT; api++) {
+    clearedCounts[api] += FAKE_callCounts[api];
+  }
+  FAKE_callTotal = 0;
+  memset(FAKE_callCounts, 0, sizeof(FAKE_callCounts));
+}
+
+uint32_t FAKE_logSize(void) {
+  return (FAKE_callTotal < FAKE_LOG_CAPACITY) ? (uint32_t)FAKE_callTotal
+                                              : FAKE_LOG_CAPACITY;
+}
+
+// Index 0 is the oldest call still held in the log.
+const FAKE_Call *FAKE_logAt(uint32_t index) {
+  uint64_t first = FAKE_callTotal - FAKE_logSize();
+
+  if (index >= FAKE_logSize()) {
+    return NULL;
+  }
+
+  return &FAKE_callLog[(first + index) & (FAKE_LOG_CAPACITY - 1)];
+}
+
+uint64_t FAKE_callCount(FAKE_Api api) { return FAKE_callCounts[api]; }
+
+uint64_t FAKE_lifetimeCount(FAKE_Api api) {
+  return clearedCounts[api] + FAKE_callCounts[api];
+}
+
+const char *FAKE_apiName(FAKE_Api api) {
+  return (api < FAKE_API_COUNT) ? apiNames[api] : "unknown";
+}
@@ -0,0 +1,109 @@
+#ifndef Fake_H__
+#define Fake_H__
+
+#include "vclock.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Fast path for the HAL and Arduino mocks.
+//
+// With FAKE_setEnabled(1) the mocks skip CppUMock entirely: time comes from
+// the virtual clock, pin state from the spies, and every call is appended to
+// a preallocated in-memory log instead. Building with -DMOCKS_FAST_ONLY
+// compiles the CppUMock path out altogether, so benchmark and fuzz targets
+// do not link CppUTest at all.
+//
+// While FAKE_concurrent is set, as it is for the duration of PREEMPT_run(),
+// the mocks are called from two threads at once: the counters are then
+// bumped atomically and the log is not written, so only FAKE_callCount()
+// stays meaningful.
+//
+// FAKE_callHook, when set, runs at the end of every call the log records;
+// EXPLORE_run() uses it to make each mock call a preemption point.
+
+typedef enum {
+  FAKE_HAL_GetTick = 0,
+  FAKE_HAL_Delay,
+  FAKE_HAL_GPIO_TogglePin,
+  FAKE_HAL_GPIO_ReadPin,
+  FAKE_HAL_GPIO_WritePin,
+  FAKE_HAL_SuspendTick,
+  FAKE_HAL_ResumeTick,
+  FAKE_HAL_PWR_EnterSTOPMode,
+  FAKE_HAL_TIM_Base_Start_IT,
+  FAKE_HAL_TIM_Base_Stop_IT,
+  FAKE_HAL_TIM_Base_Start,
+  FAKE_HAL_TIM_Base_Stop,
+  FAKE_HAL_DMA_Start,
+  FAKE_HAL_DMA_Abort,
+  FAKE_HAL_UART_Transmit,
+  FAKE_HAL_UART_Transmit_DMA,
+  FAKE_millis,
+  FAKE_delay,
+  FAKE_pinMode,
+  FAKE_digitalWrite,
+  FAKE_digitalRead,
+  FAKE_attachInterrupt,
+  FAKE_detachInterrupt,
+  FAKE_digitalPinToInterrupt,
+  FAKE_API_COUNT
+} FAKE_Api;
+
+typedef struct {
+  uint32_t tick;
+  FAKE_Api api;
+  uintptr_t args[3];
+} FAKE_Call;
+
+// Must be a power of two; the log keeps the most recent entries.
+#define FAKE_LOG_CAPACITY 4096
+
+typedef void (*FAKE_Hook)(FAKE_Api api);
+
+extern int FAKE_enabled;
+extern int FAKE_concurrent;
+extern FAKE_Hook FAKE_callHook;
+extern FAKE_Call FAKE_callLog[FAKE_LOG_CAPACITY];
+extern uint64_t FAKE_callTotal;
+extern uint64_t FAKE_callCounts[FAKE_API_COUNT];
+
+void FAKE_setEnabled(int enabled);
+void FAKE_clear(void);
+uint32_t FAKE_logSize(void);
+const FAKE_Call *FAKE_logAt(uint32_t index);
+uint64_t FAKE_callCount(FAKE_Api api);
+// Calls since the program started, across FAKE_clear().
+uint64_t FAKE_lifetimeCount(FAKE_Api api);
+const char *FAKE_apiName(FAKE_Api api);
+
+static inline void FAKE_log(FAKE_Api api, uintptr_t arg0, uintptr_t arg1,
+                            uintptr_t arg2) {
+  if (FAKE_concurrent) {
+    __atomic_fetch_add(&FAKE_callTotal, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&FAKE_callCounts[api], 1, __ATOMIC_RELAXED);
+    return;
+  }
+
+  FAKE_Call *call = &FAKE_callLog[FAKE_callTotal & (FAKE_LOG_CAPACITY - 1)];
+
+  call->tick = VCLOCK_now();
+  call->api = api;
+  call->args[0] = arg0;
+  call->args[1] = arg1;
+  call->args[2] = arg2;
+  FAKE_callTotal++;
+  FAKE_callCounts[api]++;
+  if (__builtin_expect(FAKE_callHook != NULL, 0)) {
+    FAKE_callHook(api);
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Fake_H__ */
@@ -0,0 +1,149 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "preempt.h"
+#include "fake.h"
+#include <pthread.h>
+#include <sched.h>
+#include <string.h>
+#include <time.h>
+
+// Gaps longer than this are mostly slept through; the rest is yielded away
+// so that, on a single core, loop() still runs between events.
+#define SLEEP_SLACK_NS 20000ULL
+
+typedef struct {
+  PREEMPT_Isr isr;
+  uint64_t events;
+  uint64_t periodNs;
+  int done;
+} PREEMPT_Firing;
+
+static uint64_t nowNs(void) {
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+static void waitUntil(uint64_t deadline) {
+  for (;;) {
+    uint64_t now = nowNs();
+
+    if (now >= deadline) {
+      return;
+    }
+    if (deadline - now > SLEEP_SLACK_NS) {
+      uint64_t gap = deadline - now - SLEEP_SLACK_NS;
+      struct timespec sleep = {(time_t)(gap / 1000000000ULL),
+                               (long)(gap % 1000000000ULL)};
+
+      nanosleep(&sleep, NULL);
+    } else {
+      sched_yield();
+    }
+  }
+}
+
+// Events are paced against absolute deadlines, so a late wake-up is made up
+// by the following events instead of lowering the rate.
+static void *fire(void *context) {
+  PREEMPT_Firing *firing = context;
+  uint64_t next = nowNs();
+
+  for (uint64_t i = 0; i < firing->events; i++) {
+    if (firing->periodNs > 0) {
+      next += firing->periodNs;
+      waitUntil(next);
+    }
+    firing->isr();
+  }
+  __atomic_store_n(&firing->done, 1, __ATOMIC_RELEASE);
+
+  return NULL;
+}
+
+PREEMPT_Verdict PREEMPT_run(const PREEMPT_Config *config, double rateHz,
+                            PREEMPT_Result *result) {
+  PREEMPT_Firing firing = {config->isr, config->events, 0, 0};
+  pthread_t thread;
+  uint64_t start;
+
+  memset(result, 0, sizeof(*result));
+  result->rateHz = rateHz;
+  if (rateHz > 0) {
+    firing.periodNs = (uint64_t)(1e9 / rateHz);
+  }
+  if (config->reset != NULL) {
+    config->reset();
+  }
+
+  // Set before the thread starts and cleared after it is joined, so both
+  // threads see the same value throughout the run.
+  FAKE_concurrent = 1;
+  start = nowNs();
+  if (pthread_create(&thread, NULL, fire, &firing) != 0) {
+    FAKE_concurrent = 0;
+    result->verdict = PREEMPT_ERROR;
+    return result->verdict;
+  }
+
+  while (!__atomic_load_n(&firing.done, __ATOMIC_ACQUIRE)) {
+    config->loop();
+    result->loops++;
+  }
+
+  uint64_t elapsed = nowNs() - start;
+
+  pthread_join(thread, NULL);
+  FAKE_concurrent = 0;
+
+  for (uint32_t i = 0; i < config->settleLoops; i++) {
+    config->loop();
+    result->loops++;
+  }
+
+  result->fired = config->events;
+  result->achievedHz =
+      (elapsed > 0) ? (double)config->events * 1e9 / (double)elapsed : 0;
+  result->verdict = config->check(config->events);
+  return result->verdict;
+}
+
+// Returns 1 once a run fails. sustained holds the last run that passed and
+// is all zeroes when fromHz already failed.
+int PREEMPT_sweep(const PREEMPT_Config *config, double fromHz, double toHz,
+                  PREEMPT_Result *sustained, PREEMPT_Result *failed) {
+  PREEMPT_Result result;
+
+  memset(sustained, 0, sizeof(*sustained));
+  memset(failed, 0, sizeof(*failed));
+
+  for (double rate = fromHz;; rate *= 2) {
+    if (rate > toHz) {
+      rate = 0;
+    }
+    if (PREEMPT_run(config, rate, &result) != PREEMPT_OK) {
+      *failed = result;
+      return 1;
+    }
+    *sustained = result;
+    if (rate <= 0) {
+      return 0;
+    }
+  }
+}
+
+const char *PREEMPT_describe(PREEMPT_Verdict verdict) {
+  switch (verdict) {
+  case PREEMPT_OK:
+    return "ok";
+  case PREEMPT_LOST:
+    return "lost events";
+  case PREEMPT_CORRUPT:
+    return "corrupted state";
+  case PREEMPT_ERROR:
+    return "harness error";
+  default:
+    return "unknown";
+  }
+}
@@ -0,0 +1,64 @@
+#ifndef Preempt_H__
+#define Preempt_H__
+
+#include "vclock.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Runs an interrupt handler concurrently with loop().
+//
+// PREEMPT_run() calls loop() on the calling thread while a second thread
+// fires isr() the given number of times at rateHz (0 fires back to back),
+// so the handler lands at arbitrary points inside loop() the way a real
+// interrupt does, rather than only between iterations as under the virtual
+// clock. Once the last event has fired, loop() runs settleLoops more times
+// and check() decides whether every event was accounted for.
+//
+// PREEMPT_sweep() doubles the rate from fromHz up to toHz and then fires
+// back to back, and reports the fastest run that passed and the first one
+// that failed. The mocks must be on their fast path: the fake log only
+// counts calls while a run is in progress, and CppUMock is not thread-safe.
+// Build the suite with SANITIZE=thread to have ThreadSanitizer check the
+// shared state as well.
+
+typedef enum {
+  PREEMPT_OK = 0,
+  PREEMPT_LOST,
+  PREEMPT_CORRUPT,
+  PREEMPT_ERROR
+} PREEMPT_Verdict;
+
+typedef void (*PREEMPT_Isr)(void);
+typedef PREEMPT_Verdict (*PREEMPT_Check)(uint64_t fired);
+
+typedef struct {
+  void (*reset)(void);
+  VCLOCK_Loop loop;
+  PREEMPT_Isr isr;
+  PREEMPT_Check check;
+  uint64_t events;
+  uint32_t settleLoops;
+} PREEMPT_Config;
+
+typedef struct {
+  double rateHz;
+  double achievedHz;
+  uint64_t fired;
+  uint64_t loops;
+  PREEMPT_Verdict verdict;
+} PREEMPT_Result;
+
+PREEMPT_Verdict PREEMPT_run(const PREEMPT_Config *config, double rateHz,
+                            PREEMPT_Result *result);
+int PREEMPT_sweep(const PREEMPT_Config *config, double fromHz, double toHz,
+                  PREEMPT_Result *sustained, PREEMPT_Result *failed);
+const char *PREEMPT_describe(PREEMPT_Verdict verdict);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Preempt_H__ */
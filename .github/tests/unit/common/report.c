@@ -0,0 +1,33 @@
+#include "report.h"
+#include <string.h>
+
+static const char *names[REPORT_VALUES_MAX];
+static double values[REPORT_VALUES_MAX];
+static uint32_t count;
+
+void REPORT_clear(void) { count = 0; }
+
+void REPORT_value(const char *name, double value) {
+  for (uint32_t i = 0; i < count; i++) {
+    if (strcmp(names[i], name) == 0) {
+      values[i] = value;
+      return;
+    }
+  }
+  if (count < REPORT_VALUES_MAX) {
+    names[count] = name;
+    values[count] = value;
+    count++;
+  }
+}
+
+uint32_t REPORT_count(void) { return count; }
+
+void REPORT_writeJson(FILE *out, const char *group, const char *name) {
+  fprintf(out, "{\"group\": \"%s\", \"test\": \"%s\", \"values\": {", group,
+          name);
+  for (uint32_t i = 0; i < count; i++) {
+    fprintf(out, "%s\"%s\": %.10g", i ? ", " : "", names[i], values[i]);
+  }
+  fprintf(out, "}}\n");
+}
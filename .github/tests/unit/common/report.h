@@ -0,0 +1,33 @@
+#ifndef Report_H__
+#define Report_H__
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Figures a test measures but cannot assert on, such as host timings or
+// the rate a sweep settles at. REPORT_value() records one under a name for
+// the running test; ReportPlugin clears them before every test and, when
+// the REPORT_JSON environment variable names a file, writes one
+// REPORT_writeJson() line for each test that recorded any. Without the
+// variable nothing is printed, so the runner's output stays CppUTest's own.
+//
+// A test records at most REPORT_VALUES_MAX figures; recording a name again
+// replaces its value, and further names are dropped. Names are not copied
+// and must outlive the test, as string literals do.
+
+#define REPORT_VALUES_MAX 16
+
+void REPORT_clear(void);
+void REPORT_value(const char *name, double value);
+uint32_t REPORT_count(void);
+void REPORT_writeJson(FILE *out, const char *group, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Report_H__ */
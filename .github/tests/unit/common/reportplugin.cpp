@@ -0,0 +1,32 @@
+#include "reportplugin.h"
+#include <stdlib.h>
+
+extern "C" {
+#include "report.h"
+}
+
+ReportPlugin::ReportPlugin() : TestPlugin("ReportPlugin"), out(NULL) {
+  const char *path = getenv("REPORT_JSON");
+
+  if (path != NULL && path[0] != '\0') {
+    out = fopen(path, "w");
+  }
+}
+
+ReportPlugin::~ReportPlugin() {
+  if (out != NULL) {
+    fclose(out);
+  }
+}
+
+void ReportPlugin::preTestAction(UtestShell &test, TestResult &result) {
+  REPORT_clear();
+}
+
+void ReportPlugin::postTestAction(UtestShell &test, TestResult &result) {
+  if (out == NULL || REPORT_count() == 0) {
+    return;
+  }
+  REPORT_writeJson(out, test.getGroup().asCharString(),
+                   test.getName().asCharString());
+}
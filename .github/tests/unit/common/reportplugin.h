@@ -0,0 +1,25 @@
+#ifndef ReportPlugin_H__
+#define ReportPlugin_H__
+
+#include "CppUTest/TestPlugin.h"
+#include <stdio.h>
+
+// Writes the figures each test records with REPORT_value() to the file
+// named by the REPORT_JSON environment variable, one REPORT_writeJson()
+// line per test that recorded any. The file is truncated when the runner
+// starts; without the variable the figures are dropped. Install it in
+// all_tests.cpp.
+
+class ReportPlugin : public TestPlugin {
+public:
+  ReportPlugin();
+  virtual ~ReportPlugin();
+
+  virtual void preTestAction(UtestShell &test, TestResult &result);
+  virtual void postTestAction(UtestShell &test, TestResult &result);
+
+private:
+  FILE *out;
+};
+
+#endif /* ReportPlugin_H__ */
@@ -0,0 +1,174 @@
+#define _DEFAULT_SOURCE
+
+#include "soak.h"
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+static const SOAK_Config *soakConfig;
+static SOAK_Result *soakResult;
+static int level;
+static uint64_t lastEdge;
+static uint64_t searchFrom;
+
+static void fail(SOAK_Violation violation, uint64_t now, uint64_t interval) {
+  soakResult->violation = violation;
+  soakResult->violationAt = now;
+  soakResult->interval = interval;
+}
+
+static uint64_t nextWake(uint64_t now) {
+  uint64_t period = soakConfig->periodMs;
+  uint64_t tolerance = soakConfig->toleranceMs;
+
+  // Until the first edge, look every tick.
+  if (lastEdge == VCLOCK_NEVER) {
+    if (now - searchFrom > period + tolerance) {
+      fail(SOAK_LATE, now, now - searchFrom);
+    }
+    return now + 1;
+  }
+
+  uint64_t due = lastEdge + period;
+
+  if (now >= due + tolerance) {
+    fail(SOAK_LATE, now, now - lastEdge);
+  }
+
+  uint64_t wake = now + 1;
+
+  if (due > tolerance + 1 && wake < due - tolerance - 1) {
+    wake = due - tolerance - 1;
+  }
+
+  // Run every tick from a window before each wrap to a window after it, so
+  // that code misbehaving only close to the wrap is caught too.
+  uint64_t window = 2 * (period + tolerance);
+  uint64_t epoch = now & ~0xFFFFFFFFULL;
+  uint64_t nextWrap = epoch + 0x100000000ULL;
+
+  if ((epoch > 0 && now < epoch + window) || now + 1 >= nextWrap - window) {
+    return now + 1;
+  }
+  if (wake > nextWrap - window) {
+    wake = nextWrap - window;
+  }
+  return wake;
+}
+
+static void soakLoop(void) {
+  soakConfig->loop();
+
+  uint64_t now = VCLOCK_now64();
+  int current = soakConfig->probe() != 0;
+
+  soakResult->iterations++;
+  if (current != level) {
+    level = current;
+    soakResult->edges++;
+    if (lastEdge != VCLOCK_NEVER &&
+        now - lastEdge + soakConfig->toleranceMs < soakConfig->periodMs) {
+      fail(SOAK_EARLY, now, now - lastEdge);
+    }
+    lastEdge = now;
+  }
+  if (soakConfig->check != NULL && !soakConfig->check()) {
+    fail(SOAK_BROKEN, now, 0);
+  }
+
+  // Deadlines are 32-bit ticks, resolved forward from now. After a
+  // violation the clock only moves on by one tick, so it stops right there.
+  if (soakResult->violation == SOAK_OK) {
+    VCLOCK_requestDeadline((uint32_t)nextWake(now));
+  } else {
+    VCLOCK_requestDeadline((uint32_t)(now + 1));
+  }
+}
+
+SOAK_Violation SOAK_run(const SOAK_Config *config, SOAK_Result *result) {
+  uint64_t start;
+  uint64_t end;
+
+  if (config->prepare != NULL) {
+    config->prepare();
+  }
+  start = VCLOCK_now64();
+  end = start + ((uint64_t)config->wraps << 32);
+  memset(result, 0, sizeof(*result));
+  result->violationAt = VCLOCK_NEVER;
+  soakConfig = config;
+  soakResult = result;
+  level = config->probe() != 0;
+  lastEdge = VCLOCK_NEVER;
+  searchFrom = start;
+
+  while (result->violation == SOAK_OK && VCLOCK_step(soakLoop, end, 0)) {
+  }
+
+  uint64_t stop = result->violation == SOAK_OK ? VCLOCK_now64()
+                                               : result->violationAt;
+
+  result->wraps = (uint32_t)((stop >> 32) - (start >> 32));
+  if (result->violation == SOAK_OK && config->finish != NULL &&
+      !config->finish()) {
+    fail(SOAK_BROKEN, VCLOCK_now64(), 0);
+  }
+  return result->violation;
+}
+
+// The child hands its result back through shared memory, as in explore.c.
+SOAK_Violation SOAK_runIsolated(const SOAK_Config *config,
+                                SOAK_Result *result) {
+  SOAK_Result *shared;
+  pid_t child;
+  int status;
+
+  memset(result, 0, sizeof(*result));
+  result->violation = SOAK_CRASHED;
+  result->violationAt = VCLOCK_now64();
+  shared = mmap(NULL, sizeof(*shared), PROT_READ | PROT_WRITE,
+                MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (shared == MAP_FAILED) {
+    return result->violation;
+  }
+  *shared = *result;
+
+  fflush(NULL);
+  child = fork();
+  if (child == 0) {
+    SOAK_run(config, shared);
+    fflush(NULL);
+    _exit(0);
+  }
+  if (child > 0 && waitpid(child, &status, 0) == child && WIFEXITED(status) &&
+      WEXITSTATUS(status) == 0) {
+    *result = *shared;
+  }
+  munmap(shared, sizeof(*shared));
+  return result->violation;
+}
+
+const char *SOAK_describe(const SOAK_Result *result) {
+  static const char *names[] = {"ok", "early edge", "late edge",
+                                "broken invariant", "crashed"};
+  static char text[160];
+
+  if (result->violation == SOAK_OK) {
+    snprintf(text, sizeof(text), "%llu edges in %llu iterations, %u wraps",
+             (unsigned long long)result->edges,
+             (unsigned long long)result->iterations, result->wraps);
+    return text;
+  }
+  snprintf(text, sizeof(text),
+           "%s at tick %llu (wrap %llu, +%llu ms since the last edge), "
+           "%llu edges in %llu iterations",
+           names[result->violation],
+           (unsigned long long)(result->violationAt & 0xFFFFFFFFULL),
+           (unsigned long long)(result->violationAt >> 32),
+           (unsigned long long)result->interval,
+           (unsigned long long)result->edges,
+           (unsigned long long)result->iterations);
+  return text;
+}
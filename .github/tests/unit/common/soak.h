@@ -0,0 +1,84 @@
+#ifndef Soak_H__
+#define Soak_H__
+
+#include "vclock.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Fast-forward soak runs across 32-bit tick wraps.
+//
+// SOAK_run() calls loop() on the virtual clock for the given number of
+// 2^32 ms wraps and checks that the LED keeps toggling every periodMs,
+// within toleranceMs. Instead of stepping every millisecond it asks the
+// clock for a wake-up just before each edge is due and then steps one
+// tick at a time until the edge shows up, so a blinking loop costs about
+// two iterations per edge and several wraps finish in seconds. Deadlines
+// the firmware reports itself and scheduled stimuli still take effect.
+//
+// The run stops at the first violation: an edge earlier or later than
+// expected, no edge within the first period, or a failed check(). Since the
+// LED is only sampled right before an edge is due, an early edge is
+// reported as one tick early whatever its real lead, and two edges between
+// samples cancel out. Use the mocks' fast path, or every loop() goes
+// through CppUMock.
+//
+// prepare(), if set, runs first, to put the firmware in the state to
+// soak. finish(), if set, runs once after a clean soak; returning 0 counts
+// as a broken invariant, so the firmware can be checked right after the
+// wraps.
+//
+// SOAK_runIsolated() does the same in a forked child, so the firmware's
+// globals and statics are left as they were before the soak, whatever
+// prepare() and three wraps did to them. A child that crashes is reported
+// as such.
+//
+// millis() returns unsigned long, which is 64 bits on the host. A sketch
+// that keeps timestamps in unsigned long therefore sees a jump of 2^32 at
+// the wrap instead of modular arithmetic, so soak the Arduino sketches in
+// a 32-bit build, as ../../soak does, or code that stores ticks in
+// uint32_t; STM32Cube code is not affected.
+
+typedef int (*SOAK_Probe)(void);
+typedef void (*SOAK_Action)(void);
+
+typedef enum {
+  SOAK_OK = 0,
+  SOAK_EARLY,
+  SOAK_LATE,
+  SOAK_BROKEN,
+  SOAK_CRASHED
+} SOAK_Violation;
+
+typedef struct {
+  VCLOCK_Loop loop;
+  SOAK_Probe probe;
+  SOAK_Probe check;
+  uint32_t periodMs;
+  uint32_t toleranceMs;
+  uint32_t wraps;
+  SOAK_Action prepare;
+  SOAK_Probe finish;
+} SOAK_Config;
+
+typedef struct {
+  uint64_t iterations;
+  uint64_t edges;
+  uint32_t wraps;
+  SOAK_Violation violation;
+  uint64_t violationAt;
+  uint64_t interval;
+} SOAK_Result;
+
+SOAK_Violation SOAK_run(const SOAK_Config *config, SOAK_Result *result);
+SOAK_Violation SOAK_runIsolated(const SOAK_Config *config,
+                                SOAK_Result *result);
+const char *SOAK_describe(const SOAK_Result *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Soak_H__ */
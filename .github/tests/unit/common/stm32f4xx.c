@@ -0,0 +1,80 @@
+#include "stm32f4xx.h"
+#include "energy.h"
+#include "vclock.h"
+#include <string.h>
+
+uint32_t SystemCoreClock = 84000000UL;
+CoreDebug_Type SPY_CoreDebug;
+// HAL_Init() leaves SysTick running with its interrupt enabled.
+SysTick_Type SPY_SysTick = {SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_TICKINT_Msk,
+                            0, 0, 0};
+uint32_t SPY_PRIMASK = 0;
+EXTI_TypeDef SPY_EXTI;
+
+static DWT_Type dwt;
+static uint64_t syncedAt = 0;
+static uint32_t pendingCycles = 0;
+static uint32_t wfiCount = 0;
+static uint32_t wfiHangs = 0;
+static uint64_t sleptMs = 0;
+
+DWT_Type *SPY_DWT_sync(void) {
+  uint64_t now = VCLOCK_now64();
+
+  // Tests may set the tick count backwards; the counter just holds then.
+  if ((SPY_CoreDebug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk) &&
+      (dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk) && now >= syncedAt) {
+    // 32-bit wrap-around is the hardware's too.
+    dwt.CYCCNT += (uint32_t)((now - syncedAt) * (SystemCoreClock / 1000U)) +
+                  pendingCycles;
+  }
+  syncedAt = now;
+  pendingCycles = 0;
+  return &dwt;
+}
+
+void SPY_DWT_addCycles(uint32_t cycles) { pendingCycles += cycles; }
+
+void SPY_DWT_reset(void) {
+  memset(&dwt, 0, sizeof(dwt));
+  memset(&SPY_CoreDebug, 0, sizeof(SPY_CoreDebug));
+  syncedAt = VCLOCK_now64();
+  pendingCycles = 0;
+}
+
+// An interrupt pending while PRIMASK is set still wakes the core, so the
+// wake-up instant does not depend on PRIMASK.
+void SPY_WFI(void) {
+  const uint32_t tick = SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_TICKINT_Msk;
+  uint64_t now = VCLOCK_now64();
+  uint64_t wake = VCLOCK_nextEvent();
+
+  if ((SPY_SysTick.CTRL & tick) == tick && now + 1 < wake) {
+    wake = now + 1;
+  }
+
+  wfiCount++;
+  if (wake == VCLOCK_NEVER) {
+    wfiHangs++;
+    return;
+  }
+  if (wake > now) {
+    sleptMs += wake - now;
+    ENERGY_rest(wake - now);
+    VCLOCK_advanceTo(wake);
+  }
+}
+
+void SPY_WFI_reset(void) {
+  SPY_SysTick.CTRL = SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_TICKINT_Msk;
+  SPY_PRIMASK = 0;
+  wfiCount = 0;
+  wfiHangs = 0;
+  sleptMs = 0;
+}
+
+uint32_t SPY_WFI_count(void) { return wfiCount; }
+
+uint32_t SPY_WFI_hangs(void) { return wfiHangs; }
+
+uint64_t SPY_WFI_sleptMs(void) { return sleptMs; }
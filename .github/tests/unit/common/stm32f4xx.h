@@ -0,0 +1,107 @@
+#ifndef Stm32f4xx_H__
+#define Stm32f4xx_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Stand-in for the CMSIS device header shared by STM32Cube and STM32duino.
+//
+// Only the core peripherals the labs' libraries touch are emulated. DWT is
+// reached through SPY_DWT_sync(), which brings CYCCNT up to date with the
+// virtual clock at SystemCoreClock before handing out the registers, so
+// cycle counts measured around mock calls follow simulated time. Code that
+// takes zero virtual time can be given a cost with SPY_DWT_addCycles().
+//
+// __WFI() sleeps on the virtual clock: it jumps to the next scheduled event
+// or, while the SysTick interrupt is enabled, to the next tick, and counts
+// the time spent asleep. With neither, the core would never wake up; the
+// mock counts that as a hang and returns at once.
+//
+// EXTI is a plain register file. PR is write-one-to-clear on the real
+// peripheral, which a struct cannot express, so clear it through
+// __HAL_GPIO_EXTI_CLEAR_IT() rather than by assigning EXTI->PR directly.
+
+typedef struct {
+  volatile uint32_t CTRL;
+  volatile uint32_t CYCCNT;
+  volatile uint32_t CPICNT;
+  volatile uint32_t EXCCNT;
+  volatile uint32_t SLEEPCNT;
+  volatile uint32_t LSUCNT;
+  volatile uint32_t FOLDCNT;
+  volatile uint32_t PCSR;
+} DWT_Type;
+
+typedef struct {
+  volatile uint32_t DHCSR;
+  volatile uint32_t DCRSR;
+  volatile uint32_t DCRDR;
+  volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+typedef struct {
+  volatile uint32_t CTRL;
+  volatile uint32_t LOAD;
+  volatile uint32_t VAL;
+  volatile uint32_t CALIB;
+} SysTick_Type;
+
+typedef struct {
+  volatile uint32_t IMR;
+  volatile uint32_t EMR;
+  volatile uint32_t RTSR;
+  volatile uint32_t FTSR;
+  volatile uint32_t SWIER;
+  volatile uint32_t PR;
+} EXTI_TypeDef;
+
+#define SysTick_CTRL_ENABLE_Pos 0U
+#define SysTick_CTRL_ENABLE_Msk (1UL << SysTick_CTRL_ENABLE_Pos)
+#define SysTick_CTRL_TICKINT_Pos 1U
+#define SysTick_CTRL_TICKINT_Msk (1UL << SysTick_CTRL_TICKINT_Pos)
+#define DWT_CTRL_CYCCNTENA_Pos 0U
+#define DWT_CTRL_CYCCNTENA_Msk (1UL << DWT_CTRL_CYCCNTENA_Pos)
+#define CoreDebug_DEMCR_TRCENA_Pos 24U
+#define CoreDebug_DEMCR_TRCENA_Msk (1UL << CoreDebug_DEMCR_TRCENA_Pos)
+
+extern uint32_t SystemCoreClock;
+extern CoreDebug_Type SPY_CoreDebug;
+extern SysTick_Type SPY_SysTick;
+extern uint32_t SPY_PRIMASK;
+extern EXTI_TypeDef SPY_EXTI;
+
+#define DWT (SPY_DWT_sync())
+#define CoreDebug (&SPY_CoreDebug)
+#define SysTick (&SPY_SysTick)
+#define EXTI (&SPY_EXTI)
+
+#define __WFI() SPY_WFI()
+#define __disable_irq() (SPY_PRIMASK = 1U)
+#define __enable_irq() (SPY_PRIMASK = 0U)
+
+static inline uint32_t __get_PRIMASK(void) { return SPY_PRIMASK; }
+static inline void __set_PRIMASK(uint32_t priMask) { SPY_PRIMASK = priMask; }
+
+// CLZ of 0 is 32 on the core, where __builtin_clz() is undefined.
+static inline uint8_t __CLZ(uint32_t value) {
+  return value ? (uint8_t)__builtin_clz(value) : 32U;
+}
+
+DWT_Type *SPY_DWT_sync(void);
+void SPY_DWT_addCycles(uint32_t cycles);
+void SPY_DWT_reset(void);
+
+void SPY_WFI(void);
+void SPY_WFI_reset(void);
+uint32_t SPY_WFI_count(void);
+uint32_t SPY_WFI_hangs(void);
+uint64_t SPY_WFI_sleptMs(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Stm32f4xx_H__ */
@@ -0,0 +1,179 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "trace.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+int TRACE_recording = 0;
+
+static FILE *traceFile = NULL;
+static TRACE_Record buffer[TRACE_BUFFER_RECORDS];
+static size_t buffered = 0;
+
+static void flush(void) {
+  if (buffered > 0) {
+    fwrite(buffer, sizeof(TRACE_Record), buffered, traceFile);
+    buffered = 0;
+  }
+}
+
+// Opens path for a new trace, replacing any earlier one, under a header
+// stamped with the current virtual time. Appending would leave a second
+// run's records, from a clock that started over, after the first run's.
+int TRACE_open(const char *path) {
+  TRACE_Header header = {TRACE_MAGIC, TRACE_VERSION, sizeof(TRACE_Record),
+                         VCLOCK_now64()};
+
+  TRACE_close();
+
+  traceFile = fopen(path, "wb");
+  if (traceFile == NULL) {
+    return -1;
+  }
+  if (fwrite(&header, sizeof(header), 1, traceFile) != 1) {
+    fclose(traceFile);
+    traceFile = NULL;
+    return -1;
+  }
+
+  TRACE_recording = 1;
+  return 0;
+}
+
+void TRACE_close(void) {
+  if (traceFile != NULL) {
+    flush();
+    fclose(traceFile);
+    traceFile = NULL;
+  }
+  TRACE_recording = 0;
+}
+
+void TRACE_record(TRACE_Kind kind, uint16_t port, uint16_t pins,
+                  uint16_t levels) {
+  if (!TRACE_recording) {
+    return;
+  }
+
+  TRACE_Record *record = &buffer[buffered++];
+
+  record->tick = VCLOCK_now64();
+  record->port = port;
+  record->pins = pins;
+  record->levels = levels;
+  record->kind = (uint8_t)kind;
+  record->reserved = 0;
+
+  if (buffered == TRACE_BUFFER_RECORDS) {
+    flush();
+  }
+}
+
+int TRACE_map(TRACE_Reader *reader, const char *path) {
+  struct stat info;
+  int fd = open(path, O_RDONLY);
+
+  memset(reader, 0, sizeof(*reader));
+  if (fd < 0) {
+    return -1;
+  }
+  if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(TRACE_Header)) {
+    close(fd);
+    return -1;
+  }
+
+  void *map = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) {
+    return -1;
+  }
+
+  const TRACE_Header *header = (const TRACE_Header *)map;
+  if (header->magic != TRACE_MAGIC || header->version != TRACE_VERSION ||
+      header->recordSize != sizeof(TRACE_Record)) {
+    munmap(map, (size_t)info.st_size);
+    return -1;
+  }
+
+  reader->header = header;
+  reader->records = (const TRACE_Record *)(header + 1);
+  reader->count =
+      ((size_t)info.st_size - sizeof(TRACE_Header)) / sizeof(TRACE_Record);
+  reader->map = map;
+  reader->mapSize = (size_t)info.st_size;
+  return 0;
+}
+
+void TRACE_unmap(TRACE_Reader *reader) {
+  if (reader->map != NULL) {
+    munmap(reader->map, reader->mapSize);
+  }
+  memset(reader, 0, sizeof(*reader));
+}
+
+// Replays the stimulus records of a trace starting at the current virtual
+// time, running loop() in between; output records are skipped. Returns the
+// number of loop() iterations.
+uint64_t TRACE_replay(const TRACE_Reader *reader, VCLOCK_Loop loop,
+                      TRACE_Stimulus stimulus, uint32_t maxStep) {
+  const uint64_t origin = VCLOCK_now64();
+  uint64_t iterations = 0;
+
+  for (size_t i = 0; i < reader->count; i++) {
+    const TRACE_Record *record = &reader->records[i];
+
+    if (record->kind == TRACE_OUTPUT) {
+      continue;
+    }
+
+    uint64_t at = origin + (record->tick - reader->header->startTick);
+
+    while (VCLOCK_step(loop, at, maxStep)) {
+      iterations++;
+    }
+    VCLOCK_advanceTo(at);
+    stimulus(record);
+  }
+
+  return iterations;
+}
+
+static size_t nextOutput(const TRACE_Reader *reader, size_t i) {
+  while (i < reader->count && reader->records[i].kind != TRACE_OUTPUT) {
+    i++;
+  }
+  return i;
+}
+
+// Compares the output waveforms of two traces, with timestamps taken
+// relative to each trace's start. Returns -1 if they match, otherwise the
+// position of the first differing transition.
+long TRACE_diffOutputs(const TRACE_Reader *a, const TRACE_Reader *b,
+                       uint32_t toleranceMs) {
+  size_t i = nextOutput(a, 0);
+  size_t j = nextOutput(b, 0);
+  long position = 0;
+
+  while (i < a->count && j < b->count) {
+    const TRACE_Record *ra = &a->records[i];
+    const TRACE_Record *rb = &b->records[j];
+    uint64_t ta = ra->tick - a->header->startTick;
+    uint64_t tb = rb->tick - b->header->startTick;
+    uint64_t delta = (ta > tb) ? ta - tb : tb - ta;
+
+    if (ra->port != rb->port || ra->pins != rb->pins ||
+        ra->levels != rb->levels || delta > toleranceMs) {
+      return position;
+    }
+
+    i = nextOutput(a, i + 1);
+    j = nextOutput(b, j + 1);
+    position++;
+  }
+
+  return (i < a->count || j < b->count) ? position : -1;
+}
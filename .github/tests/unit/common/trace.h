@@ -0,0 +1,76 @@
+#ifndef Trace_H__
+#define Trace_H__
+
+#include "vclock.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Binary waveform trace of mock GPIO activity.
+//
+// A trace file is a 16-byte header followed by fixed 16-byte records in host
+// byte order, appended as they happen, so a finished file can be mapped and
+// walked in place. TRACE_open() truncates, so each file holds one run. Output records (pin transitions driven by the firmware)
+// describe the waveform; interrupt and input records are the stimulus that
+// TRACE_replay() feeds back into loop().
+
+#define TRACE_MAGIC 0x4352544DUL // "MTRC"
+#define TRACE_VERSION 1
+#define TRACE_BUFFER_RECORDS 1024
+
+typedef enum {
+  TRACE_OUTPUT = 0,
+  TRACE_INPUT = 1,
+  TRACE_INTERRUPT = 2
+} TRACE_Kind;
+
+typedef struct {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t recordSize;
+  uint64_t startTick;
+} TRACE_Header;
+
+// port is the GPIO port index on STM32 and the pin number on Arduino; pins
+// is the mask of lines that changed and levels their new state.
+typedef struct {
+  uint64_t tick;
+  uint16_t port;
+  uint16_t pins;
+  uint16_t levels;
+  uint8_t kind;
+  uint8_t reserved;
+} TRACE_Record;
+
+typedef struct {
+  const TRACE_Header *header;
+  const TRACE_Record *records;
+  size_t count;
+  void *map;
+  size_t mapSize;
+} TRACE_Reader;
+
+typedef void (*TRACE_Stimulus)(const TRACE_Record *record);
+
+extern int TRACE_recording;
+
+int TRACE_open(const char *path);
+void TRACE_close(void);
+void TRACE_record(TRACE_Kind kind, uint16_t port, uint16_t pins,
+                  uint16_t levels);
+
+int TRACE_map(TRACE_Reader *reader, const char *path);
+void TRACE_unmap(TRACE_Reader *reader);
+uint64_t TRACE_replay(const TRACE_Reader *reader, VCLOCK_Loop loop,
+                      TRACE_Stimulus stimulus, uint32_t maxStep);
+long TRACE_diffOutputs(const TRACE_Reader *a, const TRACE_Reader *b,
+                       uint32_t toleranceMs);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Trace_H__ */
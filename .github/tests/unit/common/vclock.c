@@ -0,0 +1,255 @@
+#include "vclock.h"
+#include <stddef.h>
+
+typedef enum { EVENT_FREE = 0, EVENT_PENDING, EVENT_CANCELLED } VCLOCK_State;
+
+typedef struct {
+  uint64_t at;
+  uint64_t sequence;
+  VCLOCK_Callback callback;
+  void *context;
+  VCLOCK_State state;
+  uint16_t generation;
+} VCLOCK_Event;
+
+static uint64_t now = 0;
+static uint64_t elapsed = 0;
+static uint64_t sequence = 0;
+static uint64_t deadline = VCLOCK_NEVER;
+
+static VCLOCK_Event events[VCLOCK_EVENT_MAX];
+// Min-heap of indexes into events[], ordered by (at, sequence) so events due
+// at the same instant fire in the order they were scheduled.
+static int heap[VCLOCK_EVENT_MAX];
+static int heapSize = 0;
+static int freeSlots[VCLOCK_EVENT_MAX];
+static int freeCount = -1;
+
+// PREEMPT_run() reads the clock from its interrupt thread while loop()
+// advances it, so the current time is only ever accessed atomically. Only
+// the loop thread writes it.
+static uint64_t loadNow(void) {
+  return __atomic_load_n(&now, __ATOMIC_RELAXED);
+}
+
+static void storeNow(uint64_t ticks) {
+  __atomic_store_n(&now, ticks, __ATOMIC_RELAXED);
+}
+
+static int eventBefore(int a, int b) {
+  if (events[a].at != events[b].at) {
+    return events[a].at < events[b].at;
+  }
+  return events[a].sequence < events[b].sequence;
+}
+
+static void heapSwap(int i, int j) {
+  int tmp = heap[i];
+  heap[i] = heap[j];
+  heap[j] = tmp;
+}
+
+static void heapPush(int id) {
+  int i = heapSize++;
+
+  heap[i] = id;
+  while (i > 0 && eventBefore(heap[i], heap[(i - 1) / 2])) {
+    heapSwap(i, (i - 1) / 2);
+    i = (i - 1) / 2;
+  }
+}
+
+static int heapPop(void) {
+  int top = heap[0];
+  int i = 0;
+
+  heap[0] = heap[--heapSize];
+  for (;;) {
+    int left = 2 * i + 1;
+    int right = left + 1;
+    int smallest = i;
+
+    if (left < heapSize && eventBefore(heap[left], heap[smallest])) {
+      smallest = left;
+    }
+    if (right < heapSize && eventBefore(heap[right], heap[smallest])) {
+      smallest = right;
+    }
+    if (smallest == i) {
+      break;
+    }
+    heapSwap(i, smallest);
+    i = smallest;
+  }
+
+  return top;
+}
+
+static void releaseSlot(int slot) {
+  events[slot].state = EVENT_FREE;
+  events[slot].generation++;
+  freeSlots[freeCount++] = slot;
+}
+
+// Cancelled events stay in the heap until they reach the top.
+static void dropCancelled(void) {
+  while (heapSize > 0 && events[heap[0]].state == EVENT_CANCELLED) {
+    releaseSlot(heapPop());
+  }
+}
+
+static void initSlots(void) {
+  heapSize = 0;
+  freeCount = 0;
+  // Bumping the generation keeps ids from before a reset from cancelling
+  // the events that reuse their slots.
+  for (int slot = VCLOCK_EVENT_MAX - 1; slot >= 0; slot--) {
+    events[slot].state = EVENT_FREE;
+    events[slot].generation++;
+    freeSlots[freeCount++] = slot;
+  }
+}
+
+void VCLOCK_reset(void) {
+  storeNow(0);
+  sequence = 0;
+  deadline = VCLOCK_NEVER;
+  initSlots();
+}
+
+uint32_t VCLOCK_now(void) { return (uint32_t)loadNow(); }
+
+uint64_t VCLOCK_now64(void) { return loadNow(); }
+
+uint64_t VCLOCK_elapsed(void) { return elapsed; }
+
+void VCLOCK_setNow(uint32_t ticks) {
+  storeNow((loadNow() & ~(uint64_t)UINT32_MAX) | ticks);
+}
+
+void VCLOCK_setNow64(uint64_t ticks) { storeNow(ticks); }
+
+void VCLOCK_advanceTo(uint64_t ticks) {
+  for (;;) {
+    dropCancelled();
+    if (heapSize == 0 || events[heap[0]].at > ticks) {
+      break;
+    }
+
+    int slot = heapPop();
+    VCLOCK_Callback callback = events[slot].callback;
+    void *context = events[slot].context;
+
+    if (events[slot].at > loadNow()) {
+      elapsed += events[slot].at - loadNow();
+      storeNow(events[slot].at);
+    }
+    // Release first so the callback can reschedule itself.
+    releaseSlot(slot);
+    callback(context);
+  }
+
+  if (ticks > loadNow()) {
+    elapsed += ticks - loadNow();
+    storeNow(ticks);
+  }
+}
+
+void VCLOCK_advance(uint32_t ms) { VCLOCK_advanceTo(loadNow() + ms); }
+
+// Event ids carry the slot generation so a stale id never cancels an event
+// that later reused the same slot.
+int VCLOCK_schedule(uint64_t at, VCLOCK_Callback callback, void *context) {
+  if (freeCount < 0) {
+    initSlots();
+  }
+  dropCancelled();
+  if (freeCount == 0) {
+    return -1;
+  }
+
+  int slot = freeSlots[--freeCount];
+
+  events[slot].at = at;
+  events[slot].sequence = sequence++;
+  events[slot].callback = callback;
+  events[slot].context = context;
+  events[slot].state = EVENT_PENDING;
+  heapPush(slot);
+
+  return events[slot].generation * VCLOCK_EVENT_MAX + slot;
+}
+
+int VCLOCK_scheduleIn(uint32_t delay, VCLOCK_Callback callback,
+                      void *context) {
+  return VCLOCK_schedule(loadNow() + delay, callback, context);
+}
+
+void VCLOCK_cancel(int id) {
+  if (id < 0) {
+    return;
+  }
+
+  int slot = id % VCLOCK_EVENT_MAX;
+
+  if (events[slot].state == EVENT_PENDING &&
+      events[slot].generation == (uint16_t)(id / VCLOCK_EVENT_MAX)) {
+    events[slot].state = EVENT_CANCELLED;
+  }
+}
+
+// Deadlines are given as 32-bit ticks, like the firmware sees them, and
+// resolve to their next occurrence at or after the current time.
+void VCLOCK_requestDeadline(uint32_t ticks) {
+  uint64_t current = loadNow();
+  uint64_t at = current + (uint32_t)(ticks - (uint32_t)current);
+
+  if (at < deadline) {
+    deadline = at;
+  }
+}
+
+uint64_t VCLOCK_nextEvent(void) {
+  uint64_t next = deadline;
+
+  dropCancelled();
+  if (heapSize > 0 && events[heap[0]].at < next) {
+    next = events[heap[0]].at;
+  }
+
+  return next;
+}
+
+int VCLOCK_step(VCLOCK_Loop loop, uint64_t horizon, uint32_t maxStep) {
+  if (loadNow() >= horizon) {
+    return 0;
+  }
+
+  deadline = VCLOCK_NEVER;
+  loop();
+
+  uint64_t next = VCLOCK_nextEvent();
+
+  if (maxStep > 0 && loadNow() + maxStep < next) {
+    next = loadNow() + maxStep;
+  }
+  if (next > horizon) {
+    next = horizon;
+  }
+  if (next <= loadNow()) {
+    next = loadNow() + 1;
+  }
+  VCLOCK_advanceTo(next);
+
+  return 1;
+}
+
+uint64_t VCLOCK_run(VCLOCK_Loop loop, uint64_t horizon, uint32_t maxStep) {
+  uint64_t iterations = 0;
+
+  while (VCLOCK_step(loop, horizon, maxStep)) {
+    iterations++;
+  }
+
+  return iterations;
+}
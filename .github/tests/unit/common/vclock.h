@@ -0,0 +1,53 @@
+#ifndef Vclock_H__
+#define Vclock_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Discrete-event virtual clock shared by the HAL and Arduino mocks.
+//
+// Time is kept as a 64-bit millisecond count so simulations can run across
+// any number of 32-bit tick wraps; HAL_GetTick() and millis() return the
+// low 32 bits. Instead of stepping one millisecond at a time, VCLOCK_step()
+// jumps straight to the next interesting instant: the next scheduled event,
+// the next deadline reported through VCLOCK_requestDeadline(), the caller's
+// horizon or, for firmware that only polls, the caller's maximum step.
+
+#define VCLOCK_EVENT_MAX 64
+#define VCLOCK_NEVER UINT64_MAX
+
+typedef void (*VCLOCK_Callback)(void *context);
+typedef void (*VCLOCK_Loop)(void);
+
+void VCLOCK_reset(void);
+
+uint32_t VCLOCK_now(void);
+uint64_t VCLOCK_now64(void);
+// Time the clock has moved forward since the program started, across
+// resets and not counting jumps made with the setters.
+uint64_t VCLOCK_elapsed(void);
+void VCLOCK_setNow(uint32_t ticks);
+void VCLOCK_setNow64(uint64_t ticks);
+
+void VCLOCK_advance(uint32_t ms);
+void VCLOCK_advanceTo(uint64_t ticks);
+
+int VCLOCK_schedule(uint64_t at, VCLOCK_Callback callback, void *context);
+int VCLOCK_scheduleIn(uint32_t delay, VCLOCK_Callback callback,
+                      void *context);
+void VCLOCK_cancel(int id);
+
+void VCLOCK_requestDeadline(uint32_t ticks);
+uint64_t VCLOCK_nextEvent(void);
+
+int VCLOCK_step(VCLOCK_Loop loop, uint64_t horizon, uint32_t maxStep);
+uint64_t VCLOCK_run(VCLOCK_Loop loop, uint64_t horizon, uint32_t maxStep);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Vclock_H__ */
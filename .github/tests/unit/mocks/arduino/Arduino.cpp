@@ -0,0 +1,298 @@
+#include "Arduino.h"
+#include "fake.h"
+#include "trace.h"
+#include "vclock.h"
+
+#ifndef MOCKS_FAST_ONLY
+#include "CppUTestExt/MockSupport.h"
+#endif
+
+// Static variable to store the interrupt callback
+static callback_function_t stored_interrupt_callback = nullptr;
+static uint32_t stored_interrupt_pin = 0;
+static uint8_t pinLevels[SPY_PIN_COUNT] = {0};
+static callback_function_t pinCallbacks[SPY_PIN_COUNT] = {nullptr};
+static uint8_t pinModes[SPY_PIN_COUNT] = {0};
+static uint64_t interruptCount = 0;
+
+void pinMode(uint32_t ulPin, uint32_t ulMode)
+{
+    FAKE_log(FAKE_pinMode, ulPin, ulMode, 0);
+#ifndef MOCKS_FAST_ONLY
+    if (!FAKE_enabled)
+    {
+        mock()
+            .actualCall("pinMode")
+            .withParameter("dwPin", ulPin)
+            .withParameter("dwMode", ulMode);
+    }
+#endif
+    return;
+}
+
+void digitalWrite(uint32_t ulPin, uint32_t ulVal)
+{
+    if (ulPin < SPY_PIN_COUNT)
+    {
+        uint8_t level = (ulVal != LOW) ? HIGH : LOW;
+
+        if (TRACE_recording && pinLevels[ulPin] != level)
+        {
+            TRACE_record(TRACE_OUTPUT, (uint16_t)ulPin, 1, level);
+        }
+        pinLevels[ulPin] = level;
+    }
+
+    FAKE_log(FAKE_digitalWrite, ulPin, ulVal, 0);
+#ifndef MOCKS_FAST_ONLY
+    if (!FAKE_enabled)
+    {
+        mock()
+            .actualCall("digitalWrite")
+            .withParameter("dwPin", ulPin)
+            .withParameter("dwVal", ulVal);
+    }
+#endif
+    return;
+}
+
+void delay(uint32_t ms)
+{
+    FAKE_log(FAKE_delay, ms, 0, 0);
+#ifndef MOCKS_FAST_ONLY
+    if (!FAKE_enabled)
+    {
+        mock()
+            .actualCall("delay")
+            .withParameter("ms", ms);
+    }
+#endif
+    VCLOCK_advance(ms);
+    return;
+}
+
+unsigned long millis(void)
+{
+    FAKE_log(FAKE_millis, 0, 0, 0);
+#ifndef MOCKS_FAST_ONLY
+    if (!FAKE_enabled)
+    {
+        MockActualCall &call = mock().actualCall("millis");
+        uint32_t currentMillis = call.returnUnsignedLongIntValueOrDefault(VCLOCK_now());
+        VCLOCK_setNow(currentMillis);
+        return currentMillis;
+    }
+#endif
+    return VCLOCK_now();
+}
+
+int digitalRead(uint32_t ulPin)
+{
+    int level = SPY_getPinLevel(ulPin);
+
+    FAKE_log(FAKE_digitalRead, ulPin, 0, 0);
+#ifndef MOCKS_FAST_ONLY
+    if (!FAKE_enabled)
+    {
+        return mock()
+            .actualCall("digitalRead")
+            .withParameter("ulPin", ulPin)
+            .returnIntValueOrDefault(level);
+    }
+#endif
+    return level;
+}
+
+void attachInterrupt(uint32_t pin, callback_function_t callback, uint32_t mode)
+{
+    stored_interrupt_callback = callback;
+    stored_interrupt_pin = pin;
+    if (pin < SPY_PIN_COUNT)
+    {
+        pinCallbacks[pin] = callback;
+        pinModes[pin] = (uint8_t)mode;
+    }
+
+    FAKE_log(FAKE_attachInterrupt, pin, (uintptr_t)callback, mode);
+#ifndef MOCKS_FAST_ONLY
+    if (!FAKE_enabled)
+    {
+        mock()
+            .actualCall("attachInterrupt")
+            .withParameter("pin", pin)
+            .withParameter("callback", callback)
+            .withParameter("mode", mode);
+    }
+#endif
+    return;
+}
+
+void detachInterrupt(uint32_t pin)
+{
+    if (pin < SPY_PIN_COUNT)
+    {
+        pinCallbacks[pin] = nullptr;
+    }
+    if (pin == stored_interrupt_pin)
+    {
+        stored_interrupt_callback = nullptr;
+    }
+
+    FAKE_log(FAKE_detachInterrupt, pin, 0, 0);
+#ifndef MOCKS_FAST_ONLY
+    if (!FAKE_enabled)
+    {
+        mock()
+            .actualCall("detachInterrupt")
+            .withParameter("pin", pin);
+    }
+#endif
+    return;
+}
+
+uint32_t digitalPinToInterrupt(uint32_t pin)
+{
+    FAKE_log(FAKE_digitalPinToInterrupt, pin, 0, 0);
+#ifndef MOCKS_FAST_ONLY
+    if (!FAKE_enabled)
+    {
+        return mock()
+            .actualCall("digitalPinToInterrupt")
+            .withParameter("pin", pin)
+            .returnUnsignedIntValueOrDefault(pin);
+    }
+#endif
+    return pin;
+}
+
+callback_function_t SPY_getStoredInterruptCallback(void)
+{
+    return stored_interrupt_callback;
+}
+
+callback_function_t SPY_getInterruptCallback(uint32_t pin)
+{
+    return (pin < SPY_PIN_COUNT) ? pinCallbacks[pin] : nullptr;
+}
+
+uint32_t SPY_getInterruptMode(uint32_t pin)
+{
+    return (pin < SPY_PIN_COUNT) ? pinModes[pin] : 0;
+}
+
+uint64_t SPY_getInterruptCount(void)
+{
+    return interruptCount;
+}
+
+void SPY_resetInterrupts(void)
+{
+    stored_interrupt_callback = nullptr;
+    stored_interrupt_pin = 0;
+    for (uint32_t pin = 0; pin < SPY_PIN_COUNT; pin++)
+    {
+        pinCallbacks[pin] = nullptr;
+        pinModes[pin] = 0;
+    }
+    interruptCount = 0;
+}
+
+void SPY_setCurrentMillis(uint32_t millis)
+{
+    VCLOCK_setNow(millis);
+}
+
+int SPY_getPinLevel(uint32_t pin)
+{
+    return (pin < SPY_PIN_COUNT) ? pinLevels[pin] : LOW;
+}
+
+static bool modeFires(uint8_t mode, uint8_t from, uint8_t to)
+{
+    switch (mode)
+    {
+    case CHANGE:
+        return from != to;
+    case RISING:
+        return from == LOW && to == HIGH;
+    case FALLING:
+        return from == HIGH && to == LOW;
+    case LOW:
+        return to == LOW;
+    case HIGH:
+        return to == HIGH;
+    default:
+        return false;
+    }
+}
+
+// Handlers fired from here are not traced as interrupts: replaying the input
+// record fires them again.
+void SPY_setPinLevel(uint32_t pin, int level)
+{
+    if (pin < SPY_PIN_COUNT)
+    {
+        uint8_t previous = pinLevels[pin];
+        uint8_t newLevel = (level != LOW) ? HIGH : LOW;
+
+        if (TRACE_recording && previous != newLevel)
+        {
+            TRACE_record(TRACE_INPUT, (uint16_t)pin, 1, newLevel);
+        }
+        pinLevels[pin] = newLevel;
+
+        callback_function_t callback = pinCallbacks[pin];
+        if (callback != nullptr && modeFires(pinModes[pin], previous, newLevel))
+        {
+            interruptCount++;
+            callback();
+        }
+    }
+}
+
+// Drives the given number of transitions back to back, for load tests.
+void SPY_toggleInputPin(uint32_t pin, uint32_t edges)
+{
+    for (uint32_t i = 0; i < edges; i++)
+    {
+        SPY_setPinLevel(pin, !SPY_getPinLevel(pin));
+    }
+}
+
+static void applyPinLevel(void *context)
+{
+    uintptr_t packed = (uintptr_t)context;
+
+    SPY_setPinLevel((uint32_t)(packed >> 1), (int)(packed & 1));
+}
+
+// Sets the pin level at the given virtual time, so that edges land between
+// loop() iterations as they would on the board. Returns the event id, or -1
+// when the clock's event table is full.
+int SPY_schedulePinLevel(uint64_t at, uint32_t pin, int level)
+{
+    uintptr_t packed = ((uintptr_t)pin << 1) | (level != LOW ? 1 : 0);
+
+    return VCLOCK_schedule(at, applyPinLevel, (void *)packed);
+}
+
+void SPY_triggerInterrupt(void)
+{
+    TRACE_record(TRACE_INTERRUPT, (uint16_t)stored_interrupt_pin, 1, 0);
+    if (stored_interrupt_callback != nullptr)
+    {
+        stored_interrupt_callback();
+    }
+}
+
+void SPY_traceStimulus(const TRACE_Record *record)
+{
+    if (record->kind == TRACE_INTERRUPT)
+    {
+        SPY_triggerInterrupt();
+    }
+    else if (record->kind == TRACE_INPUT)
+    {
+        SPY_setPinLevel(record->port, record->levels);
+    }
+}
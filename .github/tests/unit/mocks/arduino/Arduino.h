@@ -0,0 +1,49 @@
+#ifndef Arduino_H__
+#define Arduino_H__
+
+#include "stm32f4xx.h"
+#include "trace.h"
+#include <stdint.h>
+
+#define OUTPUT 0x1
+#define INPUT 0x0
+#define LOW 0x0
+#define HIGH 0x1
+#define CHANGE 0x2
+#define FALLING 0x3
+#define RISING 0x4
+
+#define SPY_PIN_COUNT 128
+
+typedef void (*callback_function_t)(void);
+
+void delay(uint32_t ms);
+unsigned long millis(void);
+void digitalWrite(uint32_t dwPin, uint32_t dwVal);
+void pinMode(uint32_t dwPin, uint32_t dwMode);
+int digitalRead(uint32_t ulPin);
+void attachInterrupt(uint32_t pin, callback_function_t callback, uint32_t mode);
+void detachInterrupt(uint32_t pin);
+uint32_t digitalPinToInterrupt(uint32_t pin);
+// Pin-level input model. Interrupt numbers are pin numbers, and each pin
+// keeps the handler and mode last attached to it. SPY_setPinLevel() drives
+// an input and fires the pin's handler when the transition matches its
+// mode: RISING, FALLING or CHANGE on an edge, LOW or HIGH whenever the pin
+// is set to that level, as a level-triggered line would keep firing.
+// Handlers run after the new level is visible to digitalRead().
+// SPY_triggerInterrupt() still calls the most recently attached handler
+// directly, whatever the pin level.
+callback_function_t SPY_getStoredInterruptCallback(void);
+callback_function_t SPY_getInterruptCallback(uint32_t pin);
+uint32_t SPY_getInterruptMode(uint32_t pin);
+uint64_t SPY_getInterruptCount(void);
+void SPY_resetInterrupts(void);
+void SPY_setCurrentMillis(uint32_t millis);
+int SPY_getPinLevel(uint32_t pin);
+void SPY_setPinLevel(uint32_t pin, int level);
+void SPY_toggleInputPin(uint32_t pin, uint32_t edges);
+int SPY_schedulePinLevel(uint64_t at, uint32_t pin, int level);
+void SPY_triggerInterrupt(void);
+void SPY_traceStimulus(const TRACE_Record *record);
+
+#endif /* Arduino_H__ */
\ No newline at end of file
@@ -0,0 +1,855 @@
+#include "main.h"
+#include "energy.h"
+#include "fake.h"
+#include "trace.h"
+#include "vclock.h"
+#include <stddef.h>
+#include <string.h>
+
+#ifndef MOCKS_FAST_ONLY
+#include "CppUTestExt/MockSupport_c.h"
+#endif
+
+GPIO_TypeDef SPY_HAL_GPIO_Ports[SPY_HAL_GPIO_PORT_COUNT];
+
+static uint32_t stopCount = 0;
+static uint64_t stoppedMs = 0;
+
+uint32_t HAL_Init(void) { return 0; }
+void SystemClock_Config(void) {}
+void MX_GPIO_Init(void) {}
+
+// What CubeMX generates for the Nucleo's ST-LINK virtual COM port.
+UART_HandleTypeDef huart2;
+
+void MX_USART2_UART_Init(void) {
+  huart2.Instance = USART2;
+  huart2.Init.BaudRate = 115200;
+  huart2.Init.WordLength = UART_WORDLENGTH_8B;
+  huart2.Init.StopBits = UART_STOPBITS_1;
+  huart2.Init.Parity = UART_PARITY_NONE;
+  huart2.Init.Mode = UART_MODE_TX_RX;
+  huart2.Init.HwFlowCtl = UART_HWCONTROL_NONE;
+  huart2.Init.OverSampling = UART_OVERSAMPLING_16;
+  HAL_UART_Init(&huart2);
+}
+
+uint32_t HAL_GetTick(void) {
+  FAKE_log(FAKE_HAL_GetTick, 0, 0, 0);
+#ifndef MOCKS_FAST_ONLY
+  if (!FAKE_enabled) {
+    uint32_t ticks = mock_c()
+                         ->actualCall("HAL_GetTick")
+                         ->returnUnsignedLongIntValueOrDefault(VCLOCK_now());
+    VCLOCK_setNow(ticks);
+    return ticks;
+  }
+#endif
+  return VCLOCK_now();
+}
+
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+  SPY_HAL_GPIO_TogglePin(GPIOx, GPIO_Pin);
+  FAKE_log(FAKE_HAL_GPIO_TogglePin, (uintptr_t)GPIOx, GPIO_Pin, 0);
+#ifndef MOCKS_FAST_ONLY
+  if (!FAKE_enabled) {
+    mock_c()
+        ->actualCall("HAL_GPIO_TogglePin")
+        ->withPointerParameters("GPIOx", GPIOx)
+        ->withUnsignedIntParameters("GPIO_Pin", GPIO_Pin);
+  }
+#endif
+  return;
+}
+
+void HAL_Delay(uint32_t Delay) {
+  FAKE_log(FAKE_HAL_Delay, Delay, 0, 0);
+#ifndef MOCKS_FAST_ONLY
+  if (!FAKE_enabled) {
+    mock_c()
+        ->actualCall("HAL_Delay")
+        ->withUnsignedIntParameters("Delay", Delay);
+  }
+#endif
+  VCLOCK_advance(Delay);
+  return;
+}
+
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+  GPIO_PinState state =
+      (GPIOx->IDR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+
+  FAKE_log(FAKE_HAL_GPIO_ReadPin, (uintptr_t)GPIOx, GPIO_Pin, 0);
+#ifndef MOCKS_FAST_ONLY
+  if (!FAKE_enabled) {
+    return mock_c()
+        ->actualCall("HAL_GPIO_ReadPin")
+        ->withPointerParameters("GPIOx", GPIOx)
+        ->withUnsignedIntParameters("GPIO_Pin", GPIO_Pin)
+        ->returnUnsignedLongIntValueOrDefault(state);
+  }
+#endif
+  return state;
+}
+
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin,
+                       GPIO_PinState PinState) {
+  SPY_HAL_GPIO_WritePin(GPIOx, GPIO_Pin, PinState);
+  FAKE_log(FAKE_HAL_GPIO_WritePin, (uintptr_t)GPIOx, GPIO_Pin, PinState);
+#ifndef MOCKS_FAST_ONLY
+  if (!FAKE_enabled) {
+    mock_c()
+        ->actualCall("HAL_GPIO_WritePin")
+        ->withPointerParameters("GPIOx", GPIOx)
+        ->withUnsignedIntParameters("GPIO_Pin", GPIO_Pin)
+        ->withUnsignedIntParameters("PinState", PinState);
+  }
+#endif
+  return;
+}
+
+void HAL_SuspendTick(void) {
+  SysTick->CTRL &= ~SysTick_CTRL_TICKINT_Msk;
+  FAKE_log(FAKE_HAL_SuspendTick, 0, 0, 0);
+#ifndef MOCKS_FAST_ONLY
+  if (!FAKE_enabled) {
+    mock_c()->actualCall("HAL_SuspendTick");
+  }
+#endif
+  return;
+}
+
+void HAL_ResumeTick(void) {
+  SysTick->CTRL |= SysTick_CTRL_TICKINT_Msk;
+  FAKE_log(FAKE_HAL_ResumeTick, 0, 0, 0);
+#ifndef MOCKS_FAST_ONLY
+  if (!FAKE_enabled) {
+    mock_c()->actualCall("HAL_ResumeTick");
+  }
+#endif
+  return;
+}
+
+// STOP mode is a WFI with the clocks gated: the core only wakes on an
+// interrupt that does not need them, i.e. the next scheduled event.
+void HAL_PWR_EnterSTOPMode(uint32_t Regulator, uint8_t STOPEntry) {
+  uint64_t start = VCLOCK_now64();
+
+  FAKE_log(FAKE_HAL_PWR_EnterSTOPMode, Regulator, STOPEntry, 0);
+#ifndef MOCKS_FAST_ONLY
+  if (!FAKE_enabled) {
+    mock_c()
+        ->actualCall("HAL_PWR_EnterSTOPMode")
+        ->withUnsignedIntParameters("Regulator", Regulator)
+        ->withUnsignedIntParameters("STOPEntry", STOPEntry);
+  }
+#endif
+  stopCount++;
+  ENERGY_setRestState(ENERGY_STOP);
+  __WFI();
+  ENERGY_setRestState(ENERGY_SLEEP);
+  stoppedMs += VCLOCK_now64() - start;
+  return;
+}
+
+void SPY_HAL_PWR_Reset(void) {
+  stopCount = 0;
+  stoppedMs = 0;
+}
+
+uint32_t SPY_HAL_PWR_StopCount(void) { return stopCount; }
+
+uint64_t SPY_HAL_PWR_StoppedMs(void) { return stoppedMs; }
+
+TIM_TypeDef SPY_HAL_TIM_Instances[SPY_HAL_TIM_COUNT];
+
+// A running counter was at baseCount at baseMs, plus baseRemainder
+// thousandths of a count carried over so that periods that are not a whole
+// number of milliseconds do not drift.
+typedef struct {
+  TIM_HandleTypeDef *htim;
+  uint64_t baseMs;
+  uint32_t baseCount;
+  uint32_t baseRemainder;
+  uint32_t updates;
+  int event;
+} SPY_HAL_TIM_State;
+
+static SPY_HAL_TIM_State timStates[SPY_HAL_TIM_COUNT];
+
+static SPY_HAL_TIM_State *timState(TIM_TypeDef *TIMx) {
+  return &timStates[TIMx - SPY_HAL_TIM_Instances];
+}
+
+static uint64_t timMilliCounts(TIM_TypeDef *TIMx, uint64_t at) {
+  const SPY_HAL_TIM_State *state = timState(TIMx);
+  uint64_t countHz = SystemCoreClock / (TIMx->PSC + 1U);
+
+  return (at - state->baseMs) * countHz + state->baseRemainder;
+}
+
+static void timRebase(TIM_TypeDef *TIMx, uint32_t count) {
+  SPY_HAL_TIM_State *state = timState(TIMx);
+
+  state->baseMs = VCLOCK_now64();
+  state->baseCount = count;
+  state->baseRemainder = 0;
+  TIMx->CNT = count;
+}
+
+static void timUpdate(void *context);
+
+static void timUpdateEvent(TIM_TypeDef *TIMx) {
+  TIMx->SR |= TIM_SR_UIF;
+  if (TIMx->DIER & TIM_DIER_UDE) {
+    SPY_HAL_DMA_Request(TIMx);
+  }
+  if ((TIMx->DIER & TIM_DIER_UIE) && timState(TIMx)->htim != NULL) {
+    HAL_TIM_IRQHandler(timState(TIMx)->htim);
+  }
+}
+
+// The next overflow is the first millisecond by which the counter has gone
+// past ARR.
+static void timSchedule(TIM_TypeDef *TIMx) {
+  SPY_HAL_TIM_State *state = timState(TIMx);
+  uint64_t countHz = SystemCoreClock / (TIMx->PSC + 1U);
+  uint64_t toGo = ((uint64_t)TIMx->ARR + 1U - state->baseCount) * 1000U -
+                  state->baseRemainder;
+
+  uint64_t at = state->baseMs + (toGo + countHz - 1U) / countHz;
+
+  state->event = VCLOCK_schedule(at, timUpdate, TIMx);
+}
+
+static void timUpdate(void *context) {
+  TIM_TypeDef *TIMx = context;
+  SPY_HAL_TIM_State *state = timState(TIMx);
+  uint64_t milliCounts = timMilliCounts(TIMx, VCLOCK_now64());
+  uint64_t count = state->baseCount + milliCounts / 1000U;
+  uint64_t period = (uint64_t)TIMx->ARR + 1U;
+
+  if ((TIMx->CR1 & TIM_CR1_CEN) == 0U) {
+    return;
+  }
+
+  timRebase(TIMx, (uint32_t)(count % period));
+  state->baseRemainder = (uint32_t)(milliCounts % 1000U);
+  state->updates += (uint32_t)(count / period);
+  timSchedule(TIMx);
+  timUpdateEvent(TIMx);
+}
+
+// Like the real one, initialisation generates an update event to load PSC,
+// which leaves UIF set: starting with interrupts then fires at once unless
+// the flag is cleared first.
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef *htim) {
+  if (htim == NULL || htim->Instance == NULL) {
+    return HAL_ERROR;
+  }
+
+  TIM_TypeDef *TIMx = htim->Instance;
+
+  timState(TIMx)->htim = htim;
+  TIMx->PSC = htim->Init.Prescaler;
+  TIMx->ARR = htim->Init.Period;
+  TIMx->CNT = 0;
+  TIMx->SR |= TIM_SR_UIF;
+  return HAL_OK;
+}
+
+static HAL_StatusTypeDef timStart(TIM_HandleTypeDef *htim) {
+  TIM_TypeDef *TIMx = htim->Instance;
+
+  if (TIMx->CR1 & TIM_CR1_CEN) {
+    return HAL_ERROR;
+  }
+
+  timState(TIMx)->htim = htim;
+  timRebase(TIMx, TIMx->CNT);
+  TIMx->CR1 |= TIM_CR1_CEN;
+  timSchedule(TIMx);
+  return HAL_OK;
+}
+
+static void timStop(TIM_HandleTypeDef *htim) {
+  TIM_TypeDef *TIMx = htim->Instance;
+
+  if (TIMx->CR1 & TIM_CR1_CEN) {
+    SPY_HAL_TIM_Sync(TIMx);
+    VCLOCK_cancel(timState(TIMx)->event);
+  }
+  TIMx->CR1 &= ~TIM_CR1_CEN;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef *htim) {
+  FAKE_log(FAKE_HAL_TIM_Base_Start, (uintptr_t)htim, 0, 0);
+#ifndef MOCKS_FAST_ONLY
+  if (!FAKE_enabled) {
+    mock_c()
+        ->actualCall("HAL_TIM_Base_Start")
+        ->withPointerParameters("htim", htim);
+  }
+#endif
+  return timStart(htim);
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Stop(TIM_HandleTypeDef *htim) {
+  FAKE_log(FAKE_HAL_TIM_Base_Stop, (uintptr_t)htim, 0, 0);
+#ifndef MOCKS_FAST_ONLY
+  if (!FAKE_enabled) {
+    mock_c()
+        ->actualCall("HAL_TIM_Base_Stop")
+        ->withPointerParameters("htim", htim);
+  }
+#endif
+  timStop(htim);
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim) {
+  FAKE_log(FAKE_HAL_TIM_Base_Start_IT, (uintptr_t)htim, 0, 0);
+#ifndef MOCKS_FAST_ONLY
+  if (!FAKE_enabled) {
+    mock_c()
+        ->actualCall("HAL_TIM_Base_Start_IT")
+        ->withPointerParameters("htim", htim);
+  }
+#endif
+  if (timStart(htim) != HAL_OK) {
+    return HAL_ERROR;
+  }
+
+  htim->Instance->DIER |= TIM_DIER_UIE;
+  HAL_TIM_IRQHandler(htim);
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef *htim) {
+  FAKE_log(FAKE_HAL_TIM_Base_Stop_IT, (uintptr_t)htim, 0, 0);
+#ifndef MOCKS_FAST_ONLY
+  if (!FAKE_enabled) {
+    mock_c()
+        ->actualCall("HAL_TIM_Base_Stop_IT")
+        ->withPointerParameters("htim", htim);
+  }
+#endif
+  htim->Instance->DIER &= ~TIM_DIER_UIE;
+  timStop(htim);
+  return HAL_OK;
+}
+
+void HAL_TIM_IRQHandler(TIM_HandleTypeDef *htim) {
+  TIM_TypeDef *TIMx = htim->Instance;
+
+  if ((TIMx->SR & TIM_SR_UIF) && (TIMx->DIER & TIM_DIER_UIE)) {
+    TIMx->SR &= ~TIM_SR_UIF;
+    HAL_TIM_PeriodElapsedCallback(htim);
+  }
+}
+
+__attribute__((weak)) void
+HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {}
+
+void SPY_HAL_TIM_Reset(void) {
+  for (int i = 0; i < SPY_HAL_TIM_COUNT; i++) {
+    if (SPY_HAL_TIM_Instances[i].CR1 & TIM_CR1_CEN) {
+      VCLOCK_cancel(timStates[i].event);
+    }
+  }
+  memset((void *)SPY_HAL_TIM_Instances, 0, sizeof(SPY_HAL_TIM_Instances));
+  memset(timStates, 0, sizeof(timStates));
+}
+
+TIM_TypeDef *SPY_HAL_TIM_Sync(TIM_TypeDef *TIMx) {
+  if (TIMx->CR1 & TIM_CR1_CEN) {
+    uint64_t count = timState(TIMx)->baseCount +
+                     timMilliCounts(TIMx, VCLOCK_now64()) / 1000U;
+
+    TIMx->CNT = (uint32_t)(count % ((uint64_t)TIMx->ARR + 1U));
+  }
+  return TIMx;
+}
+
+void SPY_HAL_TIM_SetCounter(TIM_TypeDef *TIMx, uint32_t counter) {
+  SPY_HAL_TIM_State *state = timState(TIMx);
+
+  timRebase(TIMx, counter);
+  if (TIMx->CR1 & TIM_CR1_CEN) {
+    VCLOCK_cancel(state->event);
+    timSchedule(TIMx);
+  }
+}
+
+uint32_t SPY_HAL_TIM_UpdateCount(TIM_TypeDef *TIMx) {
+  return timState(TIMx)->updates;
+}
+
+// A software update event restarts the period, as UG does.
+void SPY_HAL_TIM_GenerateEvent(TIM_TypeDef *TIMx, uint32_t events) {
+  if (events & TIM_EGR_UG) {
+    SPY_HAL_TIM_SetCounter(TIMx, 0);
+    timUpdateEvent(TIMx);
+  }
+}
+
+DMA_Stream_TypeDef SPY_HAL_DMA2_Streams[SPY_HAL_DMA_STREAM_COUNT];
+
+static uint32_t dmaLengths[SPY_HAL_DMA_STREAM_COUNT];
+static uint32_t dmaTransfers[SPY_HAL_DMA_STREAM_COUNT];
+
+static uint32_t dmaIndex(DMA_Stream_TypeDef *stream) {
+  return (uint32_t)(stream - SPY_HAL_DMA2_Streams);
+}
+
+// Timer requests wired to DMA2, from the request mapping table.
+static const struct {
+  TIM_TypeDef *timer;
+  DMA_Stream_TypeDef *stream;
+  uint32_t channel;
+} dmaRoutes[] = {
+    {TIM1, DMA2_Stream5, DMA_CHANNEL_6},
+};
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma) {
+  if (hdma == NULL || hdma->Instance == NULL) {
+    return HAL_ERROR;
+  }
+
+  hdma->Instance->CR = hdma->Init.Channel | hdma->Init.Direction |
+                       hdma->Init.PeriphInc | hdma->Init.MemInc |
+                       hdma->Init.PeriphDataAlignment |
+                       hdma->Init.MemDataAlignment | hdma->Init.Mode |
+                       hdma->Init.Priority;
+  hdma->Instance->FCR = hdma->Init.FIFOMode;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef *hdma, uintptr_t SrcAddress,
+                                uintptr_t DstAddress, uint32_t DataLength) {
+  DMA_Stream_TypeDef *stream = hdma->Instance;
+  HAL_StatusTypeDef status = HAL_OK;
+
+  FAKE_log(FAKE_HAL_DMA_Start, SrcAddress, DstAddress, DataLength);
+#ifndef MOCKS_FAST_ONLY
+  if (!FAKE_enabled) {
+    status = (HAL_StatusTypeDef)mock_c()
+                 ->actualCall("HAL_DMA_Start")
+                 ->withPointerParameters("hdma", hdma)
+                 ->withUnsignedIntParameters("DataLength", DataLength)
+                 ->returnIntValueOrDefault(HAL_OK);
+  }
+#endif
+  if (status != HAL_OK) {
+    return status;
+  }
+  if ((stream->CR & DMA_SxCR_EN) || DataLength == 0 ||
+      DataLength > 0xFFFFU) {
+    return HAL_ERROR;
+  }
+
+  dmaLengths[dmaIndex(stream)] = DataLength;
+  stream->NDTR = DataLength;
+  stream->M0AR = SrcAddress;
+  stream->PAR = DstAddress;
+  stream->CR |= DMA_SxCR_EN;
+  return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma) {
+  FAKE_log(FAKE_HAL_DMA_Abort, (uintptr_t)hdma, 0, 0);
+#ifndef MOCKS_FAST_ONLY
+  if (!FAKE_enabled) {
+    mock_c()->actualCall("HAL_DMA_Abort")->withPointerParameters("hdma", hdma);
+  }
+#endif
+  hdma->Instance->CR &= ~DMA_SxCR_EN;
+  return HAL_OK;
+}
+
+void SPY_HAL_DMA_Reset(void) {
+  memset((void *)SPY_HAL_DMA2_Streams, 0, sizeof(SPY_HAL_DMA2_Streams));
+  memset(dmaLengths, 0, sizeof(dmaLengths));
+  memset(dmaTransfers, 0, sizeof(dmaTransfers));
+}
+
+// Moves the next word of the stream the timer's request is routed to, if
+// that stream is enabled on the right channel.
+static void dmaTransfer(DMA_Stream_TypeDef *stream) {
+  uint32_t index = dmaIndex(stream);
+  uint32_t offset = (stream->CR & DMA_SxCR_MINC)
+                        ? dmaLengths[index] - stream->NDTR
+                        : 0;
+  uint32_t value = ((const uint32_t *)stream->M0AR)[offset];
+  uintptr_t port = (stream->PAR - offsetof(GPIO_TypeDef, BSRR) -
+                    (uintptr_t)SPY_HAL_GPIO_Ports) /
+                   sizeof(GPIO_TypeDef);
+
+  if (port < SPY_HAL_GPIO_PORT_COUNT &&
+      stream->PAR == (uintptr_t)&SPY_HAL_GPIO_Ports[port].BSRR) {
+    SPY_HAL_GPIO_WriteBSRR(&SPY_HAL_GPIO_Ports[port], value);
+  } else {
+    *(volatile uint32_t *)stream->PAR = value;
+  }
+
+  dmaTransfers[index]++;
+  if (--stream->NDTR == 0) {
+    if (stream->CR & DMA_SxCR_CIRC) {
+      stream->NDTR = dmaLengths[index];
+    } else {
+      stream->CR &= ~DMA_SxCR_EN;
+    }
+  }
+}
+
+void SPY_HAL_DMA_Request(TIM_TypeDef *TIMx) {
+  for (size_t i = 0; i < sizeof(dmaRoutes) / sizeof(dmaRoutes[0]); i++) {
+    DMA_Stream_TypeDef *stream = dmaRoutes[i].stream;
+
+    if (dmaRoutes[i].timer == TIMx && (stream->CR & DMA_SxCR_EN) &&
+        (stream->CR & DMA_SxCR_CHSEL) == dmaRoutes[i].channel) {
+      dmaTransfer(stream);
+    }
+  }
+}
+
+uint32_t SPY_HAL_DMA_TransferCount(DMA_Stream_TypeDef *stream) {
+  return dmaTransfers[dmaIndex(stream)];
+}
+
+USART_TypeDef SPY_HAL_USART_Instances[SPY_HAL_USART_COUNT];
+
+// Line time is kept in microseconds: lineFreeUs is when the last frame
+// queued so far leaves the shift register, which falls between ticks.
+typedef struct {
+  UART_HandleTypeDef *huart;
+  uint64_t lineFreeUs;
+  int event;
+  int completing;
+  uint32_t transfers;
+  uint64_t bytes;
+  uint32_t captured;
+  uint8_t wire[SPY_HAL_UART_WIRE_CAPACITY];
+} SPY_HAL_UART_State;
+
+static SPY_HAL_UART_State uartStates[SPY_HAL_USART_COUNT];
+
+static SPY_HAL_UART_State *uartState(USART_TypeDef *USARTx) {
+  return &uartStates[USARTx - SPY_HAL_USART_Instances];
+}
+
+// Start bit, data bits and stop bits; parity takes one of the data bits.
+static uint64_t uartFrameBits(const UART_InitTypeDef *init) {
+  return 1U + (init->WordLength == UART_WORDLENGTH_9B ? 9U : 8U) +
+         (init->StopBits == UART_STOPBITS_2 ? 2U : 1U);
+}
+
+static uint64_t uartWireUs(const UART_HandleTypeDef *huart, uint32_t size) {
+  return (size * uartFrameBits(&huart->Init) * 1000000U +
+          huart->Init.BaudRate - 1U) /
+         huart->Init.BaudRate;
+}
+
+// From within the completion callback, the line is free at the exact
+// instant the last transfer ended rather than at the tick it was seen.
+static uint64_t uartNowUs(SPY_HAL_UART_State *state) {
+  uint64_t now = VCLOCK_now64() * 1000U;
+
+  if (state->completing || state->lineFreeUs > now) {
+    return state->lineFreeUs;
+  }
+  return now;
+}
+
+static void uartCapture(SPY_HAL_UART_State *state, const uint8_t *data,
+                        uint32_t size) {
+  uint32_t room = SPY_HAL_UART_WIRE_CAPACITY - state->captured;
+  uint32_t count = size < room ? size : room;
+
+  memcpy(&state->wire[state->captured], data, count);
+  state->captured += count;
+  state->bytes += size;
+}
+
+static void uartComplete(void *context) {
+  UART_HandleTypeDef *huart = context;
+  SPY_HAL_UART_State *state = uartState(huart->Instance);
+
+  uartCapture(state, huart->pTxBuffPtr, huart->TxXferSize);
+  huart->TxXferCount = 0;
+  huart->gState = HAL_UART_STATE_READY;
+  state->transfers++;
+  state->completing = 1;
+  HAL_UART_TxCpltCallback(huart);
+  state->completing = 0;
+}
+
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart) {
+  if (huart == NULL || huart->Instance == NULL ||
+      huart->Init.BaudRate == 0) {
+    return HAL_ERROR;
+  }
+
+  uartState(huart->Instance)->huart = huart;
+  huart->Instance->BRR = SystemCoreClock / 2U / huart->Init.BaudRate;
+  huart->Instance->CR1 = huart->Init.WordLength | huart->Init.Parity |
+                         huart->Init.Mode | huart->Init.OverSampling;
+  huart->Instance->CR2 = huart->Init.StopBits;
+  huart->ErrorCode = HAL_UART_ERROR_NONE;
+  huart->gState = HAL_UART_STATE_READY;
+  return HAL_OK;
+}
+
+// Polls the frames out, so the caller is held up for as long as they take
+// on the wire, or until Timeout with only the frames sent by then.
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart,
+                                    const uint8_t *pData, uint16_t Size,
+                                    uint32_t Timeout) {
+  FAKE_log(FAKE_HAL_UART_Transmit, (uintptr_t)huart, Size, Timeout);
+#ifndef MOCKS_FAST_ONLY
+  if (!FAKE_enabled) {
+    mock_c()
+        ->actualCall("HAL_UART_Transmit")
+        ->withPointerParameters("huart", huart)
+        ->withUnsignedIntParameters("Size", Size)
+        ->withUnsignedIntParameters("Timeout", Timeout);
+  }
+#endif
+  if (huart->gState != HAL_UART_STATE_READY) {
+    return HAL_BUSY;
+  }
+  if (pData == NULL || Size == 0) {
+    return HAL_ERROR;
+  }
+
+  SPY_HAL_UART_State *state = uartState(huart->Instance);
+  uint64_t startUs = uartNowUs(state);
+  uint64_t endUs = startUs + uartWireUs(huart, Size);
+  uint64_t deadlineUs = VCLOCK_now64() * 1000U + (uint64_t)Timeout * 1000U;
+  uint32_t sent = Size;
+
+  if (endUs > deadlineUs) {
+    uint64_t bits = (deadlineUs - startUs) * huart->Init.BaudRate / 1000000U;
+
+    sent = (uint32_t)(bits / uartFrameBits(&huart->Init));
+    endUs = startUs + uartWireUs(huart, sent);
+  }
+
+  huart->gState = HAL_UART_STATE_BUSY_TX;
+  state->lineFreeUs = endUs;
+  VCLOCK_advanceTo(sent < Size ? deadlineUs / 1000U : (endUs + 999U) / 1000U);
+  uartCapture(state, pData, sent);
+  state->transfers++;
+  huart->gState = HAL_UART_STATE_READY;
+  return sent < Size ? HAL_TIMEOUT : HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart,
+                                        const uint8_t *pData, uint16_t Size) {
+  FAKE_log(FAKE_HAL_UART_Transmit_DMA, (uintptr_t)huart, Size, 0);
+#ifndef MOCKS_FAST_ONLY
+  if (!FAKE_enabled) {
+    mock_c()
+        ->actualCall("HAL_UART_Transmit_DMA")
+        ->withPointerParameters("huart", huart)
+        ->withUnsignedIntParameters("Size", Size);
+  }
+#endif
+  if (huart->gState != HAL_UART_STATE_READY) {
+    return HAL_BUSY;
+  }
+  if (pData == NULL || Size == 0) {
+    return HAL_ERROR;
+  }
+
+  SPY_HAL_UART_State *state = uartState(huart->Instance);
+  uint64_t endUs = uartNowUs(state) + uartWireUs(huart, Size);
+
+  huart->pTxBuffPtr = pData;
+  huart->TxXferSize = Size;
+  huart->TxXferCount = Size;
+  huart->ErrorCode = HAL_UART_ERROR_NONE;
+  huart->gState = HAL_UART_STATE_BUSY_TX;
+  state->huart = huart;
+  state->lineFreeUs = endUs;
+  state->event = VCLOCK_schedule((endUs + 999U) / 1000U, uartComplete, huart);
+  return HAL_OK;
+}
+
+__attribute__((weak)) void
+HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {}
+
+__attribute__((weak)) void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+}
+
+void SPY_HAL_UART_Reset(void) {
+  for (int i = 0; i < SPY_HAL_USART_COUNT; i++) {
+    UART_HandleTypeDef *huart = uartStates[i].huart;
+
+    if (huart != NULL && huart->gState == HAL_UART_STATE_BUSY_TX) {
+      VCLOCK_cancel(uartStates[i].event);
+      huart->gState = HAL_UART_STATE_READY;
+    }
+  }
+  memset((void *)SPY_HAL_USART_Instances, 0,
+         sizeof(SPY_HAL_USART_Instances));
+  memset(uartStates, 0, sizeof(uartStates));
+}
+
+const uint8_t *SPY_HAL_UART_Wire(USART_TypeDef *USARTx, uint32_t *length) {
+  *length = uartState(USARTx)->captured;
+  return uartState(USARTx)->wire;
+}
+
+uint64_t SPY_HAL_UART_ByteCount(USART_TypeDef *USARTx) {
+  return uartState(USARTx)->bytes;
+}
+
+uint32_t SPY_HAL_UART_TransferCount(USART_TypeDef *USARTx) {
+  return uartState(USARTx)->transfers;
+}
+
+// A DMA transfer fails part way, say on a framing error: the HAL aborts
+// it and reports through HAL_UART_ErrorCallback() instead of the
+// completion callback, and none of the buffer is counted as sent.
+void SPY_HAL_UART_Error(UART_HandleTypeDef *huart, uint32_t errorCode) {
+  SPY_HAL_UART_State *state = uartState(huart->Instance);
+
+  if (huart->gState == HAL_UART_STATE_BUSY_TX) {
+    VCLOCK_cancel(state->event);
+    state->lineFreeUs = VCLOCK_now64() * 1000U;
+  }
+  huart->ErrorCode |= errorCode;
+  huart->gState = HAL_UART_STATE_READY;
+  HAL_UART_ErrorCallback(huart);
+}
+
+void SPY_HAL_setCurrentTicks(uint32_t ticks) { VCLOCK_setNow(ticks); }
+
+void SPY_setCurrentTicks(uint32_t ticks) { SPY_HAL_setCurrentTicks(ticks); }
+
+void SPY_HAL_GPIO_Reset(void) {
+  memset((void *)SPY_HAL_GPIO_Ports, 0, sizeof(SPY_HAL_GPIO_Ports));
+  memset((void *)&SPY_EXTI, 0, sizeof(SPY_EXTI));
+}
+
+GPIO_TypeDef *SPY_HAL_GPIO_PortFromBase(uint32_t base) {
+  uint32_t index = (base - GPIOA_BASE) / GPIO_PORT_STRIDE;
+
+  if (base < GPIOA_BASE || index >= SPY_HAL_GPIO_PORT_COUNT) {
+    return NULL;
+  }
+
+  return &SPY_HAL_GPIO_Ports[index];
+}
+
+// BSRR writes are latched into ODR immediately, set bits winning over reset
+// bits of the same pin as on the real peripheral. BSRR always reads as 0.
+void SPY_HAL_GPIO_WriteBSRR(GPIO_TypeDef *GPIOx, uint32_t value) {
+  uint32_t previous = GPIOx->ODR;
+  uint32_t odr = (previous & ~(value >> 16)) | (value & 0xFFFFU);
+  uint32_t changed = odr ^ previous;
+
+  GPIOx->ODR = odr;
+  GPIOx->BSRR = 0;
+
+  if (TRACE_recording && changed) {
+    TRACE_record(TRACE_OUTPUT, (uint16_t)(GPIOx - SPY_HAL_GPIO_Ports),
+                 (uint16_t)changed, (uint16_t)(odr & changed));
+  }
+}
+
+void SPY_HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin,
+                           GPIO_PinState PinState) {
+  SPY_HAL_GPIO_WriteBSRR(GPIOx, (PinState != GPIO_PIN_RESET)
+                                    ? (uint32_t)GPIO_Pin
+                                    : (uint32_t)GPIO_Pin << 16);
+}
+
+GPIO_PinState SPY_HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+  return (GPIOx->ODR & GPIO_Pin) ? GPIO_PIN_SET : GPIO_PIN_RESET;
+}
+
+int SPY_HAL_ledLevel(void) {
+  return SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin) == GPIO_PIN_SET;
+}
+
+int SPY_HAL_neverBlocks(void) {
+  return FAKE_callCount(FAKE_HAL_Delay) == 0 &&
+         FAKE_callCount(FAKE_HAL_GPIO_ReadPin) == 0;
+}
+
+void SPY_HAL_setButton(int pressed, void (*isr)(uint16_t GPIO_Pin)) {
+  SPY_HAL_GPIO_SetInputPin(PUSH_BUTTON_GPIO_Port, PUSH_BUTTON_Pin,
+                           pressed ? GPIO_PIN_RESET : GPIO_PIN_SET);
+  if (isr != NULL) {
+    isr(PUSH_BUTTON_Pin);
+  }
+}
+
+void SPY_HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
+  uint32_t odr = GPIOx->ODR;
+
+  SPY_HAL_GPIO_WriteBSRR(GPIOx, ((odr & GPIO_Pin) << 16) | (~odr & GPIO_Pin));
+}
+
+void SPY_HAL_GPIO_SetInputPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin,
+                              GPIO_PinState PinState) {
+  uint32_t previous = GPIOx->IDR;
+  uint32_t idr = (PinState != GPIO_PIN_RESET)
+                     ? (previous | GPIO_Pin)
+                     : (previous & ~(uint32_t)GPIO_Pin);
+  uint32_t changed = idr ^ previous;
+
+  GPIOx->IDR = idr;
+
+  if (TRACE_recording && changed) {
+    TRACE_record(TRACE_INPUT, (uint16_t)(GPIOx - SPY_HAL_GPIO_Ports),
+                 (uint16_t)changed, (uint16_t)(idr & changed));
+  }
+}
+
+__attribute__((weak)) void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {}
+
+void HAL_GPIO_EXTI_IRQHandler(uint16_t GPIO_Pin) {
+  if (__HAL_GPIO_EXTI_GET_IT(GPIO_Pin) != 0U) {
+    __HAL_GPIO_EXTI_CLEAR_IT(GPIO_Pin);
+    HAL_GPIO_EXTI_Callback(GPIO_Pin);
+  }
+}
+
+// Calls the callback directly, bypassing the EXTI registers.
+void SPY_HAL_GPIO_EXTI_Trigger(uint16_t GPIO_Pin) {
+  TRACE_record(TRACE_INTERRUPT, 0, GPIO_Pin, 0);
+  HAL_GPIO_EXTI_Callback(GPIO_Pin);
+}
+
+// Sets several lines pending at once, as simultaneous edges would, and
+// enters the interrupt handler. The default handler does what the
+// CubeMX-generated EXTIx_IRQHandler()s do, one HAL_GPIO_EXTI_IRQHandler()
+// call per line from 0 up; override it to test another dispatch scheme.
+__attribute__((weak)) void SPY_HAL_EXTI_IRQHandler(void) {
+  for (uint32_t line = 0; line < 16; line++) {
+    HAL_GPIO_EXTI_IRQHandler((uint16_t)(1U << line));
+  }
+}
+
+void SPY_HAL_GPIO_EXTI_Fire(uint16_t GPIO_Pins) {
+  TRACE_record(TRACE_INTERRUPT, 0, GPIO_Pins, 0);
+  SPY_EXTI.PR |= GPIO_Pins;
+  SPY_HAL_EXTI_IRQHandler();
+}
+
+void SPY_HAL_TRACE_Stimulus(const TRACE_Record *record) {
+  if (record->kind == TRACE_INTERRUPT) {
+    SPY_HAL_GPIO_EXTI_Trigger(record->pins);
+  } else if (record->kind == TRACE_INPUT &&
+             record->port < SPY_HAL_GPIO_PORT_COUNT) {
+    GPIO_TypeDef *GPIOx = &SPY_HAL_GPIO_Ports[record->port];
+
+    SPY_HAL_GPIO_SetInputPin(GPIOx, record->pins & record->levels,
+                             GPIO_PIN_SET);
+    SPY_HAL_GPIO_SetInputPin(GPIOx, record->pins & ~record->levels,
+                             GPIO_PIN_RESET);
+  }
+}
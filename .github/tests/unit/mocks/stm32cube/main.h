@@ -0,0 +1,385 @@
+#ifndef Main_H__
+#define Main_H__
+
+#include "stm32f4xx.h"
+#include "trace.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  volatile uint32_t MODER;
+  volatile uint32_t OTYPER;
+  volatile uint32_t OSPEEDR;
+  volatile uint32_t PUPDR;
+  volatile uint32_t IDR;
+  volatile uint32_t ODR;
+  volatile uint32_t BSRR;
+  volatile uint32_t LCKR;
+  volatile uint32_t AFR[2];
+} GPIO_TypeDef;
+
+// Emulated AHB1 GPIO block: one register file per port, laid out like the
+// real one (GPIOA at 0x40020000, one port every 0x400 bytes).
+#define SPY_HAL_GPIO_PORT_COUNT 11
+#define GPIOA_BASE 0x40020000UL
+#define GPIO_PORT_STRIDE 0x400UL
+
+extern GPIO_TypeDef SPY_HAL_GPIO_Ports[SPY_HAL_GPIO_PORT_COUNT];
+
+#define GPIOA (&SPY_HAL_GPIO_Ports[0])
+#define GPIOB (&SPY_HAL_GPIO_Ports[1])
+#define GPIOC (&SPY_HAL_GPIO_Ports[2])
+#define GPIOD (&SPY_HAL_GPIO_Ports[3])
+#define GPIOE (&SPY_HAL_GPIO_Ports[4])
+#define GPIOF (&SPY_HAL_GPIO_Ports[5])
+#define GPIOG (&SPY_HAL_GPIO_Ports[6])
+#define GPIOH (&SPY_HAL_GPIO_Ports[7])
+#define GPIOI (&SPY_HAL_GPIO_Ports[8])
+#define GPIOJ (&SPY_HAL_GPIO_Ports[9])
+#define GPIOK (&SPY_HAL_GPIO_Ports[10])
+
+#define LED_GPIO_Port GPIOA
+#define LED_Pin 0x0020
+#define PUSH_BUTTON_GPIO_Port GPIOC
+#define PUSH_BUTTON_Pin 0x2000
+
+#define GPIO_PIN_0 ((uint16_t)0x0001)
+#define GPIO_PIN_1 ((uint16_t)0x0002)
+#define GPIO_PIN_2 ((uint16_t)0x0004)
+#define GPIO_PIN_3 ((uint16_t)0x0008)
+#define GPIO_PIN_4 ((uint16_t)0x0010)
+#define GPIO_PIN_5 ((uint16_t)0x0020)
+#define GPIO_PIN_6 ((uint16_t)0x0040)
+#define GPIO_PIN_7 ((uint16_t)0x0080)
+#define GPIO_PIN_8 ((uint16_t)0x0100)
+#define GPIO_PIN_9 ((uint16_t)0x0200)
+#define GPIO_PIN_10 ((uint16_t)0x0400)
+#define GPIO_PIN_11 ((uint16_t)0x0800)
+#define GPIO_PIN_12 ((uint16_t)0x1000)
+#define GPIO_PIN_13 ((uint16_t)0x2000)
+#define GPIO_PIN_14 ((uint16_t)0x4000)
+#define GPIO_PIN_15 ((uint16_t)0x8000)
+#define GPIO_PIN_All ((uint16_t)0xFFFF)
+
+// PR is write-one-to-clear on the device; see stm32f4xx.h.
+#define __HAL_GPIO_EXTI_GET_IT(__EXTI_LINE__) (EXTI->PR & (__EXTI_LINE__))
+#define __HAL_GPIO_EXTI_CLEAR_IT(__EXTI_LINE__)                              \
+  (EXTI->PR &= ~(uint32_t)(__EXTI_LINE__))
+
+typedef struct {
+  volatile uint32_t CR1;
+  volatile uint32_t CR2;
+  volatile uint32_t SMCR;
+  volatile uint32_t DIER;
+  volatile uint32_t SR;
+  volatile uint32_t EGR;
+  volatile uint32_t CCMR1;
+  volatile uint32_t CCMR2;
+  volatile uint32_t CCER;
+  volatile uint32_t CNT;
+  volatile uint32_t PSC;
+  volatile uint32_t ARR;
+  volatile uint32_t RCR;
+  volatile uint32_t CCR1;
+  volatile uint32_t CCR2;
+  volatile uint32_t CCR3;
+  volatile uint32_t CCR4;
+  volatile uint32_t BDTR;
+  volatile uint32_t DCR;
+  volatile uint32_t DMAR;
+  volatile uint32_t OR;
+} TIM_TypeDef;
+
+// Emulated timers TIM2 to TIM5 and TIM1, all clocked at SystemCoreClock.
+// CNT follows the virtual clock: it is brought up to date by
+// SPY_HAL_TIM_Sync(), which __HAL_TIM_GET_COUNTER() goes through, and each
+// overflow is a scheduled virtual clock event that sets UIF and, with UIE
+// set, runs HAL_TIM_IRQHandler() as TIMx_IRQHandler() would, or with UDE
+// set, raises the timer's DMA request. Writing EGR through
+// __HAL_TIM_GENERATE_EVENT() forces an update event at once. Time only
+// resolves to 1 ms, so overflows less than 1 ms apart raise one interrupt.
+// Like EXTI->PR, SR is write-zero-to-clear on the device; clear it through
+// __HAL_TIM_CLEAR_FLAG() or __HAL_TIM_CLEAR_IT().
+#define SPY_HAL_TIM_COUNT 5
+
+extern TIM_TypeDef SPY_HAL_TIM_Instances[SPY_HAL_TIM_COUNT];
+
+#define TIM2 (&SPY_HAL_TIM_Instances[0])
+#define TIM3 (&SPY_HAL_TIM_Instances[1])
+#define TIM4 (&SPY_HAL_TIM_Instances[2])
+#define TIM5 (&SPY_HAL_TIM_Instances[3])
+#define TIM1 (&SPY_HAL_TIM_Instances[4])
+
+#define TIM_CR1_CEN 0x0001U
+#define TIM_DIER_UIE 0x0001U
+#define TIM_DIER_UDE 0x0100U
+#define TIM_SR_UIF 0x0001U
+#define TIM_EGR_UG 0x0001U
+#define TIM_FLAG_UPDATE TIM_SR_UIF
+#define TIM_IT_UPDATE TIM_DIER_UIE
+#define TIM_DMA_UPDATE TIM_DIER_UDE
+#define TIM_EVENTSOURCE_UPDATE TIM_EGR_UG
+#define TIM_COUNTERMODE_UP 0x00000000U
+#define TIM_CLOCKDIVISION_DIV1 0x00000000U
+#define TIM_AUTORELOAD_PRELOAD_DISABLE 0x00000000U
+
+typedef struct {
+  uint32_t Prescaler;
+  uint32_t CounterMode;
+  uint32_t Period;
+  uint32_t ClockDivision;
+  uint32_t RepetitionCounter;
+  uint32_t AutoReloadPreload;
+} TIM_Base_InitTypeDef;
+
+typedef struct {
+  TIM_TypeDef *Instance;
+  TIM_Base_InitTypeDef Init;
+} TIM_HandleTypeDef;
+
+#define __HAL_TIM_GET_COUNTER(__HANDLE__)                                    \
+  (SPY_HAL_TIM_Sync((__HANDLE__)->Instance)->CNT)
+#define __HAL_TIM_SET_COUNTER(__HANDLE__, __COUNTER__)                       \
+  SPY_HAL_TIM_SetCounter((__HANDLE__)->Instance, (__COUNTER__))
+#define __HAL_TIM_GET_FLAG(__HANDLE__, __FLAG__)                             \
+  (((__HANDLE__)->Instance->SR & (__FLAG__)) == (__FLAG__))
+#define __HAL_TIM_CLEAR_FLAG(__HANDLE__, __FLAG__)                           \
+  ((__HANDLE__)->Instance->SR &= ~(uint32_t)(__FLAG__))
+#define __HAL_TIM_CLEAR_IT(__HANDLE__, __INTERRUPT__)                        \
+  ((__HANDLE__)->Instance->SR &= ~(uint32_t)(__INTERRUPT__))
+#define __HAL_TIM_ENABLE_DMA(__HANDLE__, __DMA__)                            \
+  ((__HANDLE__)->Instance->DIER |= (__DMA__))
+#define __HAL_TIM_DISABLE_DMA(__HANDLE__, __DMA__)                           \
+  ((__HANDLE__)->Instance->DIER &= ~(uint32_t)(__DMA__))
+#define __HAL_TIM_GENERATE_EVENT(__HANDLE__, __EVENT__)                      \
+  SPY_HAL_TIM_GenerateEvent((__HANDLE__)->Instance, (__EVENT__))
+
+// Emulated DMA2 streams, the only DMA controller that reaches the AHB1
+// GPIO ports on the F4. A stream is triggered by the timer request routed
+// to it (TIM1_UP is stream 5, channel 6) and moves one word per request,
+// memory to peripheral. Writes to a port's BSRR latch as the GPIO model's
+// do. Addresses are uintptr_t so they survive a 64-bit host; on the target
+// that is the HAL's uint32_t. NDTR is 16 bits wide, so HAL_DMA_Start()
+// fails longer transfers as the HAL's parameter check would.
+typedef struct {
+  volatile uint32_t CR;
+  volatile uint32_t NDTR;
+  volatile uintptr_t PAR;
+  volatile uintptr_t M0AR;
+  volatile uintptr_t M1AR;
+  volatile uint32_t FCR;
+} DMA_Stream_TypeDef;
+
+#define SPY_HAL_DMA_STREAM_COUNT 8
+
+extern DMA_Stream_TypeDef SPY_HAL_DMA2_Streams[SPY_HAL_DMA_STREAM_COUNT];
+
+#define DMA2_Stream0 (&SPY_HAL_DMA2_Streams[0])
+#define DMA2_Stream1 (&SPY_HAL_DMA2_Streams[1])
+#define DMA2_Stream2 (&SPY_HAL_DMA2_Streams[2])
+#define DMA2_Stream3 (&SPY_HAL_DMA2_Streams[3])
+#define DMA2_Stream4 (&SPY_HAL_DMA2_Streams[4])
+#define DMA2_Stream5 (&SPY_HAL_DMA2_Streams[5])
+#define DMA2_Stream6 (&SPY_HAL_DMA2_Streams[6])
+#define DMA2_Stream7 (&SPY_HAL_DMA2_Streams[7])
+
+#define DMA_SxCR_EN 0x00000001U
+#define DMA_SxCR_CIRC 0x00000100U
+#define DMA_SxCR_MINC 0x00000400U
+#define DMA_SxCR_CHSEL 0x0E000000U
+#define DMA_CHANNEL_6 0x0C000000U
+#define DMA_MEMORY_TO_PERIPH 0x00000040U
+#define DMA_PINC_DISABLE 0x00000000U
+#define DMA_MINC_ENABLE DMA_SxCR_MINC
+#define DMA_PDATAALIGN_WORD 0x00001000U
+#define DMA_MDATAALIGN_WORD 0x00004000U
+#define DMA_NORMAL 0x00000000U
+#define DMA_CIRCULAR DMA_SxCR_CIRC
+#define DMA_PRIORITY_HIGH 0x00020000U
+#define DMA_FIFOMODE_DISABLE 0x00000000U
+
+typedef struct {
+  uint32_t Channel;
+  uint32_t Direction;
+  uint32_t PeriphInc;
+  uint32_t MemInc;
+  uint32_t PeriphDataAlignment;
+  uint32_t MemDataAlignment;
+  uint32_t Mode;
+  uint32_t Priority;
+  uint32_t FIFOMode;
+} DMA_InitTypeDef;
+
+typedef struct {
+  DMA_Stream_TypeDef *Instance;
+  DMA_InitTypeDef Init;
+} DMA_HandleTypeDef;
+
+// Emulated USART1, USART2 and USART6. Transmits take as long on the
+// virtual clock as the frames would on the wire at the configured baud
+// rate: HAL_UART_Transmit() advances the clock by that much before it
+// returns, while HAL_UART_Transmit_DMA() returns at once and runs
+// HAL_UART_TxCpltCallback() as a scheduled event when the last frame has
+// gone out. A transfer started from that callback follows the previous
+// one without a gap, as it would on the board, so chained transfers reach
+// the line rate even though the clock only resolves to 1 ms. Everything
+// sent is captured per instance for the tests to decode, up to
+// SPY_HAL_UART_WIRE_CAPACITY bytes.
+typedef struct {
+  volatile uint32_t SR;
+  volatile uint32_t DR;
+  volatile uint32_t BRR;
+  volatile uint32_t CR1;
+  volatile uint32_t CR2;
+  volatile uint32_t CR3;
+  volatile uint32_t GTPR;
+} USART_TypeDef;
+
+#define SPY_HAL_USART_COUNT 3
+#define SPY_HAL_UART_WIRE_CAPACITY 65536U
+
+extern USART_TypeDef SPY_HAL_USART_Instances[SPY_HAL_USART_COUNT];
+
+#define USART1 (&SPY_HAL_USART_Instances[0])
+#define USART2 (&SPY_HAL_USART_Instances[1])
+#define USART6 (&SPY_HAL_USART_Instances[2])
+
+#define UART_WORDLENGTH_8B 0x00000000U
+#define UART_WORDLENGTH_9B 0x00001000U
+#define UART_STOPBITS_1 0x00000000U
+#define UART_STOPBITS_2 0x00002000U
+#define UART_PARITY_NONE 0x00000000U
+#define UART_MODE_TX 0x00000008U
+#define UART_MODE_TX_RX 0x0000000CU
+#define UART_HWCONTROL_NONE 0x00000000U
+#define UART_OVERSAMPLING_16 0x00000000U
+#define HAL_UART_ERROR_NONE 0x00000000U
+#define HAL_UART_ERROR_FE 0x00000004U
+#define HAL_UART_ERROR_DMA 0x00000010U
+
+typedef enum {
+  HAL_UART_STATE_RESET = 0x00U,
+  HAL_UART_STATE_READY = 0x20U,
+  HAL_UART_STATE_BUSY = 0x24U,
+  HAL_UART_STATE_BUSY_TX = 0x21U,
+  HAL_UART_STATE_ERROR = 0xE0U
+} HAL_UART_StateTypeDef;
+
+typedef struct {
+  uint32_t BaudRate;
+  uint32_t WordLength;
+  uint32_t StopBits;
+  uint32_t Parity;
+  uint32_t Mode;
+  uint32_t HwFlowCtl;
+  uint32_t OverSampling;
+} UART_InitTypeDef;
+
+typedef struct {
+  USART_TypeDef *Instance;
+  UART_InitTypeDef Init;
+  const uint8_t *pTxBuffPtr;
+  uint16_t TxXferSize;
+  volatile uint16_t TxXferCount;
+  DMA_HandleTypeDef *hdmatx;
+  volatile HAL_UART_StateTypeDef gState;
+  volatile uint32_t ErrorCode;
+} UART_HandleTypeDef;
+
+#define PWR_MAINREGULATOR_ON 0x00000000U
+#define PWR_LOWPOWERREGULATOR_ON 0x00000001U
+#define PWR_STOPENTRY_WFI ((uint8_t)0x01)
+#define PWR_STOPENTRY_WFE ((uint8_t)0x02)
+
+typedef uint32_t HAL_StatusTypeDef;
+#define HAL_OK 0x00U
+#define HAL_ERROR 0x01U
+#define HAL_BUSY 0x02U
+#define HAL_TIMEOUT 0x03U
+typedef enum { GPIO_PIN_RESET = 0, GPIO_PIN_SET } GPIO_PinState;
+
+HAL_StatusTypeDef HAL_Init(void);
+void SystemClock_Config(void);
+void MX_GPIO_Init(void);
+void MX_USART2_UART_Init(void);
+
+uint32_t HAL_GetTick(void);
+void HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin,
+                       GPIO_PinState PinState);
+void HAL_Delay(uint32_t Delay);
+void HAL_GPIO_EXTI_IRQHandler(uint16_t GPIO_Pin);
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin);
+void HAL_SuspendTick(void);
+void HAL_ResumeTick(void);
+void HAL_PWR_EnterSTOPMode(uint32_t Regulator, uint8_t STOPEntry);
+HAL_StatusTypeDef HAL_TIM_Base_Init(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Start(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Stop(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef *htim);
+void HAL_TIM_IRQHandler(TIM_HandleTypeDef *htim);
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim);
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_DMA_Start(DMA_HandleTypeDef *hdma, uintptr_t SrcAddress,
+                                uintptr_t DstAddress, uint32_t DataLength);
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_UART_Init(UART_HandleTypeDef *huart);
+HAL_StatusTypeDef HAL_UART_Transmit(UART_HandleTypeDef *huart,
+                                    const uint8_t *pData, uint16_t Size,
+                                    uint32_t Timeout);
+HAL_StatusTypeDef HAL_UART_Transmit_DMA(UART_HandleTypeDef *huart,
+                                        const uint8_t *pData, uint16_t Size);
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart);
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart);
+
+void SPY_HAL_setCurrentTicks(uint32_t ticks);
+void SPY_setCurrentTicks(uint32_t ticks);
+void SPY_HAL_GPIO_Reset(void);
+GPIO_TypeDef *SPY_HAL_GPIO_PortFromBase(uint32_t base);
+void SPY_HAL_GPIO_WriteBSRR(GPIO_TypeDef *GPIOx, uint32_t value);
+void SPY_HAL_GPIO_WritePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin,
+                           GPIO_PinState PinState);
+GPIO_PinState SPY_HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void SPY_HAL_GPIO_TogglePin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin);
+void SPY_HAL_GPIO_SetInputPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin,
+                              GPIO_PinState PinState);
+void SPY_HAL_GPIO_EXTI_Trigger(uint16_t GPIO_Pin);
+// Checks shared by the soak and preemption tests: whether the LED is lit,
+// and whether the firmware has kept clear of HAL_Delay() and of polling
+// the button since the last FAKE_clear().
+int SPY_HAL_ledLevel(void);
+int SPY_HAL_neverBlocks(void);
+// Presses or releases the push button, which pulls its pin low while
+// pressed, and runs isr for the edge as its EXTI line would when set to
+// trigger on both edges. Pass NULL to change the level only.
+void SPY_HAL_setButton(int pressed, void (*isr)(uint16_t GPIO_Pin));
+void SPY_HAL_GPIO_EXTI_Fire(uint16_t GPIO_Pins);
+void SPY_HAL_EXTI_IRQHandler(void);
+void SPY_HAL_TRACE_Stimulus(const TRACE_Record *record);
+void SPY_HAL_PWR_Reset(void);
+uint32_t SPY_HAL_PWR_StopCount(void);
+uint64_t SPY_HAL_PWR_StoppedMs(void);
+void SPY_HAL_TIM_Reset(void);
+TIM_TypeDef *SPY_HAL_TIM_Sync(TIM_TypeDef *TIMx);
+void SPY_HAL_TIM_SetCounter(TIM_TypeDef *TIMx, uint32_t counter);
+uint32_t SPY_HAL_TIM_UpdateCount(TIM_TypeDef *TIMx);
+void SPY_HAL_TIM_GenerateEvent(TIM_TypeDef *TIMx, uint32_t events);
+void SPY_HAL_DMA_Reset(void);
+void SPY_HAL_DMA_Request(TIM_TypeDef *TIMx);
+uint32_t SPY_HAL_DMA_TransferCount(DMA_Stream_TypeDef *stream);
+void SPY_HAL_UART_Reset(void);
+const uint8_t *SPY_HAL_UART_Wire(USART_TypeDef *USARTx, uint32_t *length);
+uint64_t SPY_HAL_UART_ByteCount(USART_TypeDef *USARTx);
+uint32_t SPY_HAL_UART_TransferCount(USART_TypeDef *USARTx);
+void SPY_HAL_UART_Error(UART_HandleTypeDef *huart, uint32_t errorCode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Main_H__ */
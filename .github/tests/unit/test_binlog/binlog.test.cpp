@@ -0,0 +1,256 @@
+#include "CppUTest/TestHarness.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+extern "C" {
+#include "binlog.h"
+#include "binlogdecode.h"
+#include "fake.h"
+#include "main.h"
+#include "report.h"
+#include "vclock.h"
+}
+
+#define LINES_MAX 64
+
+static BINLOGDECODE_Decoder *decoder = NULL;
+static char lines[LINES_MAX][BINLOGDECODE_TEXT_MAX];
+static uint32_t ticks[LINES_MAX];
+static uint32_t lineCount;
+static uint32_t words[BINLOG_CAPACITY];
+
+static void collect(void *context, uint32_t tick, const char *text) {
+  if (lineCount < LINES_MAX) {
+    ticks[lineCount] = tick;
+    snprintf(lines[lineCount], sizeof(lines[0]), "%s", text);
+  }
+  lineCount++;
+}
+
+// Everything logged so far, as the UART would carry it.
+static size_t drainBytes(uint8_t *bytes) {
+  uint32_t count = BINLOG_drain(words, BINLOG_CAPACITY);
+
+  memcpy(bytes, words, count * sizeof(uint32_t));
+  return count * sizeof(uint32_t);
+}
+
+static size_t decodeAll(void) {
+  static uint8_t bytes[BINLOG_CAPACITY * sizeof(uint32_t)];
+  size_t size = drainBytes(bytes);
+
+  return BINLOGDECODE_feed(decoder, bytes, size, collect, NULL);
+}
+
+extern "C" void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+  BINLOG("exti %04x", GPIO_Pin);
+}
+
+TEST_GROUP(Binlog) {
+  void setup() {
+    VCLOCK_reset();
+    FAKE_setEnabled(1);
+    BINLOG_reset();
+    decoder = BINLOGDECODE_create(__start_binlog,
+                                  (size_t)(__stop_binlog - __start_binlog));
+    lineCount = 0;
+  };
+  void teardown() {
+    BINLOGDECODE_destroy(decoder);
+    decoder = NULL;
+    FAKE_setEnabled(0);
+  };
+};
+
+TEST(Binlog, Round_trip_rebuilds_the_text) {
+  BINLOG("boot");
+  VCLOCK_advance(12);
+  BINLOG("button %u pressed, blinking %d", PUSH_BUTTON_Pin, -1);
+  BINLOG("%08x|%-4u|%c|%%|%5.3lu", 0xBEEFU, 7, 'A', 42UL);
+
+  UNSIGNED_LONGS_EQUAL(3, decodeAll());
+  STRCMP_EQUAL("boot", lines[0]);
+  UNSIGNED_LONGS_EQUAL(0, ticks[0]);
+  STRCMP_EQUAL("button 8192 pressed, blinking -1", lines[1]);
+  UNSIGNED_LONGS_EQUAL(12, ticks[1]);
+  STRCMP_EQUAL("0000beef|7   |A|%|  042", lines[2]);
+  UNSIGNED_LONGS_EQUAL(0, BINLOGDECODE_skipped(decoder));
+}
+
+TEST(Binlog, Frames_are_whole_words_with_the_id_in_the_header) {
+  BINLOG("two %u %u", 1, 2);
+
+  UNSIGNED_LONGS_EQUAL(4, BINLOG_drain(words, BINLOG_CAPACITY));
+  UNSIGNED_LONGS_EQUAL(BINLOG_SYNC, words[0] & 0xFFU);
+  UNSIGNED_LONGS_EQUAL(2, (words[0] >> 8) & 0xFFU);
+  STRCMP_EQUAL("two %u %u", __start_binlog + (words[0] >> 16));
+  UNSIGNED_LONGS_EQUAL(1, words[2]);
+  UNSIGNED_LONGS_EQUAL(2, words[3]);
+}
+
+TEST(Binlog, Logs_from_the_exti_callback) {
+  VCLOCK_advance(5);
+  SPY_HAL_GPIO_EXTI_Trigger(PUSH_BUTTON_Pin);
+  VCLOCK_advance(250);
+  SPY_HAL_GPIO_EXTI_Trigger(GPIO_PIN_0);
+
+  UNSIGNED_LONGS_EQUAL(2, decodeAll());
+  STRCMP_EQUAL("exti 2000", lines[0]);
+  UNSIGNED_LONGS_EQUAL(5, ticks[0]);
+  STRCMP_EQUAL("exti 0001", lines[1]);
+  UNSIGNED_LONGS_EQUAL(255, ticks[1]);
+}
+
+TEST(Binlog, Frames_split_across_feeds_are_reassembled) {
+  static uint8_t bytes[BINLOG_CAPACITY * sizeof(uint32_t)];
+
+  BINLOG("a %d", 1);
+  BINLOG("b %d %d %d %d", 1, 2, 3, 4);
+  size_t size = drainBytes(bytes);
+
+  for (size_t i = 0; i < size; i++) {
+    BINLOGDECODE_feed(decoder, &bytes[i], 1, collect, NULL);
+  }
+  UNSIGNED_LONGS_EQUAL(2, lineCount);
+  STRCMP_EQUAL("b 1 2 3 4", lines[1]);
+}
+
+TEST(Binlog, Noise_is_skipped_until_the_frames_line_up) {
+  static uint8_t bytes[BINLOG_CAPACITY * sizeof(uint32_t)];
+
+  BINLOG("lost %u", 1);
+  BINLOG("kept %u", 2);
+  size_t size = drainBytes(bytes);
+
+  // The capture starts 5 bytes into the first frame.
+  BINLOGDECODE_feed(decoder, bytes + 5, size - 5, collect, NULL);
+  UNSIGNED_LONGS_EQUAL(1, lineCount);
+  STRCMP_EQUAL("kept 2", lines[0]);
+  UNSIGNED_LONGS_EQUAL(7, BINLOGDECODE_skipped(decoder));
+}
+
+TEST(Binlog, A_full_ring_drops_whole_frames_and_counts_them) {
+  BINLOG_Stats stats;
+  uint32_t frames = BINLOG_CAPACITY / 6;
+
+  for (uint32_t i = 0; i < frames + 3; i++) {
+    BINLOG("frame %u %u %u %u", i, i, i, i);
+  }
+  BINLOG_stats(&stats);
+  UNSIGNED_LONGS_EQUAL(frames, stats.frames);
+  UNSIGNED_LONGS_EQUAL(3, stats.dropped);
+  UNSIGNED_LONGS_EQUAL(frames * 6, stats.highWater);
+
+  // A short frame still fits in what is left.
+  BINLOG("short");
+  UNSIGNED_LONGS_EQUAL(frames + 1, decodeAll());
+  STRCMP_EQUAL("short", lines[frames]);
+  UNSIGNED_LONGS_EQUAL(0, BINLOGDECODE_skipped(decoder));
+}
+
+TEST(Binlog, Dictionary_comes_from_the_elf) {
+  char *data;
+  size_t size;
+
+  LONGS_EQUAL(0, BINLOGDECODE_readSection("/proc/self/exe", "binlog", &data,
+                                          &size));
+  UNSIGNED_LONGS_EQUAL(__stop_binlog - __start_binlog, size);
+  MEMCMP_EQUAL(__start_binlog, data, size);
+  free(data);
+
+  BINLOGDECODE_Decoder *fromElf = BINLOGDECODE_fromElf("/proc/self/exe");
+  CHECK(fromElf != NULL);
+  BINLOG("from the elf %d", 3);
+  uint8_t bytes[3 * sizeof(uint32_t)];
+  UNSIGNED_LONGS_EQUAL(sizeof(bytes), drainBytes(bytes));
+  UNSIGNED_LONGS_EQUAL(1, BINLOGDECODE_feed(fromElf, bytes, sizeof(bytes),
+                                            collect, NULL));
+  STRCMP_EQUAL("from the elf 3", lines[0]);
+  BINLOGDECODE_destroy(fromElf);
+}
+
+TEST(Binlog, Missing_section_and_non_elf_files_are_reported) {
+  char *data;
+  size_t size;
+
+  LONGS_EQUAL(-1, BINLOGDECODE_readSection("/proc/self/exe", "nosuch",
+                                           &data, &size));
+  LONGS_EQUAL(ENOENT, errno);
+  LONGS_EQUAL(-1, BINLOGDECODE_readSection("makefile", "binlog", &data,
+                                           &size));
+  LONGS_EQUAL(ENOEXEC, errno);
+  POINTERS_EQUAL(NULL, BINLOGDECODE_fromElf("/nonexistent"));
+}
+
+TEST(Binlog, Dictionaries_over_64_KiB_are_refused) {
+  static char formats[BINLOGDECODE_DICTIONARY_MAX + 1];
+
+  memset(formats, 'x', sizeof(formats));
+  errno = 0;
+  POINTERS_EQUAL(NULL, BINLOGDECODE_create(formats, sizeof(formats)));
+  LONGS_EQUAL(EFBIG, errno);
+
+  BINLOGDECODE_Decoder *largest =
+      BINLOGDECODE_create(formats, BINLOGDECODE_DICTIONARY_MAX);
+  CHECK(largest != NULL);
+  BINLOGDECODE_destroy(largest);
+}
+
+TEST(Binlog, Formatting_without_the_firmware) {
+  const uint32_t args[] = {0xFFFFFFFFU, 0x1234U};
+  char text[32];
+
+  LONGS_EQUAL(2, BINLOGDECODE_conversions("%d%% of %x"));
+  LONGS_EQUAL(2, BINLOGDECODE_format("%d%% of %#x", args, 2, text,
+                                     sizeof(text)));
+  STRCMP_EQUAL("-1% of 0x1234", text);
+  LONGS_EQUAL(-1, BINLOGDECODE_format("%d %d %d", args, 2, text,
+                                      sizeof(text)));
+  LONGS_EQUAL(1, BINLOGDECODE_format("%s!", args, 2, text, sizeof(text)));
+  STRCMP_EQUAL("?!", text);
+  LONGS_EQUAL(0, BINLOGDECODE_format("100%", args, 0, text, sizeof(text)));
+  STRCMP_EQUAL("100%", text);
+  LONGS_EQUAL(1, BINLOGDECODE_format("%p", args + 1, 1, text, 5));
+  STRCMP_EQUAL("0x00", text);
+}
+
+TEST(Binlog, A_call_costs_well_under_a_microsecond) {
+  const uint32_t calls = 1000000;
+  char text[64];
+  struct timespec start, end;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < calls; i++) {
+    BINLOG("button %u pressed, blinking %d", PUSH_BUTTON_Pin, (int)(i & 1));
+    if ((i & 31) == 31) {
+      BINLOG_drain(words, BINLOG_CAPACITY);
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double binlogNs = ((double)(end.tv_sec - start.tv_sec) * 1e9 +
+                     (double)(end.tv_nsec - start.tv_nsec)) /
+                    calls;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (uint32_t i = 0; i < calls; i++) {
+    snprintf(text, sizeof(text), "%lu button %u pressed, blinking %d",
+             (unsigned long)HAL_GetTick(), PUSH_BUTTON_Pin, (int)(i & 1));
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  double snprintfNs = ((double)(end.tv_sec - start.tv_sec) * 1e9 +
+                       (double)(end.tv_nsec - start.tv_nsec)) /
+                      calls;
+
+  BINLOG_Stats stats;
+  BINLOG_stats(&stats);
+  UNSIGNED_LONGS_EQUAL(calls, stats.frames);
+  UNSIGNED_LONGS_EQUAL(0, stats.dropped);
+  REPORT_value("binlog_ns", binlogNs);
+  REPORT_value("snprintf_ns", snprintfNs);
+  REPORT_value("text_bytes", strlen(text) + 1);
+  CHECK(binlogNs < 1000.0);
+}
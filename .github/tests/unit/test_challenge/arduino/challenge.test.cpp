@@ -2,8 +2,10 @@
 #include "CppUTestExt/MockSupport.h"
 
 #include <stdexcept>
-#include <stdio.h>
 #include "Arduino.h"
+#include "fake.h"
+#include "trace.h"
+#include "vclock.h"
 
 // Arduino main functions prototypes
 extern void setup(void);
@@ -31,6 +33,11 @@ TEST_GROUP(Challenge){
         mock().checkExpectations();
         mock().clear();
     }
+
+    void teardown()
+    {
+        FAKE_setEnabled(0);
+    }
 // clang-format on
 }
 ;
@@ -96,4 +103,70 @@ TEST(Challenge, Toggle_LED_blinking_on_interrupt_loop)
         mock().checkExpectations();
         mock().clear();
     }
+}
+
+TEST(Challenge, Blink_for_an_hour_in_fast_mode)
+{
+    const uint64_t start = VCLOCK_now64();
+    uint32_t transitions = 0;
+
+    FAKE_setEnabled(1);
+    FAKE_clear();
+
+    interruptCallback();
+
+    int previous = SPY_getPinLevel(13);
+    while (VCLOCK_step(loop, start + 3600000ULL, 1))
+    {
+        int current = SPY_getPinLevel(13);
+
+        if (current != previous)
+        {
+            transitions++;
+            previous = current;
+        }
+    }
+
+    interruptCallback();
+    VCLOCK_run(loop, start + 3601000ULL, 1);
+
+    // Two toggles per second, give or take the edge when blinking starts.
+    CHECK(transitions >= 7199 && transitions <= 7201);
+    CHECK_EQUAL(LOW, SPY_getPinLevel(13));
+    CHECK(FAKE_callCount(FAKE_millis) > 0);
+    UNSIGNED_LONGS_EQUAL(0, FAKE_callCount(FAKE_digitalRead));
+    UNSIGNED_LONGS_EQUAL(0, FAKE_callCount(FAKE_delay));
+}
+
+TEST(Challenge, Replayed_trace_reproduces_LED_waveform)
+{
+    TRACE_Reader recorded;
+    TRACE_Reader replayed;
+
+    FAKE_setEnabled(1);
+
+    // Record: idle, start blinking, stop three seconds later.
+    const uint64_t start = VCLOCK_now64();
+    LONGS_EQUAL(0, TRACE_open("build/challenge.trace"));
+    VCLOCK_run(loop, start + 1000, 1);
+    SPY_triggerInterrupt();
+    VCLOCK_run(loop, start + 4000, 1);
+    SPY_triggerInterrupt();
+    VCLOCK_run(loop, start + 5000, 1);
+    TRACE_close();
+
+    // Replay the recorded presses and record the new waveform.
+    LONGS_EQUAL(0, TRACE_map(&recorded, "build/challenge.trace"));
+    LONGS_EQUAL(0, TRACE_open("build/challenge.replay.trace"));
+    TRACE_replay(&recorded, loop, SPY_traceStimulus, 1);
+    VCLOCK_run(loop, VCLOCK_now64() + 1000, 1);
+    TRACE_close();
+    LONGS_EQUAL(0, TRACE_map(&replayed, "build/challenge.replay.trace"));
+
+    CHECK(recorded.count > 6);
+    LONGS_EQUAL(recorded.count, replayed.count);
+    LONGS_EQUAL(-1, TRACE_diffOutputs(&recorded, &replayed, 0));
+
+    TRACE_unmap(&recorded);
+    TRACE_unmap(&replayed);
 }
\ No newline at end of file
@@ -3,7 +3,11 @@
 
 // STM32Cube app functions prototypes
 extern "C" {
+#include "fake.h"
 #include "main.h"
+#include "soak.h"
+#include "trace.h"
+#include "vclock.h"
 extern void setup(void);
 extern void loop(void);
 void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin);
@@ -11,10 +15,19 @@ void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin);
 
 static GPIO_PinState expectedPinState = GPIO_PIN_RESET;
 
+static void pressButton(void *context) {
+  HAL_GPIO_EXTI_Callback(PUSH_BUTTON_Pin);
+}
+
+// Every test starts at tick 0 with the LED off and leaves the app not
+// blinking, so app.c's own state carries nothing from one test to the next.
 TEST_GROUP(Challenge) {
   void setup() {
-    SPY_HAL_GPIO_WritePin(LED_GPIO_Port, LED_Pin, GPIO_PIN_RESET);
+    VCLOCK_reset();
+    SPY_HAL_GPIO_Reset();
+    FAKE_clear();
   };
+  void teardown() { FAKE_setEnabled(0); };
 };
 
 TEST(Challenge, Toggle_LED_blinking_on_interrupt_loop) {
@@ -101,4 +114,147 @@ TEST(Challenge, Toggle_LED_blinking_on_interrupt_loop) {
     mock().checkExpectations();
     mock().clear();
   }
-}
\ No newline at end of file
+}
+
+TEST(Challenge, Blink_across_tick_wrap) {
+  // Start 1.5 s before HAL_GetTick() wraps and let the virtual clock deliver
+  // both button presses; loop() is polled once per simulated millisecond.
+  const uint64_t start = 0x100000000ULL - 1500;
+  uint64_t lastToggle = 0;
+  uint32_t toggles = 0;
+
+  mock().expectNoCall("HAL_GPIO_ReadPin");
+  mock().expectNoCall("HAL_Delay");
+  mock().ignoreOtherCalls();
+
+  VCLOCK_setNow64(start);
+  VCLOCK_schedule(start + 100, pressButton, NULL);
+  VCLOCK_schedule(start + 4100, pressButton, NULL);
+
+  GPIO_PinState previous = SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin);
+  while (VCLOCK_step(::loop, start + 4000, 1)) {
+    GPIO_PinState current = SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin);
+
+    if (current != previous) {
+      if (toggles > 1) {
+        UNSIGNED_LONGS_EQUAL(500, VCLOCK_now64() - 1 - lastToggle);
+      }
+      lastToggle = VCLOCK_now64() - 1;
+      toggles++;
+      previous = current;
+    }
+  }
+
+  CHECK(toggles >= 7);
+
+  VCLOCK_run(::loop, start + 4500, 1);
+  CHECK_EQUAL(GPIO_PIN_RESET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+
+  mock().checkExpectations();
+  mock().clear();
+}
+
+TEST(Challenge, Blink_for_an_hour_in_fast_mode) {
+  const uint64_t start = VCLOCK_now64();
+  uint32_t transitions = 0;
+
+  FAKE_setEnabled(1);
+  FAKE_clear();
+
+  HAL_GPIO_EXTI_Callback(PUSH_BUTTON_Pin);
+
+  GPIO_PinState previous = SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin);
+  while (VCLOCK_step(::loop, start + 3600000ULL, 1)) {
+    GPIO_PinState current = SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin);
+
+    if (current != previous) {
+      transitions++;
+      previous = current;
+    }
+  }
+
+  HAL_GPIO_EXTI_Callback(PUSH_BUTTON_Pin);
+  VCLOCK_run(::loop, start + 3601000ULL, 1);
+
+  // Two toggles per second, give or take the edge when blinking starts.
+  CHECK(transitions >= 7199 && transitions <= 7201);
+  CHECK_EQUAL(GPIO_PIN_RESET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+  CHECK(FAKE_callCount(FAKE_HAL_GetTick) > 0);
+  UNSIGNED_LONGS_EQUAL(0, FAKE_callCount(FAKE_HAL_GPIO_ReadPin));
+  UNSIGNED_LONGS_EQUAL(0, FAKE_callCount(FAKE_HAL_Delay));
+}
+
+TEST(Challenge, Replayed_trace_reproduces_LED_waveform) {
+  TRACE_Reader recorded;
+  TRACE_Reader replayed;
+
+  FAKE_setEnabled(1);
+
+  // Record: idle, start blinking, stop three seconds later.
+  const uint64_t start = VCLOCK_now64();
+  LONGS_EQUAL(0, TRACE_open("build/challenge.trace"));
+  VCLOCK_run(::loop, start + 1000, 1);
+  SPY_HAL_GPIO_EXTI_Trigger(PUSH_BUTTON_Pin);
+  VCLOCK_run(::loop, start + 4000, 1);
+  SPY_HAL_GPIO_EXTI_Trigger(PUSH_BUTTON_Pin);
+  VCLOCK_run(::loop, start + 5000, 1);
+  TRACE_close();
+
+  // Replay the recorded presses and record the new waveform.
+  LONGS_EQUAL(0, TRACE_map(&recorded, "build/challenge.trace"));
+  LONGS_EQUAL(0, TRACE_open("build/challenge.replay.trace"));
+  TRACE_replay(&recorded, ::loop, SPY_HAL_TRACE_Stimulus, 1);
+  VCLOCK_run(::loop, VCLOCK_now64() + 1000, 1);
+  TRACE_close();
+  LONGS_EQUAL(0, TRACE_map(&replayed, "build/challenge.replay.trace"));
+
+  CHECK(recorded.count > 6);
+  LONGS_EQUAL(recorded.count, replayed.count);
+  LONGS_EQUAL(-1, TRACE_diffOutputs(&recorded, &replayed, 0));
+
+  TRACE_unmap(&recorded);
+  TRACE_unmap(&replayed);
+}
+
+TEST(Challenge, Reopened_trace_holds_only_the_new_run) {
+  TRACE_Reader reader;
+
+  LONGS_EQUAL(0, TRACE_open("build/challenge.reopen.trace"));
+  TRACE_record(TRACE_OUTPUT, 0, LED_Pin, LED_Pin);
+  TRACE_record(TRACE_OUTPUT, 0, LED_Pin, 0);
+  TRACE_close();
+
+  VCLOCK_setNow64(1000);
+  LONGS_EQUAL(0, TRACE_open("build/challenge.reopen.trace"));
+  TRACE_record(TRACE_INTERRUPT, 0, PUSH_BUTTON_Pin, 0);
+  TRACE_close();
+
+  LONGS_EQUAL(0, TRACE_map(&reader, "build/challenge.reopen.trace"));
+  UNSIGNED_LONGS_EQUAL(1000, reader.header->startTick);
+  UNSIGNED_LONGS_EQUAL(1, reader.count);
+  LONGS_EQUAL(TRACE_INTERRUPT, reader.records[0].kind);
+  TRACE_unmap(&reader);
+}
+
+static void startBlinking(void) { HAL_GPIO_EXTI_Callback(PUSH_BUTTON_Pin); }
+
+// Still stops right after the last wrap.
+static int stopsOnPress(void) {
+  HAL_GPIO_EXTI_Callback(PUSH_BUTTON_Pin);
+  VCLOCK_run(::loop, VCLOCK_now64() + 1000, 1);
+  return SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin) == GPIO_PIN_RESET;
+}
+
+// In a child process, so that app.c is left not blinking for the others.
+TEST(Challenge, Soak_blinking_across_three_tick_wraps) {
+  SOAK_Config config = {::loop, SPY_HAL_ledLevel, SPY_HAL_neverBlocks, 500,
+                        0, 3, startBlinking, stopsOnPress};
+  SOAK_Result result;
+
+  FAKE_setEnabled(1);
+  SOAK_runIsolated(&config, &result);
+
+  CHECK_TEXT(result.violation == SOAK_OK, SOAK_describe(&result));
+  UNSIGNED_LONGS_EQUAL(3, result.wraps);
+  CHECK(result.edges >= 3 * (0x100000000ULL / 500) - 1);
+}
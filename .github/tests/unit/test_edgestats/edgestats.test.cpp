@@ -0,0 +1,156 @@
+#include "CppUTest/TestHarness.h"
+
+#include <stdio.h>
+
+extern "C" {
+#include "edgestats.h"
+#include "trace.h"
+#include "vclock.h"
+}
+
+#include "edgestats.hpp"
+
+static EDGESTATS_Stats *stats = NULL;
+static EDGESTATS_Summary summary;
+
+static void squareWave(uint64_t start, uint64_t period, uint64_t high,
+                       int cycles) {
+  for (int i = 0; i < cycles; i++) {
+    EDGESTATS_edge(stats, start + i * period, 1);
+    EDGESTATS_edge(stats, start + i * period + high, 0);
+  }
+}
+
+TEST_GROUP(EdgeStats) {
+  void setup() { stats = EDGESTATS_create(1000000, 150000); };
+  void teardown() {
+    EDGESTATS_destroy(stats);
+    stats = NULL;
+  };
+};
+
+TEST(EdgeStats, Square_wave_period_and_duty) {
+  squareWave(0, 1000000, 500000, 10);
+  EDGESTATS_summary(stats, &summary);
+
+  UNSIGNED_LONGS_EQUAL(20, summary.edges);
+  UNSIGNED_LONGS_EQUAL(18, summary.periods);
+  UNSIGNED_LONGS_EQUAL(0, summary.missedEdges);
+  UNSIGNED_LONGS_EQUAL(18, summary.inTolerance);
+  UNSIGNED_LONGS_EQUAL(1000000, summary.periodMinUs);
+  UNSIGNED_LONGS_EQUAL(1000000, summary.periodMaxUs);
+  DOUBLES_EQUAL(1000000.0, summary.periodMeanUs, 1e-6);
+  DOUBLES_EQUAL(0.0, summary.periodStdDevUs, 1e-6);
+  DOUBLES_EQUAL(0.5, summary.dutyMean, 1e-9);
+  DOUBLES_EQUAL(1000000.0, summary.fittedPeriodUs, 1e-3);
+  DOUBLES_EQUAL(0.0, summary.driftPpm, 1e-6);
+  UNSIGNED_LONGS_EQUAL(0, EDGESTATS_jitterPercentile(stats, 99.0));
+}
+
+TEST(EdgeStats, Duty_cycle_follows_high_time) {
+  squareWave(0, 1000000, 250000, 10);
+  EDGESTATS_summary(stats, &summary);
+
+  DOUBLES_EQUAL(0.25, summary.dutyMean, 1e-9);
+}
+
+TEST(EdgeStats, Jitter_percentiles) {
+  uint64_t t = 0;
+
+  // 90 periods 20 us late and 10 periods 300 us late
+  for (int i = 0; i < 101; i++) {
+    EDGESTATS_edge(stats, t, 1);
+    t += i % 10 == 9 ? 1000300 : 1000020;
+  }
+  EDGESTATS_summary(stats, &summary);
+
+  UNSIGNED_LONGS_EQUAL(100, summary.periods);
+  UNSIGNED_LONGS_EQUAL(20, EDGESTATS_jitterPercentile(stats, 50.0));
+  UNSIGNED_LONGS_EQUAL(20, EDGESTATS_jitterPercentile(stats, 90.0));
+  uint64_t p99 = EDGESTATS_jitterPercentile(stats, 99.0);
+  CHECK(p99 >= 300 && p99 <= 300 + 300 / 32);
+  UNSIGNED_LONGS_EQUAL(1000300, summary.periodMaxUs);
+}
+
+TEST(EdgeStats, Out_of_tolerance_periods) {
+  EDGESTATS_edge(stats, 0, 1);
+  EDGESTATS_edge(stats, 1100000, 1);
+  EDGESTATS_edge(stats, 2300000, 1);
+  EDGESTATS_summary(stats, &summary);
+
+  UNSIGNED_LONGS_EQUAL(2, summary.periods);
+  UNSIGNED_LONGS_EQUAL(1, summary.inTolerance);
+}
+
+TEST(EdgeStats, Missed_edges) {
+  squareWave(0, 1000000, 500000, 3);
+  // One whole cycle lost, then a falling edge lost
+  squareWave(4000000, 1000000, 500000, 1);
+  EDGESTATS_edge(stats, 5000000, 1);
+  EDGESTATS_edge(stats, 6000000, 1);
+  EDGESTATS_edge(stats, 6500000, 0);
+  EDGESTATS_summary(stats, &summary);
+
+  UNSIGNED_LONGS_EQUAL(3, summary.missedEdges);
+  DOUBLES_EQUAL(1000000.0, summary.periodMeanUs, 1e-6);
+  DOUBLES_EQUAL(1000000.0, summary.fittedPeriodUs, 1e-3);
+}
+
+TEST(EdgeStats, Drift_from_slow_clock) {
+  squareWave(0, 1000100, 500050, 1000);
+  EDGESTATS_summary(stats, &summary);
+
+  DOUBLES_EQUAL(100.0, summary.driftPpm, 1e-3);
+  UNSIGNED_LONGS_EQUAL(100, EDGESTATS_jitterPercentile(stats, 50.0));
+}
+
+TEST(EdgeStats, Period_to_period_jitter_without_nominal) {
+  EDGESTATS_Stats *free = EDGESTATS_create(0, 10);
+
+  EDGESTATS_edge(free, 0, 1);
+  EDGESTATS_edge(free, 700, 1);
+  EDGESTATS_edge(free, 1405, 1);
+  EDGESTATS_edge(free, 2130, 1);
+  EDGESTATS_summary(free, &summary);
+
+  UNSIGNED_LONGS_EQUAL(3, summary.periods);
+  UNSIGNED_LONGS_EQUAL(3, summary.missedEdges);
+  UNSIGNED_LONGS_EQUAL(1, summary.inTolerance);
+  UNSIGNED_LONGS_EQUAL(20, EDGESTATS_jitterPercentile(free, 100.0));
+  DOUBLES_EQUAL(0.0, summary.driftPpm, 1e-9);
+  EDGESTATS_destroy(free);
+}
+
+TEST(EdgeStats, Histogram_buckets_bound_the_value) {
+  uint64_t values[] = {0, 1, 63, 64, 65, 1000, 1000000, 123456789012ULL,
+                       UINT64_MAX};
+
+  for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+    int bucket = Histogram::bucketOf(values[i]);
+    CHECK(bucket < Histogram::BUCKETS);
+    uint64_t upper = Histogram::bucketUpper(bucket);
+    CHECK(upper >= values[i]);
+    CHECK(upper - values[i] <= values[i] / Histogram::SUB_BUCKETS);
+  }
+}
+
+TEST(EdgeStats, Feed_mock_trace) {
+  TRACE_Record records[8];
+  memset(records, 0, sizeof(records));
+  for (int i = 0; i < 8; i++) {
+    records[i].tick = 1000 + i * 500;
+    records[i].port = 0;
+    records[i].pins = 0x0020;
+    records[i].levels = i % 2 == 0 ? 0x0020 : 0;
+    records[i].kind = TRACE_OUTPUT;
+  }
+  // Other lines and kinds are skipped
+  records[3].kind = TRACE_INTERRUPT;
+  records[5].port = 2;
+
+  UNSIGNED_LONGS_EQUAL(6, EDGESTATS_feedTrace(stats, records, 8, 0, 0x0020));
+  EDGESTATS_summary(stats, &summary);
+
+  UNSIGNED_LONGS_EQUAL(6, summary.edges);
+  UNSIGNED_LONGS_EQUAL(2, summary.missedEdges);
+}
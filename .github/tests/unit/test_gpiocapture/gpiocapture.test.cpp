@@ -0,0 +1,177 @@
+#include "CppUTest/TestHarness.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "gpiocapture.hpp"
+
+static GPIOCAPTURE_Edge edgeAt(uint64_t timeNs, uint32_t seqno) {
+  GPIOCAPTURE_Edge edge = {timeNs, seqno, 17, (uint8_t)(seqno & 1), 0};
+
+  return edge;
+}
+
+static GPIOCAPTURE_Edge out[GPIOCAPTURE_RING_EDGES + 1];
+
+TEST_GROUP(EdgeRing) { EdgeRing<8> ring; };
+
+TEST(EdgeRing, Pops_in_order_across_the_wrap) {
+  for (uint32_t i = 0; i < 6; i++) {
+    CHECK(ring.push(edgeAt(i, i)));
+  }
+  UNSIGNED_LONGS_EQUAL(4, ring.pop(out, 4));
+  for (uint32_t i = 6; i < 12; i++) {
+    CHECK(ring.push(edgeAt(i, i)));
+  }
+
+  UNSIGNED_LONGS_EQUAL(8, ring.size());
+  UNSIGNED_LONGS_EQUAL(8, ring.pop(out, 100));
+  for (uint32_t i = 0; i < 8; i++) {
+    UNSIGNED_LONGS_EQUAL(i + 4, out[i].timeNs);
+  }
+  UNSIGNED_LONGS_EQUAL(0, ring.pop(out, 100));
+}
+
+TEST(EdgeRing, Refuses_edges_when_full) {
+  for (uint32_t i = 0; i < 8; i++) {
+    CHECK(ring.push(edgeAt(i, i)));
+  }
+
+  CHECK_FALSE(ring.push(edgeAt(8, 8)));
+  UNSIGNED_LONGS_EQUAL(1, ring.pop(out, 1));
+  CHECK(ring.push(edgeAt(8, 8)));
+}
+
+static EdgeRing<64> shared;
+static const uint64_t HANDED_OVER = 200000;
+
+static void *produce(void *unused) {
+  for (uint64_t i = 0; i < HANDED_OVER; i++) {
+    while (!shared.push(edgeAt(i, (uint32_t)i))) {
+      sched_yield();
+    }
+  }
+  return NULL;
+}
+
+TEST(EdgeRing, Hands_edges_across_threads_in_order) {
+  pthread_t producer;
+  uint64_t next = 0;
+  GPIOCAPTURE_Edge batch[16];
+
+  pthread_create(&producer, NULL, produce, NULL);
+  while (next < HANDED_OVER) {
+    size_t count = shared.pop(batch, 16);
+
+    if (count == 0) {
+      sched_yield();
+    }
+    for (size_t i = 0; i < count; i++) {
+      if (batch[i].timeNs != next) {
+        UNSIGNED_LONGS_EQUAL(next, batch[i].timeNs);
+      }
+      next++;
+    }
+  }
+  pthread_join(producer, NULL);
+
+  UNSIGNED_LONGS_EQUAL(0, shared.size());
+}
+
+TEST_GROUP(EdgeRecorder) {
+  EdgeRecorder *recorder;
+  char path[32];
+
+  void setup() {
+    recorder = new EdgeRecorder();
+    snprintf(path, sizeof(path), "/tmp/gpiocapture-XXXXXX");
+    close(mkstemp(path));
+  };
+  void teardown() {
+    delete recorder;
+    unlink(path);
+  };
+
+  long fileSize() {
+    FILE *file = fopen(path, "rb");
+    long size = 0;
+
+    fseek(file, 0, SEEK_END);
+    size = ftell(file);
+    fclose(file);
+    return size;
+  }
+};
+
+TEST(EdgeRecorder, Counts_gaps_in_the_kernel_sequence) {
+  GPIOCAPTURE_Edge edges[] = {edgeAt(0, 1), edgeAt(1, 2), edgeAt(2, 5),
+                              edgeAt(3, 6)};
+
+  recorder->record(edges, 2);
+  recorder->record(edges + 2, 2);
+
+  UNSIGNED_LONGS_EQUAL(2, recorder->kernelDropped());
+  UNSIGNED_LONGS_EQUAL(4, recorder->read(out, 10));
+}
+
+TEST(EdgeRecorder, Sequence_gaps_survive_the_wrap) {
+  GPIOCAPTURE_Edge edges[] = {edgeAt(0, 0xfffffffe), edgeAt(1, 0xffffffff),
+                              edgeAt(2, 0), edgeAt(3, 2)};
+
+  recorder->record(edges, 4);
+
+  UNSIGNED_LONGS_EQUAL(1, recorder->kernelDropped());
+}
+
+TEST(EdgeRecorder, File_keeps_what_a_full_ring_drops) {
+  static GPIOCAPTURE_Edge edges[GPIOCAPTURE_RING_EDGES + 10];
+  GPIOCAPTURE_Header header;
+
+  for (uint32_t i = 0; i < GPIOCAPTURE_RING_EDGES + 10; i++) {
+    edges[i] = edgeAt(i, i + 1);
+  }
+  LONGS_EQUAL(0, recorder->open(path, 1234, 2));
+  recorder->record(edges, GPIOCAPTURE_RING_EDGES + 10);
+
+  UNSIGNED_LONGS_EQUAL(10, recorder->ringDropped());
+  UNSIGNED_LONGS_EQUAL(0, recorder->kernelDropped());
+  UNSIGNED_LONGS_EQUAL(GPIOCAPTURE_RING_EDGES,
+                       recorder->read(out, GPIOCAPTURE_RING_EDGES + 1));
+  UNSIGNED_LONGS_EQUAL(GPIOCAPTURE_RING_EDGES - 1,
+                       out[GPIOCAPTURE_RING_EDGES - 1].timeNs);
+
+  LONGS_EQUAL(sizeof(header) +
+                  (GPIOCAPTURE_RING_EDGES + 10) * sizeof(GPIOCAPTURE_Edge),
+              fileSize());
+  FILE *file = fopen(path, "rb");
+  UNSIGNED_LONGS_EQUAL(1, fread(&header, sizeof(header), 1, file));
+  fseek(file, -(long)sizeof(GPIOCAPTURE_Edge), SEEK_END);
+  UNSIGNED_LONGS_EQUAL(1, fread(out, sizeof(GPIOCAPTURE_Edge), 1, file));
+  fclose(file);
+  UNSIGNED_LONGS_EQUAL(GPIOCAPTURE_MAGIC, header.magic);
+  UNSIGNED_LONGS_EQUAL(GPIOCAPTURE_VERSION, header.version);
+  UNSIGNED_LONGS_EQUAL(16, header.recordSize);
+  UNSIGNED_LONGS_EQUAL(1234, header.startNs);
+  UNSIGNED_LONGS_EQUAL(2, header.lineCount);
+  UNSIGNED_LONGS_EQUAL(GPIOCAPTURE_RING_EDGES + 9, out[0].timeNs);
+}
+
+TEST(EdgeRecorder, Records_to_the_ring_only_without_a_path) {
+  GPIOCAPTURE_Edge edge = edgeAt(42, 1);
+
+  LONGS_EQUAL(0, recorder->open(NULL, 0, 1));
+  recorder->record(&edge, 1);
+
+  UNSIGNED_LONGS_EQUAL(1, recorder->read(out, 1));
+  UNSIGNED_LONGS_EQUAL(42, out[0].timeNs);
+  LONGS_EQUAL(0, fileSize());
+}
+
+TEST(EdgeRecorder, Open_reports_the_error) {
+  LONGS_EQUAL(-1, recorder->open("/nonexistent/edges.gcap", 0, 1));
+  LONGS_EQUAL(ENOENT, errno);
+}
@@ -0,0 +1,162 @@
+#include "CppUTest/TestHarness.h"
+
+#include "Arduino.h"
+#include "blinker.hpp"
+#include "fake.h"
+#include "vclock.h"
+#include <string.h>
+#include <type_traits>
+
+#define LED_PIN 13
+#define HEARTBEAT_PIN 12
+#define BUTTON_PIN 23
+
+typedef BLINKER::Blinker<LED_PIN, 500> Led;
+typedef BLINKER::Blinker<HEARTBEAT_PIN, 1000> Heartbeat;
+typedef BLINKER::Button<BUTTON_PIN, FALLING> Button;
+
+static_assert(sizeof(Led) <= sizeof(unsigned long) + sizeof(unsigned long),
+              "a blinker is its timestamp and level");
+static_assert(!std::is_polymorphic<Led>::value, "no virtual dispatch");
+static_assert(std::is_empty<Button>::value, "a button holds no state");
+static_assert(Led::periodMs == 500 && Button::mode == FALLING,
+              "constants are visible at compile time");
+
+static unsigned long previousMillis;
+static bool stateLED;
+
+// A hand-written toggle that writes only when the LED changes.
+static void handwritten(unsigned long now)
+{
+    if (now - previousMillis >= 500)
+    {
+        previousMillis = now;
+        stateLED = !stateLED;
+        digitalWrite(LED_PIN, stateLED);
+    }
+}
+
+static Led led;
+static uint32_t presses = 0;
+
+static void onPress()
+{
+    presses++;
+}
+
+TEST_GROUP(Blinker)
+{
+    void setup()
+    {
+        VCLOCK_reset();
+        SPY_resetInterrupts();
+        SPY_setPinLevel(LED_PIN, LOW);
+        SPY_setPinLevel(HEARTBEAT_PIN, LOW);
+        SPY_setPinLevel(BUTTON_PIN, HIGH);
+        FAKE_setEnabled(1);
+        FAKE_clear();
+        previousMillis = 0;
+        stateLED = LOW;
+        presses = 0;
+        led = Led();
+    }
+
+    void teardown()
+    {
+        FAKE_setEnabled(0);
+    }
+};
+
+TEST(Blinker, Begin_drives_the_led_low)
+{
+    SPY_setPinLevel(LED_PIN, HIGH);
+
+    led.begin();
+
+    UNSIGNED_LONGS_EQUAL(1, FAKE_callCount(FAKE_pinMode));
+    CHECK_EQUAL(LOW, SPY_getPinLevel(LED_PIN));
+}
+
+TEST(Blinker, Toggles_every_period)
+{
+    led.begin();
+    led.run(499);
+    CHECK_EQUAL(LOW, SPY_getPinLevel(LED_PIN));
+    led.run(500);
+    CHECK_EQUAL(HIGH, SPY_getPinLevel(LED_PIN));
+    led.run(1000);
+    CHECK_EQUAL(LOW, SPY_getPinLevel(LED_PIN));
+}
+
+TEST(Blinker, Start_and_stop)
+{
+    led.begin();
+    led.start(1234);
+    CHECK_EQUAL(HIGH, SPY_getPinLevel(LED_PIN));
+    led.run(1733);
+    CHECK_EQUAL(HIGH, SPY_getPinLevel(LED_PIN));
+    led.run(1734);
+    CHECK_EQUAL(LOW, SPY_getPinLevel(LED_PIN));
+
+    led.start(2000);
+    led.stop();
+    CHECK_EQUAL(LOW, SPY_getPinLevel(LED_PIN));
+}
+
+TEST(Blinker, Instances_are_independent)
+{
+    Heartbeat heartbeat;
+
+    led.begin();
+    heartbeat.begin();
+    for (unsigned long now = 0; now <= 3000; now++)
+    {
+        led.run(now);
+        heartbeat.run(now);
+    }
+
+    CHECK_EQUAL(LOW, SPY_getPinLevel(LED_PIN));
+    CHECK_EQUAL(HIGH, SPY_getPinLevel(HEARTBEAT_PIN));
+    UNSIGNED_LONGS_EQUAL(2 + 6 + 3, FAKE_callCount(FAKE_digitalWrite));
+}
+
+// Same calls with the same arguments on the same ticks as the hand-written
+// toggle.
+TEST(Blinker, Matches_the_handwritten_toggle)
+{
+    FAKE_Call expected[64];
+    uint32_t count;
+
+    for (unsigned long now = 0; now < 20000; now += 7)
+    {
+        VCLOCK_setNow(now);
+        handwritten(now);
+    }
+    count = FAKE_logSize();
+    CHECK(count > 0 && count <= 64);
+    memcpy(expected, FAKE_logAt(0), count * sizeof(FAKE_Call));
+
+    FAKE_clear();
+    for (unsigned long now = 0; now < 20000; now += 7)
+    {
+        VCLOCK_setNow(now);
+        led.run(now);
+    }
+    UNSIGNED_LONGS_EQUAL(count, FAKE_logSize());
+    MEMCMP_EQUAL(expected, FAKE_logAt(0), count * sizeof(FAKE_Call));
+}
+
+TEST(Blinker, Button_attaches_on_its_edge)
+{
+    Button::attach(onPress);
+
+    POINTERS_EQUAL((void *)onPress,
+                   (void *)SPY_getInterruptCallback(BUTTON_PIN));
+    UNSIGNED_LONGS_EQUAL(FALLING, SPY_getInterruptMode(BUTTON_PIN));
+    SPY_toggleInputPin(BUTTON_PIN, 4);
+    UNSIGNED_LONGS_EQUAL(2, presses);
+
+    Button::detach();
+    SPY_toggleInputPin(BUTTON_PIN, 4);
+    UNSIGNED_LONGS_EQUAL(2, presses);
+}
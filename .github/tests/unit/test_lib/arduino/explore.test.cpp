@@ -0,0 +1,139 @@
+#include "CppUTest/TestHarness.h"
+
+#include "Arduino.h"
+#include "apps.h"
+#include "debounce.h"
+#include "explore.h"
+#include "fake.h"
+#include "scheduler.h"
+#include "vclock.h"
+
+// The interrupts lab with a press flag: the racy loop clears the flag
+// after acting on it, so a press that lands on digitalWrite() is lost;
+// the fixed one clears it first.
+static volatile bool buttonPressed = false;
+static bool stateLED = LOW;
+static uint32_t steps = 0;
+static uint32_t pressedAt = 0;
+static uint32_t servedAt = 0;
+
+static void onPress(void)
+{
+    buttonPressed = true;
+    pressedAt = ++steps;
+}
+
+static void flagSetup(void)
+{
+    VCLOCK_reset();
+    SPY_resetInterrupts();
+    buttonPressed = false;
+    stateLED = LOW;
+    steps = 0;
+    pressedAt = 0;
+    servedAt = 0;
+    attachInterrupt(digitalPinToInterrupt(PUSH_BUTTON), onPress, FALLING);
+}
+
+static void racyLoop(void)
+{
+    millis();
+    if (buttonPressed)
+    {
+        servedAt = ++steps;
+        stateLED = !stateLED;
+        digitalWrite(LED, stateLED);
+        buttonPressed = false;
+    }
+}
+
+static void fixedLoop(void)
+{
+    millis();
+    if (buttonPressed)
+    {
+        servedAt = ++steps;
+        buttonPressed = false;
+        stateLED = !stateLED;
+        digitalWrite(LED, stateLED);
+    }
+}
+
+// Two presses before loop() gets to the first make one toggle by design,
+// so rather than counting presses, the last one must have been served.
+static int lastPressServed(void)
+{
+    return servedAt >= pressedAt;
+}
+
+// The lib challenge app, with every press a clean tap far enough from the
+// last to pass the debounce: every press must start or stop the blink job.
+static void challengeSetup(void)
+{
+    VCLOCK_reset();
+    SPY_resetInterrupts();
+    SPY_setPinLevel(PUSH_BUTTON, HIGH);
+    CHALLENGE_setup();
+}
+
+static void challengeTap(void)
+{
+    SPY_setPinLevel(PUSH_BUTTON, LOW);
+    SPY_setPinLevel(PUSH_BUTTON, HIGH);
+}
+
+static void challengeLoop(void)
+{
+    CHALLENGE_loop();
+    VCLOCK_advance(DEBOUNCE_QUIET_MS);
+}
+
+static int blinksPerPress(void)
+{
+    return SCHEDULER_pending() == (EXPLORE_injected() & 1);
+}
+
+TEST_GROUP(Explore)
+{
+    EXPLORE_Result result;
+
+    void setup()
+    {
+        FAKE_setEnabled(1);
+    }
+
+    void teardown()
+    {
+        FAKE_setEnabled(0);
+    }
+};
+
+TEST(Explore, Finds_the_press_lost_while_clearing_the_flag)
+{
+    EXPLORE_Config config = {flagSetup, racyLoop, SPY_triggerInterrupt,
+                             lastPressServed, 3, 1, 2};
+
+    CHECK(EXPLORE_run(&config, &result) > 0);
+    UNSIGNED_LONGS_EQUAL(0, result.crashes);
+    UNSIGNED_LONGS_EQUAL(2, result.failedDepth);
+    LONGS_EQUAL(FAKE_millis, result.failedApi[0]);
+    LONGS_EQUAL(FAKE_digitalWrite, result.failedApi[1]);
+}
+
+TEST(Explore, Clearing_the_flag_first_survives_every_interleaving)
+{
+    EXPLORE_Config config = {flagSetup, fixedLoop, SPY_triggerInterrupt,
+                             lastPressServed, 3, 1, 2};
+
+    UNSIGNED_LONGS_EQUAL(0, EXPLORE_run(&config, &result));
+    CHECK(result.runs > result.points);
+}
+
+TEST(Explore, Challenge_app_acts_on_a_press_at_any_point)
+{
+    EXPLORE_Config config = {challengeSetup, challengeLoop, challengeTap,
+                             blinksPerPress, 4, 2, 1};
+
+    UNSIGNED_LONGS_EQUAL(0, EXPLORE_run(&config, &result));
+    CHECK(result.points >= 4);
+}
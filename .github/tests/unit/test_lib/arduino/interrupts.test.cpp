@@ -0,0 +1,173 @@
+#include "CppUTest/TestHarness.h"
+
+#include "Arduino.h"
+#include "apps.h"
+#include "bounce.h"
+#include "debounce.h"
+#include "fake.h"
+#include "scheduler.h"
+#include "vclock.h"
+
+#define INPUT_PIN 7
+#define OTHER_PIN 8
+
+static uint32_t fired = 0;
+static uint32_t otherFired = 0;
+static int levelSeen = -1;
+
+static void onEdge(void)
+{
+    fired++;
+    levelSeen = digitalRead(INPUT_PIN);
+}
+
+static void onOther(void)
+{
+    otherFired++;
+}
+
+TEST_GROUP(PinInterrupts)
+{
+    void setup()
+    {
+        VCLOCK_reset();
+        SPY_resetInterrupts();
+        SPY_setPinLevel(INPUT_PIN, HIGH);
+        SPY_setPinLevel(OTHER_PIN, HIGH);
+        fired = 0;
+        otherFired = 0;
+        levelSeen = -1;
+        FAKE_setEnabled(1);
+    }
+
+    void teardown()
+    {
+        FAKE_setEnabled(0);
+    }
+};
+
+TEST(PinInterrupts, Falling_fires_on_high_to_low_only)
+{
+    attachInterrupt(digitalPinToInterrupt(INPUT_PIN), onEdge, FALLING);
+
+    SPY_setPinLevel(INPUT_PIN, HIGH);
+    SPY_setPinLevel(INPUT_PIN, LOW);
+    SPY_setPinLevel(INPUT_PIN, LOW);
+    SPY_setPinLevel(INPUT_PIN, HIGH);
+
+    UNSIGNED_LONGS_EQUAL(1, fired);
+    CHECK_EQUAL(LOW, levelSeen);
+}
+
+TEST(PinInterrupts, Rising_and_change)
+{
+    attachInterrupt(INPUT_PIN, onEdge, RISING);
+    attachInterrupt(OTHER_PIN, onOther, CHANGE);
+
+    SPY_toggleInputPin(INPUT_PIN, 10);
+    SPY_toggleInputPin(OTHER_PIN, 10);
+
+    UNSIGNED_LONGS_EQUAL(5, fired);
+    CHECK_EQUAL(HIGH, levelSeen);
+    UNSIGNED_LONGS_EQUAL(10, otherFired);
+    UNSIGNED_LONGS_EQUAL(15, SPY_getInterruptCount());
+}
+
+TEST(PinInterrupts, Low_level_keeps_firing)
+{
+    attachInterrupt(INPUT_PIN, onEdge, LOW);
+
+    SPY_setPinLevel(INPUT_PIN, LOW);
+    SPY_setPinLevel(INPUT_PIN, LOW);
+    SPY_setPinLevel(INPUT_PIN, HIGH);
+
+    UNSIGNED_LONGS_EQUAL(2, fired);
+}
+
+TEST(PinInterrupts, Handlers_are_per_pin)
+{
+    attachInterrupt(INPUT_PIN, onEdge, FALLING);
+    attachInterrupt(OTHER_PIN, onOther, FALLING);
+    POINTERS_EQUAL((void *)onEdge, (void *)SPY_getInterruptCallback(INPUT_PIN));
+    UNSIGNED_LONGS_EQUAL(FALLING, SPY_getInterruptMode(OTHER_PIN));
+
+    SPY_setPinLevel(OTHER_PIN, LOW);
+
+    UNSIGNED_LONGS_EQUAL(0, fired);
+    UNSIGNED_LONGS_EQUAL(1, otherFired);
+}
+
+TEST(PinInterrupts, Detached_pins_stay_quiet)
+{
+    attachInterrupt(INPUT_PIN, onEdge, CHANGE);
+    SPY_toggleInputPin(INPUT_PIN, 2);
+    detachInterrupt(INPUT_PIN);
+
+    SPY_toggleInputPin(INPUT_PIN, 2);
+    SPY_triggerInterrupt();
+
+    UNSIGNED_LONGS_EQUAL(2, fired);
+    POINTERS_EQUAL(nullptr, (void *)SPY_getStoredInterruptCallback());
+}
+
+TEST(PinInterrupts, Scheduled_levels_fire_at_their_time)
+{
+    attachInterrupt(INPUT_PIN, onEdge, FALLING);
+
+    CHECK(SPY_schedulePinLevel(100, INPUT_PIN, LOW) >= 0);
+    CHECK(SPY_schedulePinLevel(300, INPUT_PIN, HIGH) >= 0);
+    VCLOCK_advanceTo(99);
+    UNSIGNED_LONGS_EQUAL(0, fired);
+    VCLOCK_advanceTo(100);
+    UNSIGNED_LONGS_EQUAL(1, fired);
+    VCLOCK_advanceTo(1000);
+    CHECK_EQUAL(HIGH, SPY_getPinLevel(INPUT_PIN));
+}
+
+TEST(PinInterrupts, A_million_edges)
+{
+    attachInterrupt(INPUT_PIN, onEdge, CHANGE);
+
+    SPY_toggleInputPin(INPUT_PIN, 1000000);
+
+    UNSIGNED_LONGS_EQUAL(1000000, fired);
+}
+
+// Presses and releases the button with a bouncing contact, one pin level
+// per edge of the generated press. Returns the time of the last edge.
+static uint64_t schedulePress(BOUNCE_Generator *generator, uint64_t at,
+                              uint32_t *edges)
+{
+    uint32_t press[BOUNCE_PRESS_EDGES_MAX];
+    uint32_t count = BOUNCE_press(generator, press, BOUNCE_PRESS_EDGES_MAX);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        SPY_schedulePinLevel(at + press[i] / 1000, PUSH_BUTTON,
+                             BOUNCE_CLOSES(i) ? LOW : HIGH);
+    }
+    *edges += count;
+    return at + press[count - 1] / 1000;
+}
+
+TEST(PinInterrupts, Challenge_under_bouncing_presses)
+{
+    BOUNCE_Generator generator;
+    uint32_t edges = 0;
+
+    BOUNCE_init(&generator, 13);
+    SPY_setPinLevel(PUSH_BUTTON, HIGH);
+    CHALLENGE_setup();
+
+    for (uint32_t press = 0; press < 1000; press++)
+    {
+        uint64_t at = VCLOCK_now64() + 300;
+        uint64_t released = schedulePress(&generator, at, &edges);
+
+        VCLOCK_run(CHALLENGE_loop, released + DEBOUNCE_QUIET_MS, 1);
+        UNSIGNED_LONGS_EQUAL(press % 2 ? 0 : 1, SCHEDULER_pending());
+    }
+
+    UNSIGNED_LONGS_EQUAL(edges, SPY_getInterruptCount());
+    CHECK(edges > 4000);
+}
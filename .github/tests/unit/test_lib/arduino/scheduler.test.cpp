@@ -0,0 +1,148 @@
+#include "CppUTest/TestHarness.h"
+
+#include "Arduino.h"
+#include "apps.h"
+#include "debounce.h"
+#include "fake.h"
+#include "scheduler.h"
+#include "soak.h"
+#include "vclock.h"
+
+static void reportDeadline(void)
+{
+    uint32_t deadline;
+
+    if (SCHEDULER_nextDeadline(&deadline))
+    {
+        VCLOCK_requestDeadline(deadline);
+    }
+}
+
+static void blinkLoop(void)
+{
+    BLINK_loop();
+    reportDeadline();
+}
+
+static void challengeLoop(void)
+{
+    CHALLENGE_loop();
+    reportDeadline();
+}
+
+// A clean press and release, one CHANGE interrupt each.
+static void tap(void)
+{
+    SPY_setPinLevel(PUSH_BUTTON, LOW);
+    SPY_setPinLevel(PUSH_BUTTON, HIGH);
+}
+
+TEST_GROUP(ScheduledApps)
+{
+    void setup()
+    {
+        VCLOCK_reset();
+        SPY_resetInterrupts();
+        SPY_setPinLevel(PUSH_BUTTON, HIGH);
+        FAKE_setEnabled(1);
+    }
+
+    void teardown()
+    {
+        FAKE_setEnabled(0);
+    }
+};
+
+TEST(ScheduledApps, Blink_wakes_only_at_deadlines)
+{
+    BLINK_setup();
+    CHECK_EQUAL(LOW, SPY_getPinLevel(LED));
+
+    uint64_t iterations = VCLOCK_run(blinkLoop, 10000, 60000);
+
+    // One loop() per toggle: at 0 s, then 1 s to 9 s.
+    UNSIGNED_LONGS_EQUAL(10, iterations);
+    CHECK_EQUAL(HIGH, SPY_getPinLevel(LED));
+    VCLOCK_run(blinkLoop, 10001, 60000);
+    CHECK_EQUAL(LOW, SPY_getPinLevel(LED));
+}
+
+TEST(ScheduledApps, Challenge_blinks_between_presses)
+{
+    CHALLENGE_setup();
+    POINTERS_EQUAL((void *)CHALLENGE_onButton,
+                   (void *)SPY_getStoredInterruptCallback());
+    VCLOCK_run(challengeLoop, 1000, 60000);
+    CHECK_EQUAL(LOW, SPY_getPinLevel(LED));
+
+    tap();
+    VCLOCK_run(challengeLoop, 1001, 60000);
+    CHECK_EQUAL(HIGH, SPY_getPinLevel(LED));
+    VCLOCK_run(challengeLoop, 1501, 60000);
+    CHECK_EQUAL(LOW, SPY_getPinLevel(LED));
+    VCLOCK_run(challengeLoop, 2001, 60000);
+    CHECK_EQUAL(HIGH, SPY_getPinLevel(LED));
+
+    tap();
+    VCLOCK_run(challengeLoop, 5000, 60000);
+    CHECK_EQUAL(LOW, SPY_getPinLevel(LED));
+    UNSIGNED_LONGS_EQUAL(0, SCHEDULER_pending());
+}
+
+static void idleJob(void *context)
+{
+}
+
+TEST(ScheduledApps, Press_with_the_scheduler_full_leaves_the_led_off)
+{
+    int ids[SCHEDULER_JOBS];
+
+    CHALLENGE_setup();
+    for (int i = 0; i < SCHEDULER_JOBS; i++)
+    {
+        ids[i] = SCHEDULER_every(60000, idleJob, nullptr);
+        CHECK(ids[i] >= 0);
+    }
+    VCLOCK_run(challengeLoop, 1000, 60000);
+
+    tap();
+    VCLOCK_run(challengeLoop, 1001, 60000);
+    CHECK_EQUAL(LOW, SPY_getPinLevel(LED));
+    UNSIGNED_LONGS_EQUAL(1, CHALLENGE_failures());
+    UNSIGNED_LONGS_EQUAL(SCHEDULER_JOBS, SCHEDULER_pending());
+
+    // Once a slot is free the next press starts blinking
+    SCHEDULER_cancel(ids[0]);
+    VCLOCK_advance(DEBOUNCE_QUIET_MS);
+    tap();
+    VCLOCK_run(challengeLoop, VCLOCK_now64() + 1, 60000);
+    CHECK_EQUAL(HIGH, SPY_getPinLevel(LED));
+    UNSIGNED_LONGS_EQUAL(1, CHALLENGE_failures());
+    UNSIGNED_LONGS_EQUAL(SCHEDULER_JOBS, SCHEDULER_pending());
+}
+
+static int ledLevel(void)
+{
+    return SPY_getPinLevel(LED);
+}
+
+static int oneJob(void)
+{
+    return SCHEDULER_pending() == 1;
+}
+
+TEST(ScheduledApps, Challenge_soak_across_three_millis_wraps)
+{
+    SOAK_Config config = {challengeLoop, ledLevel, oneJob,
+                          CHALLENGE_PERIOD_MS, 0, 3};
+    SOAK_Result result;
+
+    CHALLENGE_setup();
+    tap();
+    CHALLENGE_loop();
+    SOAK_run(&config, &result);
+
+    CHECK_TEXT(result.violation == SOAK_OK, SOAK_describe(&result));
+    UNSIGNED_LONGS_EQUAL(3, result.wraps);
+    CHECK(result.edges >= 3 * (0x100000000ULL / CHALLENGE_PERIOD_MS) - 1);
+}
@@ -0,0 +1,14 @@
+#include "CppUTest/CommandLineTestRunner.h"
+#include "CppUTest/TestRegistry.h"
+#include "energyplugin.h"
+#include "reportplugin.h"
+
+int main(int ac, char **av)
+{
+    EnergyPlugin energy;
+    ReportPlugin report;
+
+    TestRegistry::getCurrentRegistry()->installPlugin(&energy);
+    TestRegistry::getCurrentRegistry()->installPlugin(&report);
+    return CommandLineTestRunner::RunAllTests(ac, av);
+}
\ No newline at end of file
@@ -0,0 +1,144 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include "fake.h"
+#include "main.h"
+#include "vclock.h"
+}
+#include "blinker.hpp"
+#include <string.h>
+#include <type_traits>
+
+typedef BLINKER::Blinker<BLINKER::GpioA, LED_Pin, 500> Led;
+typedef BLINKER::Blinker<BLINKER::GpioB, GPIO_PIN_7, 1000> Heartbeat;
+typedef BLINKER::Button<PUSH_BUTTON_Pin, BLINKER::FALLING> Button;
+
+// What the template has to cost no more than: the scheduling lab's
+// previousMillis and nothing else.
+static_assert(sizeof(Led) == sizeof(uint32_t), "a blinker is its timestamp");
+static_assert(!std::is_polymorphic<Led>::value, "no virtual dispatch");
+static_assert(std::is_empty<Button>::value, "a button holds no state");
+static_assert(Led::periodMs == 500 && Heartbeat::pin == GPIO_PIN_7,
+              "constants are visible at compile time");
+static_assert(Button::matches(PUSH_BUTTON_Pin) && !Button::matches(LED_Pin),
+              "matches() folds to a compare");
+
+static uint32_t previousMillis;
+
+// The scheduling lab's loop() at a 500 ms period.
+static void handwritten(uint32_t now) {
+  if (now - previousMillis >= 500) {
+    previousMillis = now;
+    HAL_GPIO_TogglePin(LED_GPIO_Port, LED_Pin);
+  }
+}
+
+static Led led;
+
+static void templated(uint32_t now) { led.run(now); }
+
+TEST_GROUP(Blinker) {
+  void setup() {
+    VCLOCK_reset();
+    SPY_HAL_GPIO_Reset();
+    FAKE_setEnabled(1);
+    FAKE_clear();
+    previousMillis = 0;
+    led = Led();
+  };
+  void teardown() { FAKE_setEnabled(0); };
+};
+
+TEST(Blinker, Toggles_every_period) {
+  led.run(499);
+  CHECK_EQUAL(GPIO_PIN_RESET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+  led.run(500);
+  CHECK_EQUAL(GPIO_PIN_SET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+  led.run(999);
+  CHECK_EQUAL(GPIO_PIN_SET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+  led.run(1000);
+  CHECK_EQUAL(GPIO_PIN_RESET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+}
+
+TEST(Blinker, Start_lights_the_led_and_restarts_the_period) {
+  led.start(1234);
+  CHECK_EQUAL(GPIO_PIN_SET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+  led.run(1733);
+  CHECK_EQUAL(GPIO_PIN_SET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+  led.run(1734);
+  CHECK_EQUAL(GPIO_PIN_RESET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+
+  led.start(2000);
+  led.stop();
+  CHECK_EQUAL(GPIO_PIN_RESET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+}
+
+TEST(Blinker, Survives_the_tick_wrap) {
+  uint32_t beforeWrap = 0xFFFFFF00U;
+
+  led.start(beforeWrap);
+  led.run(beforeWrap + 499);
+  CHECK_EQUAL(GPIO_PIN_SET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+  led.run(beforeWrap + 500);
+  CHECK_EQUAL(GPIO_PIN_RESET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+}
+
+TEST(Blinker, Instances_are_independent) {
+  BLINKER::Blinker<BLINKER::GpioA, GPIO_PIN_6, 500> other;
+  Heartbeat heartbeat;
+
+  other.start(0);
+  for (uint32_t now = 0; now <= 3000; now++) {
+    led.run(now);
+    other.run(now);
+    heartbeat.run(now);
+  }
+
+  // led and other toggled 6 times, other from on, heartbeat 3 times.
+  CHECK_EQUAL(GPIO_PIN_RESET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+  CHECK_EQUAL(GPIO_PIN_SET, SPY_HAL_GPIO_ReadPin(GPIOA, GPIO_PIN_6));
+  CHECK_EQUAL(GPIO_PIN_SET, SPY_HAL_GPIO_ReadPin(GPIOB, GPIO_PIN_7));
+  UNSIGNED_LONGS_EQUAL(6 + 6 + 3, FAKE_callCount(FAKE_HAL_GPIO_TogglePin));
+}
+
+// Same HAL calls with the same arguments on the same ticks: the template
+// adds no calls and no work the mocks can see. The benchmarks compare the
+// generated code itself.
+TEST(Blinker, Matches_the_handwritten_toggle) {
+  const uint32_t ticks = 20000;
+  FAKE_Call expected[64];
+  uint32_t count;
+
+  for (uint32_t now = 0; now < ticks; now += 7) {
+    VCLOCK_setNow(now);
+    handwritten(now);
+  }
+  count = FAKE_logSize();
+  CHECK(count > 0 && count <= 64);
+  memcpy(expected, FAKE_logAt(0), count * sizeof(FAKE_Call));
+
+  FAKE_clear();
+  for (uint32_t now = 0; now < ticks; now += 7) {
+    VCLOCK_setNow(now);
+    templated(now);
+  }
+  UNSIGNED_LONGS_EQUAL(count, FAKE_logSize());
+  MEMCMP_EQUAL(expected, FAKE_logAt(0), count * sizeof(FAKE_Call));
+}
+
+TEST(Blinker, Button_selects_its_edges) {
+  EXTI->RTSR = PUSH_BUTTON_Pin;
+
+  Button::arm();
+  UNSIGNED_LONGS_EQUAL(PUSH_BUTTON_Pin, EXTI->IMR);
+  UNSIGNED_LONGS_EQUAL(0, EXTI->RTSR);
+  UNSIGNED_LONGS_EQUAL(PUSH_BUTTON_Pin, EXTI->FTSR);
+
+  BLINKER::Button<GPIO_PIN_0, BLINKER::BOTH>::arm();
+  UNSIGNED_LONGS_EQUAL(PUSH_BUTTON_Pin | GPIO_PIN_0, EXTI->IMR);
+  UNSIGNED_LONGS_EQUAL(GPIO_PIN_0, EXTI->RTSR);
+  UNSIGNED_LONGS_EQUAL(PUSH_BUTTON_Pin | GPIO_PIN_0, EXTI->FTSR);
+
+  Button::disarm();
+  UNSIGNED_LONGS_EQUAL(GPIO_PIN_0, EXTI->IMR);
+}
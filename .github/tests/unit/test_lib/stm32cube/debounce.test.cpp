@@ -0,0 +1,303 @@
+#include "CppUTest/TestHarness.h"
+
+#include <string.h>
+#include <time.h>
+
+extern "C" {
+#include "apps.h"
+#include "bounce.h"
+#include "debounce.h"
+#include "fake.h"
+#include "main.h"
+#include "report.h"
+#include "scheduler.h"
+#include "vclock.h"
+}
+
+static DEBOUNCE_Filter filter;
+static BOUNCE_Generator generator;
+
+TEST_GROUP(Debounce) {
+  void setup() {
+    DEBOUNCE_init(&filter, DEBOUNCE_QUIET_MS);
+    BOUNCE_init(&generator, 1);
+  };
+};
+
+TEST(Debounce, First_edge_of_a_press_is_accepted) {
+  CHECK(DEBOUNCE_edge(&filter, 1000, 1));
+  CHECK_FALSE(DEBOUNCE_edge(&filter, 1000, 0));
+  CHECK_FALSE(DEBOUNCE_edge(&filter, 1003, 1));
+
+  // The release bounces closed once, then the next press
+  CHECK_FALSE(DEBOUNCE_edge(&filter, 1500, 0));
+  CHECK_FALSE(DEBOUNCE_edge(&filter, 1502, 1));
+  CHECK_FALSE(DEBOUNCE_edge(&filter, 1504, 0));
+  CHECK(DEBOUNCE_edge(&filter, 1504 + DEBOUNCE_QUIET_MS, 1));
+
+  UNSIGNED_LONGS_EQUAL(2, filter.accepted);
+  UNSIGNED_LONGS_EQUAL(5, filter.rejected);
+}
+
+TEST(Debounce, Holds_of_any_length_count_once) {
+  uint32_t holds[] = {1, DEBOUNCE_QUIET_MS, 600, 60000, 0x80000000UL};
+  uint32_t tick = 0;
+
+  for (uint32_t i = 0; i < sizeof(holds) / sizeof(holds[0]); i++) {
+    CHECK(DEBOUNCE_edge(&filter, tick, 1));
+    CHECK_FALSE(DEBOUNCE_edge(&filter, tick + 2, 0));
+    CHECK_FALSE(DEBOUNCE_edge(&filter, tick + 4, 1));
+
+    // Released after the hold, bouncing closed twice
+    tick += 4 + holds[i];
+    CHECK_FALSE(DEBOUNCE_edge(&filter, tick, 0));
+    CHECK_FALSE(DEBOUNCE_edge(&filter, tick + 1, 1));
+    CHECK_FALSE(DEBOUNCE_edge(&filter, tick + 3, 0));
+    CHECK_FALSE(DEBOUNCE_edge(&filter, tick + 5, 1));
+    CHECK_FALSE(DEBOUNCE_edge(&filter, tick + 9, 0));
+    tick += 9 + DEBOUNCE_QUIET_MS;
+  }
+  UNSIGNED_LONGS_EQUAL(5, filter.accepted);
+}
+
+TEST(Debounce, Press_closer_than_the_window_is_missed) {
+  CHECK(DEBOUNCE_edge(&filter, 1000, 1));
+  CHECK_FALSE(DEBOUNCE_edge(&filter, 1200, 0));
+
+  // Not yet settled released: the press merges with the release bounce
+  CHECK_FALSE(DEBOUNCE_edge(&filter, 1200 + DEBOUNCE_QUIET_MS - 1, 1));
+  CHECK_FALSE(DEBOUNCE_edge(&filter, 1400, 0));
+  CHECK(DEBOUNCE_edge(&filter, 1400 + DEBOUNCE_QUIET_MS, 1));
+}
+
+TEST(Debounce, Bounce_read_released_does_not_lose_the_press) {
+  // The contact opened again before the ISR read the first edge
+  CHECK_FALSE(DEBOUNCE_edge(&filter, 1000, 0));
+  CHECK(DEBOUNCE_edge(&filter, 1001, 1));
+}
+
+TEST(Debounce, Every_bounce_restarts_the_window) {
+  CHECK(DEBOUNCE_edge(&filter, 0, 1));
+  for (uint32_t tick = 10; tick < 1000; tick += DEBOUNCE_QUIET_MS - 1) {
+    CHECK_FALSE(DEBOUNCE_edge(&filter, tick, (tick / 10) & 1));
+  }
+}
+
+TEST(Debounce, Quiet_time_across_tick_wrap) {
+  uint32_t tick = 0xFFFFFFF0UL;
+
+  CHECK(DEBOUNCE_edge(&filter, tick, 1));
+  CHECK_FALSE(DEBOUNCE_edge(&filter, tick + 5, 0));
+  CHECK_FALSE(DEBOUNCE_edge(&filter, tick + 5 + DEBOUNCE_QUIET_MS - 1, 1));
+  CHECK_FALSE(DEBOUNCE_edge(&filter, tick + 30, 0));
+  CHECK(DEBOUNCE_edge(&filter, tick + 30 + DEBOUNCE_QUIET_MS, 1));
+}
+
+TEST(Debounce, Bursts_are_ordered_and_bounded) {
+  uint32_t edges[BOUNCE_EDGES_MAX];
+
+  for (uint32_t i = 0; i < 10000; i++) {
+    uint32_t count = BOUNCE_burst(&generator, edges, BOUNCE_EDGES_MAX);
+
+    CHECK(count >= 1 && count <= BOUNCE_EDGES_MAX);
+    UNSIGNED_LONGS_EQUAL(0, edges[0]);
+    for (uint32_t j = 1; j < count; j++) {
+      CHECK(edges[j] >= edges[j - 1]);
+    }
+    CHECK(edges[count - 1] <= generator.maxBurstUs);
+  }
+}
+
+TEST(Debounce, Presses_release_after_the_hold) {
+  uint32_t edges[BOUNCE_PRESS_EDGES_MAX];
+
+  for (uint32_t i = 0; i < 10000; i++) {
+    uint32_t count = BOUNCE_press(&generator, edges, BOUNCE_PRESS_EDGES_MAX);
+    uint32_t holds = 0;
+
+    // Ends open, with one gap a hold long, after a closing edge
+    CHECK(count >= 2 && count % 2 == 0);
+    UNSIGNED_LONGS_EQUAL(0, edges[0]);
+    for (uint32_t j = 1; j < count; j++) {
+      CHECK(edges[j] >= edges[j - 1]);
+      if (edges[j] - edges[j - 1] >= generator.minHoldUs) {
+        CHECK(BOUNCE_CLOSES(j - 1));
+        CHECK(edges[j] - edges[j - 1] <= generator.maxHoldUs);
+        holds++;
+      }
+    }
+    UNSIGNED_LONGS_EQUAL(1, holds);
+    CHECK(edges[count - 1] <=
+          generator.maxHoldUs + 2 * generator.maxBurstUs);
+  }
+}
+
+TEST(Debounce, Generator_replays_from_its_seed) {
+  uint32_t first[BOUNCE_EDGES_MAX], second[BOUNCE_EDGES_MAX];
+  uint32_t count = BOUNCE_burst(&generator, first, BOUNCE_EDGES_MAX);
+
+  BOUNCE_init(&generator, 1);
+  UNSIGNED_LONGS_EQUAL(count,
+                       BOUNCE_burst(&generator, second, BOUNCE_EDGES_MAX));
+  MEMCMP_EQUAL(first, second, count * sizeof(uint32_t));
+}
+
+// Feeds bouncing presses and releases through the filter in chunks: the
+// edges of a chunk are generated first so that only the filter itself is
+// timed. Holds are drawn from [minHold, maxHold] and the next press starts
+// [minGap, maxGap] after the last edge of the release, all in
+// milliseconds. A press starting less than quietMs after that edge is
+// counted as too close: the filter cannot tell it from release bounce. The
+// counts, the miss and double-count rates and the time per edge are
+// recorded with REPORT_value().
+#define BENCH_CHUNK 4096
+
+typedef struct {
+  uint32_t presses;
+  uint32_t edges;
+  uint32_t tooClose;
+  uint32_t misses;
+  uint32_t doubles;
+  double nsPerEdge;
+} Bench;
+
+static uint32_t benchTicks[BENCH_CHUNK * BOUNCE_PRESS_EDGES_MAX];
+static uint8_t benchPressed[BENCH_CHUNK * BOUNCE_PRESS_EDGES_MAX];
+static uint8_t benchAccepted[BENCH_CHUNK * BOUNCE_PRESS_EDGES_MAX];
+static uint32_t benchFirst[BENCH_CHUNK + 1];
+
+static Bench bench(uint32_t presses, uint32_t quietMs, uint32_t minHold,
+                   uint32_t maxHold, uint32_t minGap, uint32_t maxGap) {
+  Bench result = {0, 0, 0, 0, 0, 0.0};
+  uint32_t press[BOUNCE_PRESS_EDGES_MAX];
+  uint64_t startUs = (uint64_t)(0xFFFFFFFFUL - 1000) * 1000;
+  uint32_t lastTick = (uint32_t)(startUs / 1000) - quietMs;
+  double seconds = 0.0;
+
+  DEBOUNCE_init(&filter, quietMs);
+  BOUNCE_init(&generator, 0x5EED);
+  generator.minHoldUs = minHold * 1000;
+  generator.maxHoldUs = maxHold * 1000;
+
+  while (result.presses < presses) {
+    uint32_t chunk = presses - result.presses < BENCH_CHUNK
+                         ? presses - result.presses
+                         : BENCH_CHUNK;
+    uint32_t edges = 0;
+
+    for (uint32_t p = 0; p < chunk; p++) {
+      uint32_t count =
+          BOUNCE_press(&generator, press, BOUNCE_PRESS_EDGES_MAX);
+
+      benchFirst[p] = edges;
+      for (uint32_t i = 0; i < count; i++) {
+        benchTicks[edges] = (uint32_t)((startUs + press[i]) / 1000);
+        benchPressed[edges++] = BOUNCE_CLOSES(i);
+      }
+      result.tooClose += benchTicks[benchFirst[p]] - lastTick < quietMs;
+      lastTick = benchTicks[edges - 1];
+      startUs += press[count - 1];
+      startUs += (uint64_t)BOUNCE_between(&generator, minGap, maxGap) * 1000;
+    }
+    benchFirst[chunk] = edges;
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (uint32_t i = 0; i < edges; i++) {
+      benchAccepted[i] =
+          (uint8_t)DEBOUNCE_edge(&filter, benchTicks[i], benchPressed[i]);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    seconds += (double)(end.tv_sec - start.tv_sec) +
+               (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+
+    for (uint32_t p = 0; p < chunk; p++) {
+      uint32_t accepted = 0;
+
+      for (uint32_t i = benchFirst[p]; i < benchFirst[p + 1]; i++) {
+        accepted += benchAccepted[i];
+      }
+      result.misses += accepted == 0;
+      result.doubles += accepted > 1;
+    }
+    result.presses += chunk;
+    result.edges += edges;
+  }
+
+  result.nsPerEdge = seconds * 1e9 / result.edges;
+  REPORT_value("presses", result.presses);
+  REPORT_value("spurious_edges", result.edges - 2 * result.presses);
+  REPORT_value("ns_per_edge", result.nsPerEdge);
+  REPORT_value("too_close", result.tooClose);
+  REPORT_value("missed", result.misses);
+  REPORT_value("double_counted", result.doubles);
+  REPORT_value("miss_rate", (double)result.misses / result.presses);
+  REPORT_value("double_rate", (double)result.doubles / result.presses);
+  return result;
+}
+
+TEST(Debounce, Millions_of_bouncing_presses_count_once) {
+  // Holds from shorter than the window to seconds, and presses from
+  // closer than the window to a second apart.
+  Bench result = bench(2000000, DEBOUNCE_QUIET_MS, 1, 2000, 1, 1000);
+
+  CHECK(result.edges > 4 * result.presses);
+  CHECK(result.tooClose > 0);
+  UNSIGNED_LONGS_EQUAL(result.tooClose, result.misses);
+  UNSIGNED_LONGS_EQUAL(0, result.doubles);
+  UNSIGNED_LONGS_EQUAL(result.presses - result.misses, filter.accepted);
+}
+
+TEST(Debounce, Presses_closer_than_the_window_are_missed) {
+  Bench result = bench(200000, DEBOUNCE_QUIET_MS, 50, 500, 1, 30);
+
+  CHECK(result.misses > 0);
+  UNSIGNED_LONGS_EQUAL(result.tooClose, result.misses);
+  UNSIGNED_LONGS_EQUAL(0, result.doubles);
+}
+
+TEST(Debounce, Window_shorter_than_the_bounce_double_counts) {
+  Bench result = bench(200000, 2, 50, 500, 40, 1000);
+
+  UNSIGNED_LONGS_EQUAL(0, result.misses);
+  CHECK(result.doubles > 0);
+}
+
+static void challengeLoop(void) { CHALLENGE_loop(); }
+
+static void closeButton(void *context) {
+  SPY_HAL_setButton(1, CHALLENGE_onButton);
+}
+
+static void openButton(void *context) {
+  SPY_HAL_setButton(0, CHALLENGE_onButton);
+}
+
+TEST_GROUP(DebouncedChallenge) {
+  void setup() {
+    VCLOCK_reset();
+    SPY_HAL_GPIO_Reset();
+    BOUNCE_init(&generator, 7);
+    FAKE_setEnabled(1);
+  };
+  void teardown() { FAKE_setEnabled(0); };
+};
+
+TEST(DebouncedChallenge, Bouncing_presses_toggle_once_each) {
+  // Long bursts, so that bounces straddle loop() iterations
+  generator.minBurstUs = generator.maxBurstUs;
+  CHALLENGE_setup();
+
+  for (uint32_t press = 0; press < 100; press++) {
+    uint64_t at = 1000 + press * 1000;
+
+    CHECK(BOUNCE_schedule(&generator, at, closeButton, openButton, NULL) >
+          0);
+    VCLOCK_run(challengeLoop, at + 100, 1);
+    CHECK_EQUAL(press % 2 ? GPIO_PIN_RESET : GPIO_PIN_SET,
+                SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+    // The release bounces before the next press, and must not toggle
+    VCLOCK_run(challengeLoop, at + 1000, 1);
+    UNSIGNED_LONGS_EQUAL(press % 2 ? 0 : 1, SCHEDULER_pending());
+  }
+}
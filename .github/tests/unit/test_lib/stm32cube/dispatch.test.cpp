@@ -0,0 +1,148 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include "apps.h"
+#include "dispatch.h"
+#include "fake.h"
+#include "main.h"
+#include "scheduler.h"
+#include "vclock.h"
+}
+#include "dispatch.hpp"
+
+static uint16_t calls[DISPATCH_LINES * 2];
+static uint32_t callCount = 0;
+
+static void record(uint16_t GPIO_Pin) { calls[callCount++] = GPIO_Pin; }
+
+// Simulates an edge on line 0 while its own handler runs.
+static void retrigger(uint16_t GPIO_Pin) {
+  record(GPIO_Pin);
+  if (callCount == 1) {
+    EXTI->PR |= GPIO_PIN_0;
+  }
+}
+
+static void (*irqHandler)(uint16_t lines) = DISPATCH_irq;
+
+// The NVIC enters each vector with lines pending, lowest IRQ number first.
+void SPY_HAL_EXTI_IRQHandler(void) {
+  static const uint16_t vectors[] = {
+      DISPATCH_EXTI0, DISPATCH_EXTI1,   DISPATCH_EXTI2,    DISPATCH_EXTI3,
+      DISPATCH_EXTI4, DISPATCH_EXTI9_5, DISPATCH_EXTI15_10};
+
+  for (uint32_t i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++) {
+    if (__HAL_GPIO_EXTI_GET_IT(vectors[i]) != 0U) {
+      irqHandler(vectors[i]);
+    }
+  }
+}
+
+typedef DISPATCH::Table<DISPATCH::Line<GPIO_PIN_13, record>,
+                        DISPATCH::Line<GPIO_PIN_0, record>,
+                        DISPATCH::Line<GPIO_PIN_7, record>>
+    Exti;
+
+static_assert(Exti::handlers[13] == record, "line 13 is bound");
+static_assert(Exti::handlers[12] == DISPATCH_ignore, "line 12 is not");
+
+TEST_GROUP(Dispatch) {
+  void setup() {
+    SPY_HAL_GPIO_Reset();
+    DISPATCH_init();
+    irqHandler = DISPATCH_irq;
+    callCount = 0;
+  };
+};
+
+TEST(Dispatch, Simultaneous_lines_run_highest_first) {
+  DISPATCH_register(GPIO_PIN_10, record);
+  DISPATCH_register(GPIO_PIN_13, record);
+  DISPATCH_register(GPIO_PIN_15, record);
+
+  SPY_HAL_GPIO_EXTI_Fire(GPIO_PIN_10 | GPIO_PIN_13 | GPIO_PIN_15);
+
+  UNSIGNED_LONGS_EQUAL(3, callCount);
+  UNSIGNED_LONGS_EQUAL(GPIO_PIN_15, calls[0]);
+  UNSIGNED_LONGS_EQUAL(GPIO_PIN_13, calls[1]);
+  UNSIGNED_LONGS_EQUAL(GPIO_PIN_10, calls[2]);
+  UNSIGNED_LONGS_EQUAL(0, EXTI->PR);
+}
+
+TEST(Dispatch, Lines_of_other_vectors_stay_pending) {
+  DISPATCH_register(GPIO_PIN_0, record);
+  DISPATCH_register(GPIO_PIN_7, record);
+  DISPATCH_register(GPIO_PIN_13, record);
+  EXTI->PR |= GPIO_PIN_0 | GPIO_PIN_7 | GPIO_PIN_13;
+
+  DISPATCH_irq(DISPATCH_EXTI15_10);
+
+  UNSIGNED_LONGS_EQUAL(1, callCount);
+  UNSIGNED_LONGS_EQUAL(GPIO_PIN_13, calls[0]);
+  UNSIGNED_LONGS_EQUAL(GPIO_PIN_0 | GPIO_PIN_7, EXTI->PR);
+
+  DISPATCH_irq(DISPATCH_EXTI9_5);
+
+  UNSIGNED_LONGS_EQUAL(2, callCount);
+  UNSIGNED_LONGS_EQUAL(GPIO_PIN_7, calls[1]);
+  UNSIGNED_LONGS_EQUAL(GPIO_PIN_0, EXTI->PR);
+}
+
+TEST(Dispatch, Unregistered_lines_are_cleared_and_ignored) {
+  DISPATCH_register(GPIO_PIN_13, record);
+
+  SPY_HAL_GPIO_EXTI_Fire(GPIO_PIN_All);
+
+  UNSIGNED_LONGS_EQUAL(1, callCount);
+  UNSIGNED_LONGS_EQUAL(GPIO_PIN_13, calls[0]);
+  UNSIGNED_LONGS_EQUAL(0, EXTI->PR);
+
+  DISPATCH_register(GPIO_PIN_13, NULL);
+  SPY_HAL_GPIO_EXTI_Fire(GPIO_PIN_13);
+  UNSIGNED_LONGS_EQUAL(1, callCount);
+}
+
+TEST(Dispatch, Only_single_lines_register) {
+  CHECK_FALSE(DISPATCH_register(0, record));
+  CHECK_FALSE(DISPATCH_register(GPIO_PIN_0 | GPIO_PIN_1, record));
+  CHECK(DISPATCH_register(GPIO_PIN_15, record));
+}
+
+TEST(Dispatch, Edge_during_a_handler_stays_pending) {
+  DISPATCH_register(GPIO_PIN_0, retrigger);
+
+  SPY_HAL_GPIO_EXTI_Fire(GPIO_PIN_0);
+
+  UNSIGNED_LONGS_EQUAL(1, callCount);
+  UNSIGNED_LONGS_EQUAL(GPIO_PIN_0, EXTI->PR);
+  DISPATCH_irq(DISPATCH_EXTI0);
+  UNSIGNED_LONGS_EQUAL(2, callCount);
+  UNSIGNED_LONGS_EQUAL(0, EXTI->PR);
+}
+
+TEST(Dispatch, Compile_time_table) {
+  irqHandler = Exti::irq;
+
+  SPY_HAL_GPIO_EXTI_Fire(GPIO_PIN_0 | GPIO_PIN_5 | GPIO_PIN_7 | GPIO_PIN_13);
+
+  UNSIGNED_LONGS_EQUAL(3, callCount);
+  UNSIGNED_LONGS_EQUAL(GPIO_PIN_0, calls[0]);
+  UNSIGNED_LONGS_EQUAL(GPIO_PIN_7, calls[1]);
+  UNSIGNED_LONGS_EQUAL(GPIO_PIN_13, calls[2]);
+  UNSIGNED_LONGS_EQUAL(0, EXTI->PR);
+}
+
+TEST(Dispatch, Challenge_ignores_other_lines) {
+  VCLOCK_reset();
+  FAKE_setEnabled(1);
+  CHALLENGE_setup();
+  DISPATCH_register(PUSH_BUTTON_Pin, CHALLENGE_onButton);
+
+  SPY_HAL_setButton(1, NULL);
+  SPY_HAL_GPIO_EXTI_Fire(PUSH_BUTTON_Pin | GPIO_PIN_0 | GPIO_PIN_14);
+  CHALLENGE_loop();
+
+  CHECK_EQUAL(GPIO_PIN_SET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+  UNSIGNED_LONGS_EQUAL(1, SCHEDULER_pending());
+  FAKE_setEnabled(0);
+}
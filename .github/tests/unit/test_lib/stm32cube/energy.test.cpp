@@ -0,0 +1,136 @@
+#include "CppUTest/TestHarness.h"
+
+#include <stdio.h>
+#include <string.h>
+
+extern "C" {
+#include "apps.h"
+#include "energy.h"
+#include "fake.h"
+#include "idle.h"
+#include "main.h"
+#include "scheduler.h"
+#include "vclock.h"
+}
+
+static void wakeup(void *context) {}
+
+static void sleepingBlink(void) {
+  BLINK_loop();
+  IDLE_waitForScheduler();
+}
+
+TEST_GROUP(Energy) {
+  ENERGY_Report report;
+
+  void setup() {
+    VCLOCK_reset();
+    SPY_WFI_reset();
+    SPY_HAL_PWR_Reset();
+    FAKE_setEnabled(1);
+    ENERGY_start();
+  };
+  void teardown() {
+    FAKE_setEnabled(0);
+    VCLOCK_reset();
+  };
+};
+
+TEST(Energy, Window_survives_the_resets_in_setup) {
+  HAL_GetTick();
+  HAL_GPIO_TogglePin(LED_GPIO_Port, LED_Pin);
+  VCLOCK_advance(400);
+  FAKE_clear();
+  VCLOCK_reset();
+  HAL_GetTick();
+  VCLOCK_advance(600);
+
+  ENERGY_measure(&ENERGY_defaultModel, &report);
+
+  UNSIGNED_LONGS_EQUAL(1000, report.elapsedMs);
+  UNSIGNED_LONGS_EQUAL(1000, report.stateMs[ENERGY_RUN]);
+  UNSIGNED_LONGS_EQUAL(2, report.calls[FAKE_HAL_GetTick]);
+  UNSIGNED_LONGS_EQUAL(1, report.calls[FAKE_HAL_GPIO_TogglePin]);
+  DOUBLES_EQUAL(1.0, report.dutyCycle, 1e-9);
+  DOUBLES_EQUAL(12.3, report.milliamps, 1e-9);
+  DOUBLES_EQUAL(2.0, ENERGY_callsPerSecond(&report, FAKE_HAL_GetTick), 1e-9);
+  // 44 cycles at 84 MHz.
+  DOUBLES_EQUAL(44e3 / 84e6, report.callMs, 1e-12);
+}
+
+TEST(Energy, Sleep_and_stop_draw_their_own_current) {
+  VCLOCK_schedule(100, wakeup, NULL);
+  SysTick->CTRL = 0;
+  __WFI();
+  VCLOCK_schedule(400, wakeup, NULL);
+  HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
+  VCLOCK_advance(100);
+
+  ENERGY_measure(&ENERGY_defaultModel, &report);
+
+  UNSIGNED_LONGS_EQUAL(500, report.elapsedMs);
+  UNSIGNED_LONGS_EQUAL(100, report.stateMs[ENERGY_RUN]);
+  UNSIGNED_LONGS_EQUAL(100, report.stateMs[ENERGY_SLEEP]);
+  UNSIGNED_LONGS_EQUAL(300, report.stateMs[ENERGY_STOP]);
+  DOUBLES_EQUAL(0.2, report.dutyCycle, 1e-9);
+  DOUBLES_EQUAL((100 * 12.3 + 100 * 4.6 + 300 * 0.042) / 500,
+                report.milliamps, 1e-9);
+}
+
+TEST(Energy, Nothing_to_report_without_simulated_time) {
+  HAL_GetTick();
+
+  ENERGY_measure(&ENERGY_defaultModel, &report);
+
+  UNSIGNED_LONGS_EQUAL(0, report.elapsedMs);
+  UNSIGNED_LONGS_EQUAL(1, report.calls[FAKE_HAL_GetTick]);
+  DOUBLES_EQUAL(0, report.milliamps, 0);
+  DOUBLES_EQUAL(0, ENERGY_callsPerSecond(&report, FAKE_HAL_GetTick), 0);
+}
+
+// The same blink, polled and slept through: polling keeps the core running
+// and spins on HAL_GetTick() millions of times a second.
+TEST(Energy, Sleeping_blink_draws_a_fraction_of_polling) {
+  ENERGY_Report polling;
+
+  BLINK_setup();
+  VCLOCK_run(BLINK_loop, 10001, 1);
+  ENERGY_measure(&ENERGY_defaultModel, &polling);
+
+  VCLOCK_reset();
+  ENERGY_start();
+  BLINK_setup();
+  while (VCLOCK_now() <= 10000) {
+    sleepingBlink();
+  }
+  ENERGY_measure(&ENERGY_defaultModel, &report);
+
+  DOUBLES_EQUAL(1.0, polling.dutyCycle, 1e-9);
+  CHECK(ENERGY_estimatedCallsPerSecond(&polling, FAKE_HAL_GetTick) > 1e6);
+  UNSIGNED_LONGS_EQUAL(10, polling.calls[FAKE_HAL_GPIO_TogglePin]);
+  UNSIGNED_LONGS_EQUAL(10, report.calls[FAKE_HAL_GPIO_TogglePin]);
+  DOUBLES_EQUAL(0, report.dutyCycle, 1e-9);
+  CHECK(report.milliamps * 2 < polling.milliamps);
+}
+
+TEST(Energy, Writes_one_json_line_per_test) {
+  char line[512];
+  FILE *out = tmpfile();
+
+  HAL_GetTick();
+  HAL_GetTick();
+  VCLOCK_advance(1000);
+  ENERGY_measure(&ENERGY_defaultModel, &report);
+  ENERGY_writeJson(out, "Energy", "Json", &report);
+  rewind(out);
+  CHECK(fgets(line, sizeof(line), out) != NULL);
+  fclose(out);
+
+  STRCMP_EQUAL("{\"group\": \"Energy\", \"test\": \"Json\", "
+               "\"elapsed_ms\": 1000, \"run_ms\": 1000, \"sleep_ms\": 0, "
+               "\"stop_ms\": 0, \"call_ms\": 0.000285714, "
+               "\"duty_cycle\": 1, \"mah_per_hour\": 12.3, \"calls\": "
+               "{\"HAL_GetTick\": {\"count\": 2, \"per_second\": 2, "
+               "\"estimated_per_second\": 7e+06}}}\n",
+               line);
+}
@@ -0,0 +1,138 @@
+#include "CppUTest/TestHarness.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+extern "C" {
+#include "evqueue.h"
+}
+
+static EVQUEUE_Queue queue;
+static EVQUEUE_Event batch[EVQUEUE_CAPACITY];
+
+TEST_GROUP(Evqueue) {
+  void setup() { EVQUEUE_init(&queue); };
+};
+
+TEST(Evqueue, Events_come_out_in_order) {
+  CHECK(EVQUEUE_push(&queue, 10, 0x2000, EVQUEUE_FALLING));
+  CHECK(EVQUEUE_push(&queue, 20, 0x2000, EVQUEUE_RISING));
+  UNSIGNED_LONGS_EQUAL(2, EVQUEUE_pending(&queue));
+
+  UNSIGNED_LONGS_EQUAL(2, EVQUEUE_drain(&queue, batch, EVQUEUE_CAPACITY));
+  UNSIGNED_LONGS_EQUAL(10, batch[0].tick);
+  UNSIGNED_LONGS_EQUAL(0x2000, batch[0].pin);
+  UNSIGNED_LONGS_EQUAL(EVQUEUE_FALLING, batch[0].edge);
+  UNSIGNED_LONGS_EQUAL(20, batch[1].tick);
+  UNSIGNED_LONGS_EQUAL(EVQUEUE_RISING, batch[1].edge);
+  UNSIGNED_LONGS_EQUAL(0, EVQUEUE_pending(&queue));
+}
+
+TEST(Evqueue, Drains_in_batches) {
+  for (uint32_t i = 0; i < 5; i++) {
+    EVQUEUE_push(&queue, i, 1, EVQUEUE_RISING);
+  }
+
+  UNSIGNED_LONGS_EQUAL(3, EVQUEUE_drain(&queue, batch, 3));
+  UNSIGNED_LONGS_EQUAL(2, batch[2].tick);
+  UNSIGNED_LONGS_EQUAL(2, EVQUEUE_drain(&queue, batch, 3));
+  UNSIGNED_LONGS_EQUAL(4, batch[1].tick);
+  UNSIGNED_LONGS_EQUAL(0, EVQUEUE_drain(&queue, batch, 3));
+}
+
+TEST(Evqueue, Overflow_drops_newest_and_counts) {
+  for (uint32_t i = 0; i < EVQUEUE_CAPACITY + 3; i++) {
+    EVQUEUE_push(&queue, i, 1, EVQUEUE_RISING);
+  }
+
+  UNSIGNED_LONGS_EQUAL(3, EVQUEUE_overflows(&queue));
+  UNSIGNED_LONGS_EQUAL(EVQUEUE_CAPACITY,
+                       EVQUEUE_drain(&queue, batch, EVQUEUE_CAPACITY));
+  UNSIGNED_LONGS_EQUAL(0, batch[0].tick);
+  UNSIGNED_LONGS_EQUAL(EVQUEUE_CAPACITY - 1, batch[EVQUEUE_CAPACITY - 1].tick);
+  CHECK(EVQUEUE_push(&queue, 99, 1, EVQUEUE_RISING));
+}
+
+TEST(Evqueue, Indexes_wrap) {
+  queue.head = queue.tail = 0xFFFFFFFEUL;
+
+  for (uint32_t i = 0; i < 4; i++) {
+    EVQUEUE_push(&queue, i, 1, EVQUEUE_RISING);
+  }
+
+  UNSIGNED_LONGS_EQUAL(4, EVQUEUE_pending(&queue));
+  UNSIGNED_LONGS_EQUAL(4, EVQUEUE_drain(&queue, batch, EVQUEUE_CAPACITY));
+  UNSIGNED_LONGS_EQUAL(3, batch[3].tick);
+}
+
+// The producer thread stands in for the EXTI ISR and pushes a numbered
+// event stream as fast as it can while the test thread drains it. A paced
+// producer waits for room, as if interrupts never outran loop(); an
+// unpaced one overflows.
+#define STRESS_EVENTS 2000000UL
+
+static int producerDone = 0;
+static int producerPaced = 0;
+
+static void *produce(void *arg) {
+  for (uint32_t i = 0; i < STRESS_EVENTS; i++) {
+    while (producerPaced && EVQUEUE_pending(&queue) == EVQUEUE_CAPACITY) {
+      sched_yield();
+    }
+    EVQUEUE_push(&queue, i, (uint16_t)i, EVQUEUE_FALLING);
+  }
+  __atomic_store_n(&producerDone, 1, __ATOMIC_RELEASE);
+  return NULL;
+}
+
+static uint32_t consume(int paced, int *ordered) {
+  pthread_t producer;
+  uint32_t received = 0;
+  uint32_t next = 0;
+
+  producerDone = 0;
+  producerPaced = paced;
+  *ordered = 1;
+  LONGS_EQUAL(0, pthread_create(&producer, NULL, produce, NULL));
+
+  for (;;) {
+    int finished = __atomic_load_n(&producerDone, __ATOMIC_ACQUIRE);
+    uint32_t count = EVQUEUE_drain(&queue, batch, EVQUEUE_CAPACITY);
+
+    // Overflow skips events but never reorders or corrupts them.
+    for (uint32_t i = 0; i < count; i++) {
+      if (batch[i].tick < next || (paced && batch[i].tick != next) ||
+          batch[i].pin != (uint16_t)batch[i].tick ||
+          batch[i].edge != EVQUEUE_FALLING) {
+        *ordered = 0;
+      }
+      next = batch[i].tick + 1;
+    }
+    received += count;
+    if (count == 0) {
+      if (finished) {
+        break;
+      }
+      sched_yield();
+    }
+  }
+  pthread_join(producer, NULL);
+  return received;
+}
+
+TEST(Evqueue, Concurrent_producer_keeps_every_event_in_order) {
+  int ordered = 0;
+
+  UNSIGNED_LONGS_EQUAL(STRESS_EVENTS, consume(1, &ordered));
+  CHECK(ordered);
+  UNSIGNED_LONGS_EQUAL(0, EVQUEUE_overflows(&queue));
+}
+
+TEST(Evqueue, Concurrent_producer_overflow_is_accounted) {
+  int ordered = 0;
+  uint32_t received = consume(0, &ordered);
+
+  CHECK(ordered);
+  CHECK(received > 0);
+  UNSIGNED_LONGS_EQUAL(STRESS_EVENTS, received + EVQUEUE_overflows(&queue));
+}
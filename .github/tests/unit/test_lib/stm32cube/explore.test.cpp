@@ -0,0 +1,147 @@
+#include "CppUTest/TestHarness.h"
+
+#include <stdlib.h>
+
+extern "C" {
+#include "apps.h"
+#include "debounce.h"
+#include "explore.h"
+#include "fake.h"
+#include "main.h"
+#include "scheduler.h"
+#include "vclock.h"
+}
+
+// The ISR counts presses and loop() hands them on. The racy loop clears
+// the count after a HAL call, so a press that lands on that call is lost;
+// the fixed one takes the count and clears it in one step.
+static volatile uint32_t pending;
+static uint32_t handled;
+
+static void countingSetup(void) {
+  SPY_HAL_GPIO_Reset();
+  pending = 0;
+  handled = 0;
+}
+
+static void countingIsr(void) { pending = pending + 1; }
+
+static void racyLoop(void) {
+  HAL_GetTick();
+  uint32_t presses = pending;
+
+  handled += presses;
+  HAL_GPIO_WritePin(LED_GPIO_Port, LED_Pin,
+                    (handled & 1) ? GPIO_PIN_SET : GPIO_PIN_RESET);
+  pending = 0;
+}
+
+static void fixedLoop(void) {
+  HAL_GetTick();
+  uint32_t presses = __atomic_exchange_n(&pending, 0, __ATOMIC_RELAXED);
+
+  handled += presses;
+  HAL_GPIO_WritePin(LED_GPIO_Port, LED_Pin,
+                    (handled & 1) ? GPIO_PIN_SET : GPIO_PIN_RESET);
+}
+
+static int everyPressHandled(void) { return handled == EXPLORE_injected(); }
+
+static void crashingIsr(void) { abort(); }
+
+// The lib challenge app, with every press a clean tap far enough from the
+// last to pass the debounce: every press must start or stop the blink job.
+static void challengeSetup(void) {
+  VCLOCK_reset();
+  SPY_HAL_GPIO_Reset();
+  CHALLENGE_setup();
+}
+
+static void challengeIsr(void) {
+  SPY_HAL_setButton(1, CHALLENGE_onButton);
+  SPY_HAL_setButton(0, CHALLENGE_onButton);
+}
+
+static void challengeLoop(void) {
+  CHALLENGE_loop();
+  VCLOCK_advance(DEBOUNCE_QUIET_MS);
+}
+
+static int blinksPerPress(void) {
+  return SCHEDULER_pending() == (EXPLORE_injected() & 1);
+}
+
+TEST_GROUP(Explore) {
+  EXPLORE_Result result;
+
+  void setup() { FAKE_setEnabled(1); };
+  void teardown() { FAKE_setEnabled(0); };
+};
+
+TEST(Explore, Finds_the_press_lost_between_read_and_clear) {
+  EXPLORE_Config config = {countingSetup, racyLoop, countingIsr,
+                           everyPressHandled, 3, 1, 1};
+
+  UNSIGNED_LONGS_EQUAL(3, EXPLORE_run(&config, &result));
+  UNSIGNED_LONGS_EQUAL(6, result.points);
+  UNSIGNED_LONGS_EQUAL(7, result.runs);
+  UNSIGNED_LONGS_EQUAL(0, result.crashes);
+  UNSIGNED_LONGS_EQUAL(1, result.failedDepth);
+  UNSIGNED_LONGS_EQUAL(1, result.failedAt[0]);
+  LONGS_EQUAL(FAKE_HAL_GPIO_WritePin, result.failedApi[0]);
+  STRCMP_EQUAL("3 of 7 runs failed, first: interrupt after call 1 "
+               "(HAL_GPIO_WritePin)",
+               EXPLORE_describe(&result));
+}
+
+TEST(Explore, Two_interrupts_try_every_pair_of_points) {
+  EXPLORE_Config config = {countingSetup, racyLoop, countingIsr,
+                           everyPressHandled, 3, 1, 2};
+
+  // 1 + 6 + 15 runs; only the 3 pairs of HAL_GetTick points pass.
+  UNSIGNED_LONGS_EQUAL(15, EXPLORE_run(&config, &result));
+  UNSIGNED_LONGS_EQUAL(22, result.runs);
+}
+
+TEST(Explore, Atomic_exchange_survives_every_interleaving) {
+  EXPLORE_Config config = {countingSetup, fixedLoop, countingIsr,
+                           everyPressHandled, 4, 1, 3};
+
+  UNSIGNED_LONGS_EQUAL(0, EXPLORE_run(&config, &result));
+  // 1 + 8 + 28 + 56 runs.
+  UNSIGNED_LONGS_EQUAL(93, result.runs);
+  STRCMP_EQUAL("93 runs over 8 points passed", EXPLORE_describe(&result));
+}
+
+TEST(Explore, Counts_runs_that_crash_as_failures) {
+  EXPLORE_Config config = {countingSetup, fixedLoop, crashingIsr,
+                           everyPressHandled, 2, 0, 1};
+
+  UNSIGNED_LONGS_EQUAL(4, EXPLORE_run(&config, &result));
+  UNSIGNED_LONGS_EQUAL(4, result.crashes);
+  UNSIGNED_LONGS_EQUAL(5, result.runs);
+  UNSIGNED_LONGS_EQUAL(0, result.failedAt[0]);
+  STRCMP_EQUAL("4 of 5 runs failed (4 crashed), first: interrupt after call "
+               "0 (HAL_GetTick)",
+               EXPLORE_describe(&result));
+}
+
+TEST(Explore, Leaves_the_callers_state_alone) {
+  EXPLORE_Config config = {countingSetup, racyLoop, countingIsr,
+                           everyPressHandled, 3, 1, 1};
+
+  pending = 42;
+  handled = 7;
+  EXPLORE_run(&config, &result);
+  UNSIGNED_LONGS_EQUAL(42, pending);
+  UNSIGNED_LONGS_EQUAL(7, handled);
+  POINTERS_EQUAL(NULL, FAKE_callHook);
+}
+
+TEST(Explore, Challenge_app_acts_on_a_press_at_any_point) {
+  EXPLORE_Config config = {challengeSetup, challengeLoop, challengeIsr,
+                           blinksPerPress, 4, 2, 1};
+
+  UNSIGNED_LONGS_EQUAL(0, EXPLORE_run(&config, &result));
+  CHECK(result.points >= 4);
+}
@@ -0,0 +1,142 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include "apps.h"
+#include "debounce.h"
+#include "fake.h"
+#include "idle.h"
+#include "main.h"
+#include "scheduler.h"
+#include "vclock.h"
+}
+
+static int wakeupTimer = 0;
+static int wakeupEvent = -1;
+static uint32_t presses = 0;
+
+static void wakeup(void *context) {}
+
+// A clean press and release, one edge interrupt each.
+static void tap(void) {
+  SPY_HAL_setButton(1, CHALLENGE_onButton);
+  SPY_HAL_setButton(0, CHALLENGE_onButton);
+}
+
+static void pressButton(void *context) {
+  presses++;
+  tap();
+}
+
+// RTC wake-up timer stand-in for the weak hooks in idle.c.
+extern "C" int IDLE_armWakeup(uint32_t ms) {
+  if (wakeupTimer) {
+    wakeupEvent = VCLOCK_scheduleIn(ms, wakeup, NULL);
+  }
+  return wakeupTimer;
+}
+
+extern "C" void IDLE_disarmWakeup(void) {
+  VCLOCK_cancel(wakeupEvent);
+  wakeupEvent = -1;
+}
+
+TEST_GROUP(Idle) {
+  void setup() {
+    VCLOCK_reset();
+    SPY_WFI_reset();
+    SPY_HAL_PWR_Reset();
+    FAKE_setEnabled(1);
+    wakeupTimer = 0;
+    presses = 0;
+  };
+  void teardown() {
+    FAKE_setEnabled(0);
+    VCLOCK_reset();
+  };
+};
+
+TEST(Idle, Busy_when_the_deadline_has_passed) {
+  VCLOCK_setNow(100);
+
+  LONGS_EQUAL(IDLE_BUSY, IDLE_enter(1, 100));
+  LONGS_EQUAL(IDLE_BUSY, IDLE_enter(1, 50));
+  UNSIGNED_LONGS_EQUAL(0, SPY_WFI_count());
+}
+
+TEST(Idle, Sleeps_until_the_next_tick_without_a_wakeup_timer) {
+  LONGS_EQUAL(IDLE_SLEEP, IDLE_enter(1, 5));
+  LONGS_EQUAL(IDLE_SLEEP, IDLE_enter(1, 5000));
+
+  UNSIGNED_LONGS_EQUAL(2, SPY_WFI_count());
+  UNSIGNED_LONGS_EQUAL(2, SPY_WFI_sleptMs());
+  UNSIGNED_LONGS_EQUAL(2, VCLOCK_now());
+  UNSIGNED_LONGS_EQUAL(0, SPY_HAL_PWR_StopCount());
+}
+
+TEST(Idle, Stops_until_the_wakeup_timer) {
+  wakeupTimer = 1;
+
+  LONGS_EQUAL(IDLE_SLEEP, IDLE_enter(1, IDLE_STOP_MIN_MS - 1));
+  LONGS_EQUAL(IDLE_STOP, IDLE_enter(1, 5000));
+
+  UNSIGNED_LONGS_EQUAL(5000, VCLOCK_now());
+  UNSIGNED_LONGS_EQUAL(1, SPY_HAL_PWR_StopCount());
+  UNSIGNED_LONGS_EQUAL(4999, SPY_HAL_PWR_StoppedMs());
+  CHECK(SysTick->CTRL & SysTick_CTRL_TICKINT_Msk);
+  LONGS_EQUAL(-1, wakeupEvent);
+}
+
+TEST(Idle, Button_wakes_up_from_stop_mode) {
+  CHALLENGE_setup();
+  VCLOCK_schedule(3000, pressButton, NULL);
+
+  LONGS_EQUAL(IDLE_STOP, IDLE_waitForScheduler());
+
+  UNSIGNED_LONGS_EQUAL(3000, VCLOCK_now());
+  UNSIGNED_LONGS_EQUAL(1, presses);
+  UNSIGNED_LONGS_EQUAL(0, SPY_WFI_hangs());
+
+  // Stop blinking again, past the debounce window
+  CHALLENGE_loop();
+  VCLOCK_advance(DEBOUNCE_QUIET_MS);
+  tap();
+  CHALLENGE_loop();
+  UNSIGNED_LONGS_EQUAL(0, SCHEDULER_pending());
+}
+
+TEST(Idle, Stop_without_wakeup_source_hangs) {
+  SCHEDULER_init(0);
+
+  LONGS_EQUAL(IDLE_STOP, IDLE_waitForScheduler());
+
+  UNSIGNED_LONGS_EQUAL(1, SPY_WFI_hangs());
+}
+
+static void challengeLoop(void) {
+  CHALLENGE_loop();
+  CHALLENGE_idle();
+}
+
+TEST(Idle, Challenge_sleeps_most_of_the_time) {
+  wakeupTimer = 1;
+  CHALLENGE_setup();
+  VCLOCK_schedule(10000, pressButton, NULL);
+  VCLOCK_schedule(20000, pressButton, NULL);
+  VCLOCK_schedule(30000, pressButton, NULL);
+
+  uint64_t iterations = VCLOCK_run(challengeLoop, 30000, 1);
+
+  // Awake for one tick per toggle, asleep otherwise.
+  CHECK(SPY_WFI_sleptMs() * 1000 / 30000 >= 998);
+  CHECK(iterations < 100);
+  UNSIGNED_LONGS_EQUAL(0, SPY_WFI_hangs());
+  CHECK(SPY_HAL_PWR_StopCount() >= 20);
+
+  // Stop blinking again, past the debounce window
+  CHALLENGE_loop();
+  UNSIGNED_LONGS_EQUAL(3, presses);
+  VCLOCK_advance(DEBOUNCE_QUIET_MS);
+  tap();
+  CHALLENGE_loop();
+  UNSIGNED_LONGS_EQUAL(0, SCHEDULER_pending());
+}
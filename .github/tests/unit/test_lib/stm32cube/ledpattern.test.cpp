@@ -0,0 +1,251 @@
+#include "CppUTest/TestHarness.h"
+#include "CppUTestExt/MockSupport.h"
+
+extern "C" {
+#include "fake.h"
+#include "ledpattern.h"
+#include "main.h"
+#include "vclock.h"
+}
+
+#define ON LED_Pin
+#define OFF ((uint32_t)LED_Pin << 16)
+
+static uint32_t words[256];
+static uint32_t other[256];
+static LEDPATTERN_Buffer buffer;
+static LEDPATTERN_Buffer otherBuffer;
+
+TEST_GROUP(LedPatternCompiler) {
+  void setup() { LEDPATTERN_begin(&buffer, words, 256, LED_Pin); };
+};
+
+TEST(LedPatternCompiler, Holds_are_bsrr_words_for_the_pin_only) {
+  CHECK(LEDPATTERN_hold(&buffer, 1, 2));
+  CHECK(LEDPATTERN_hold(&buffer, 0, 1));
+
+  UNSIGNED_LONGS_EQUAL(3, buffer.length);
+  UNSIGNED_LONGS_EQUAL(ON, words[0]);
+  UNSIGNED_LONGS_EQUAL(ON, words[1]);
+  UNSIGNED_LONGS_EQUAL(OFF, words[2]);
+}
+
+TEST(LedPatternCompiler, Overflow_is_reported) {
+  LEDPATTERN_begin(&buffer, words, 4, LED_Pin);
+
+  CHECK(LEDPATTERN_hold(&buffer, 1, 4));
+  CHECK_FALSE(LEDPATTERN_hold(&buffer, 0, 1));
+  CHECK(buffer.overflow);
+  UNSIGNED_LONGS_EQUAL(4, buffer.length);
+}
+
+TEST(LedPatternCompiler, Capacity_is_capped_at_what_dma_can_count) {
+  LEDPATTERN_begin(&buffer, words, LEDPATTERN_MAX_SLOTS + 100, LED_Pin);
+
+  UNSIGNED_LONGS_EQUAL(LEDPATTERN_MAX_SLOTS, buffer.capacity);
+  CHECK_FALSE(LEDPATTERN_hold(&buffer, 1, LEDPATTERN_MAX_SLOTS + 1));
+  CHECK(buffer.overflow);
+  UNSIGNED_LONGS_EQUAL(0, buffer.length);
+}
+
+TEST(LedPatternCompiler, Morse_timing) {
+  const uint32_t expected[] = {ON, OFF, ON, OFF, ON,             // S
+                               OFF, OFF, OFF,                    // letter
+                               ON, ON, ON, OFF, ON, ON, ON, OFF, // O
+                               ON, ON, ON,                       //
+                               OFF, OFF, OFF, OFF, OFF, OFF, OFF};
+
+  CHECK(LEDPATTERN_morse(&buffer, "so?"));
+
+  UNSIGNED_LONGS_EQUAL(sizeof(expected) / sizeof(expected[0]), buffer.length);
+  MEMCMP_EQUAL(expected, words, sizeof(expected));
+}
+
+TEST(LedPatternCompiler, Morse_word_gap) {
+  CHECK(LEDPATTERN_morse(&buffer, "E E"));
+
+  // E, 7 off, E, 7 off.
+  UNSIGNED_LONGS_EQUAL(16, buffer.length);
+  UNSIGNED_LONGS_EQUAL(ON, words[8]);
+}
+
+TEST(LedPatternCompiler, Status_code_blinks_then_pauses) {
+  CHECK(LEDPATTERN_code(&buffer, 3));
+
+  UNSIGNED_LONGS_EQUAL(3 * 2 * LEDPATTERN_CODE_BLINK_SLOTS +
+                           LEDPATTERN_CODE_PAUSE_SLOTS,
+                       buffer.length);
+}
+
+TEST(LedPatternCompiler, Breathing_ramps_the_duty_up_and_down) {
+  const uint32_t duty[] = {0, 2, 4, 4, 2, 0};
+
+  CHECK(LEDPATTERN_breathe(&buffer, 4, 3));
+
+  UNSIGNED_LONGS_EQUAL(24, buffer.length);
+  for (uint32_t frame = 0; frame < 6; frame++) {
+    for (uint32_t slot = 0; slot < 4; slot++) {
+      UNSIGNED_LONGS_EQUAL(slot < duty[frame] ? ON : OFF,
+                           words[frame * 4 + slot]);
+    }
+  }
+}
+
+static TIM_HandleTypeDef htim1;
+static DMA_HandleTypeDef hdma;
+static LEDPATTERN_Player player;
+
+static int led(void) {
+  return SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin) == GPIO_PIN_SET;
+}
+
+// What the EXTI callback does to swap patterns.
+static void onButton(uint16_t GPIO_Pin) {
+  if (GPIO_Pin == PUSH_BUTTON_Pin) {
+    LEDPATTERN_play(&player, otherBuffer.words, otherBuffer.length);
+  }
+}
+
+// Samples the LED once per millisecond for ms milliseconds.
+static void sample(int *levels, uint32_t ms) {
+  for (uint32_t i = 0; i < ms; i++) {
+    levels[i] = led();
+    VCLOCK_advance(1);
+  }
+}
+
+TEST_GROUP(LedPatternPlayer) {
+  void setup() {
+    VCLOCK_reset();
+    SPY_HAL_GPIO_Reset();
+    SPY_HAL_TIM_Reset();
+    SPY_HAL_DMA_Reset();
+    FAKE_setEnabled(1);
+    htim1.Instance = TIM1;
+    hdma.Instance = DMA2_Stream5;
+    CHECK(LEDPATTERN_init(&player, &htim1, &hdma, LED_GPIO_Port, LED_Pin, 10));
+
+    // 20 ms on, 10 off, 10 on, 40 off.
+    LEDPATTERN_begin(&buffer, words, 256, LED_Pin);
+    LEDPATTERN_hold(&buffer, 1, 2);
+    LEDPATTERN_hold(&buffer, 0, 1);
+    LEDPATTERN_hold(&buffer, 1, 1);
+    LEDPATTERN_hold(&buffer, 0, 4);
+    LEDPATTERN_begin(&otherBuffer, other, 256, LED_Pin);
+    LEDPATTERN_code(&otherBuffer, 1);
+  };
+  void teardown() { FAKE_setEnabled(0); };
+};
+
+TEST(LedPatternPlayer, Plays_the_waveform_in_a_loop) {
+  static int levels[240];
+
+  CHECK(LEDPATTERN_play(&player, buffer.words, buffer.length));
+  sample(levels, 240);
+
+  for (uint32_t ms = 0; ms < 240; ms++) {
+    uint32_t t = ms % 80;
+    int expected = t < 20 || (t >= 30 && t < 40);
+
+    CHECK_EQUAL_TEXT(expected, levels[ms], "waveform mismatch");
+  }
+  // One word per 10 ms slot, from 0 ms up to and including 240 ms.
+  UNSIGNED_LONGS_EQUAL(25, SPY_HAL_DMA_TransferCount(DMA2_Stream5));
+}
+
+TEST(LedPatternPlayer, No_cpu_work_while_playing) {
+  static int levels[10000];
+  uint64_t calls;
+
+  LEDPATTERN_play(&player, buffer.words, buffer.length);
+  calls = FAKE_callTotal;
+  sample(levels, 10000);
+
+  UNSIGNED_LONGS_EQUAL(calls, FAKE_callTotal);
+  UNSIGNED_LONGS_EQUAL(0, TIM1->DIER & TIM_DIER_UIE);
+  UNSIGNED_LONGS_EQUAL(1001, SPY_HAL_DMA_TransferCount(DMA2_Stream5));
+}
+
+TEST(LedPatternPlayer, Other_pins_of_the_port_are_untouched) {
+  static int levels[80];
+
+  SPY_HAL_GPIO_WritePin(LED_GPIO_Port, GPIO_PIN_6, GPIO_PIN_SET);
+  LEDPATTERN_play(&player, buffer.words, buffer.length);
+  sample(levels, 80);
+
+  CHECK_EQUAL(GPIO_PIN_SET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, GPIO_PIN_6));
+}
+
+TEST(LedPatternPlayer, Swapping_from_the_button_restarts_at_the_first_slot) {
+  static int levels[80];
+
+  LEDPATTERN_play(&player, buffer.words, buffer.length);
+  sample(levels, 25);
+  CHECK_FALSE(led());
+
+  onButton(PUSH_BUTTON_Pin);
+  sample(levels, 80);
+
+  // One status blink: 20 ms on, 20 off, then the pause.
+  for (uint32_t ms = 0; ms < 80; ms++) {
+    CHECK_EQUAL_TEXT(ms < 20, levels[ms], "swapped waveform mismatch");
+  }
+  POINTERS_EQUAL(other, player.words);
+}
+
+TEST(LedPatternPlayer, Stop_turns_the_led_off) {
+  static int levels[100];
+
+  LEDPATTERN_play(&player, buffer.words, buffer.length);
+  sample(levels, 5);
+  CHECK(led());
+
+  LEDPATTERN_stop(&player);
+  uint32_t transfers = SPY_HAL_DMA_TransferCount(DMA2_Stream5);
+  sample(levels, 100);
+
+  CHECK_FALSE(led());
+  CHECK_FALSE(LEDPATTERN_playing(&player));
+  UNSIGNED_LONGS_EQUAL(transfers, SPY_HAL_DMA_TransferCount(DMA2_Stream5));
+  UNSIGNED_LONGS_EQUAL(0, TIM1->CR1 & TIM_CR1_CEN);
+}
+
+TEST(LedPatternPlayer, Rejects_patterns_longer_than_ndtr_counts) {
+  CHECK(LEDPATTERN_play(&player, buffer.words, buffer.length));
+  uint64_t starts = FAKE_callCount(FAKE_HAL_DMA_Start);
+
+  CHECK_FALSE(LEDPATTERN_play(&player, words, LEDPATTERN_MAX_SLOTS + 1));
+  UNSIGNED_LONGS_EQUAL(starts, FAKE_callCount(FAKE_HAL_DMA_Start));
+  POINTERS_EQUAL(buffer.words, player.words);
+  CHECK(LEDPATTERN_playing(&player));
+}
+
+TEST(LedPatternPlayer, Failed_dma_start_leaves_the_player_stopped) {
+  CHECK(LEDPATTERN_play(&player, buffer.words, buffer.length));
+  uint32_t transfers = SPY_HAL_DMA_TransferCount(DMA2_Stream5);
+
+  FAKE_setEnabled(0);
+  mock()
+      .expectOneCall("HAL_DMA_Start")
+      .withPointerParameter("hdma", &hdma)
+      .ignoreOtherParameters()
+      .andReturnValue(HAL_ERROR);
+  mock().ignoreOtherCalls();
+  CHECK_FALSE(LEDPATTERN_play(&player, otherBuffer.words, otherBuffer.length));
+  mock().checkExpectations();
+  mock().clear();
+  FAKE_setEnabled(1);
+  VCLOCK_advance(100);
+
+  CHECK_FALSE(LEDPATTERN_playing(&player));
+  POINTERS_EQUAL(NULL, player.words);
+  UNSIGNED_LONGS_EQUAL(0, TIM1->CR1 & TIM_CR1_CEN);
+  UNSIGNED_LONGS_EQUAL(0, DMA2_Stream5->CR & DMA_SxCR_EN);
+  UNSIGNED_LONGS_EQUAL(transfers, SPY_HAL_DMA_TransferCount(DMA2_Stream5));
+}
+
+TEST(LedPatternPlayer, Rejects_empty_patterns_and_bad_slots) {
+  CHECK_FALSE(LEDPATTERN_play(&player, words, 0));
+  CHECK_FALSE(LEDPATTERN_init(&player, &htim1, &hdma, LED_GPIO_Port, LED_Pin,
+                              0));
+}
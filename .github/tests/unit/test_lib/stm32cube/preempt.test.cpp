@@ -0,0 +1,173 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include "apps.h"
+#include "evqueue.h"
+#include "fake.h"
+#include "main.h"
+#include "preempt.h"
+#include "report.h"
+#include "scheduler.h"
+#include "vclock.h"
+}
+
+// Loop iterations of stand-in work per loop() in the queue firmware, so it
+// drains slower than a back-to-back interrupt can fill the queue.
+#define BUSY_ITERATIONS 1000
+
+// The interrupts lab: the ISR flips the state and loop() mirrors it on the
+// LED. The state is shared, so both sides access it atomically.
+static int toggleState;
+
+static void toggleReset(void) {
+  SPY_HAL_GPIO_Reset();
+  toggleState = 0;
+}
+
+static void toggleIsr(void) {
+  __atomic_fetch_xor(&toggleState, 1, __ATOMIC_RELAXED);
+}
+
+static void toggleLoop(void) {
+  HAL_GPIO_WritePin(LED_GPIO_Port, LED_Pin,
+                    __atomic_load_n(&toggleState, __ATOMIC_RELAXED)
+                        ? GPIO_PIN_SET
+                        : GPIO_PIN_RESET);
+}
+
+static PREEMPT_Verdict toggleCheck(uint64_t fired) {
+  return (SPY_HAL_ledLevel() == (int)(fired & 1)) ? PREEMPT_OK
+                                                   : PREEMPT_LOST;
+}
+
+// The ISR queues numbered events and loop() handles at most one of them per
+// pass, so a fast enough interrupt overflows the queue.
+static EVQUEUE_Queue queue;
+static uint32_t produced;
+static uint32_t consumed;
+static uint32_t expected;
+static int ordered;
+
+static void queueReset(void) {
+  EVQUEUE_init(&queue);
+  produced = 0;
+  consumed = 0;
+  expected = 0;
+  ordered = 1;
+}
+
+static void queueIsr(void) {
+  EVQUEUE_push(&queue, produced++, PUSH_BUTTON_Pin, EVQUEUE_FALLING);
+}
+
+static void queueLoop(void) {
+  EVQUEUE_Event event;
+
+  if (EVQUEUE_drain(&queue, &event, 1) == 1) {
+    if (event.tick < expected || event.pin != PUSH_BUTTON_Pin) {
+      ordered = 0;
+    }
+    expected = event.tick + 1;
+    consumed++;
+  }
+  for (volatile int i = 0; i < BUSY_ITERATIONS; i++) {
+  }
+}
+
+static PREEMPT_Verdict queueCheck(uint64_t fired) {
+  uint32_t overflows = EVQUEUE_overflows(&queue);
+
+  if (!ordered || produced != fired || consumed + overflows != fired) {
+    return PREEMPT_CORRUPT;
+  }
+  return (overflows > 0) ? PREEMPT_LOST : PREEMPT_OK;
+}
+
+// The lib challenge app, with the virtual clock advancing 1 ms per pass.
+// Every accepted press writes the LED once, on for an odd count and off
+// for an even one, and the blink job must agree with it.
+static void challengeReset(void) {
+  VCLOCK_reset();
+  SPY_HAL_GPIO_Reset();
+  FAKE_clear();
+  CHALLENGE_setup();
+}
+
+static void challengeIsr(void) {
+  SPY_HAL_setButton(1, CHALLENGE_onButton);
+  SPY_HAL_setButton(0, CHALLENGE_onButton);
+}
+
+static void challengeLoop(void) {
+  CHALLENGE_loop();
+  VCLOCK_advance(1);
+}
+
+static PREEMPT_Verdict challengeCheck(uint64_t fired) {
+  uint64_t writes = FAKE_callCount(FAKE_HAL_GPIO_WritePin);
+
+  if (writes == 0 || writes > fired) {
+    return PREEMPT_LOST;
+  }
+  if (SCHEDULER_pending() != (uint32_t)(writes & 1)) {
+    return PREEMPT_CORRUPT;
+  }
+  return PREEMPT_OK;
+}
+
+TEST_GROUP(Preempt) {
+  PREEMPT_Result sustained;
+  PREEMPT_Result failed;
+  PREEMPT_Result result;
+
+  void setup() { FAKE_setEnabled(1); };
+  void teardown() { FAKE_setEnabled(0); };
+};
+
+TEST(Preempt, Atomic_toggle_never_loses_an_edge) {
+  PREEMPT_Config config = {toggleReset, toggleLoop, toggleIsr, toggleCheck,
+                           100001, 1};
+
+  LONGS_EQUAL(PREEMPT_OK, PREEMPT_run(&config, 0, &result));
+  UNSIGNED_LONGS_EQUAL(100001, result.fired);
+  CHECK(SPY_HAL_ledLevel());
+}
+
+TEST(Preempt, Sweep_finds_the_rate_a_slow_consumer_sustains) {
+  PREEMPT_Config config = {queueReset, queueLoop, queueIsr, queueCheck, 400,
+                           EVQUEUE_CAPACITY};
+
+  CHECK(PREEMPT_sweep(&config, 2000, 1e6, &sustained, &failed));
+  CHECK(sustained.fired > 0);
+  LONGS_EQUAL(PREEMPT_LOST, failed.verdict);
+  REPORT_value("sustained_hz", sustained.achievedHz);
+  REPORT_value("loops_per_event", (double)sustained.loops / sustained.fired);
+  REPORT_value("lost_hz", failed.achievedHz);
+}
+
+TEST(Preempt, Challenge_app_handles_presses_from_another_thread) {
+  PREEMPT_Config config = {challengeReset, challengeLoop, challengeIsr,
+                           challengeCheck, 2000, 8};
+
+  LONGS_EQUAL(PREEMPT_OK, PREEMPT_run(&config, 20000, &result));
+  CHECK(result.loops > 0);
+}
+
+TEST(Preempt, Fake_log_counts_calls_from_both_threads) {
+  PREEMPT_Config config = {challengeReset, challengeLoop, challengeIsr,
+                           challengeCheck, 1000, 0};
+
+  PREEMPT_run(&config, 0, &result);
+  UNSIGNED_LONGS_EQUAL(FAKE_callTotal,
+                       FAKE_callCount(FAKE_HAL_GetTick) +
+                           FAKE_callCount(FAKE_HAL_GPIO_ReadPin) +
+                           FAKE_callCount(FAKE_HAL_GPIO_WritePin) +
+                           FAKE_callCount(FAKE_HAL_GPIO_TogglePin));
+  CHECK(FAKE_callCount(FAKE_HAL_GetTick) >= 1000);
+}
+
+TEST(Preempt, Describes_verdicts) {
+  STRCMP_EQUAL("ok", PREEMPT_describe(PREEMPT_OK));
+  STRCMP_EQUAL("lost events", PREEMPT_describe(PREEMPT_LOST));
+  STRCMP_EQUAL("corrupted state", PREEMPT_describe(PREEMPT_CORRUPT));
+}
@@ -0,0 +1,90 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include "main.h"
+#include "profiler.h"
+#include "vclock.h"
+}
+
+TEST_GROUP(Profiler) {
+  void setup() {
+    VCLOCK_reset();
+    SPY_DWT_reset();
+    PROFILER_init();
+  };
+};
+
+TEST(Profiler, Init_starts_the_cycle_counter) {
+  CHECK(CoreDebug->DEMCR & CoreDebug_DEMCR_TRCENA_Msk);
+  CHECK(DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk);
+  UNSIGNED_LONGS_EQUAL(0, DWT->CYCCNT);
+
+  VCLOCK_advance(2);
+
+  UNSIGNED_LONGS_EQUAL(2 * SystemCoreClock / 1000, DWT->CYCCNT);
+}
+
+TEST(Profiler, ISR_duration) {
+  PROFILER_enter(PROFILER_ISR);
+  SPY_DWT_addCycles(1000);
+  PROFILER_exit(PROFILER_ISR);
+
+  PROFILER_enter(PROFILER_ISR);
+  SPY_DWT_addCycles(3);
+  PROFILER_exit(PROFILER_ISR);
+
+  const PROFILER_Probe *isr = PROFILER_get(PROFILER_ISR);
+  UNSIGNED_LONGS_EQUAL(2, isr->count);
+  UNSIGNED_LONGS_EQUAL(3, isr->min);
+  UNSIGNED_LONGS_EQUAL(1000, isr->max);
+  UNSIGNED_LONGS_EQUAL(1003, isr->total);
+  UNSIGNED_LONGS_EQUAL(1, isr->histogram[2]);
+  UNSIGNED_LONGS_EQUAL(1, isr->histogram[10]);
+  UNSIGNED_LONGS_EQUAL(3, PROFILER_percentile(PROFILER_ISR, 50));
+  UNSIGNED_LONGS_EQUAL(1000, PROFILER_percentile(PROFILER_ISR, 99));
+}
+
+TEST(Profiler, ISR_nested_in_loop) {
+  PROFILER_enter(PROFILER_LOOP);
+  SPY_DWT_addCycles(100);
+  PROFILER_enter(PROFILER_ISR);
+  SPY_DWT_addCycles(50);
+  PROFILER_exit(PROFILER_ISR);
+  PROFILER_exit(PROFILER_LOOP);
+
+  UNSIGNED_LONGS_EQUAL(50, PROFILER_get(PROFILER_ISR)->max);
+  UNSIGNED_LONGS_EQUAL(150, PROFILER_get(PROFILER_LOOP)->max);
+}
+
+TEST(Profiler, Loop_period_jitter) {
+  for (int i = 0; i < 100; i++) {
+    PROFILER_mark(PROFILER_LOOP_PERIOD);
+    VCLOCK_advance(1);
+    SPY_DWT_addCycles(i == 50 ? 4000 : 0);
+  }
+  PROFILER_mark(PROFILER_LOOP_PERIOD);
+
+  const PROFILER_Probe *period = PROFILER_get(PROFILER_LOOP_PERIOD);
+  UNSIGNED_LONGS_EQUAL(100, period->count);
+  UNSIGNED_LONGS_EQUAL(84000, period->min);
+  UNSIGNED_LONGS_EQUAL(88000, period->max);
+}
+
+TEST(Profiler, Duration_across_counter_wrap) {
+  DWT->CYCCNT = 0xFFFFFF00UL;
+
+  PROFILER_enter(PROFILER_ISR);
+  SPY_DWT_addCycles(0x200);
+  PROFILER_exit(PROFILER_ISR);
+
+  UNSIGNED_LONGS_EQUAL(0x200, PROFILER_get(PROFILER_ISR)->max);
+  UNSIGNED_LONGS_EQUAL(0x100, DWT->CYCCNT);
+}
+
+TEST(Profiler, Exit_without_enter_is_ignored) {
+  PROFILER_exit(PROFILER_ISR);
+  PROFILER_enter(PROFILER_PROBES);
+
+  UNSIGNED_LONGS_EQUAL(0, PROFILER_get(PROFILER_ISR)->count);
+  POINTERS_EQUAL(NULL, PROFILER_get(PROFILER_PROBES));
+}
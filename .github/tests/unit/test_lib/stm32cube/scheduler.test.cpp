@@ -0,0 +1,266 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include "apps.h"
+#include "debounce.h"
+#include "fake.h"
+#include "main.h"
+#include "scheduler.h"
+#include "vclock.h"
+}
+
+static uint32_t runs[4];
+static int selfId = -1;
+
+static void count(void *context) { runs[(intptr_t)context]++; }
+
+static void cancelSelf(void *context) {
+  runs[(intptr_t)context]++;
+  SCHEDULER_cancel(selfId);
+}
+
+static void rescheduleSelf(void *context) {
+  runs[(intptr_t)context]++;
+  if (runs[(intptr_t)context] < 3) {
+    SCHEDULER_after(10, rescheduleSelf, context);
+  }
+}
+
+TEST_GROUP(Scheduler) {
+  void setup() {
+    memset(runs, 0, sizeof(runs));
+    SCHEDULER_init(0);
+  };
+};
+
+TEST(Scheduler, One_shot_runs_once_when_due) {
+  SCHEDULER_after(100, count, (void *)0);
+
+  UNSIGNED_LONGS_EQUAL(0, SCHEDULER_run(99));
+  UNSIGNED_LONGS_EQUAL(1, SCHEDULER_run(100));
+  UNSIGNED_LONGS_EQUAL(0, SCHEDULER_run(1000));
+  UNSIGNED_LONGS_EQUAL(1, runs[0]);
+  UNSIGNED_LONGS_EQUAL(0, SCHEDULER_pending());
+}
+
+TEST(Scheduler, Jobs_run_in_deadline_order) {
+  uint32_t deadline = 0;
+
+  SCHEDULER_every(300, count, (void *)2);
+  SCHEDULER_after(100, count, (void *)0);
+  SCHEDULER_after(200, count, (void *)1);
+
+  CHECK(SCHEDULER_nextDeadline(&deadline));
+  UNSIGNED_LONGS_EQUAL(100, deadline);
+  SCHEDULER_run(150);
+  UNSIGNED_LONGS_EQUAL(1, runs[0]);
+  UNSIGNED_LONGS_EQUAL(0, runs[1]);
+  CHECK(SCHEDULER_nextDeadline(&deadline));
+  UNSIGNED_LONGS_EQUAL(200, deadline);
+  SCHEDULER_run(300);
+  UNSIGNED_LONGS_EQUAL(1, runs[1]);
+  UNSIGNED_LONGS_EQUAL(1, runs[2]);
+  CHECK(SCHEDULER_nextDeadline(&deadline));
+  UNSIGNED_LONGS_EQUAL(600, deadline);
+}
+
+TEST(Scheduler, Periodic_job_keeps_phase_and_skips_missed_periods) {
+  uint32_t deadline = 0;
+
+  SCHEDULER_every(100, count, (void *)0);
+
+  SCHEDULER_run(130);
+  SCHEDULER_nextDeadline(&deadline);
+  UNSIGNED_LONGS_EQUAL(200, deadline);
+
+  SCHEDULER_run(750);
+  SCHEDULER_nextDeadline(&deadline);
+  UNSIGNED_LONGS_EQUAL(800, deadline);
+  UNSIGNED_LONGS_EQUAL(2, runs[0]);
+}
+
+TEST(Scheduler, Deadlines_across_tick_wrap) {
+  uint32_t deadline = 0;
+
+  SCHEDULER_init(0xFFFFFF00UL);
+  SCHEDULER_every(0x200, count, (void *)0);
+  SCHEDULER_after(0x80, count, (void *)1);
+
+  SCHEDULER_nextDeadline(&deadline);
+  UNSIGNED_LONGS_EQUAL(0xFFFFFF80UL, deadline);
+  UNSIGNED_LONGS_EQUAL(1, SCHEDULER_run(0xFFFFFFFFUL));
+  UNSIGNED_LONGS_EQUAL(0, runs[0]);
+  UNSIGNED_LONGS_EQUAL(1, SCHEDULER_run(0x100));
+  UNSIGNED_LONGS_EQUAL(1, runs[0]);
+  SCHEDULER_nextDeadline(&deadline);
+  UNSIGNED_LONGS_EQUAL(0x300, deadline);
+}
+
+TEST(Scheduler, Cancel_ignores_stale_ids) {
+  int first = SCHEDULER_after(10, count, (void *)0);
+  SCHEDULER_cancel(first);
+  int second = SCHEDULER_after(10, count, (void *)1);
+
+  // second reuses first's slot
+  SCHEDULER_cancel(first);
+  SCHEDULER_run(10);
+
+  CHECK(first != second);
+  UNSIGNED_LONGS_EQUAL(0, runs[0]);
+  UNSIGNED_LONGS_EQUAL(1, runs[1]);
+}
+
+TEST(Scheduler, Cancel_from_the_middle_of_the_heap) {
+  int ids[8];
+
+  for (int i = 0; i < 8; i++) {
+    ids[i] = SCHEDULER_after(10 * (i + 1), count, (void *)(intptr_t)(i % 2));
+  }
+  SCHEDULER_cancel(ids[2]);
+  SCHEDULER_cancel(ids[5]);
+
+  UNSIGNED_LONGS_EQUAL(6, SCHEDULER_run(100));
+  UNSIGNED_LONGS_EQUAL(3, runs[0]);
+  UNSIGNED_LONGS_EQUAL(3, runs[1]);
+}
+
+TEST(Scheduler, Table_full) {
+  for (int i = 0; i < SCHEDULER_JOBS; i++) {
+    CHECK(SCHEDULER_after(1, count, (void *)0) >= 0);
+  }
+
+  LONGS_EQUAL(-1, SCHEDULER_after(1, count, (void *)0));
+  LONGS_EQUAL(-1, SCHEDULER_every(0, count, (void *)0));
+  UNSIGNED_LONGS_EQUAL(SCHEDULER_JOBS, SCHEDULER_run(1));
+  CHECK(SCHEDULER_after(1, count, (void *)0) >= 0);
+}
+
+TEST(Scheduler, Jobs_cancel_and_reschedule_themselves) {
+  selfId = SCHEDULER_every(10, cancelSelf, (void *)0);
+  SCHEDULER_after(10, rescheduleSelf, (void *)1);
+
+  for (uint32_t now = 0; now <= 100; now += 5) {
+    SCHEDULER_run(now);
+  }
+
+  UNSIGNED_LONGS_EQUAL(1, runs[0]);
+  UNSIGNED_LONGS_EQUAL(3, runs[1]);
+  UNSIGNED_LONGS_EQUAL(0, SCHEDULER_pending());
+}
+
+static void reportDeadline(void) {
+  uint32_t deadline;
+
+  if (SCHEDULER_nextDeadline(&deadline)) {
+    VCLOCK_requestDeadline(deadline);
+  }
+}
+
+static void blinkLoop(void) {
+  BLINK_loop();
+  reportDeadline();
+}
+
+// A clean press and release, one edge interrupt each.
+static void tap(void) {
+  SPY_HAL_setButton(1, CHALLENGE_onButton);
+  SPY_HAL_setButton(0, CHALLENGE_onButton);
+}
+
+static void challengeLoop(void) {
+  CHALLENGE_loop();
+  reportDeadline();
+}
+
+TEST_GROUP(ScheduledApps) {
+  void setup() {
+    VCLOCK_reset();
+    SPY_HAL_GPIO_Reset();
+    FAKE_setEnabled(1);
+  };
+  void teardown() { FAKE_setEnabled(0); };
+};
+
+TEST(ScheduledApps, Blink_wakes_only_at_deadlines) {
+  BLINK_setup();
+
+  uint64_t iterations = VCLOCK_run(blinkLoop, 10000, 60000);
+
+  // One loop() per toggle: at 0 s, then 1 s to 9 s.
+  UNSIGNED_LONGS_EQUAL(10, iterations);
+  CHECK_EQUAL(GPIO_PIN_SET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+  VCLOCK_run(blinkLoop, 10001, 60000);
+  CHECK_EQUAL(GPIO_PIN_RESET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+}
+
+TEST(ScheduledApps, Challenge_blinks_between_presses) {
+  CHALLENGE_setup();
+  VCLOCK_run(challengeLoop, 1000, 60000);
+  CHECK_EQUAL(GPIO_PIN_RESET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+
+  tap();
+  VCLOCK_run(challengeLoop, 1001, 60000);
+  CHECK_EQUAL(GPIO_PIN_SET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+  VCLOCK_run(challengeLoop, 1501, 60000);
+  CHECK_EQUAL(GPIO_PIN_RESET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+  VCLOCK_run(challengeLoop, 2001, 60000);
+  CHECK_EQUAL(GPIO_PIN_SET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+
+  tap();
+  VCLOCK_run(challengeLoop, 2100, 60000);
+  CHECK_EQUAL(GPIO_PIN_RESET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+  UNSIGNED_LONGS_EQUAL(0, SCHEDULER_pending());
+
+  // Other EXTI lines are not the button
+  CHALLENGE_onButton(0x0001);
+  VCLOCK_run(challengeLoop, 5000, 60000);
+  CHECK_EQUAL(GPIO_PIN_RESET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+}
+
+TEST(ScheduledApps, Second_press_before_loop_is_not_lost) {
+  CHALLENGE_setup();
+  VCLOCK_run(challengeLoop, 1000, 60000);
+
+  // Presses further apart than the debounce window, all before loop() runs
+  tap();
+  VCLOCK_advance(DEBOUNCE_QUIET_MS);
+  tap();
+  VCLOCK_advance(DEBOUNCE_QUIET_MS);
+  tap();
+  VCLOCK_run(challengeLoop, VCLOCK_now64() + 1, 60000);
+
+  CHECK_EQUAL(GPIO_PIN_SET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+  UNSIGNED_LONGS_EQUAL(1, SCHEDULER_pending());
+
+  VCLOCK_advance(DEBOUNCE_QUIET_MS);
+  tap();
+  VCLOCK_run(challengeLoop, VCLOCK_now64() + 1, 60000);
+  CHECK_EQUAL(GPIO_PIN_RESET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+  UNSIGNED_LONGS_EQUAL(0, SCHEDULER_pending());
+}
+
+TEST(ScheduledApps, Press_with_the_scheduler_full_leaves_the_led_off) {
+  int ids[SCHEDULER_JOBS];
+
+  CHALLENGE_setup();
+  for (int i = 0; i < SCHEDULER_JOBS; i++) {
+    ids[i] = SCHEDULER_every(60000, count, (void *)0);
+    CHECK(ids[i] >= 0);
+  }
+  VCLOCK_run(challengeLoop, 1000, 60000);
+
+  tap();
+  VCLOCK_run(challengeLoop, 1001, 60000);
+  CHECK_EQUAL(GPIO_PIN_RESET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+  UNSIGNED_LONGS_EQUAL(1, CHALLENGE_failures());
+  UNSIGNED_LONGS_EQUAL(SCHEDULER_JOBS, SCHEDULER_pending());
+
+  // Once a slot is free the next press starts blinking
+  SCHEDULER_cancel(ids[0]);
+  VCLOCK_advance(DEBOUNCE_QUIET_MS);
+  tap();
+  VCLOCK_run(challengeLoop, VCLOCK_now64() + 1, 60000);
+  CHECK_EQUAL(GPIO_PIN_SET, SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin));
+  UNSIGNED_LONGS_EQUAL(1, CHALLENGE_failures());
+  UNSIGNED_LONGS_EQUAL(SCHEDULER_JOBS, SCHEDULER_pending());
+}
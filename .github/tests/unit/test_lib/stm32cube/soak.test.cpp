@@ -0,0 +1,148 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include "apps.h"
+#include "fake.h"
+#include "main.h"
+#include "scheduler.h"
+#include "soak.h"
+#include "vclock.h"
+#include <stdlib.h>
+}
+
+static uint32_t previousMillis = 0;
+
+static int oneJob(void) { return SCHEDULER_pending() == 1; }
+
+static void reportDeadline(void) {
+  uint32_t deadline;
+
+  if (SCHEDULER_nextDeadline(&deadline)) {
+    VCLOCK_requestDeadline(deadline);
+  }
+}
+
+static void blinkLoop(void) {
+  BLINK_loop();
+  reportDeadline();
+}
+
+static void challengeLoop(void) {
+  CHALLENGE_loop();
+  reportDeadline();
+}
+
+// The classic wrap bug: the sum overflows right before the tick does.
+static void wrapBugLoop(void) {
+  uint32_t now = HAL_GetTick();
+
+  if (now >= previousMillis + 1000) {
+    previousMillis = now;
+    HAL_GPIO_TogglePin(LED_GPIO_Port, LED_Pin);
+  }
+}
+
+static void stuckLoop(void) { HAL_GetTick(); }
+
+static void crashingLoop(void) {
+  wrapBugLoop();
+  if (HAL_GetTick() >= 2500) {
+    abort();
+  }
+}
+
+static void dropJobs(void *context) { SCHEDULER_init(VCLOCK_now()); }
+
+TEST_GROUP(Soak) {
+  void setup() {
+    VCLOCK_reset();
+    SPY_HAL_GPIO_Reset();
+    FAKE_setEnabled(1);
+  };
+  void teardown() { FAKE_setEnabled(0); };
+};
+
+TEST(Soak, Blink_app_across_three_tick_wraps) {
+  SOAK_Config config = {blinkLoop, SPY_HAL_ledLevel, oneJob, BLINK_PERIOD_MS,
+                        0, 3};
+  SOAK_Result result;
+
+  BLINK_setup();
+  SOAK_run(&config, &result);
+
+  CHECK_TEXT(result.violation == SOAK_OK, SOAK_describe(&result));
+  UNSIGNED_LONGS_EQUAL(3, result.wraps);
+  CHECK(result.edges >= 3 * (0x100000000ULL / BLINK_PERIOD_MS) - 1);
+}
+
+TEST(Soak, Challenge_app_across_three_tick_wraps) {
+  SOAK_Config config = {challengeLoop, SPY_HAL_ledLevel, oneJob,
+                        CHALLENGE_PERIOD_MS, 0, 3};
+  SOAK_Result result;
+
+  // Start late in the first epoch so the first wrap comes quickly.
+  VCLOCK_setNow64(0xFFFF0000ULL);
+  CHALLENGE_setup();
+  SPY_HAL_setButton(1, CHALLENGE_onButton);
+  SPY_HAL_setButton(0, CHALLENGE_onButton);
+  CHALLENGE_loop();
+  SOAK_run(&config, &result);
+
+  CHECK_TEXT(result.violation == SOAK_OK, SOAK_describe(&result));
+  UNSIGNED_LONGS_EQUAL(3, result.wraps);
+  CHECK(result.edges >= 3 * (0x100000000ULL / CHALLENGE_PERIOD_MS) - 1);
+}
+
+TEST(Soak, Catches_a_wrap_bug) {
+  SOAK_Config config = {wrapBugLoop, SPY_HAL_ledLevel, NULL, 1000, 0, 1};
+  SOAK_Result result;
+
+  previousMillis = 0;
+
+  LONGS_EQUAL(SOAK_EARLY, SOAK_run(&config, &result));
+  UNSIGNED_LONGS_EQUAL(0, result.wraps);
+  CHECK(result.violationAt > 0xFFFFFFFFULL - 1000);
+  CHECK(result.violationAt <= 0xFFFFFFFFULL);
+}
+
+TEST(Soak, Catches_a_stuck_LED) {
+  SOAK_Config config = {stuckLoop, SPY_HAL_ledLevel, NULL, 1000, 5, 1};
+  SOAK_Result result;
+
+  LONGS_EQUAL(SOAK_LATE, SOAK_run(&config, &result));
+  UNSIGNED_LONGS_EQUAL(1006, result.violationAt);
+}
+
+TEST(Soak, Stops_on_a_broken_invariant) {
+  SOAK_Config config = {blinkLoop, SPY_HAL_ledLevel, oneJob, BLINK_PERIOD_MS,
+                        0, 1};
+  SOAK_Result result;
+
+  BLINK_setup();
+  VCLOCK_schedule(5000, dropJobs, NULL);
+
+  LONGS_EQUAL(SOAK_BROKEN, SOAK_run(&config, &result));
+  UNSIGNED_LONGS_EQUAL(5000, result.violationAt);
+}
+
+TEST(Soak, Isolated_run_leaves_the_firmware_as_it_was) {
+  SOAK_Config config = {wrapBugLoop, SPY_HAL_ledLevel, NULL, 1000, 0, 1};
+  SOAK_Result result;
+
+  previousMillis = 0;
+
+  LONGS_EQUAL(SOAK_EARLY, SOAK_runIsolated(&config, &result));
+  CHECK(result.violationAt > 0xFFFFFFFFULL - 1000);
+  UNSIGNED_LONGS_EQUAL(0, previousMillis);
+  UNSIGNED_LONGS_EQUAL(0, VCLOCK_now64());
+}
+
+TEST(Soak, Isolated_run_reports_a_crash) {
+  SOAK_Config config = {crashingLoop, SPY_HAL_ledLevel, NULL, 1000, 0, 1};
+  SOAK_Result result;
+
+  previousMillis = 0;
+
+  LONGS_EQUAL(SOAK_CRASHED, SOAK_runIsolated(&config, &result));
+  UNSIGNED_LONGS_EQUAL(0, result.violationAt);
+}
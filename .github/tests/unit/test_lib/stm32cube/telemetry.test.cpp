@@ -0,0 +1,345 @@
+#include "CppUTest/TestHarness.h"
+
+#include <string.h>
+
+extern "C" {
+#include "fake.h"
+#include "main.h"
+#include "telemetry.h"
+#include "vclock.h"
+
+extern UART_HandleTypeDef huart2;
+}
+
+// 115200 8N1 is 11520 bytes a second, or 960 records.
+#define LINE_BYTES_PER_S 11520U
+#define RECORD_BYTES sizeof(TELEMETRY_Record)
+
+static TELEMETRY_Channel channel;
+static TELEMETRY_Stats stats;
+static TELEMETRY_Record records[4096];
+static uint32_t completions;
+
+extern "C" void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+  completions++;
+  TELEMETRY_onTxComplete(&channel, huart);
+}
+
+extern "C" void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+  TELEMETRY_onTxError(&channel, huart);
+}
+
+static uint32_t decode(void) {
+  uint32_t length;
+  const uint8_t *wire = SPY_HAL_UART_Wire(USART2, &length);
+  uint32_t count = length / RECORD_BYTES;
+
+  UNSIGNED_LONGS_EQUAL(0, length % RECORD_BYTES);
+  CHECK(count <= sizeof(records) / sizeof(records[0]));
+  memcpy(records, wire, count * RECORD_BYTES);
+  for (uint32_t i = 0; i < count; i++) {
+    UNSIGNED_LONGS_EQUAL(TELEMETRY_SYNC, records[i].sync);
+  }
+  return count;
+}
+
+// Polls until everything logged has gone out.
+static void drain(void) {
+  while (TELEMETRY_pending(&channel) > 0 || channel.sending > 0) {
+    TELEMETRY_poll(&channel);
+    VCLOCK_advance(1);
+  }
+}
+
+static void floodLoop(void) {
+  TELEMETRY_log(&channel, TELEMETRY_ID_USER, VCLOCK_now());
+  TELEMETRY_log(&channel, TELEMETRY_ID_USER + 1, VCLOCK_now());
+  TELEMETRY_poll(&channel);
+}
+
+static uint32_t previousMillis;
+static uint32_t toggleAt[8];
+static uint32_t toggles;
+
+static void blink(uint32_t now) {
+  if (now - previousMillis >= 500 && toggles < 8) {
+    previousMillis = now;
+    HAL_GPIO_TogglePin(LED_GPIO_Port, LED_Pin);
+    toggleAt[toggles++] = now;
+  }
+}
+
+// The scheduling lab's blink, chatting about every pass.
+static void telemetryBlinkLoop(void) {
+  blink(HAL_GetTick());
+  for (uint32_t i = 0; i < 8; i++) {
+    TELEMETRY_log(&channel, TELEMETRY_ID_USER, i);
+  }
+  TELEMETRY_poll(&channel);
+}
+
+static void blockingBlinkLoop(void) {
+  static const uint8_t message[6 * RECORD_BYTES] = {0};
+
+  blink(HAL_GetTick());
+  HAL_UART_Transmit(&huart2, message, sizeof(message), 100);
+}
+
+TEST_GROUP(UartFake) {
+  void setup() {
+    SPY_HAL_UART_Reset();
+    VCLOCK_reset();
+    FAKE_setEnabled(1);
+    MX_USART2_UART_Init();
+  };
+  void teardown() {
+    SPY_HAL_UART_Reset();
+    FAKE_setEnabled(0);
+  };
+};
+
+TEST(UartFake, Blocking_transmit_holds_the_caller_for_the_wire_time) {
+  static const uint8_t message[48] = {1, 2, 3};
+  uint32_t length;
+
+  // 480 bits at 115200 baud is 4.17 ms.
+  UNSIGNED_LONGS_EQUAL(HAL_OK, HAL_UART_Transmit(&huart2, message, 48, 100));
+  UNSIGNED_LONGS_EQUAL(5, VCLOCK_now());
+  MEMCMP_EQUAL(message, SPY_HAL_UART_Wire(USART2, &length), 48);
+  UNSIGNED_LONGS_EQUAL(48, length);
+}
+
+TEST(UartFake, Blocking_transmit_times_out_part_way) {
+  static const uint8_t message[100] = {0};
+
+  UNSIGNED_LONGS_EQUAL(HAL_TIMEOUT,
+                       HAL_UART_Transmit(&huart2, message, 100, 2));
+  UNSIGNED_LONGS_EQUAL(2, VCLOCK_now());
+  UNSIGNED_LONGS_EQUAL(23, SPY_HAL_UART_ByteCount(USART2));
+}
+
+TEST(UartFake, Dma_transmit_returns_at_once_and_completes_later) {
+  static const uint8_t message[48] = {0};
+
+  UNSIGNED_LONGS_EQUAL(HAL_OK, HAL_UART_Transmit_DMA(&huart2, message, 48));
+  UNSIGNED_LONGS_EQUAL(0, VCLOCK_now());
+  LONGS_EQUAL(HAL_UART_STATE_BUSY_TX, huart2.gState);
+  UNSIGNED_LONGS_EQUAL(HAL_BUSY, HAL_UART_Transmit_DMA(&huart2, message, 1));
+  UNSIGNED_LONGS_EQUAL(HAL_BUSY,
+                       HAL_UART_Transmit(&huart2, message, 1, 100));
+
+  VCLOCK_advance(4);
+  UNSIGNED_LONGS_EQUAL(0, SPY_HAL_UART_TransferCount(USART2));
+  VCLOCK_advance(1);
+  UNSIGNED_LONGS_EQUAL(1, SPY_HAL_UART_TransferCount(USART2));
+  UNSIGNED_LONGS_EQUAL(48, SPY_HAL_UART_ByteCount(USART2));
+  LONGS_EQUAL(HAL_UART_STATE_READY, huart2.gState);
+}
+
+TEST_GROUP(Telemetry) {
+  void setup() {
+    SPY_HAL_UART_Reset();
+    VCLOCK_reset();
+    SPY_HAL_GPIO_Reset();
+    FAKE_setEnabled(1);
+    FAKE_clear();
+    MX_USART2_UART_Init();
+    TELEMETRY_init(&channel, &huart2);
+    completions = 0;
+    previousMillis = 0;
+    toggles = 0;
+  };
+  void teardown() {
+    SPY_HAL_UART_Reset();
+    TELEMETRY_init(&channel, NULL);
+    FAKE_setEnabled(0);
+  };
+};
+
+TEST(Telemetry, Records_go_out_framed_and_in_order) {
+  VCLOCK_advance(7);
+  CHECK(TELEMETRY_log(&channel, TELEMETRY_ID_BUTTON, PUSH_BUTTON_Pin));
+  CHECK(TELEMETRY_log(&channel, TELEMETRY_ID_LED, 1));
+  CHECK(TELEMETRY_log(&channel, TELEMETRY_ID_USER, 0xDEADBEEF));
+
+  UNSIGNED_LONGS_EQUAL(3, TELEMETRY_poll(&channel));
+  drain();
+
+  UNSIGNED_LONGS_EQUAL(3, decode());
+  UNSIGNED_LONGS_EQUAL(TELEMETRY_ID_BUTTON, records[0].id);
+  UNSIGNED_LONGS_EQUAL(PUSH_BUTTON_Pin, records[0].value);
+  UNSIGNED_LONGS_EQUAL(7, records[0].tick);
+  UNSIGNED_LONGS_EQUAL(TELEMETRY_ID_USER, records[2].id);
+  UNSIGNED_LONGS_EQUAL(0xDEADBEEF, records[2].value);
+  for (uint16_t i = 0; i < 3; i++) {
+    UNSIGNED_LONGS_EQUAL(i, records[i].seq);
+  }
+  TELEMETRY_stats(&channel, &stats);
+  UNSIGNED_LONGS_EQUAL(3, stats.sent);
+  UNSIGNED_LONGS_EQUAL(3 * RECORD_BYTES, stats.bytes);
+}
+
+TEST(Telemetry, A_full_ring_drops_and_counts_instead_of_waiting) {
+  for (uint32_t i = 0; i < TELEMETRY_CAPACITY; i++) {
+    CHECK(TELEMETRY_log(&channel, TELEMETRY_ID_USER, i));
+  }
+  for (uint32_t i = 0; i < 6; i++) {
+    CHECK_FALSE(TELEMETRY_log(&channel, TELEMETRY_ID_USER, i));
+  }
+  UNSIGNED_LONGS_EQUAL(0, VCLOCK_now());
+
+  TELEMETRY_stats(&channel, &stats);
+  UNSIGNED_LONGS_EQUAL(TELEMETRY_CAPACITY, stats.logged);
+  UNSIGNED_LONGS_EQUAL(6, stats.dropped);
+  UNSIGNED_LONGS_EQUAL(TELEMETRY_CAPACITY, stats.highWater);
+
+  // The host sees the drops as a jump in the sequence numbers.
+  drain();
+  CHECK(TELEMETRY_log(&channel, TELEMETRY_ID_LED, 0));
+  drain();
+  UNSIGNED_LONGS_EQUAL(TELEMETRY_CAPACITY + 1, decode());
+  UNSIGNED_LONGS_EQUAL(TELEMETRY_CAPACITY - 1,
+                       records[TELEMETRY_CAPACITY - 1].seq);
+  UNSIGNED_LONGS_EQUAL(TELEMETRY_CAPACITY + 6,
+                       records[TELEMETRY_CAPACITY].seq);
+}
+
+TEST(Telemetry, Double_buffering_keeps_the_line_busy_under_load) {
+  // Twice what the line can carry.
+  VCLOCK_run(floodLoop, 2000, 1);
+
+  TELEMETRY_stats(&channel, &stats);
+  uint64_t bytes = SPY_HAL_UART_ByteCount(USART2);
+  CHECK(bytes >= LINE_BYTES_PER_S * 2 * 99 / 100);
+  CHECK(bytes <= LINE_BYTES_PER_S * 2);
+  UNSIGNED_LONGS_EQUAL(bytes, stats.bytes);
+  UNSIGNED_LONGS_EQUAL(stats.sent, decode());
+  UNSIGNED_LONGS_EQUAL(2 * 2000, stats.logged + stats.dropped);
+  CHECK(stats.dropped > 1900);
+  UNSIGNED_LONGS_EQUAL(0, stats.errors);
+  // Full buffers only, after the first: the completion chains them.
+  CHECK(SPY_HAL_UART_TransferCount(USART2) <=
+        stats.sent / TELEMETRY_BATCH + 2);
+}
+
+TEST(Telemetry, Records_from_interrupts_and_loop_interleave_in_order) {
+  struct Isr {
+    static void fire(void *context) {
+      TELEMETRY_log(&channel, TELEMETRY_ID_BUTTON, VCLOCK_now());
+      if (VCLOCK_now() < 300) {
+        VCLOCK_scheduleIn(3, fire, context);
+      }
+    }
+    static void loop(void) {
+      if (VCLOCK_now() % 4 == 0) {
+        TELEMETRY_log(&channel, TELEMETRY_ID_LED, VCLOCK_now());
+      }
+      TELEMETRY_poll(&channel);
+    }
+  };
+
+  // Together well under the line rate, so nothing is dropped.
+  VCLOCK_scheduleIn(3, Isr::fire, NULL);
+  VCLOCK_run(Isr::loop, 301, 1);
+  drain();
+
+  uint32_t count = decode();
+  uint32_t fromIsr = 0;
+
+  TELEMETRY_stats(&channel, &stats);
+  UNSIGNED_LONGS_EQUAL(0, stats.dropped);
+  UNSIGNED_LONGS_EQUAL(stats.logged, count);
+  for (uint32_t i = 0; i < count; i++) {
+    UNSIGNED_LONGS_EQUAL((uint16_t)i, records[i].seq);
+    if (i > 0) {
+      CHECK(records[i].tick >= records[i - 1].tick);
+    }
+    fromIsr += records[i].id == TELEMETRY_ID_BUTTON;
+  }
+  UNSIGNED_LONGS_EQUAL(100, fromIsr);
+}
+
+TEST(Telemetry, Loop_never_waits_for_the_wire) {
+  static const uint8_t message[4 * RECORD_BYTES] = {0};
+  uint64_t worstStall = 0;
+  uint32_t worstMoved = 0;
+
+  for (uint32_t pass = 0; pass < 1000; pass++) {
+    uint64_t before = VCLOCK_now64();
+
+    for (uint32_t i = 0; i < 4; i++) {
+      TELEMETRY_log(&channel, TELEMETRY_ID_USER, i);
+    }
+    uint32_t moved = TELEMETRY_poll(&channel);
+
+    worstMoved = moved > worstMoved ? moved : worstMoved;
+    worstStall = VCLOCK_now64() - before > worstStall
+                     ? VCLOCK_now64() - before
+                     : worstStall;
+    VCLOCK_advance(1);
+  }
+
+  UNSIGNED_LONGS_EQUAL(0, worstStall);
+  CHECK(worstMoved <= TELEMETRY_BATCH);
+  CHECK(FAKE_callCount(FAKE_HAL_UART_Transmit_DMA) <= 1000 + completions);
+
+  // Sending the same 4 records with a blocking write stalls loop() for
+  // the 4.2 ms they take on the wire.
+  drain();
+  uint64_t before = VCLOCK_now64();
+  HAL_UART_Transmit(&huart2, message, sizeof(message), 100);
+  UNSIGNED_LONGS_EQUAL(5, VCLOCK_now64() - before);
+}
+
+TEST(Telemetry, Blink_keeps_time_while_logging) {
+  VCLOCK_run(telemetryBlinkLoop, 4001, 1);
+
+  UNSIGNED_LONGS_EQUAL(8, toggles);
+  for (uint32_t i = 0; i < toggles; i++) {
+    UNSIGNED_LONGS_EQUAL(500 * (i + 1), toggleAt[i]);
+  }
+}
+
+TEST(Telemetry, Blocking_writes_make_the_blink_drift) {
+  VCLOCK_run(blockingBlinkLoop, 4501, 1);
+
+  // 72 bytes hold each pass up for 7 ms on top of the 1 ms step, so every
+  // period stretches to the next multiple of 8 ms.
+  UNSIGNED_LONGS_EQUAL(8, toggles);
+  for (uint32_t i = 0; i < toggles; i++) {
+    UNSIGNED_LONGS_EQUAL(504 * (i + 1), toggleAt[i]);
+  }
+}
+
+TEST(Telemetry, A_failed_transfer_is_counted_and_the_next_one_goes_out) {
+  for (uint32_t i = 0; i < 3; i++) {
+    TELEMETRY_log(&channel, TELEMETRY_ID_USER, i);
+  }
+  TELEMETRY_poll(&channel);
+  SPY_HAL_UART_Error(&huart2, HAL_UART_ERROR_FE);
+  TELEMETRY_log(&channel, TELEMETRY_ID_LED, 0);
+  drain();
+
+  TELEMETRY_stats(&channel, &stats);
+  UNSIGNED_LONGS_EQUAL(1, stats.errors);
+  UNSIGNED_LONGS_EQUAL(3, stats.dropped);
+  UNSIGNED_LONGS_EQUAL(1, stats.sent);
+  UNSIGNED_LONGS_EQUAL(1, decode());
+  UNSIGNED_LONGS_EQUAL(3, records[0].seq);
+}
+
+TEST(Telemetry, A_busy_uart_is_retried_on_the_next_poll) {
+  static const uint8_t other[24] = {0};
+
+  HAL_UART_Transmit_DMA(&huart2, other, sizeof(other));
+  TELEMETRY_log(&channel, TELEMETRY_ID_USER, 1);
+  TELEMETRY_poll(&channel);
+  TELEMETRY_stats(&channel, &stats);
+  UNSIGNED_LONGS_EQUAL(1, stats.errors);
+
+  drain();
+  TELEMETRY_stats(&channel, &stats);
+  UNSIGNED_LONGS_EQUAL(1, stats.sent);
+  UNSIGNED_LONGS_EQUAL(sizeof(other) + RECORD_BYTES,
+                       SPY_HAL_UART_ByteCount(USART2));
+}
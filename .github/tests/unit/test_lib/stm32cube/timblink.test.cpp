@@ -0,0 +1,227 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" {
+#include "fake.h"
+#include "main.h"
+#include "timblink.h"
+#include "vclock.h"
+}
+
+static TIM_HandleTypeDef htim2;
+static TIM_HandleTypeDef htim3;
+static uint32_t elapsed[16];
+static uint32_t elapsedCount = 0;
+static int forward = 0;
+
+void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
+  if (forward) {
+    TIMBLINK_onPeriodElapsed(htim);
+  } else if (elapsedCount < 16) {
+    elapsed[elapsedCount++] = HAL_GetTick();
+  }
+}
+
+void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+  if (forward) {
+    TIMBLINK_onButton(GPIO_Pin);
+  }
+}
+
+static void initTimer(TIM_HandleTypeDef *htim, TIM_TypeDef *TIMx,
+                      uint32_t prescaler, uint32_t period) {
+  htim->Instance = TIMx;
+  htim->Init.Prescaler = prescaler;
+  htim->Init.Period = period;
+  HAL_TIM_Base_Init(htim);
+}
+
+TEST_GROUP(TimMock) {
+  void setup() {
+    VCLOCK_reset();
+    SPY_HAL_TIM_Reset();
+    FAKE_setEnabled(1);
+    elapsedCount = 0;
+    forward = 0;
+  };
+  void teardown() { FAKE_setEnabled(0); };
+};
+
+TEST(TimMock, Counter_follows_the_virtual_clock) {
+  // 84 MHz / 8400 = 10 kHz, overflowing every second.
+  initTimer(&htim2, TIM2, 8399, 9999);
+  __HAL_TIM_CLEAR_FLAG(&htim2, TIM_FLAG_UPDATE);
+  HAL_TIM_Base_Start_IT(&htim2);
+
+  VCLOCK_advance(250);
+  UNSIGNED_LONGS_EQUAL(2500, __HAL_TIM_GET_COUNTER(&htim2));
+  VCLOCK_advance(1000);
+  UNSIGNED_LONGS_EQUAL(2500, __HAL_TIM_GET_COUNTER(&htim2));
+}
+
+TEST(TimMock, Update_interrupt_every_period) {
+  initTimer(&htim2, TIM2, 8399, 4999);
+  __HAL_TIM_CLEAR_FLAG(&htim2, TIM_FLAG_UPDATE);
+  HAL_TIM_Base_Start_IT(&htim2);
+
+  VCLOCK_advance(1600);
+
+  UNSIGNED_LONGS_EQUAL(3, elapsedCount);
+  UNSIGNED_LONGS_EQUAL(500, elapsed[0]);
+  UNSIGNED_LONGS_EQUAL(1000, elapsed[1]);
+  UNSIGNED_LONGS_EQUAL(1500, elapsed[2]);
+  UNSIGNED_LONGS_EQUAL(0, TIM2->SR);
+}
+
+TEST(TimMock, Init_leaves_the_update_flag_set) {
+  initTimer(&htim2, TIM2, 8399, 4999);
+  CHECK(__HAL_TIM_GET_FLAG(&htim2, TIM_FLAG_UPDATE));
+
+  HAL_TIM_Base_Start_IT(&htim2);
+
+  UNSIGNED_LONGS_EQUAL(1, elapsedCount);
+  UNSIGNED_LONGS_EQUAL(0, elapsed[0]);
+}
+
+TEST(TimMock, Stop_freezes_the_counter) {
+  initTimer(&htim2, TIM2, 8399, 9999);
+  __HAL_TIM_CLEAR_FLAG(&htim2, TIM_FLAG_UPDATE);
+  HAL_TIM_Base_Start_IT(&htim2);
+  VCLOCK_advance(1300);
+
+  HAL_TIM_Base_Stop_IT(&htim2);
+  VCLOCK_advance(5000);
+
+  UNSIGNED_LONGS_EQUAL(1, elapsedCount);
+  UNSIGNED_LONGS_EQUAL(3000, __HAL_TIM_GET_COUNTER(&htim2));
+  UNSIGNED_LONGS_EQUAL(0, TIM2->CR1 & TIM_CR1_CEN);
+  UNSIGNED_LONGS_EQUAL(1, FAKE_callCount(FAKE_HAL_TIM_Base_Stop_IT));
+}
+
+TEST(TimMock, Timers_run_independently) {
+  initTimer(&htim2, TIM2, 8399, 9999);
+  initTimer(&htim3, TIM3, 8399, 2999);
+  __HAL_TIM_CLEAR_FLAG(&htim2, TIM_FLAG_UPDATE);
+  __HAL_TIM_CLEAR_FLAG(&htim3, TIM_FLAG_UPDATE);
+  HAL_TIM_Base_Start_IT(&htim2);
+  HAL_TIM_Base_Start_IT(&htim3);
+
+  VCLOCK_advance(3000);
+
+  UNSIGNED_LONGS_EQUAL(3, SPY_HAL_TIM_UpdateCount(TIM2));
+  UNSIGNED_LONGS_EQUAL(10, SPY_HAL_TIM_UpdateCount(TIM3));
+}
+
+// 84 MHz / 30000 = 2800 Hz: a 1000-count period is 357.14... ms, which
+// must not drift however long the timer runs.
+TEST(TimMock, Fractional_periods_do_not_drift) {
+  initTimer(&htim2, TIM2, 29999, 999);
+  __HAL_TIM_CLEAR_FLAG(&htim2, TIM_FLAG_UPDATE);
+  HAL_TIM_Base_Start_IT(&htim2);
+
+  VCLOCK_advance(999999);
+  UNSIGNED_LONGS_EQUAL(2799, SPY_HAL_TIM_UpdateCount(TIM2));
+  VCLOCK_advance(1);
+  UNSIGNED_LONGS_EQUAL(2800, SPY_HAL_TIM_UpdateCount(TIM2));
+  UNSIGNED_LONGS_EQUAL(0, __HAL_TIM_GET_COUNTER(&htim2));
+}
+
+static GPIO_PinState led(void) {
+  return SPY_HAL_GPIO_ReadPin(LED_GPIO_Port, LED_Pin);
+}
+
+TEST_GROUP(Timblink) {
+  void setup() {
+    VCLOCK_reset();
+    SPY_HAL_GPIO_Reset();
+    SPY_HAL_TIM_Reset();
+    FAKE_setEnabled(1);
+    FAKE_clear();
+    forward = 1;
+    htim2.Instance = TIM2;
+  };
+  void teardown() {
+    FAKE_setEnabled(0);
+    forward = 0;
+  };
+};
+
+TEST(Timblink, Configures_a_10_kHz_count) {
+  CHECK(TIMBLINK_init(&htim2, 500));
+  UNSIGNED_LONGS_EQUAL(8399, TIM2->PSC);
+  UNSIGNED_LONGS_EQUAL(4999, TIM2->ARR);
+
+  CHECK_FALSE(TIMBLINK_init(&htim2, 0));
+  CHECK_FALSE(TIMBLINK_init(&htim2, 6554));
+}
+
+TEST(Timblink, Scheduling_lab_keeps_no_time_in_loop) {
+  TIMBLINK_init(&htim2, 1000);
+  TIMBLINK_start();
+  CHECK_EQUAL(GPIO_PIN_SET, led());
+
+  VCLOCK_advance(999);
+  CHECK_EQUAL(GPIO_PIN_SET, led());
+  VCLOCK_advance(1);
+  CHECK_EQUAL(GPIO_PIN_RESET, led());
+  VCLOCK_advance(9000);
+
+  CHECK_EQUAL(GPIO_PIN_SET, led());
+  UNSIGNED_LONGS_EQUAL(10, FAKE_callCount(FAKE_HAL_GPIO_TogglePin));
+  UNSIGNED_LONGS_EQUAL(0, FAKE_callCount(FAKE_HAL_GetTick));
+}
+
+TEST(Timblink, Button_starts_and_stops_the_timer) {
+  TIMBLINK_init(&htim2, 500);
+  VCLOCK_advance(1000);
+  CHECK_EQUAL(GPIO_PIN_RESET, led());
+
+  SPY_HAL_setButton(1, SPY_HAL_GPIO_EXTI_Trigger);
+  SPY_HAL_setButton(0, SPY_HAL_GPIO_EXTI_Trigger);
+  CHECK(TIMBLINK_running());
+  CHECK_EQUAL(GPIO_PIN_SET, led());
+  VCLOCK_advance(500);
+  CHECK_EQUAL(GPIO_PIN_RESET, led());
+  VCLOCK_advance(500);
+  CHECK_EQUAL(GPIO_PIN_SET, led());
+
+  VCLOCK_advance(100);
+  SPY_HAL_setButton(1, SPY_HAL_GPIO_EXTI_Trigger);
+  SPY_HAL_setButton(0, SPY_HAL_GPIO_EXTI_Trigger);
+  CHECK_FALSE(TIMBLINK_running());
+  CHECK_EQUAL(GPIO_PIN_RESET, led());
+  UNSIGNED_LONGS_EQUAL(0, TIM2->CR1 & TIM_CR1_CEN);
+  VCLOCK_advance(5000);
+  CHECK_EQUAL(GPIO_PIN_RESET, led());
+  UNSIGNED_LONGS_EQUAL(2, FAKE_callCount(FAKE_HAL_GPIO_TogglePin));
+
+  // Restarting gives a full period before the first toggle.
+  SPY_HAL_setButton(1, SPY_HAL_GPIO_EXTI_Trigger);
+  SPY_HAL_setButton(0, SPY_HAL_GPIO_EXTI_Trigger);
+  VCLOCK_advance(499);
+  CHECK_EQUAL(GPIO_PIN_SET, led());
+}
+
+TEST(Timblink, Bounces_do_not_restart_the_timer) {
+  TIMBLINK_init(&htim2, 500);
+
+  SPY_HAL_setButton(1, SPY_HAL_GPIO_EXTI_Trigger);
+  VCLOCK_advance(2);
+  SPY_HAL_setButton(0, SPY_HAL_GPIO_EXTI_Trigger);
+  VCLOCK_advance(3);
+  SPY_HAL_setButton(1, SPY_HAL_GPIO_EXTI_Trigger);
+
+  CHECK(TIMBLINK_running());
+  UNSIGNED_LONGS_EQUAL(1, FAKE_callCount(FAKE_HAL_TIM_Base_Start_IT));
+  UNSIGNED_LONGS_EQUAL(0, FAKE_callCount(FAKE_HAL_TIM_Base_Stop_IT));
+}
+
+TEST(Timblink, Other_timers_and_pins_are_ignored) {
+  TIMBLINK_init(&htim2, 500);
+  htim3.Instance = TIM3;
+
+  TIMBLINK_onPeriodElapsed(&htim3);
+  SPY_HAL_GPIO_EXTI_Trigger(GPIO_PIN_0);
+
+  CHECK_FALSE(TIMBLINK_running());
+  UNSIGNED_LONGS_EQUAL(0, FAKE_callCount(FAKE_HAL_GPIO_TogglePin));
+}
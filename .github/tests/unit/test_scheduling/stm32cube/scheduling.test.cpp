@@ -6,12 +6,24 @@
 
 // STM32Cube app functions prototypes
 extern "C" {
+#include "fake.h"
 #include "main.h"
+#include "soak.h"
+#include "vclock.h"
 extern void setup(void);
 extern void loop(void);
 }
 
-TEST_GROUP(Scheduling){};
+// The soak runs in a child process, so the tick of the last toggle that
+// app.c keeps after three wraps never reaches the other tests.
+TEST_GROUP(Scheduling) {
+  void setup() {
+    VCLOCK_reset();
+    SPY_HAL_GPIO_Reset();
+    FAKE_clear();
+  };
+  void teardown() { FAKE_setEnabled(0); };
+};
 
 TEST(Scheduling, Blink_without_delay_loop) {
   for (int i = 0; i <= 10; ++i) {
@@ -33,4 +45,17 @@ TEST(Scheduling, Blink_without_delay_loop) {
     mock().checkExpectations();
     mock().clear();
   }
-}
\ No newline at end of file
+}
+
+TEST(Scheduling, Soak_blink_across_three_tick_wraps) {
+  SOAK_Config config = {::loop, SPY_HAL_ledLevel, SPY_HAL_neverBlocks, 1000,
+                        0, 3};
+  SOAK_Result result;
+
+  FAKE_setEnabled(1);
+  SOAK_runIsolated(&config, &result);
+
+  CHECK_TEXT(result.violation == SOAK_OK, SOAK_describe(&result));
+  UNSIGNED_LONGS_EQUAL(3, result.wraps);
+  CHECK(result.edges >= 3 * (0x100000000ULL / 1000) - 1);
+}
@@ -0,0 +1,87 @@
+#include "binlog.h"
+#include <string.h>
+
+// head and tail count words, run freely and wrap; head - tail is the fill
+// level.
+static uint32_t ring[BINLOG_CAPACITY];
+static uint32_t head;
+static uint32_t tail;
+static BINLOG_Stats stats;
+
+void BINLOG_reset(void) {
+  head = 0;
+  tail = 0;
+  memset(&stats, 0, sizeof(stats));
+}
+
+// Any context, through BINLOG().
+void BINLOG_write(uint32_t header, uint32_t a0, uint32_t a1, uint32_t a2,
+                  uint32_t a3) {
+  uint32_t words = 2 + ((header >> 8) & 0xFFU);
+  uint32_t tick = HAL_GetTick();
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  uint32_t at = head;
+  uint32_t level = at - __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+
+  if (BINLOG_CAPACITY - level < words) {
+    stats.dropped++;
+    __set_PRIMASK(primask);
+    return;
+  }
+
+  ring[at & (BINLOG_CAPACITY - 1)] = header;
+  ring[(at + 1) & (BINLOG_CAPACITY - 1)] = tick;
+  switch (words) {
+  case 6:
+    ring[(at + 5) & (BINLOG_CAPACITY - 1)] = a3;
+    /* fall through */
+  case 5:
+    ring[(at + 4) & (BINLOG_CAPACITY - 1)] = a2;
+    /* fall through */
+  case 4:
+    ring[(at + 3) & (BINLOG_CAPACITY - 1)] = a1;
+    /* fall through */
+  case 3:
+    ring[(at + 2) & (BINLOG_CAPACITY - 1)] = a0;
+    break;
+  default:
+    break;
+  }
+  __atomic_store_n(&head, at + words, __ATOMIC_RELEASE);
+  stats.frames++;
+  if (level + words > stats.highWater) {
+    stats.highWater = level + words;
+  }
+  __set_PRIMASK(primask);
+}
+
+// loop() only. Copies up to max words in order; a frame cut short at the
+// end carries on in the next call.
+uint32_t BINLOG_drain(uint32_t *words, uint32_t max) {
+  uint32_t from = tail;
+  uint32_t count = __atomic_load_n(&head, __ATOMIC_ACQUIRE) - from;
+
+  if (count > max) {
+    count = max;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    words[i] = ring[(from + i) & (BINLOG_CAPACITY - 1)];
+  }
+  __atomic_store_n(&tail, from + count, __ATOMIC_RELEASE);
+  return count;
+}
+
+uint32_t BINLOG_pending(void) {
+  return __atomic_load_n(&head, __ATOMIC_ACQUIRE) -
+         __atomic_load_n(&tail, __ATOMIC_ACQUIRE);
+}
+
+void BINLOG_stats(BINLOG_Stats *out) {
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  *out = stats;
+  __set_PRIMASK(primask);
+}
@@ -0,0 +1,106 @@
+#ifndef Binlog_H__
+#define Binlog_H__
+
+#include "main.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Deferred-format logging: the firmware never formats text.
+//
+// Each BINLOG() call site puts its format string in the binlog linker
+// section, and the string's offset in that section is its id. A call
+// copies a one-word header, the tick and up to four 32-bit arguments into a
+// ring of words, which costs a few dozen cycles and no stack to speak of,
+// so it is cheap enough for HAL_GPIO_EXTI_Callback(). Text is rebuilt on
+// the host by binlogdecode (.github/tests/tools/binlog) from the firmware's
+// ELF, or from a dictionary of just that section:
+//
+//   arm-none-eabi-objcopy -O binary --only-section=binlog app.elf app.dict
+//
+//   BINLOG("button %u pressed, blinking %d", GPIO_Pin, blinking);
+//
+// Arguments are converted to uint32_t, so the formats take the integer
+// conversions: d, i, u, x, X, o, c and p, with the usual flags, width and
+// precision. Strings and floating point are not carried; log a fixed-point
+// value or an enum instead. GNU ld defines __start_binlog for the section
+// on its own, and as the strings are referenced from code they survive
+// --gc-sections without a KEEP() in the linker script; on the target the
+// section goes to flash with the rest of the read-only data.
+//
+// Ids are 16 bits, so the section must stay within 64 KiB or the ids of
+// the formats past it alias earlier ones. Have the linker check it by
+// adding this after the SECTIONS block of the CubeMX linker script
+// (STM32F401RETX_FLASH.ld on the Nucleo-F401RE):
+//
+//   ASSERT(SIZEOF(binlog) <= 0x10000, "binlog formats exceed 64 KiB")
+//
+// binlogdecode refuses dictionaries larger than that as well.
+//
+// Frames are whole words, little-endian as the core stores them: the
+// header has BINLOG_SYNC in its low byte, the argument count in the next
+// and the id in the top half. Calls from loop() and from ISRs may nest:
+// space is claimed with interrupts masked for a handful of instructions,
+// and when the ring is full the frame is dropped and counted. loop() takes
+// the words out with BINLOG_drain() and sends them however it likes, for
+// instance with HAL_UART_Transmit_DMA().
+
+#ifndef BINLOG_CAPACITY
+#define BINLOG_CAPACITY 256
+#endif
+
+#if (BINLOG_CAPACITY & (BINLOG_CAPACITY - 1)) != 0
+#error "BINLOG_CAPACITY must be a power of two"
+#endif
+
+#define BINLOG_SYNC 0xB1U
+#define BINLOG_ARGS_MAX 4
+#define BINLOG_FRAME_WORDS_MAX (2 + BINLOG_ARGS_MAX)
+
+extern const char __start_binlog[];
+extern const char __stop_binlog[];
+
+#define BINLOG_HEADER(format, count)                                         \
+  ((uint32_t)((format) - __start_binlog) << 16 | (uint32_t)(count) << 8 |    \
+   BINLOG_SYNC)
+
+#define BINLOG_FORMAT(format, count, a0, a1, a2, a3)                         \
+  do {                                                                       \
+    static const char binlogFormat[]                                         \
+        __attribute__((section("binlog"), used)) = format;                   \
+    BINLOG_write(BINLOG_HEADER(binlogFormat, count), (uint32_t)(a0),         \
+                 (uint32_t)(a1), (uint32_t)(a2), (uint32_t)(a3));            \
+  } while (0)
+
+#define BINLOG_0(f) BINLOG_FORMAT(f, 0, 0, 0, 0, 0)
+#define BINLOG_1(f, a) BINLOG_FORMAT(f, 1, a, 0, 0, 0)
+#define BINLOG_2(f, a, b) BINLOG_FORMAT(f, 2, a, b, 0, 0)
+#define BINLOG_3(f, a, b, c) BINLOG_FORMAT(f, 3, a, b, c, 0)
+#define BINLOG_4(f, a, b, c, d) BINLOG_FORMAT(f, 4, a, b, c, d)
+#define BINLOG_PICK(f, a, b, c, d, e, name, ...) name
+
+// A fifth argument picks a name that does not exist, so the error says so.
+#define BINLOG(...)                                                          \
+  BINLOG_PICK(__VA_ARGS__, BINLOG_TOO_MANY_ARGUMENTS, BINLOG_4, BINLOG_3,    \
+              BINLOG_2, BINLOG_1, BINLOG_0, )(__VA_ARGS__)
+
+typedef struct {
+  uint32_t frames;
+  uint32_t dropped;
+  uint32_t highWater;
+} BINLOG_Stats;
+
+void BINLOG_reset(void);
+void BINLOG_write(uint32_t header, uint32_t a0, uint32_t a1, uint32_t a2,
+                  uint32_t a3);
+uint32_t BINLOG_drain(uint32_t *words, uint32_t max);
+uint32_t BINLOG_pending(void);
+void BINLOG_stats(BINLOG_Stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Binlog_H__ */
@@ -0,0 +1,103 @@
+#ifndef Blinker_HPP__
+#define Blinker_HPP__
+
+#include <Arduino.h>
+#include <stdint.h>
+
+// Header-only LED and button components with every constant resolved at
+// compile time.
+//
+// Arduino numbers pins globally, so there is no port argument. Pins,
+// periods and interrupt modes are template arguments, and an instance holds
+// nothing but its timestamp and the level it last wrote:
+//
+//   static BLINKER::Blinker<LED, 500> led;
+//   using Button = BLINKER::Button<PUSH_BUTTON, FALLING>;
+//
+//   void setup()
+//   {
+//       led.begin();
+//       Button::attach(toggleBlinking);
+//   }
+//   void loop() { led.run(millis()); }
+
+namespace BLINKER
+{
+
+// Toggles Pin every PeriodMs once started. Like the labs, the next period
+// is counted from the millis() the toggle was seen, not from the deadline.
+template <uint32_t Pin, unsigned long PeriodMs> class Blinker
+{
+    static_assert(PeriodMs > 0, "a blink period is at least 1 ms");
+
+public:
+    static constexpr uint32_t pin = Pin;
+    static constexpr unsigned long periodMs = PeriodMs;
+
+    void begin()
+    {
+        pinMode(Pin, OUTPUT);
+        stop();
+    }
+
+    // Drives the LED on and restarts the period from now.
+    void start(unsigned long now)
+    {
+        write(HIGH);
+        previous = now;
+    }
+
+    void stop() { write(LOW); }
+
+    void run(unsigned long now)
+    {
+        if (now - previous >= PeriodMs)
+        {
+            previous = now;
+            write(!level);
+        }
+    }
+
+private:
+    void write(bool value)
+    {
+        level = value;
+        digitalWrite(Pin, level);
+    }
+
+    unsigned long previous = 0;
+    bool level = LOW;
+};
+
+template <uint32_t Pin, unsigned long PeriodMs>
+constexpr uint32_t Blinker<Pin, PeriodMs>::pin;
+template <uint32_t Pin, unsigned long PeriodMs>
+constexpr unsigned long Blinker<Pin, PeriodMs>::periodMs;
+
+// A button on an external interrupt. Mode is one of attachInterrupt()'s:
+// RISING, FALLING or CHANGE, or LOW or HIGH for a level.
+template <uint32_t Pin, uint32_t Mode> struct Button
+{
+    static_assert(Mode == RISING || Mode == FALLING || Mode == CHANGE ||
+                      Mode == LOW || Mode == HIGH,
+                  "not an attachInterrupt() mode");
+
+    static constexpr uint32_t pin = Pin;
+    static constexpr uint32_t mode = Mode;
+
+    static void attach(callback_function_t callback)
+    {
+        pinMode(Pin, INPUT);
+        attachInterrupt(digitalPinToInterrupt(Pin), callback, Mode);
+    }
+
+    static void detach() { detachInterrupt(digitalPinToInterrupt(Pin)); }
+};
+
+template <uint32_t Pin, uint32_t Mode> constexpr uint32_t Button<Pin, Mode>::pin;
+template <uint32_t Pin, uint32_t Mode>
+constexpr uint32_t Button<Pin, Mode>::mode;
+
+} // namespace BLINKER
+
+#endif /* Blinker_HPP__ */
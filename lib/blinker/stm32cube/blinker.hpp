@@ -0,0 +1,122 @@
+#ifndef Blinker_HPP__
+#define Blinker_HPP__
+
+#include "main.h"
+#include <stdint.h>
+
+// Header-only LED and button components with every constant resolved at
+// compile time.
+//
+// A port is a type whose static get() returns the GPIO_TypeDef; GpioA to
+// GpioK cover the built-in ports. Pins and periods are template arguments,
+// so run() compiles to the same compare-and-toggle as the hand-written labs
+// and an instance holds nothing but its own timestamp:
+//
+//   static BLINKER::Blinker<BLINKER::GpioA, LED_Pin, 500> led;
+//   static BLINKER::Blinker<BLINKER::GpioB, GPIO_PIN_7, 1000> heartbeat;
+//   using Button = BLINKER::Button<PUSH_BUTTON_Pin, BLINKER::FALLING>;
+//
+//   void setup(void) { Button::arm(); }
+//   void loop(void) {
+//     led.run(HAL_GetTick());
+//     heartbeat.run(HAL_GetTick());
+//   }
+//   void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+//     if (Button::matches(GPIO_Pin)) { ... }
+//   }
+
+namespace BLINKER {
+
+#define BLINKER_PORT(Name, GPIOx)                                              \
+  struct Name {                                                                \
+    static GPIO_TypeDef *get(void) { return GPIOx; }                          \
+  }
+
+BLINKER_PORT(GpioA, GPIOA);
+BLINKER_PORT(GpioB, GPIOB);
+BLINKER_PORT(GpioC, GPIOC);
+BLINKER_PORT(GpioD, GPIOD);
+BLINKER_PORT(GpioE, GPIOE);
+BLINKER_PORT(GpioF, GPIOF);
+BLINKER_PORT(GpioG, GPIOG);
+BLINKER_PORT(GpioH, GPIOH);
+BLINKER_PORT(GpioI, GPIOI);
+BLINKER_PORT(GpioJ, GPIOJ);
+BLINKER_PORT(GpioK, GPIOK);
+
+#undef BLINKER_PORT
+
+template <uint16_t Pin> struct SinglePin {
+  static_assert(Pin != 0 && (Pin & (Pin - 1)) == 0,
+                "a pin is a single GPIO_PIN_x");
+  static constexpr uint16_t value = Pin;
+};
+
+// Toggles Pin every PeriodMs once started. Like the labs, the next period
+// is counted from the tick the toggle was seen, not from the deadline.
+template <typename Port, uint16_t Pin, uint32_t PeriodMs> class Blinker {
+  static_assert(PeriodMs > 0, "a blink period is at least 1 ms");
+
+public:
+  static constexpr uint16_t pin = SinglePin<Pin>::value;
+  static constexpr uint32_t periodMs = PeriodMs;
+
+  // Drives the LED on and restarts the period from now.
+  void start(uint32_t now) {
+    HAL_GPIO_WritePin(Port::get(), Pin, GPIO_PIN_SET);
+    previous = now;
+  }
+
+  void stop(void) { HAL_GPIO_WritePin(Port::get(), Pin, GPIO_PIN_RESET); }
+
+  void run(uint32_t now) {
+    if (now - previous >= PeriodMs) {
+      previous = now;
+      HAL_GPIO_TogglePin(Port::get(), Pin);
+    }
+  }
+
+private:
+  uint32_t previous = 0;
+};
+
+template <typename Port, uint16_t Pin, uint32_t PeriodMs>
+constexpr uint16_t Blinker<Port, Pin, PeriodMs>::pin;
+template <typename Port, uint16_t Pin, uint32_t PeriodMs>
+constexpr uint32_t Blinker<Port, Pin, PeriodMs>::periodMs;
+
+enum Edge { RISING = 1, FALLING = 2, BOTH = RISING | FALLING };
+
+// An EXTI button. arm() unmasks the line and selects its edges, which
+// CubeMX otherwise does in MX_GPIO_Init(); matches() picks the line out of
+// HAL_GPIO_EXTI_Callback().
+template <uint16_t Pin, Edge Trigger> struct Button {
+  static constexpr uint16_t pin = SinglePin<Pin>::value;
+  static constexpr Edge edge = Trigger;
+
+  static void arm(void) {
+    if (Trigger & RISING) {
+      EXTI->RTSR |= Pin;
+    } else {
+      EXTI->RTSR &= ~(uint32_t)Pin;
+    }
+    if (Trigger & FALLING) {
+      EXTI->FTSR |= Pin;
+    } else {
+      EXTI->FTSR &= ~(uint32_t)Pin;
+    }
+    EXTI->IMR |= Pin;
+  }
+
+  static void disarm(void) { EXTI->IMR &= ~(uint32_t)Pin; }
+
+  static constexpr bool matches(uint16_t GPIO_Pin) { return GPIO_Pin == Pin; }
+};
+
+template <uint16_t Pin, Edge Trigger>
+constexpr uint16_t Button<Pin, Trigger>::pin;
+template <uint16_t Pin, Edge Trigger> constexpr Edge Button<Pin, Trigger>::edge;
+
+} // namespace BLINKER
+
+#endif /* Blinker_HPP__ */
@@ -0,0 +1,28 @@
+#include "debounce.h"
+
+void DEBOUNCE_init(DEBOUNCE_Filter *filter, uint32_t quietMs) {
+  filter->lastEdge = 0;
+  filter->quietMs = quietMs;
+  filter->accepted = 0;
+  filter->rejected = 0;
+  filter->lastPressed = 0;
+  filter->pressed = 0;
+}
+
+// Call from the ISR only, with the level read after the edge. Returns 1 for
+// the first edge of a press.
+int DEBOUNCE_edge(DEBOUNCE_Filter *filter, uint32_t tick, int pressed) {
+  if (tick - filter->lastEdge >= filter->quietMs) {
+    filter->pressed = filter->lastPressed;
+  }
+  filter->lastEdge = tick;
+  filter->lastPressed = pressed != 0;
+
+  if (filter->pressed || !pressed) {
+    filter->rejected++;
+    return 0;
+  }
+  filter->pressed = 1;
+  filter->accepted++;
+  return 1;
+}
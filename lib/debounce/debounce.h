@@ -0,0 +1,54 @@
+#ifndef Debounce_H__
+#define Debounce_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Timestamp-based debounce for edge interrupts.
+//
+// A bouncing contact fires the EXTI line several times within a few
+// milliseconds, and it bounces on release as well as on press. The line
+// must therefore trigger on both edges, and the ISR calls DEBOUNCE_edge()
+// with the current tick and whether the pin reads pressed. Reading the pin
+// tells press from release: the level read after the last edge of a burst
+// is the level the contact settled at, even when the EXTI merged some of
+// the edges before it into one interrupt.
+//
+// The filter keeps the debounced state of the button. It takes the line as
+// settled at the last level it read once quietMs have passed without an
+// edge, which is only known when the next edge arrives. An edge that reads
+// pressed while the button is settled released is the press: it is
+// accepted at once, and everything until the line has been quiet again at
+// the released level is bounce. Nothing is locked out by time, so a hold
+// of any length counts once and presses only need to be quietMs apart;
+// a press starting sooner after the previous release merges with its
+// bounce and is missed.
+//
+// The filter never waits: the cost per edge is a subtraction and a few
+// compares. Ticks are compared by unsigned difference, so the filter works
+// across tick wraps.
+
+#ifndef DEBOUNCE_QUIET_MS
+#define DEBOUNCE_QUIET_MS 20
+#endif
+
+typedef struct {
+  uint32_t lastEdge;
+  uint32_t quietMs;
+  uint32_t accepted;
+  uint32_t rejected;
+  uint8_t lastPressed;
+  uint8_t pressed;
+} DEBOUNCE_Filter;
+
+void DEBOUNCE_init(DEBOUNCE_Filter *filter, uint32_t quietMs);
+int DEBOUNCE_edge(DEBOUNCE_Filter *filter, uint32_t tick, int pressed);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Debounce_H__ */
@@ -0,0 +1,39 @@
+#include "dispatch.h"
+
+static DISPATCH_Handler handlers[DISPATCH_LINES] = {
+    DISPATCH_ignore, DISPATCH_ignore, DISPATCH_ignore, DISPATCH_ignore,
+    DISPATCH_ignore, DISPATCH_ignore, DISPATCH_ignore, DISPATCH_ignore,
+    DISPATCH_ignore, DISPATCH_ignore, DISPATCH_ignore, DISPATCH_ignore,
+    DISPATCH_ignore, DISPATCH_ignore, DISPATCH_ignore, DISPATCH_ignore};
+
+void DISPATCH_ignore(uint16_t GPIO_Pin) {}
+
+void DISPATCH_init(void) {
+  for (uint32_t line = 0; line < DISPATCH_LINES; line++) {
+    handlers[line] = DISPATCH_ignore;
+  }
+}
+
+// GPIO_Pin must name exactly one line; a null handler unregisters it.
+int DISPATCH_register(uint16_t GPIO_Pin, DISPATCH_Handler handler) {
+  if (GPIO_Pin == 0 || (GPIO_Pin & (GPIO_Pin - 1U)) != 0) {
+    return 0;
+  }
+
+  handlers[31U - __CLZ(GPIO_Pin)] = handler ? handler : DISPATCH_ignore;
+  return 1;
+}
+
+void DISPATCH_run(const DISPATCH_Handler *table, uint16_t lines) {
+  uint32_t pending = __HAL_GPIO_EXTI_GET_IT(lines);
+
+  __HAL_GPIO_EXTI_CLEAR_IT(pending);
+  while (pending != 0U) {
+    uint32_t line = 31U - __CLZ(pending);
+
+    pending &= ~(1UL << line);
+    table[line]((uint16_t)(1U << line));
+  }
+}
+
+void DISPATCH_irq(uint16_t lines) { DISPATCH_run(handlers, lines); }
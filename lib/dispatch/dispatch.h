@@ -0,0 +1,56 @@
+#ifndef Dispatch_H__
+#define Dispatch_H__
+
+#include "main.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Table-driven dispatch of the 16 GPIO EXTI lines.
+//
+// Instead of a HAL_GPIO_EXTI_Callback() that compares GPIO_Pin against each
+// pin in turn, every line gets a slot in a table of handlers, and lines
+// without one point at DISPATCH_ignore(). DISPATCH_irq() reads EXTI->PR
+// once, masked with the lines of the vector being serviced, clears what it
+// read, and then walks the pending bits with CLZ, highest line first,
+// calling each line's handler with its GPIO_PIN_x. The work per interrupt
+// depends only on how many lines are pending, never on how many are
+// registered, and unrelated pins cost nothing.
+//
+// Call DISPATCH_irq() from every EXTIx_IRQHandler() in place of
+// HAL_GPIO_EXTI_IRQHandler(), passing that vector's lines:
+//
+//   void EXTI15_10_IRQHandler(void) { DISPATCH_irq(DISPATCH_EXTI15_10); }
+//
+// Lines of other vectors stay pending for their own handler, which the
+// NVIC may run at another priority. Lines are cleared before their
+// handlers run, so an edge during a handler is pending again on return and
+// not lost. Register handlers before enabling the EXTI interrupts;
+// dispatch.hpp builds the table at compile time instead.
+
+#define DISPATCH_LINES 16
+
+// The GPIO lines each EXTI vector serves.
+#define DISPATCH_EXTI0 0x0001U
+#define DISPATCH_EXTI1 0x0002U
+#define DISPATCH_EXTI2 0x0004U
+#define DISPATCH_EXTI3 0x0008U
+#define DISPATCH_EXTI4 0x0010U
+#define DISPATCH_EXTI9_5 0x03E0U
+#define DISPATCH_EXTI15_10 0xFC00U
+
+typedef void (*DISPATCH_Handler)(uint16_t GPIO_Pin);
+
+void DISPATCH_ignore(uint16_t GPIO_Pin);
+void DISPATCH_init(void);
+int DISPATCH_register(uint16_t GPIO_Pin, DISPATCH_Handler handler);
+void DISPATCH_run(const DISPATCH_Handler *table, uint16_t lines);
+void DISPATCH_irq(uint16_t lines);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Dispatch_H__ */
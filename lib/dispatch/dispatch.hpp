@@ -0,0 +1,77 @@
+#ifndef Dispatch_HPP__
+#define Dispatch_HPP__
+
+#include "dispatch.h"
+
+// Compile-time registration for the EXTI dispatcher.
+//
+// Each DISPATCH::Line binds a GPIO_PIN_x to a handler, and
+// DISPATCH::Table<Lines...> folds them into a constexpr handler array, so
+// the table lives in flash and no init code runs:
+//
+//   using Exti = DISPATCH::Table<DISPATCH::Line<PUSH_BUTTON_Pin, onButton>,
+//                                DISPATCH::Line<GPIO_PIN_0, onEncoder>>;
+//
+//   extern "C" void EXTI15_10_IRQHandler(void) {
+//     Exti::irq(DISPATCH_EXTI15_10);
+//   }
+//
+// A pin that is not a single line, or that is bound twice, fails to compile.
+
+namespace DISPATCH {
+
+template <uint16_t Pin, DISPATCH_Handler Handler> struct Line {
+  static_assert(Pin != 0 && (Pin & (Pin - 1)) == 0,
+                "an EXTI line is a single GPIO_PIN_x");
+  static constexpr uint16_t pin = Pin;
+  static constexpr DISPATCH_Handler handler = Handler;
+};
+
+template <typename... Lines> struct Find;
+
+template <> struct Find<> {
+  static constexpr DISPATCH_Handler at(uint32_t line) {
+    return DISPATCH_ignore;
+  }
+  static constexpr uint32_t count(uint16_t pin) { return 0; }
+};
+
+template <typename First, typename... Rest> struct Find<First, Rest...> {
+  static constexpr DISPATCH_Handler at(uint32_t line) {
+    return First::pin == (1U << line) ? First::handler
+                                      : Find<Rest...>::at(line);
+  }
+  static constexpr uint32_t count(uint16_t pin) {
+    return (First::pin == pin ? 1 : 0) + Find<Rest...>::count(pin);
+  }
+};
+
+template <typename... Lines> struct Unique;
+
+template <> struct Unique<> { static constexpr bool value = true; };
+
+template <typename First, typename... Rest> struct Unique<First, Rest...> {
+  static constexpr bool value =
+      Find<Rest...>::count(First::pin) == 0 && Unique<Rest...>::value;
+};
+
+template <typename... Lines> struct Table {
+  static_assert(Unique<Lines...>::value, "an EXTI line is bound twice");
+
+  static constexpr DISPATCH_Handler handlers[DISPATCH_LINES] = {
+      Find<Lines...>::at(0),  Find<Lines...>::at(1),  Find<Lines...>::at(2),
+      Find<Lines...>::at(3),  Find<Lines...>::at(4),  Find<Lines...>::at(5),
+      Find<Lines...>::at(6),  Find<Lines...>::at(7),  Find<Lines...>::at(8),
+      Find<Lines...>::at(9),  Find<Lines...>::at(10), Find<Lines...>::at(11),
+      Find<Lines...>::at(12), Find<Lines...>::at(13), Find<Lines...>::at(14),
+      Find<Lines...>::at(15)};
+
+  static void irq(uint16_t lines) { DISPATCH_run(handlers, lines); }
+};
+
+template <typename... Lines>
+constexpr DISPATCH_Handler Table<Lines...>::handlers[DISPATCH_LINES];
+
+} // namespace DISPATCH
+
+#endif /* Dispatch_HPP__ */
@@ -0,0 +1,52 @@
+#include "evqueue.h"
+#include <string.h>
+
+void EVQUEUE_init(EVQUEUE_Queue *queue) { memset(queue, 0, sizeof(*queue)); }
+
+// Producer side: call from the ISR only.
+int EVQUEUE_push(EVQUEUE_Queue *queue, uint32_t tick, uint16_t pin,
+                 EVQUEUE_Edge edge) {
+  uint32_t head = queue->head;
+  uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+
+  if (head - tail >= EVQUEUE_CAPACITY) {
+    __atomic_store_n(&queue->overflows, queue->overflows + 1,
+                     __ATOMIC_RELAXED);
+    return 0;
+  }
+
+  EVQUEUE_Event *event = &queue->events[head & (EVQUEUE_CAPACITY - 1)];
+  event->tick = tick;
+  event->pin = pin;
+  event->edge = (uint8_t)edge;
+  event->reserved = 0;
+  __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+  return 1;
+}
+
+// Consumer side: call from loop() only. Copies up to max events in arrival
+// order and frees their slots in one go.
+uint32_t EVQUEUE_drain(EVQUEUE_Queue *queue, EVQUEUE_Event *events,
+                       uint32_t max) {
+  uint32_t tail = queue->tail;
+  uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+  uint32_t count = head - tail;
+
+  if (count > max) {
+    count = max;
+  }
+  for (uint32_t i = 0; i < count; i++) {
+    events[i] = queue->events[(tail + i) & (EVQUEUE_CAPACITY - 1)];
+  }
+  __atomic_store_n(&queue->tail, tail + count, __ATOMIC_RELEASE);
+  return count;
+}
+
+uint32_t EVQUEUE_pending(const EVQUEUE_Queue *queue) {
+  return __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE) -
+         __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+}
+
+uint32_t EVQUEUE_overflows(const EVQUEUE_Queue *queue) {
+  return __atomic_load_n(&queue->overflows, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,55 @@
+#ifndef Evqueue_H__
+#define Evqueue_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Wait-free single-producer/single-consumer queue of input events.
+//
+// The ISR is the only producer and loop() the only consumer, so neither
+// side needs a critical section: each index is written by one side only and
+// published with release/acquire atomics, which on a Cortex-M4 are plain
+// aligned word accesses with a DMB. When the ring is full, the event is
+// dropped and counted instead of overwriting one loop() has not seen.
+
+#ifndef EVQUEUE_CAPACITY
+#define EVQUEUE_CAPACITY 32
+#endif
+
+#if (EVQUEUE_CAPACITY & (EVQUEUE_CAPACITY - 1)) != 0
+#error "EVQUEUE_CAPACITY must be a power of two"
+#endif
+
+typedef enum { EVQUEUE_RISING = 1, EVQUEUE_FALLING = 2 } EVQUEUE_Edge;
+
+typedef struct {
+  uint32_t tick;
+  uint16_t pin;
+  uint8_t edge;
+  uint8_t reserved;
+} EVQUEUE_Event;
+
+// head and tail run freely and wrap; head - tail is the fill level.
+typedef struct {
+  EVQUEUE_Event events[EVQUEUE_CAPACITY];
+  uint32_t head;
+  uint32_t tail;
+  uint32_t overflows;
+} EVQUEUE_Queue;
+
+void EVQUEUE_init(EVQUEUE_Queue *queue);
+int EVQUEUE_push(EVQUEUE_Queue *queue, uint32_t tick, uint16_t pin,
+                 EVQUEUE_Edge edge);
+uint32_t EVQUEUE_drain(EVQUEUE_Queue *queue, EVQUEUE_Event *events,
+                       uint32_t max);
+uint32_t EVQUEUE_pending(const EVQUEUE_Queue *queue);
+uint32_t EVQUEUE_overflows(const EVQUEUE_Queue *queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Evqueue_H__ */
@@ -0,0 +1,40 @@
+#include "idle.h"
+#include "scheduler.h"
+
+__attribute__((weak)) int IDLE_armWakeup(uint32_t ms) { return 0; }
+
+__attribute__((weak)) void IDLE_disarmWakeup(void) {}
+
+static void stop(void) {
+  HAL_SuspendTick();
+  HAL_PWR_EnterSTOPMode(PWR_LOWPOWERREGULATOR_ON, PWR_STOPENTRY_WFI);
+  SystemClock_Config();
+  HAL_ResumeTick();
+}
+
+IDLE_Mode IDLE_enter(int hasDeadline, uint32_t deadline) {
+  if (hasDeadline) {
+    int32_t remaining = (int32_t)(deadline - HAL_GetTick());
+
+    if (remaining <= 0) {
+      return IDLE_BUSY;
+    }
+    if (remaining < IDLE_STOP_MIN_MS || !IDLE_armWakeup((uint32_t)remaining)) {
+      __WFI();
+      return IDLE_SLEEP;
+    }
+  }
+
+  stop();
+  if (hasDeadline) {
+    IDLE_disarmWakeup();
+  }
+  return IDLE_STOP;
+}
+
+IDLE_Mode IDLE_waitForScheduler(void) {
+  uint32_t deadline = 0;
+  int hasDeadline = SCHEDULER_nextDeadline(&deadline);
+
+  return IDLE_enter(hasDeadline, deadline);
+}
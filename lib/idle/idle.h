@@ -0,0 +1,48 @@
+#ifndef Idle_H__
+#define Idle_H__
+
+#include "main.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Low-power idle for loop() when nothing is due.
+//
+// IDLE_enter() looks at the next deadline and picks the deepest sleep that
+// still meets it:
+//
+//  - a deadline within IDLE_STOP_MIN_MS, or no wake-up timer: __WFI() in
+//    SLEEP mode, woken by the next SysTick or any interrupt;
+//  - a later deadline with a wake-up timer armed through IDLE_armWakeup():
+//    STOP mode with SysTick suspended, woken by the timer or an EXTI line;
+//  - no deadline at all: STOP mode until an EXTI line fires.
+//
+// After STOP the system clock is reconfigured, since the core wakes up on
+// HSI. IDLE_armWakeup() and IDLE_disarmWakeup() are weak and do nothing by
+// default; override them to drive the RTC wake-up timer. The disarm hook
+// must also catch the tick up by the time slept, because SysTick does not
+// run in STOP mode.
+//
+// Call IDLE_enter() with interrupts disabled, right after checking that no
+// ISR has left work behind: a pending interrupt still wakes __WFI(), and it
+// runs as soon as interrupts are enabled again, so no event is lost.
+
+#ifndef IDLE_STOP_MIN_MS
+#define IDLE_STOP_MIN_MS 10
+#endif
+
+typedef enum { IDLE_BUSY = 0, IDLE_SLEEP, IDLE_STOP } IDLE_Mode;
+
+IDLE_Mode IDLE_enter(int hasDeadline, uint32_t deadline);
+IDLE_Mode IDLE_waitForScheduler(void);
+
+int IDLE_armWakeup(uint32_t ms);
+void IDLE_disarmWakeup(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Idle_H__ */
@@ -0,0 +1,190 @@
+#include "ledpattern.h"
+#include <stddef.h>
+
+void LEDPATTERN_begin(LEDPATTERN_Buffer *buffer, uint32_t *words,
+                      uint32_t capacity, uint16_t pin) {
+  buffer->words = words;
+  buffer->capacity =
+      capacity > LEDPATTERN_MAX_SLOTS ? LEDPATTERN_MAX_SLOTS : capacity;
+  buffer->length = 0;
+  buffer->pin = pin;
+  buffer->overflow = 0;
+}
+
+// Appends slots at one level. Returns 0, and leaves the buffer marked as
+// overflowed, when they do not fit.
+int LEDPATTERN_hold(LEDPATTERN_Buffer *buffer, int on, uint32_t slots) {
+  uint32_t word = on ? buffer->pin : (uint32_t)buffer->pin << 16;
+
+  if (slots > buffer->capacity - buffer->length) {
+    buffer->overflow = 1;
+    return 0;
+  }
+
+  for (uint32_t i = 0; i < slots; i++) {
+    buffer->words[buffer->length++] = word;
+  }
+  return 1;
+}
+
+// International Morse, dots and dashes for A to Z, then 0 to 9.
+static const char *const morseLetters[26] = {
+    ".-",   "-...", "-.-.", "-..",  ".",   "..-.", "--.",  "....", "..",
+    ".---", "-.-",  ".-..", "--",   "-.",  "---",  ".--.", "--.-", ".-.",
+    "...",  "-",    "..-",  "...-", ".--", "-..-", "-.--", "--.."};
+static const char *const morseDigits[10] = {
+    "-----", ".----", "..---", "...--", "....-",
+    ".....", "-....", "--...", "---..", "----."};
+
+static const char *morseCode(char c) {
+  if (c >= 'a' && c <= 'z') {
+    return morseLetters[c - 'a'];
+  }
+  if (c >= 'A' && c <= 'Z') {
+    return morseLetters[c - 'A'];
+  }
+  if (c >= '0' && c <= '9') {
+    return morseDigits[c - '0'];
+  }
+  return NULL;
+}
+
+// One slot is one dot: a dash is 3 on, elements are 1 apart, letters 3 and
+// words 7. The message ends with a word gap, so it repeats cleanly.
+// Characters without a code are skipped.
+int LEDPATTERN_morse(LEDPATTERN_Buffer *buffer, const char *text) {
+  uint32_t gap = 0;
+  int ok = 1;
+
+  for (; *text != '\0'; text++) {
+    const char *code = morseCode(*text);
+
+    if (*text == ' ') {
+      gap = 7;
+      continue;
+    }
+    if (code == NULL) {
+      continue;
+    }
+
+    ok = ok && LEDPATTERN_hold(buffer, 0, gap);
+    for (; *code != '\0'; code++) {
+      ok = ok && LEDPATTERN_hold(buffer, 1, *code == '-' ? 3 : 1);
+      if (code[1] != '\0') {
+        ok = ok && LEDPATTERN_hold(buffer, 0, 1);
+      }
+    }
+    gap = 3;
+  }
+
+  return ok && LEDPATTERN_hold(buffer, 0, 7);
+}
+
+int LEDPATTERN_code(LEDPATTERN_Buffer *buffer, uint32_t count) {
+  int ok = 1;
+
+  for (uint32_t i = 0; i < count; i++) {
+    ok = ok && LEDPATTERN_hold(buffer, 1, LEDPATTERN_CODE_BLINK_SLOTS);
+    ok = ok && LEDPATTERN_hold(buffer, 0, LEDPATTERN_CODE_BLINK_SLOTS);
+  }
+
+  return ok && LEDPATTERN_hold(buffer, 0, LEDPATTERN_CODE_PAUSE_SLOTS);
+}
+
+// Software PWM: frames of frameSlots slots whose duty ramps from off to
+// fully on over steps frames and back down over as many.
+int LEDPATTERN_breathe(LEDPATTERN_Buffer *buffer, uint32_t frameSlots,
+                       uint32_t steps) {
+  int ok = 1;
+
+  for (uint32_t frame = 0; frame < 2 * steps; frame++) {
+    uint32_t level = frame < steps ? frame : 2 * steps - 1 - frame;
+    uint32_t duty = level * frameSlots / (steps > 1 ? steps - 1 : 1);
+
+    ok = ok && LEDPATTERN_hold(buffer, 1, duty);
+    ok = ok && LEDPATTERN_hold(buffer, 0, frameSlots - duty);
+  }
+
+  return ok;
+}
+
+// The timer ticks at LEDPATTERN_COUNT_HZ and overflows once per slot.
+// Returns 0 when slotMs does not fit a 16-bit auto-reload register.
+int LEDPATTERN_init(LEDPATTERN_Player *player, TIM_HandleTypeDef *htim,
+                    DMA_HandleTypeDef *hdma, GPIO_TypeDef *port,
+                    uint16_t pin, uint32_t slotMs) {
+  uint32_t counts = slotMs * (LEDPATTERN_COUNT_HZ / 1000U);
+
+  if (counts == 0 || counts > 0x10000U || slotMs > 0x10000U) {
+    return 0;
+  }
+
+  player->htim = htim;
+  player->hdma = hdma;
+  player->port = port;
+  player->pin = pin;
+  player->words = NULL;
+  player->length = 0;
+
+  htim->Init.Prescaler = LEDPATTERN_CLOCK_HZ / LEDPATTERN_COUNT_HZ - 1U;
+  htim->Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim->Init.Period = counts - 1U;
+  htim->Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim->Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+
+  hdma->Init.Channel = LEDPATTERN_DMA_CHANNEL;
+  hdma->Init.Direction = DMA_MEMORY_TO_PERIPH;
+  hdma->Init.PeriphInc = DMA_PINC_DISABLE;
+  hdma->Init.MemInc = DMA_MINC_ENABLE;
+  hdma->Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+  hdma->Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+  hdma->Init.Mode = DMA_CIRCULAR;
+  hdma->Init.Priority = DMA_PRIORITY_HIGH;
+  hdma->Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+
+  return HAL_TIM_Base_Init(htim) == HAL_OK && HAL_DMA_Init(hdma) == HAL_OK;
+}
+
+static void halt(LEDPATTERN_Player *player) {
+  HAL_TIM_Base_Stop(player->htim);
+  __HAL_TIM_DISABLE_DMA(player->htim, TIM_DMA_UPDATE);
+  HAL_DMA_Abort(player->hdma);
+}
+
+// Starts words from the first slot, replacing whatever was playing. A
+// software update event moves the first word at once and restarts the
+// period, so every slot lasts the same. If the stream will not start, the
+// old pattern is gone all the same: the player is left stopped and the LED
+// wherever the last word put it.
+int LEDPATTERN_play(LEDPATTERN_Player *player, const uint32_t *words,
+                    uint32_t length) {
+  if (length == 0 || length > LEDPATTERN_MAX_SLOTS) {
+    return 0;
+  }
+
+  halt(player);
+  player->words = NULL;
+  player->length = 0;
+  if (HAL_DMA_Start(player->hdma, (uintptr_t)words,
+                    (uintptr_t)&player->port->BSRR, length) != HAL_OK) {
+    return 0;
+  }
+  player->words = words;
+  player->length = length;
+  __HAL_TIM_ENABLE_DMA(player->htim, TIM_DMA_UPDATE);
+  __HAL_TIM_GENERATE_EVENT(player->htim, TIM_EVENTSOURCE_UPDATE);
+  HAL_TIM_Base_Start(player->htim);
+  return 1;
+}
+
+// Stops the pattern and turns the LED off.
+void LEDPATTERN_stop(LEDPATTERN_Player *player) {
+  halt(player);
+  player->words = NULL;
+  player->length = 0;
+  HAL_GPIO_WritePin(player->port, player->pin, GPIO_PIN_RESET);
+}
+
+int LEDPATTERN_playing(const LEDPATTERN_Player *player) {
+  return player->words != NULL;
+}
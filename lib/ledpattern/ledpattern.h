@@ -0,0 +1,104 @@
+#ifndef Ledpattern_H__
+#define Ledpattern_H__
+
+#include "main.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// LED patterns played by DMA, with no interrupt per edge.
+//
+// A pattern is compiled ahead of time into BSRR words, one per time slot:
+// the pin's set bit for on, its reset bit for off, so the other pins of the
+// port are never touched. A timer's update event requests one DMA transfer
+// per slot, and a circular DMA stream copies the words into the port's BSRR
+// for as long as the pattern plays; the CPU only runs to start, stop or
+// swap patterns, which is cheap enough for the EXTI callback.
+//
+// On the F4 only DMA2 reaches the GPIO ports, so the timer is TIM1, whose
+// update request is DMA2 stream 5, channel 6:
+//
+//   static uint32_t sos[64];
+//   static LEDPATTERN_Buffer buffer;
+//   static LEDPATTERN_Player player;
+//
+//   void setup(void) {
+//     htim1.Instance = TIM1;
+//     hdma.Instance = DMA2_Stream5;
+//     LEDPATTERN_init(&player, &htim1, &hdma, LED_GPIO_Port, LED_Pin, 100);
+//     LEDPATTERN_begin(&buffer, sos, 64, LED_Pin);
+//     LEDPATTERN_morse(&buffer, "SOS");
+//   }
+//   void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+//     LEDPATTERN_play(&player, buffer.words, buffer.length);
+//   }
+//
+// Buffers must stay valid while they play. To swap patterns, compile both
+// up front and play the other buffer rather than rewriting the one the DMA
+// is reading. A DMA stream counts its transfers in the 16-bit NDTR
+// register, so LEDPATTERN_begin() caps buffers at LEDPATTERN_MAX_SLOTS and
+// LEDPATTERN_play() refuses anything longer.
+
+#define LEDPATTERN_MAX_SLOTS 0xFFFFU
+
+#ifndef LEDPATTERN_COUNT_HZ
+#define LEDPATTERN_COUNT_HZ 10000U
+#endif
+
+#ifndef LEDPATTERN_CLOCK_HZ
+#define LEDPATTERN_CLOCK_HZ SystemCoreClock
+#endif
+
+#ifndef LEDPATTERN_DMA_CHANNEL
+#define LEDPATTERN_DMA_CHANNEL DMA_CHANNEL_6
+#endif
+
+// Status codes: count blinks of this many slots on and off, then a pause.
+#ifndef LEDPATTERN_CODE_BLINK_SLOTS
+#define LEDPATTERN_CODE_BLINK_SLOTS 2
+#endif
+
+#ifndef LEDPATTERN_CODE_PAUSE_SLOTS
+#define LEDPATTERN_CODE_PAUSE_SLOTS 10
+#endif
+
+typedef struct {
+  uint32_t *words;
+  uint32_t capacity;
+  uint32_t length;
+  uint16_t pin;
+  uint8_t overflow;
+} LEDPATTERN_Buffer;
+
+typedef struct {
+  TIM_HandleTypeDef *htim;
+  DMA_HandleTypeDef *hdma;
+  GPIO_TypeDef *port;
+  uint16_t pin;
+  const uint32_t *words;
+  uint32_t length;
+} LEDPATTERN_Player;
+
+void LEDPATTERN_begin(LEDPATTERN_Buffer *buffer, uint32_t *words,
+                      uint32_t capacity, uint16_t pin);
+int LEDPATTERN_hold(LEDPATTERN_Buffer *buffer, int on, uint32_t slots);
+int LEDPATTERN_morse(LEDPATTERN_Buffer *buffer, const char *text);
+int LEDPATTERN_code(LEDPATTERN_Buffer *buffer, uint32_t count);
+int LEDPATTERN_breathe(LEDPATTERN_Buffer *buffer, uint32_t frameSlots,
+                       uint32_t steps);
+
+int LEDPATTERN_init(LEDPATTERN_Player *player, TIM_HandleTypeDef *htim,
+                    DMA_HandleTypeDef *hdma, GPIO_TypeDef *port,
+                    uint16_t pin, uint32_t slotMs);
+int LEDPATTERN_play(LEDPATTERN_Player *player, const uint32_t *words,
+                    uint32_t length);
+void LEDPATTERN_stop(LEDPATTERN_Player *player);
+int LEDPATTERN_playing(const LEDPATTERN_Player *player);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Ledpattern_H__ */
@@ -0,0 +1,94 @@
+#include "profiler.h"
+#include <string.h>
+
+static PROFILER_Probe probes[PROFILER_PROBES];
+
+static uint8_t bucketOf(uint32_t cycles) {
+  if (cycles == 0) {
+    return 0;
+  }
+  uint8_t bucket = (uint8_t)(32 - __builtin_clz(cycles));
+  return bucket < PROFILER_BUCKETS ? bucket : PROFILER_BUCKETS - 1;
+}
+
+static void addSample(PROFILER_Probe *p, uint32_t cycles) {
+  if (p->count == 0 || cycles < p->min) {
+    p->min = cycles;
+  }
+  if (cycles > p->max) {
+    p->max = cycles;
+  }
+  p->count++;
+  p->total += cycles;
+  p->histogram[bucketOf(cycles)]++;
+}
+
+void PROFILER_init(void) {
+  CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+  DWT->CYCCNT = 0;
+  DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+  PROFILER_reset();
+}
+
+void PROFILER_reset(void) { memset(probes, 0, sizeof(probes)); }
+
+void PROFILER_enter(uint8_t probe) {
+  if (probe < PROFILER_PROBES) {
+    probes[probe].start = DWT->CYCCNT;
+    probes[probe].started = 1;
+  }
+}
+
+void PROFILER_exit(uint8_t probe) {
+  uint32_t now = DWT->CYCCNT;
+
+  if (probe < PROFILER_PROBES && probes[probe].started) {
+    probes[probe].started = 0;
+    // Unsigned subtraction is right across one CYCCNT wrap (~51 s at
+    // 84 MHz).
+    addSample(&probes[probe], now - probes[probe].start);
+  }
+}
+
+void PROFILER_mark(uint8_t probe) {
+  uint32_t now = DWT->CYCCNT;
+
+  if (probe < PROFILER_PROBES) {
+    if (probes[probe].started) {
+      addSample(&probes[probe], now - probes[probe].start);
+    }
+    probes[probe].start = now;
+    probes[probe].started = 1;
+  }
+}
+
+const PROFILER_Probe *PROFILER_get(uint8_t probe) {
+  return probe < PROFILER_PROBES ? &probes[probe] : NULL;
+}
+
+// Upper bound of the histogram bucket holding the given percentile, capped
+// at the largest sample seen.
+uint32_t PROFILER_percentile(uint8_t probe, uint8_t percent) {
+  if (probe >= PROFILER_PROBES || probes[probe].count == 0) {
+    return 0;
+  }
+
+  const PROFILER_Probe *p = &probes[probe];
+  uint64_t rank = ((uint64_t)p->count * percent + 99) / 100;
+  uint64_t seen = 0;
+
+  if (rank == 0) {
+    rank = 1;
+  }
+  for (uint8_t bucket = 0; bucket < PROFILER_BUCKETS; bucket++) {
+    seen += p->histogram[bucket];
+    if (seen >= rank) {
+      if (bucket == PROFILER_BUCKETS - 1) {
+        return p->max;
+      }
+      uint32_t upper = bucket == 0 ? 0 : (1UL << bucket) - 1;
+      return upper < p->max ? upper : p->max;
+    }
+  }
+  return p->max;
+}
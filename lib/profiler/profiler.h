@@ -0,0 +1,68 @@
+#ifndef Profiler_H__
+#define Profiler_H__
+
+#include "stm32f4xx.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cycle-accurate timing probes based on the Cortex-M4 DWT cycle counter.
+//
+// A duration probe brackets a piece of code with PROFILER_ENTER() and
+// PROFILER_EXIT(); an interval probe is hit once per iteration with
+// PROFILER_MARK() and measures the time between hits, which is how loop()
+// jitter shows up. Each probe keeps its count, min, max, total and a
+// histogram of log2 buckets in static storage: bucket n holds samples in
+// [2^(n-1), 2^n) cycles, bucket 0 samples of 0 cycles. Read them from the
+// debugger or with PROFILER_get().
+//
+// Probes are independent, so an ISR probe may interrupt a loop() probe, but
+// a single probe must not be entered again before it exits. Build with
+// PROFILER_DISABLED to compile the macros out.
+
+#define PROFILER_BUCKETS 32
+
+#ifndef PROFILER_PROBES
+#define PROFILER_PROBES 4
+#endif
+
+// Default probe ids; any id below PROFILER_PROBES may be used.
+#define PROFILER_ISR 0
+#define PROFILER_LOOP 1
+#define PROFILER_LOOP_PERIOD 2
+
+typedef struct {
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t total;
+  uint32_t histogram[PROFILER_BUCKETS];
+  uint32_t start;
+  uint8_t started;
+} PROFILER_Probe;
+
+void PROFILER_init(void);
+void PROFILER_reset(void);
+void PROFILER_enter(uint8_t probe);
+void PROFILER_exit(uint8_t probe);
+void PROFILER_mark(uint8_t probe);
+const PROFILER_Probe *PROFILER_get(uint8_t probe);
+uint32_t PROFILER_percentile(uint8_t probe, uint8_t percent);
+
+#ifdef PROFILER_DISABLED
+#define PROFILER_ENTER(probe)
+#define PROFILER_EXIT(probe)
+#define PROFILER_MARK(probe)
+#else
+#define PROFILER_ENTER(probe) PROFILER_enter(probe)
+#define PROFILER_EXIT(probe) PROFILER_exit(probe)
+#define PROFILER_MARK(probe) PROFILER_mark(probe)
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Profiler_H__ */
@@ -0,0 +1,29 @@
+#ifndef Apps_H__
+#define Apps_H__
+
+#include <stdint.h>
+
+// The scheduling and challenge labs ported onto the scheduler. Call them
+// from main.cpp:
+//
+//   void setup() { CHALLENGE_setup(); }
+//   void loop() { CHALLENGE_loop(); }
+
+#define LED 13
+#define PUSH_BUTTON 23
+
+#define BLINK_PERIOD_MS 1000
+#define CHALLENGE_PERIOD_MS 500
+
+void BLINK_setup(void);
+void BLINK_loop(void);
+
+void CHALLENGE_setup(void);
+void CHALLENGE_loop(void);
+void CHALLENGE_onButton(void);
+
+// Presses that found the scheduler full: the blink job could not start, so
+// the LED stays off and the next press tries again.
+uint32_t CHALLENGE_failures(void);
+
+#endif /* Apps_H__ */
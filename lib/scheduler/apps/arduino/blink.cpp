@@ -0,0 +1,22 @@
+#include <Arduino.h>
+#include "apps.h"
+#include "scheduler.h"
+
+static bool stateLED = LOW;
+
+static void toggleLED(void *context)
+{
+    stateLED = !stateLED;
+    digitalWrite(LED, stateLED);
+}
+
+void BLINK_setup(void)
+{
+    pinMode(LED, OUTPUT);
+    stateLED = LOW;
+    digitalWrite(LED, stateLED);
+    SCHEDULER_init(millis());
+    SCHEDULER_every(BLINK_PERIOD_MS, toggleLED, nullptr);
+}
+
+void BLINK_loop(void) { SCHEDULER_run(millis()); }
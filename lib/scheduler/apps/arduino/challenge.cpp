@@ -0,0 +1,88 @@
+#include <Arduino.h>
+#include "apps.h"
+#include "debounce.h"
+#include "evqueue.h"
+#include "scheduler.h"
+
+// The ISR only queues the press; starting and stopping the blink job
+// happens in loop(), since the scheduler is not interrupt-safe. Contact
+// bounce is filtered out before the queue, so it costs no slots.
+static DEBOUNCE_Filter button;
+static EVQUEUE_Queue presses;
+static int blinkJob = -1;
+static bool stateLED = LOW;
+static uint32_t failures = 0;
+
+static void toggleLED(void *context)
+{
+    stateLED = !stateLED;
+    digitalWrite(LED, stateLED);
+}
+
+void CHALLENGE_setup(void)
+{
+    pinMode(LED, OUTPUT);
+    stateLED = LOW;
+    digitalWrite(LED, stateLED);
+    pinMode(PUSH_BUTTON, INPUT);
+    attachInterrupt(digitalPinToInterrupt(PUSH_BUTTON), CHALLENGE_onButton,
+                    CHANGE);
+    SCHEDULER_init(millis());
+    DEBOUNCE_init(&button, DEBOUNCE_QUIET_MS);
+    EVQUEUE_init(&presses);
+    blinkJob = -1;
+    failures = 0;
+}
+
+static void togglePressed(void)
+{
+    if (blinkJob < 0)
+    {
+        blinkJob = SCHEDULER_every(CHALLENGE_PERIOD_MS, toggleLED, nullptr);
+        if (blinkJob < 0)
+        {
+            failures++;
+            return;
+        }
+        stateLED = HIGH;
+    }
+    else
+    {
+        SCHEDULER_cancel(blinkJob);
+        blinkJob = -1;
+        stateLED = LOW;
+    }
+    digitalWrite(LED, stateLED);
+}
+
+void CHALLENGE_loop(void)
+{
+    EVQUEUE_Event batch[8];
+    uint32_t count;
+
+    SCHEDULER_run(millis());
+
+    while ((count = EVQUEUE_drain(&presses, batch, 8)) > 0)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            togglePressed();
+        }
+    }
+}
+
+uint32_t CHALLENGE_failures(void)
+{
+    return failures;
+}
+
+// Runs on both edges; the button pulls the pin low while pressed.
+void CHALLENGE_onButton(void)
+{
+    uint32_t tick = millis();
+
+    if (DEBOUNCE_edge(&button, tick, digitalRead(PUSH_BUTTON) == LOW))
+    {
+        EVQUEUE_push(&presses, tick, PUSH_BUTTON, EVQUEUE_FALLING);
+    }
+}
@@ -0,0 +1,37 @@
+#ifndef Apps_H__
+#define Apps_H__
+
+#include <stdint.h>
+
+// The scheduling and challenge labs ported onto the scheduler. Call them
+// from app.c:
+//
+//   void setup(void) { CHALLENGE_setup(); }
+//   void loop(void) {
+//     CHALLENGE_loop();
+//     CHALLENGE_idle();
+//   }
+//   void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+//     CHALLENGE_onButton(GPIO_Pin);
+//   }
+//
+// The challenge debounces the button on both of its edges: set the
+// PUSH_BUTTON EXTI line to trigger on rising and falling edges
+// (GPIO_MODE_IT_RISING_FALLING) in CubeMX.
+
+#define BLINK_PERIOD_MS 1000
+#define CHALLENGE_PERIOD_MS 500
+
+void BLINK_setup(void);
+void BLINK_loop(void);
+
+void CHALLENGE_setup(void);
+void CHALLENGE_loop(void);
+void CHALLENGE_idle(void);
+void CHALLENGE_onButton(uint16_t GPIO_Pin);
+
+// Presses that found the scheduler full: the blink job could not start, so
+// the LED stays off and the next press tries again.
+uint32_t CHALLENGE_failures(void);
+
+#endif /* Apps_H__ */
@@ -0,0 +1,15 @@
+#include "apps.h"
+#include "main.h"
+#include "scheduler.h"
+#include <stddef.h>
+
+static void toggleLED(void *context) {
+  HAL_GPIO_TogglePin(LED_GPIO_Port, LED_Pin);
+}
+
+void BLINK_setup(void) {
+  SCHEDULER_init(HAL_GetTick());
+  SCHEDULER_every(BLINK_PERIOD_MS, toggleLED, NULL);
+}
+
+void BLINK_loop(void) { SCHEDULER_run(HAL_GetTick()); }
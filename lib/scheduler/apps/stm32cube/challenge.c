@@ -0,0 +1,79 @@
+#include "apps.h"
+#include "debounce.h"
+#include "evqueue.h"
+#include "idle.h"
+#include "main.h"
+#include "scheduler.h"
+#include <stddef.h>
+
+// The ISR only queues the press; starting and stopping the blink job
+// happens in loop(), since the scheduler is not interrupt-safe. Contact
+// bounce is filtered out before the queue, so it costs no slots.
+static DEBOUNCE_Filter button;
+static EVQUEUE_Queue presses;
+static int blinkJob = -1;
+static uint32_t failures;
+
+static void toggleLED(void *context) {
+  HAL_GPIO_TogglePin(LED_GPIO_Port, LED_Pin);
+}
+
+void CHALLENGE_setup(void) {
+  SCHEDULER_init(HAL_GetTick());
+  DEBOUNCE_init(&button, DEBOUNCE_QUIET_MS);
+  EVQUEUE_init(&presses);
+  blinkJob = -1;
+  failures = 0;
+}
+
+static void togglePressed(void) {
+  if (blinkJob < 0) {
+    blinkJob = SCHEDULER_every(CHALLENGE_PERIOD_MS, toggleLED, NULL);
+    if (blinkJob < 0) {
+      failures++;
+      return;
+    }
+    HAL_GPIO_WritePin(LED_GPIO_Port, LED_Pin, GPIO_PIN_SET);
+  } else {
+    SCHEDULER_cancel(blinkJob);
+    blinkJob = -1;
+    HAL_GPIO_WritePin(LED_GPIO_Port, LED_Pin, GPIO_PIN_RESET);
+  }
+}
+
+void CHALLENGE_loop(void) {
+  EVQUEUE_Event batch[8];
+  uint32_t count;
+
+  SCHEDULER_run(HAL_GetTick());
+
+  while ((count = EVQUEUE_drain(&presses, batch, 8)) > 0) {
+    for (uint32_t i = 0; i < count; i++) {
+      togglePressed();
+    }
+  }
+}
+
+uint32_t CHALLENGE_failures(void) { return failures; }
+
+// Sleeps until the next toggle, or until the button when not blinking.
+void CHALLENGE_idle(void) {
+  __disable_irq();
+  if (EVQUEUE_pending(&presses) == 0) {
+    IDLE_waitForScheduler();
+  }
+  __enable_irq();
+}
+
+// Runs on both edges; the button pulls the pin low while pressed.
+void CHALLENGE_onButton(uint16_t GPIO_Pin) {
+  if (GPIO_Pin == PUSH_BUTTON_Pin) {
+    uint32_t tick = HAL_GetTick();
+    int pressed = HAL_GPIO_ReadPin(PUSH_BUTTON_GPIO_Port, PUSH_BUTTON_Pin) ==
+                  GPIO_PIN_RESET;
+
+    if (DEBOUNCE_edge(&button, tick, pressed)) {
+      EVQUEUE_push(&presses, tick, GPIO_Pin, EVQUEUE_FALLING);
+    }
+  }
+}
@@ -0,0 +1,164 @@
+#include "scheduler.h"
+#include <stddef.h>
+
+typedef struct {
+  uint32_t due;
+  uint32_t period;
+  SCHEDULER_Job job;
+  void *context;
+  int16_t heapIndex; // -1 when the slot is free
+  uint16_t generation;
+} SCHEDULER_Entry;
+
+static SCHEDULER_Entry entries[SCHEDULER_JOBS];
+static uint8_t heap[SCHEDULER_JOBS];
+static uint8_t heapSize = 0;
+static uint8_t freeSlots[SCHEDULER_JOBS];
+static uint8_t freeCount = 0;
+static uint32_t current = 0;
+
+static int dueBefore(uint8_t a, uint8_t b) {
+  return (int32_t)(entries[a].due - entries[b].due) < 0;
+}
+
+static void place(uint8_t i, uint8_t slot) {
+  heap[i] = slot;
+  entries[slot].heapIndex = (int16_t)i;
+}
+
+static void siftUp(uint8_t i) {
+  uint8_t slot = heap[i];
+
+  while (i > 0) {
+    uint8_t parent = (uint8_t)((i - 1) / 2);
+    if (!dueBefore(slot, heap[parent])) {
+      break;
+    }
+    place(i, heap[parent]);
+    i = parent;
+  }
+  place(i, slot);
+}
+
+static void siftDown(uint8_t i) {
+  uint8_t slot = heap[i];
+
+  for (;;) {
+    uint8_t child = (uint8_t)(2 * i + 1);
+    if (child >= heapSize) {
+      break;
+    }
+    if (child + 1 < heapSize && dueBefore(heap[child + 1], heap[child])) {
+      child++;
+    }
+    if (!dueBefore(heap[child], slot)) {
+      break;
+    }
+    place(i, heap[child]);
+    i = child;
+  }
+  place(i, slot);
+}
+
+static void removeAt(uint8_t i) {
+  uint8_t slot = heap[i];
+
+  entries[slot].heapIndex = -1;
+  freeSlots[freeCount++] = slot;
+  heapSize--;
+  if (i == heapSize) {
+    return;
+  }
+
+  uint8_t moved = heap[heapSize];
+  place(i, moved);
+  siftUp(i);
+  siftDown((uint8_t)entries[moved].heapIndex);
+}
+
+static int add(uint32_t delay, uint32_t period, SCHEDULER_Job job,
+               void *context) {
+  if (job == NULL || freeCount == 0) {
+    return -1;
+  }
+
+  uint8_t slot = freeSlots[--freeCount];
+  SCHEDULER_Entry *entry = &entries[slot];
+  entry->due = current + delay;
+  entry->period = period;
+  entry->job = job;
+  entry->context = context;
+  entry->generation++;
+  heap[heapSize] = slot;
+  entry->heapIndex = (int16_t)heapSize;
+  heapSize++;
+  siftUp((uint8_t)entry->heapIndex);
+
+  return entry->generation * SCHEDULER_JOBS + slot;
+}
+
+void SCHEDULER_init(uint32_t now) {
+  for (uint8_t slot = 0; slot < SCHEDULER_JOBS; slot++) {
+    entries[slot].heapIndex = -1;
+    freeSlots[slot] = (uint8_t)(SCHEDULER_JOBS - 1 - slot);
+  }
+  freeCount = SCHEDULER_JOBS;
+  heapSize = 0;
+  current = now;
+}
+
+uint32_t SCHEDULER_now(void) { return current; }
+
+int SCHEDULER_after(uint32_t delay, SCHEDULER_Job job, void *context) {
+  return add(delay, 0, job, context);
+}
+
+int SCHEDULER_every(uint32_t period, SCHEDULER_Job job, void *context) {
+  return period == 0 ? -1 : add(period, period, job, context);
+}
+
+// Ids of jobs that already ran or were cancelled are ignored, even once
+// their slot is reused.
+void SCHEDULER_cancel(int id) {
+  if (id < 0) {
+    return;
+  }
+
+  SCHEDULER_Entry *entry = &entries[id % SCHEDULER_JOBS];
+  if (entry->heapIndex >= 0 &&
+      entry->generation == (uint16_t)(id / SCHEDULER_JOBS)) {
+    removeAt((uint8_t)entry->heapIndex);
+  }
+}
+
+uint32_t SCHEDULER_run(uint32_t now) {
+  uint32_t ran = 0;
+
+  current = now;
+  while (heapSize > 0 && (int32_t)(now - entries[heap[0]].due) >= 0) {
+    SCHEDULER_Entry *entry = &entries[heap[0]];
+    SCHEDULER_Job job = entry->job;
+    void *context = entry->context;
+
+    if (entry->period != 0) {
+      uint32_t late = now - entry->due;
+      entry->due += (late / entry->period + 1) * entry->period;
+      siftDown(0);
+    } else {
+      removeAt(0);
+    }
+    job(context);
+    ran++;
+  }
+  return ran;
+}
+
+int SCHEDULER_nextDeadline(uint32_t *deadline) {
+  if (heapSize == 0) {
+    return 0;
+  }
+  *deadline = entries[heap[0]].due;
+  return 1;
+}
+
+uint32_t SCHEDULER_pending(void) { return heapSize; }
@@ -0,0 +1,49 @@
+#ifndef Scheduler_H__
+#define Scheduler_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cooperative scheduler for periodic and one-shot jobs.
+//
+// Jobs sit in a binary min-heap of deadlines in static storage, so loop()
+// only looks at the earliest one: SCHEDULER_run() costs O(1) when nothing
+// is due and O(log n) per job it runs; inserting and cancelling are
+// O(log n). Deadlines are compared as signed 32-bit differences, which is
+// wrap-safe for the HAL_GetTick()/millis() tick as long as no job is more
+// than 2^31 ms (~24 days) away.
+//
+// Periodic jobs keep their phase: the next deadline is the previous one
+// plus the period, and periods missed by a late run() are skipped, not
+// replayed. Jobs run from SCHEDULER_run() in deadline order and may
+// schedule or cancel jobs, including themselves. None of the functions are
+// safe to call from an ISR; hand events over to loop() instead. Call
+// SCHEDULER_init() with the current tick before anything else.
+
+#ifndef SCHEDULER_JOBS
+#define SCHEDULER_JOBS 32
+#endif
+
+#if SCHEDULER_JOBS > 255
+#error "SCHEDULER_JOBS must fit the 8-bit heap indexes"
+#endif
+
+typedef void (*SCHEDULER_Job)(void *context);
+
+void SCHEDULER_init(uint32_t now);
+uint32_t SCHEDULER_now(void);
+int SCHEDULER_after(uint32_t delay, SCHEDULER_Job job, void *context);
+int SCHEDULER_every(uint32_t period, SCHEDULER_Job job, void *context);
+void SCHEDULER_cancel(int id);
+uint32_t SCHEDULER_run(uint32_t now);
+int SCHEDULER_nextDeadline(uint32_t *deadline);
+uint32_t SCHEDULER_pending(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Scheduler_H__ */
@@ -0,0 +1,142 @@
+#include "telemetry.h"
+#include <string.h>
+
+void TELEMETRY_init(TELEMETRY_Channel *channel, UART_HandleTypeDef *huart) {
+  memset(channel, 0, sizeof(*channel));
+  channel->huart = huart;
+}
+
+// Any context. Returns 0 when the record was dropped.
+int TELEMETRY_log(TELEMETRY_Channel *channel, uint8_t id, uint32_t value) {
+  uint32_t tick = HAL_GetTick();
+  uint32_t primask = __get_PRIMASK();
+  int kept = 0;
+
+  __disable_irq();
+  uint16_t seq = channel->seq++;
+  uint32_t head = channel->head;
+  uint32_t level = head - __atomic_load_n(&channel->tail, __ATOMIC_ACQUIRE);
+
+  if (level < TELEMETRY_CAPACITY) {
+    TELEMETRY_Record *record =
+        &channel->ring[head & (TELEMETRY_CAPACITY - 1)];
+
+    record->sync = TELEMETRY_SYNC;
+    record->id = id;
+    record->seq = seq;
+    record->tick = tick;
+    record->value = value;
+    __atomic_store_n(&channel->head, head + 1, __ATOMIC_RELEASE);
+    if (level + 1 > channel->stats.highWater) {
+      channel->stats.highWater = level + 1;
+    }
+    channel->stats.logged++;
+    kept = 1;
+  } else {
+    channel->stats.dropped++;
+  }
+  __set_PRIMASK(primask);
+  return kept;
+}
+
+// Hands the back buffer to the DMA and swaps. Runs with interrupts masked
+// or from the completion interrupt, so nothing else is starting one. When
+// the UART refuses, the buffer stays put for the next poll to retry.
+static void startBack(TELEMETRY_Channel *channel) {
+  uint32_t count = channel->fill;
+  const uint8_t *data = (const uint8_t *)channel->buffers[channel->back];
+
+  if (HAL_UART_Transmit_DMA(channel->huart, data,
+                            (uint16_t)(count * sizeof(TELEMETRY_Record))) !=
+      HAL_OK) {
+    channel->stats.errors++;
+    return;
+  }
+
+  channel->sending = count;
+  channel->back ^= 1U;
+  __atomic_store_n(&channel->fill, 0, __ATOMIC_RELEASE);
+}
+
+// loop() only. Copies at most TELEMETRY_BATCH records, so its cost is
+// bounded however far behind the UART is, and returns how many it moved.
+uint32_t TELEMETRY_poll(TELEMETRY_Channel *channel) {
+  uint32_t fill = __atomic_load_n(&channel->fill, __ATOMIC_ACQUIRE);
+  uint32_t moved = 0;
+
+  if (fill < TELEMETRY_BATCH) {
+    TELEMETRY_Record *buffer = channel->buffers[channel->back];
+    uint32_t tail = channel->tail;
+    uint32_t head = __atomic_load_n(&channel->head, __ATOMIC_ACQUIRE);
+
+    moved = head - tail;
+    if (moved > TELEMETRY_BATCH - fill) {
+      moved = TELEMETRY_BATCH - fill;
+    }
+    for (uint32_t i = 0; i < moved; i++) {
+      buffer[fill + i] = channel->ring[(tail + i) & (TELEMETRY_CAPACITY - 1)];
+    }
+    __atomic_store_n(&channel->tail, tail + moved, __ATOMIC_RELEASE);
+    __atomic_store_n(&channel->fill, fill + moved, __ATOMIC_RELEASE);
+  }
+
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  if (channel->sending == 0 && channel->fill > 0) {
+    startBack(channel);
+  }
+  __set_PRIMASK(primask);
+  return moved;
+}
+
+// From HAL_UART_TxCpltCallback(). A full back buffer goes out at once;
+// a partial one waits for the next poll, which may still be adding to it.
+void TELEMETRY_onTxComplete(TELEMETRY_Channel *channel,
+                            UART_HandleTypeDef *huart) {
+  if (huart != channel->huart) {
+    return;
+  }
+
+  channel->stats.sent += channel->sending;
+  channel->stats.bytes += channel->sending * sizeof(TELEMETRY_Record);
+  channel->sending = 0;
+  if (__atomic_load_n(&channel->fill, __ATOMIC_ACQUIRE) == TELEMETRY_BATCH) {
+    startBack(channel);
+  }
+}
+
+// From HAL_UART_ErrorCallback(). The records in flight are lost; the next
+// poll starts the back buffer.
+void TELEMETRY_onTxError(TELEMETRY_Channel *channel,
+                         UART_HandleTypeDef *huart) {
+  if (huart != channel->huart || channel->sending == 0) {
+    return;
+  }
+
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  channel->stats.errors++;
+  channel->stats.dropped += channel->sending;
+  channel->sending = 0;
+  __set_PRIMASK(primask);
+}
+
+// Records logged but not yet handed to the UART.
+uint32_t TELEMETRY_pending(const TELEMETRY_Channel *channel) {
+  return __atomic_load_n(&channel->head, __ATOMIC_ACQUIRE) -
+         __atomic_load_n(&channel->tail, __ATOMIC_ACQUIRE) +
+         __atomic_load_n(&channel->fill, __ATOMIC_ACQUIRE);
+}
+
+// A consistent copy: the counters are bumped from interrupts, and bytes
+// takes two loads on the core.
+void TELEMETRY_stats(const TELEMETRY_Channel *channel,
+                     TELEMETRY_Stats *stats) {
+  uint32_t primask = __get_PRIMASK();
+
+  __disable_irq();
+  *stats = channel->stats;
+  __set_PRIMASK(primask);
+}
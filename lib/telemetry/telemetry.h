@@ -0,0 +1,120 @@
+#ifndef Telemetry_H__
+#define Telemetry_H__
+
+#include "main.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Telemetry over a UART that never holds up loop() or an ISR.
+//
+// Records are fixed 12-byte frames, a sync byte, an id, a sequence number,
+// the tick and a 32-bit value, little-endian as the core stores them.
+// TELEMETRY_log() can be called from loop() and from any ISR: it claims a
+// slot in a ring inside a critical section a few instructions long, and
+// when the ring is full it drops the record and counts it instead of
+// waiting. Every record takes a sequence number, dropped or not, so the
+// host sees where the gaps are.
+//
+// TELEMETRY_poll() in loop() moves at most TELEMETRY_BATCH records from
+// the ring into the back one of two transmit buffers and, when the UART is
+// idle, hands that buffer to HAL_UART_Transmit_DMA(). While the DMA sends
+// one buffer, loop() fills the other; the completion interrupt starts the
+// next one straight away if it is already full, so the line stays busy
+// under load without loop() having to be there at the right moment.
+//
+// On the Nucleo the ST-LINK virtual COM port is USART2, whose TX request
+// is DMA1 stream 6, channel 4: add it in CubeMX under USART2 > DMA
+// Settings, with its interrupt and the USART2 global interrupt enabled.
+//
+//   extern UART_HandleTypeDef huart2;
+//   static TELEMETRY_Channel telemetry;
+//
+//   void setup(void) { TELEMETRY_init(&telemetry, &huart2); }
+//   void loop(void) { TELEMETRY_poll(&telemetry); }
+//   void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+//     TELEMETRY_log(&telemetry, TELEMETRY_ID_BUTTON, GPIO_Pin);
+//   }
+//   void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart) {
+//     TELEMETRY_onTxComplete(&telemetry, huart);
+//   }
+//   void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart) {
+//     TELEMETRY_onTxError(&telemetry, huart);
+//   }
+
+#ifndef TELEMETRY_CAPACITY
+#define TELEMETRY_CAPACITY 64
+#endif
+
+#if (TELEMETRY_CAPACITY & (TELEMETRY_CAPACITY - 1)) != 0
+#error "TELEMETRY_CAPACITY must be a power of two"
+#endif
+
+#ifndef TELEMETRY_BATCH
+#define TELEMETRY_BATCH 16
+#endif
+
+#define TELEMETRY_SYNC 0xA5U
+
+// The labs' own ids; the application's start at TELEMETRY_ID_USER.
+typedef enum {
+  TELEMETRY_ID_BUTTON = 1,
+  TELEMETRY_ID_LED,
+  TELEMETRY_ID_USER = 16
+} TELEMETRY_Id;
+
+typedef struct {
+  uint8_t sync;
+  uint8_t id;
+  uint16_t seq;
+  uint32_t tick;
+  uint32_t value;
+} TELEMETRY_Record;
+
+// Records are dropped when the ring is full, and also when the transfer
+// carrying them fails; errors counts failed transfers and transfers the
+// UART refused to start.
+typedef struct {
+  uint32_t logged;
+  uint32_t dropped;
+  uint32_t sent;
+  uint32_t errors;
+  uint32_t highWater;
+  uint64_t bytes;
+} TELEMETRY_Stats;
+
+// head and tail run freely and wrap; head - tail is the fill level. fill
+// is how many records the back buffer holds: loop() only adds to it while
+// it is short of TELEMETRY_BATCH, and the completion interrupt only takes
+// the buffer once it is full. sending is how many the DMA has in hand.
+typedef struct {
+  UART_HandleTypeDef *huart;
+  TELEMETRY_Record ring[TELEMETRY_CAPACITY];
+  uint32_t head;
+  uint32_t tail;
+  uint16_t seq;
+  TELEMETRY_Record buffers[2][TELEMETRY_BATCH];
+  uint32_t back;
+  uint32_t fill;
+  uint32_t sending;
+  TELEMETRY_Stats stats;
+} TELEMETRY_Channel;
+
+void TELEMETRY_init(TELEMETRY_Channel *channel, UART_HandleTypeDef *huart);
+int TELEMETRY_log(TELEMETRY_Channel *channel, uint8_t id, uint32_t value);
+uint32_t TELEMETRY_poll(TELEMETRY_Channel *channel);
+void TELEMETRY_onTxComplete(TELEMETRY_Channel *channel,
+                            UART_HandleTypeDef *huart);
+void TELEMETRY_onTxError(TELEMETRY_Channel *channel,
+                         UART_HandleTypeDef *huart);
+uint32_t TELEMETRY_pending(const TELEMETRY_Channel *channel);
+void TELEMETRY_stats(const TELEMETRY_Channel *channel,
+                     TELEMETRY_Stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Telemetry_H__ */
@@ -0,0 +1,71 @@
+#include "timblink.h"
+#include "debounce.h"
+#include <stddef.h>
+
+static TIM_HandleTypeDef *timer = NULL;
+static DEBOUNCE_Filter button;
+static volatile int running = 0;
+
+// Returns 0 when periodMs does not fit the auto-reload register.
+int TIMBLINK_init(TIM_HandleTypeDef *htim, uint32_t periodMs) {
+  uint32_t counts = periodMs * (TIMBLINK_COUNT_HZ / 1000U);
+
+  if (counts == 0 || counts > 0x10000U || periodMs > 0x10000U) {
+    return 0;
+  }
+
+  timer = htim;
+  running = 0;
+  DEBOUNCE_init(&button, DEBOUNCE_QUIET_MS);
+
+  htim->Init.Prescaler = TIMBLINK_CLOCK_HZ / TIMBLINK_COUNT_HZ - 1U;
+  htim->Init.CounterMode = TIM_COUNTERMODE_UP;
+  htim->Init.Period = counts - 1U;
+  htim->Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+  htim->Init.AutoReloadPreload = TIM_AUTORELOAD_PRELOAD_DISABLE;
+  return HAL_TIM_Base_Init(htim) == HAL_OK;
+}
+
+// Lights the LED and restarts the period. HAL_TIM_Base_Init() leaves UIF
+// set from its update event, which would otherwise toggle the LED as soon
+// as the interrupt is enabled.
+void TIMBLINK_start(void) {
+  HAL_GPIO_WritePin(LED_GPIO_Port, LED_Pin, GPIO_PIN_SET);
+  __HAL_TIM_SET_COUNTER(timer, 0);
+  __HAL_TIM_CLEAR_FLAG(timer, TIM_FLAG_UPDATE);
+  HAL_TIM_Base_Start_IT(timer);
+  running = 1;
+}
+
+void TIMBLINK_stop(void) {
+  HAL_TIM_Base_Stop_IT(timer);
+  running = 0;
+  HAL_GPIO_WritePin(LED_GPIO_Port, LED_Pin, GPIO_PIN_RESET);
+}
+
+int TIMBLINK_running(void) { return running; }
+
+void TIMBLINK_onPeriodElapsed(TIM_HandleTypeDef *htim) {
+  if (timer != NULL && htim->Instance == timer->Instance) {
+    HAL_GPIO_TogglePin(LED_GPIO_Port, LED_Pin);
+  }
+}
+
+void TIMBLINK_onButton(uint16_t GPIO_Pin) {
+  if (GPIO_Pin != PUSH_BUTTON_Pin || timer == NULL) {
+    return;
+  }
+
+  int pressed = HAL_GPIO_ReadPin(PUSH_BUTTON_GPIO_Port, PUSH_BUTTON_Pin) ==
+                GPIO_PIN_RESET;
+
+  if (!DEBOUNCE_edge(&button, HAL_GetTick(), pressed)) {
+    return;
+  }
+
+  if (running) {
+    TIMBLINK_stop();
+  } else {
+    TIMBLINK_start();
+  }
+}
@@ -0,0 +1,58 @@
+#ifndef Timblink_H__
+#define Timblink_H__
+
+#include "main.h"
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Timer-driven blinking for the scheduling and challenge labs.
+//
+// A TIM update interrupt toggles LED_Pin, so loop() keeps no time at all
+// and is free to sleep in __WFI(). In the challenge the button starts and
+// stops the timer straight from the EXTI callback, debounced like
+// CHALLENGE_onButton() and so with its EXTI line triggering on both
+// edges. Route the HAL callbacks here from app.c:
+//
+//   extern TIM_HandleTypeDef htim2;
+//
+//   void setup(void) {
+//     TIMBLINK_init(&htim2, 1000);
+//     TIMBLINK_start(); // the scheduling lab only
+//   }
+//   void loop(void) { __WFI(); }
+//   void HAL_TIM_PeriodElapsedCallback(TIM_HandleTypeDef *htim) {
+//     TIMBLINK_onPeriodElapsed(htim);
+//   }
+//   void HAL_GPIO_EXTI_Callback(uint16_t GPIO_Pin) {
+//     TIMBLINK_onButton(GPIO_Pin);
+//   }
+//
+// The timer counts at TIMBLINK_COUNT_HZ from TIMBLINK_CLOCK_HZ, which is
+// SystemCoreClock for the APB1 timers with the labs' clock tree. At 10 kHz
+// any period up to 6553 ms fits a 16-bit auto-reload register. Give the
+// TIM and EXTI interrupts the same preemption priority, so a toggle never
+// lands between stopping the timer and turning the LED off.
+
+#ifndef TIMBLINK_COUNT_HZ
+#define TIMBLINK_COUNT_HZ 10000U
+#endif
+
+#ifndef TIMBLINK_CLOCK_HZ
+#define TIMBLINK_CLOCK_HZ SystemCoreClock
+#endif
+
+int TIMBLINK_init(TIM_HandleTypeDef *htim, uint32_t periodMs);
+void TIMBLINK_start(void);
+void TIMBLINK_stop(void);
+int TIMBLINK_running(void);
+void TIMBLINK_onPeriodElapsed(TIM_HandleTypeDef *htim);
+void TIMBLINK_onButton(uint16_t GPIO_Pin);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* Timblink_H__ */